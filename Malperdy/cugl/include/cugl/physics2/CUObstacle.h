@@ -131,6 +131,18 @@ private:
     bool _remove;
     /** Whether the object has changed shape and needs a new fixture */
     bool _dirty;
+
+    /// Track the transforms to draw between
+    /** The position at the end of the step before the latest one */
+    Vec2 _prevPosition;
+    /** The position at the end of the latest step */
+    Vec2 _currPosition;
+    /** The angle at the end of the step before the latest one */
+    float _prevAngle;
+    /** The angle at the end of the latest step */
+    float _currAngle;
+    /** Whether the transforms have been captured since the object last jumped */
+    bool _captured;
     
 
 #pragma mark -
@@ -903,6 +915,75 @@ public:
         _listener = listener;
     }
 
+#pragma mark -
+#pragma mark Interpolation
+    /**
+     * Keeps the current transform as the one at the end of the latest step.
+     *
+     * The transform it replaces becomes the previous transform, so that the
+     * object can be drawn partway between the two when the display refreshes
+     * more often than the physics steps. If the object has no previous
+     * transform, because this is the first capture or it has been snapped,
+     * both transforms are set to the current one.
+     *
+     * This is normally called by {@link ObstacleWorld#captureTransforms}.
+     */
+    void captureTransform() {
+        Vec2 position = getPosition();
+        float angle = getAngle();
+        _prevPosition = (_captured ? _currPosition : position);
+        _prevAngle = (_captured ? _currAngle : angle);
+        _currPosition = position;
+        _currAngle = angle;
+        _captured = true;
+    }
+
+    /**
+     * Forgets the previous transform of this object.
+     *
+     * This should be called when the object jumps somewhere instead of
+     * moving there, so that it is not drawn sliding to where it jumped.
+     * Until the next capture, the object has no transforms.
+     */
+    void snapTransform() { _captured = false; }
+
+    /**
+     * Returns true if this object has transforms to draw between.
+     *
+     * @return true if this object has transforms to draw between.
+     */
+    bool hasTransforms() const { return _captured; }
+
+    /**
+     * Returns the position partway between the last two captures.
+     *
+     * An alpha of 0 is the position at the end of the step before the latest
+     * one, and an alpha of 1 is the position at the end of the latest step.
+     *
+     * @param alpha How far between the two captures, from 0 to 1
+     *
+     * @return the position partway between the last two captures.
+     */
+    Vec2 getInterpolatedPosition(float alpha) const {
+        Vec2 result;
+        Vec2::lerp(_prevPosition, _currPosition, alpha, &result);
+        return result;
+    }
+
+    /**
+     * Returns the angle partway between the last two captures.
+     *
+     * An alpha of 0 is the angle at the end of the step before the latest
+     * one, and an alpha of 1 is the angle at the end of the latest step.
+     *
+     * @param alpha How far between the two captures, from 0 to 1
+     *
+     * @return the angle partway between the last two captures.
+     */
+    float getInterpolatedAngle(float alpha) const {
+        return _prevAngle + (_currAngle - _prevAngle) * alpha;
+    }
+
 #pragma mark -
 #pragma mark Debugging Methods
     /**
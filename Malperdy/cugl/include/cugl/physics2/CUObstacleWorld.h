@@ -327,6 +327,25 @@ public:
      * @param dt Number of seconds since last animation frame
      */
     void update(float dt);
+
+    /**
+     * Keeps the transform of every object as the one at the end of a step.
+     *
+     * Each object also keeps the transform it had at the capture before, so
+     * that it can be drawn partway between the two when the display refreshes
+     * more often than the physics steps. This should be called once all of the
+     * changes of a step are done, which may include changes made after
+     * {@link update}.
+     */
+    void captureTransforms();
+
+    /**
+     * Makes every object forget its previous transform.
+     *
+     * This should be called when objects jump somewhere instead of moving
+     * there, so that none of them are drawn sliding to where they jumped.
+     */
+    void snapTransforms();
     
     /**
      * Returns the bounds for the world controller.
@@ -0,0 +1,268 @@
+//
+//  CUProfiler.h
+//  Cornell University Game Library (CUGL)
+//
+//  Module for a low-overhead, hierarchical profiler of scoped zones. A zone
+//  is a block of code marked with CU_PROFILE_ZONE, which records when the
+//  block started and ended, in nanoseconds, when it goes out of scope. Zones
+//  nest, so a zone in a method called from another zone is recorded as its
+//  child.
+//
+//  Every thread records into its own ring buffer, so recording a zone never
+//  takes a lock. Once a buffer is full, the oldest zones are overwritten.
+//  The buffers can be exported as Chrome trace-event JSON, which can be
+//  opened in chrome://tracing or Perfetto, and the profiler keeps a rolling
+//  summary of how long each zone took per frame that can be drawn on screen.
+//
+//  The profiler only exists when CUGL is compiled with CU_PROFILE defined.
+//  Otherwise the macros compile to nothing, so the zones cost nothing at all,
+//  and any code using the Profiler class directly should be guarded by the
+//  same define.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/16/26
+//
+#ifndef __CU_PROFILER_H__
+#define __CU_PROFILER_H__
+#include <cugl/base/CUBase.h>
+
+#pragma mark -
+#pragma mark Profiler Macros
+
+#ifdef CU_PROFILE
+
+/** Pastes two tokens together, after expanding them */
+#define CU_PROFILE_CONCAT_(a,b) a##b
+/** Pastes two tokens together, after expanding them */
+#define CU_PROFILE_CONCAT(a,b)  CU_PROFILE_CONCAT_(a,b)
+
+/**
+ * Records a zone from here to the end of the enclosing block.
+ *
+ * The name must be a string literal (or some other string that lives for
+ * the whole program), as only the pointer is kept.
+ */
+#define CU_PROFILE_ZONE(name)   cugl::ProfileZone CU_PROFILE_CONCAT(__cu_zone_,__LINE__)(name)
+/** Marks the end of an animation frame, for the rolling summary */
+#define CU_PROFILE_FRAME()      cugl::Profiler::frame()
+/** Names the current thread in the exported trace */
+#define CU_PROFILE_THREAD(name) cugl::Profiler::setThreadName(name)
+
+#else
+
+#define CU_PROFILE_ZONE(name)
+#define CU_PROFILE_FRAME()
+#define CU_PROFILE_THREAD(name)
+
+#endif
+
+#ifdef CU_PROFILE
+#include <atomic>
+#include <string>
+
+/** The number of zones each thread keeps before overwriting the oldest */
+#define CU_PROFILE_CAPACITY 16384
+/** The number of frames the rolling summary is taken over */
+#define CU_PROFILE_WINDOW   60
+
+namespace cugl {
+
+#pragma mark -
+#pragma mark Profiler
+
+/**
+ * Static class for recording and reporting profiled zones.
+ *
+ * Zones are normally recorded with the CU_PROFILE_ZONE macro, which creates
+ * a {@link ProfileZone} on the stack. This class owns the per-thread ring
+ * buffers those zones are recorded into, and turns them into something that
+ * can be read.
+ *
+ * Recording is lock-free. Each thread gets its own buffer the first time it
+ * records a zone, and only that thread ever writes to it. Reading a buffer
+ * (to export it or to summarize it) takes a lock on the list of buffers, but
+ * never blocks the threads writing to them. Any zone that was overwritten
+ * while it was being read is thrown away.
+ *
+ * This class only exists when CUGL is compiled with CU_PROFILE defined.
+ */
+class Profiler {
+public:
+    /** The buffer of zones for a single thread */
+    class Buffer;
+
+    /**
+     * Returns the current time in nanoseconds.
+     *
+     * The time is measured from when the profiler was first used, with a
+     * steady clock.
+     *
+     * @return the current time in nanoseconds.
+     */
+    static Uint64 now();
+
+    /**
+     * Returns the buffer for the current thread, creating it if needed.
+     *
+     * @return the buffer for the current thread.
+     */
+    static Buffer* local();
+
+    /**
+     * Records a zone in the buffer of the current thread.
+     *
+     * This is called by {@link ProfileZone} when it goes out of scope. It
+     * should not be necessary to call it directly.
+     *
+     * @param buffer    the buffer of the current thread
+     * @param name      the zone name
+     * @param start     when the zone started, in nanoseconds
+     * @param end       when the zone ended, in nanoseconds
+     * @param depth     how many zones this zone is nested in
+     */
+    static void record(Buffer* buffer, const char* name, Uint64 start, Uint64 end, Uint32 depth);
+
+    /**
+     * Adds one to the depth of the current thread, returning the old depth.
+     *
+     * @param buffer    the buffer of the current thread
+     *
+     * @return the depth of the zone being entered
+     */
+    static Uint32 enter(Buffer* buffer);
+
+    /**
+     * Sets whether zones are recorded.
+     *
+     * Zones that have already started are still recorded when they end.
+     * Profiling is enabled by default.
+     *
+     * @param value whether zones are recorded
+     */
+    static void setEnabled(bool value);
+
+    /**
+     * Returns true if zones are recorded.
+     *
+     * @return true if zones are recorded.
+     */
+    static bool isEnabled();
+
+    /**
+     * Sets the name of the current thread in the exported trace.
+     *
+     * @param name  the thread name
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * Marks the end of an animation frame.
+     *
+     * Every zone recorded since the last frame, on any thread, is added to
+     * the rolling summary. This should be called once per frame on the main
+     * thread, which {@link Application} does at the end of each step.
+     */
+    static void frame();
+
+    /**
+     * Returns the rolling summary of the last frames.
+     *
+     * Each line is a zone, indented by how deeply it is nested, with the
+     * average and longest time it took per frame over the last
+     * CU_PROFILE_WINDOW frames, and how many times it ran per frame. The
+     * zones are in the order they were first seen.
+     *
+     * @return the rolling summary of the last frames.
+     */
+    static std::string getSummary();
+
+    /**
+     * Writes every zone still in the buffers as Chrome trace-event JSON.
+     *
+     * The file can be opened in chrome://tracing or https://ui.perfetto.dev.
+     * This does not clear the buffers.
+     *
+     * @param path  the path to write to
+     *
+     * @return true if the trace was written
+     */
+    static bool exportTrace(const std::string& path);
+
+    /**
+     * Throws away every recorded zone and the rolling summary.
+     */
+    static void clear();
+};
+
+#pragma mark -
+#pragma mark Profile Zone
+
+/**
+ * Class to record a zone from its construction to its destruction.
+ *
+ * This is meant to be created on the stack with the CU_PROFILE_ZONE macro,
+ * so that the zone ends when the enclosing block does.
+ */
+class ProfileZone {
+private:
+    /** The buffer of the current thread, or nullptr if not recording */
+    Profiler::Buffer* _buffer;
+    /** The zone name */
+    const char* _name;
+    /** When the zone started, in nanoseconds */
+    Uint64 _start;
+    /** How many zones this zone is nested in */
+    Uint32 _depth;
+
+public:
+    /**
+     * Starts a zone with the given name.
+     *
+     * @param name  the zone name, which must outlive the program
+     */
+    ProfileZone(const char* name) : _buffer(nullptr), _name(name), _start(0), _depth(0) {
+        if (Profiler::isEnabled()) {
+            _buffer = Profiler::local();
+            _depth = Profiler::enter(_buffer);
+            _start = Profiler::now();
+        }
+    }
+
+    /**
+     * Ends the zone, recording it.
+     */
+    ~ProfileZone() {
+        if (_buffer != nullptr) {
+            Profiler::record(_buffer, _name, _start, Profiler::now(), _depth);
+        }
+    }
+
+    /** Zones cannot be copied */
+    ProfileZone(const ProfileZone&) = delete;
+    /** Zones cannot be copied */
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+}
+
+#endif /* CU_PROFILE */
+#endif /* __CU_PROFILER_H__ */
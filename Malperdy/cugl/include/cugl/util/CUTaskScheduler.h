@@ -0,0 +1,509 @@
+//
+//  CUTaskScheduler.h
+//  Cornell University Game Library (CUGL)
+//
+//  Module for a work-stealing scheduler of asynchronous tasks. Each worker
+//  thread has its own deque of tasks. A worker pushes and pops the tasks it
+//  spawns at the bottom of its deque, and when it runs out it steals from the
+//  top of the deques of the other workers. Tasks submitted from outside the
+//  workers go into a shared queue, which is served first come, first served.
+//
+//  Unlike ThreadPool, tasks have handles that can be waited on, can return
+//  values through futures, and can depend on other tasks, so a task only runs
+//  once every task it depends on has finished. A thread waiting on a task
+//  runs other tasks while it waits, so it is safe to wait from inside a task.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/16/26
+//
+#ifndef __CU_TASK_SCHEDULER_H__
+#define __CU_TASK_SCHEDULER_H__
+#include <cugl/base/CUBase.h>
+#include <SDL/SDL.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <thread>
+
+// std::thread is not safe on Android and Windows platforms
+#if defined (__WINDOWS__) || defined (__ANDROID__)
+    #define CU_SDL_THREADS 1
+#endif
+
+namespace cugl {
+
+class TaskScheduler;
+
+#pragma mark -
+#pragma mark Task Handle
+
+/**
+ * Class to refer to a task submitted to a {@link TaskScheduler}.
+ *
+ * A handle can be used to check whether a task has finished, to wait for it
+ * to finish, or to make another task depend on it. Handles are cheap to copy,
+ * and a task stays alive as long as any handle to it does.
+ *
+ * A default handle refers to no task, and counts as finished.
+ */
+class TaskHandle {
+public:
+    /** A task, as shared between the scheduler and its handles */
+    class Task;
+
+private:
+    /** The task referred to */
+    std::shared_ptr<Task> _task;
+
+    friend class TaskScheduler;
+
+public:
+    /**
+     * Creates a handle that refers to no task.
+     */
+    TaskHandle() {}
+
+    /**
+     * Creates a handle for the given task.
+     *
+     * @param task  the task to refer to
+     */
+    TaskHandle(const std::shared_ptr<Task>& task) : _task(task) {}
+
+    /**
+     * Returns true if this handle refers to a task.
+     *
+     * @return true if this handle refers to a task.
+     */
+    bool isValid() const { return _task != nullptr; }
+
+    /**
+     * Returns true if the task has finished.
+     *
+     * A handle that refers to no task is always finished.
+     *
+     * @return true if the task has finished.
+     */
+    bool isDone() const;
+
+    /**
+     * Blocks until the task has finished.
+     *
+     * The calling thread runs other tasks of the same scheduler while it
+     * waits, so this is safe to call from inside a task.
+     */
+    void wait() const;
+};
+
+#pragma mark -
+#pragma mark Task Future
+
+/**
+ * Class to refer to a task that returns a value.
+ *
+ * This is a {@link TaskHandle} together with the value the task returned,
+ * which can be read once the task has finished.
+ */
+template <typename T>
+class TaskFuture {
+private:
+    /** The task computing the value */
+    TaskHandle _handle;
+    /** Where the task puts the value */
+    std::shared_ptr<std::unique_ptr<T>> _result;
+
+public:
+    /**
+     * Creates a future that refers to no task.
+     */
+    TaskFuture() {}
+
+    /**
+     * Creates a future for the given task and result.
+     *
+     * @param handle    the task computing the value
+     * @param result    where the task puts the value
+     */
+    TaskFuture(const TaskHandle& handle, const std::shared_ptr<std::unique_ptr<T>>& result) :
+    _handle(handle), _result(result) {}
+
+    /**
+     * Returns the handle of the task computing the value.
+     *
+     * @return the handle of the task computing the value.
+     */
+    const TaskHandle& getHandle() const { return _handle; }
+
+    /**
+     * Returns true if this future refers to a task.
+     *
+     * @return true if this future refers to a task.
+     */
+    bool isValid() const { return _handle.isValid(); }
+
+    /**
+     * Returns true if the value is ready.
+     *
+     * @return true if the value is ready.
+     */
+    bool isDone() const { return _handle.isDone(); }
+
+    /**
+     * Returns the value, waiting for the task to finish if necessary.
+     *
+     * The future must refer to a task.
+     *
+     * @return the value returned by the task
+     */
+    const T& get() const {
+        _handle.wait();
+        return **_result;
+    }
+};
+
+#pragma mark -
+#pragma mark Task Scheduler
+
+/**
+ * Class providing a work-stealing scheduler of asynchronous tasks.
+ *
+ * Each worker thread has its own deque. A task submitted from a worker is
+ * pushed to the bottom of that worker's deque, and the worker always takes
+ * its next task from the bottom, so nested work stays on the same core. A
+ * worker with nothing left takes from the queue of tasks submitted from
+ * outside the workers, and after that steals from the top of another
+ * worker's deque, taking its oldest (and usually largest) task. Tasks
+ * submitted from outside the workers run in the order they were submitted
+ * whenever there is only one worker.
+ *
+ * A task may depend on other tasks, in which case it is only queued once
+ * they have all finished. A thread that waits on a task runs other tasks
+ * while it waits, instead of blocking a core. If the scheduler has been
+ * stopped, the waiting thread will run the task itself.
+ *
+ * Like ThreadPool, there are no guarantees about thread safety inside of a
+ * task; that is the responsibility of the author of each task. Stopping a
+ * scheduler throws away any tasks that have not started.
+ */
+class TaskScheduler {
+private:
+    /** The deque of tasks of a single worker */
+    struct Worker {
+        /** The tasks of this worker, with the newest at the back */
+        std::deque<std::shared_ptr<TaskHandle::Task>> tasks;
+        /** A mutex lock for the tasks of this worker */
+        std::mutex mutex;
+    };
+
+    /** The individual worker threads for this scheduler */
+#ifdef CU_SDL_THREADS
+    std::vector<SDL_Thread*> _threads;
+#else
+    std::vector<std::thread> _threads;
+#endif
+    /** The deque of each worker thread */
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    /** Tasks submitted from outside the workers, oldest first */
+    std::deque<std::shared_ptr<TaskHandle::Task>> _shared;
+    /** A mutex lock for the shared queue */
+    std::mutex _sharedMutex;
+
+    /** The number of tasks waiting in any queue */
+    std::atomic<int> _queued;
+    /** The number of threads asleep, waiting for work or for a task to finish */
+    std::atomic<int> _sleepers;
+    /** A mutex lock for sleeping */
+    std::mutex _sleepMutex;
+    /** A condition variable to wake threads waiting for work or for a task */
+    std::condition_variable _sleepCondition;
+
+    /** Whether or not the scheduler has been marked for shutdown */
+    std::atomic<bool> _stop;
+    /** The number of worker threads that are completed */
+    std::atomic<int> _complete;
+
+    /**
+     * Queues a task whose dependencies have all finished.
+     *
+     * The task goes on the deque of the calling thread if it is a worker of
+     * this scheduler, and on the shared queue otherwise.
+     *
+     * @param task      the task to queue
+     * @param shared    whether to always use the shared queue
+     */
+    void enqueue(const std::shared_ptr<TaskHandle::Task>& task, bool shared = false);
+
+    /**
+     * Takes the next task for the calling thread, if there is one.
+     *
+     * @param index the worker index of the calling thread, or -1 for none
+     *
+     * @return the next task, or nullptr if every queue is empty
+     */
+    std::shared_ptr<TaskHandle::Task> take(int index);
+
+    /**
+     * Runs the given task, and queues any task that was only waiting on it.
+     *
+     * @param task  the task to run
+     */
+    void execute(const std::shared_ptr<TaskHandle::Task>& task);
+
+    /**
+     * Runs the next task for the calling thread, if there is one.
+     *
+     * @return true if a task was run
+     */
+    bool runOne();
+
+    /**
+     * Blocks until the given task has finished, running other tasks meanwhile.
+     *
+     * @param task  the task to wait on
+     */
+    void wait(const std::shared_ptr<TaskHandle::Task>& task);
+
+    /**
+     * The body function of a single worker thread.
+     *
+     * @param index the index of the worker
+     */
+    void threadFunc(int index);
+
+    /**
+     * The body function of a single worker thread.
+     *
+     * This static implementation uses the SDL thread API.  It should be used
+     * on Android and Windows, which have special thread requirements.
+     */
+    static int sdlThreadFunc(void* ptr);
+
+    friend class TaskHandle;
+
+#pragma mark Constructors
+public:
+    /**
+     * Creates a scheduler with no active threads.
+     *
+     * You must initialize this scheduler before use.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a scheduler
+     * on the heap, use one of the static constructors instead.
+     */
+    TaskScheduler() : _queued(0), _sleepers(0), _stop(false), _complete(0) { }
+
+    /**
+     * Deletes this scheduler, destroying all resources.
+     *
+     * This destructor will block until every worker thread has completed
+     * its current task.
+     */
+    ~TaskScheduler() { dispose(); }
+
+    /**
+     * Disposes this scheduler, releasing all memory.
+     *
+     * This method will block until every worker thread has completed its
+     * current task. Tasks that have not started are thrown away.
+     */
+    void dispose();
+
+    /**
+     * Initializes a scheduler with the given number of threads.
+     *
+     * If threads is 0, the scheduler has one worker for every core but one,
+     * leaving a core for the main thread. A scheduler always has at least
+     * one worker.
+     *
+     * @param threads   the number of threads in this scheduler
+     *
+     * @return true if the scheduler is initialized properly, false otherwise.
+     */
+    bool init(int threads = 0);
+
+#pragma mark Static Constructors
+    /**
+     * Returns a newly allocated scheduler with the given number of threads.
+     *
+     * If threads is 0, the scheduler has one worker for every core but one,
+     * leaving a core for the main thread. A scheduler always has at least
+     * one worker.
+     *
+     * @param threads   the number of threads in this scheduler
+     *
+     * @return a newly allocated scheduler with the given number of threads.
+     */
+    static std::shared_ptr<TaskScheduler> alloc(int threads = 0) {
+        std::shared_ptr<TaskScheduler> result = std::make_shared<TaskScheduler>();
+        return (result->init(threads) ? result : nullptr);
+    }
+
+#pragma mark Task Management
+    /**
+     * Submits a task, returning a handle to it.
+     *
+     * The task will not run until every task it depends on has finished.
+     * Handles that refer to no task are ignored.
+     *
+     * @param work          the task function
+     * @param dependencies  the tasks that must finish first
+     *
+     * @return a handle to the task
+     */
+    TaskHandle submit(const std::function<void()>& work,
+                      const std::vector<TaskHandle>& dependencies = std::vector<TaskHandle>());
+
+    /**
+     * Submits a task to the back of the shared queue, returning a handle to it.
+     *
+     * Unlike {@link submit}, this never puts the task on the deque of the
+     * calling worker, even when called from a task. When the scheduler has
+     * one worker, tasks posted this way run one at a time in the order they
+     * were posted, which is how ThreadPool keeps the order of its tasks.
+     *
+     * @param work  the task function
+     *
+     * @return a handle to the task
+     */
+    TaskHandle post(const std::function<void()>& work);
+
+    /**
+     * Submits a task that returns a value, returning a future for it.
+     *
+     * The task will not run until every task it depends on has finished.
+     *
+     * @param work          the task function
+     * @param dependencies  the tasks that must finish first
+     *
+     * @return a future for the value returned by the task
+     */
+    template <typename F>
+    auto async(F work, const std::vector<TaskHandle>& dependencies = std::vector<TaskHandle>())
+    -> TaskFuture<typename std::decay<decltype(work())>::type> {
+        typedef typename std::decay<decltype(work())>::type T;
+        std::shared_ptr<std::unique_ptr<T>> result = std::make_shared<std::unique_ptr<T>>();
+        TaskHandle handle = submit([=]() { result->reset(new T(work())); }, dependencies);
+        return TaskFuture<T>(handle,result);
+    }
+
+    /**
+     * Returns a handle that finishes once all of the given tasks have.
+     *
+     * This can be used to wait on a group of tasks, or to make a task
+     * depend on a group.
+     *
+     * @param tasks the tasks to join
+     *
+     * @return a handle that finishes once all of the given tasks have
+     */
+    TaskHandle join(const std::vector<TaskHandle>& tasks) {
+        return submit(nullptr,tasks);
+    }
+
+    /**
+     * Runs the given function over the range [begin,end), in parallel.
+     *
+     * The range is split into chunks of at most grain indices, and the
+     * function is called with the start and end of each chunk. If grain is
+     * 0, the chunks are sized so that each worker gets a few of them. The
+     * calling thread works on the chunks too, and this method only returns
+     * once every chunk is done.
+     *
+     * @param begin the start of the range
+     * @param end   the end of the range (exclusive)
+     * @param grain the most indices in a chunk, or 0 to choose
+     * @param body  the function to call on each chunk
+     */
+    void parallelFor(size_t begin, size_t end, size_t grain,
+                     const std::function<void(size_t,size_t)>& body);
+
+    /**
+     * Runs the given function on each index in [begin,end), in parallel.
+     *
+     * This is a version of parallelFor for bodies that are called on one
+     * index at a time. The calling thread works on the range too, and this
+     * method only returns once every index is done.
+     *
+     * @param begin the start of the range
+     * @param end   the end of the range (exclusive)
+     * @param body  the function to call on each index
+     */
+    void parallelFor(size_t begin, size_t end, const std::function<void(size_t)>& body) {
+        parallelFor(begin, end, 0, [&](size_t first, size_t last) {
+            for(size_t ii = first; ii < last; ii++) {
+                body(ii);
+            }
+        });
+    }
+
+    /**
+     * Stop the scheduler, marking it for shut down.
+     *
+     * This method blocks until every worker thread has finished its current
+     * task. Tasks that have not started are thrown away, except by a thread
+     * waiting on them, which will run them itself.
+     */
+    void stop();
+
+    /**
+     * Returns whether the scheduler has been stopped.
+     *
+     * @return whether the scheduler has been stopped.
+     */
+    bool isStopped() const { return _stop; }
+
+    /**
+     * Returns whether the scheduler has been shut down.
+     *
+     * A shut down scheduler has no active threads and is safe for deletion.
+     *
+     * @return whether the scheduler has been shut down.
+     */
+    bool isShutdown() const { return (int)_threads.size() == _complete; }
+
+    /**
+     * Returns the number of worker threads.
+     *
+     * @return the number of worker threads.
+     */
+    int getWorkerCount() const { return (int)_workers.size(); }
+
+    /**
+     * Returns true if the calling thread is a worker of this scheduler.
+     *
+     * @return true if the calling thread is a worker of this scheduler.
+     */
+    bool isWorkerThread() const;
+
+private:
+    /** Copying is only allowed via shared pointer. */
+    CU_DISALLOW_COPY_AND_ASSIGN(TaskScheduler);
+};
+
+}
+
+#endif /* __CU_TASK_SCHEDULER_H__ */
@@ -32,21 +32,20 @@
 //  Author: Walker White
 //  Version: 11/29/16
 //
+
+// Modified for Malperdy: the pool is now a thin layer over TaskScheduler,
+// kept so that existing code (such as the asset loaders) does not have to
+// change. New code should use TaskScheduler directly, which has handles,
+// futures, and dependencies.
+
 #ifndef __CU_THREAD_POOL_H__
 #define __CU_THREAD_POOL_H__
 #include <cugl/base/CUBase.h>
-#include <SDL/SDL.h>
-#include <condition_variable>
+#include <cugl/util/CUTaskScheduler.h>
+#include <deque>
 #include <functional>
-#include <stdio.h>
-#include <queue>
-#include <vector>
-#include <thread>
-
-// std::thread is not safe on Android and Windows platforms
-#if defined (__WINDOWS__) || defined (__ANDROID__)
-    #define CU_SDL_THREADS 1
-#endif
+#include <memory>
+#include <mutex>
 
 namespace cugl {
 
@@ -72,48 +71,36 @@ namespace cugl {
  *
  *  See the class {@link AssetManager} for an example of how to use a thread 
  *  pool.
+ *
+ *  The tasks are run by a {@link TaskScheduler} that belongs to this pool
+ *  alone. The pool keeps its own queue of tasks, and never has more of them
+ *  running than it has threads, however many threads the scheduler has or
+ *  whoever helps it run tasks. Tasks start in the order they were added, so
+ *  a pool with one thread runs its tasks one at a time, in order.
  */
 class ThreadPool {
 private:
-    /** The individual worker threads for this thread pool */
-#ifdef CU_SDL_THREADS
-    std::vector<SDL_Thread*> _workers;
-#else
-    std::vector<std::thread> _workers;
-#endif
-    
+    /** The scheduler running the tasks of this pool */
+    std::shared_ptr<TaskScheduler> _scheduler;
+
     /** Tasks waiting to be assigned to a thread */
-    std::queue< std::function<void()> > _taskQueue;
-    
+    std::deque< std::function<void()> > _taskQueue;
     /** A mutex lock for the task queue */
     std::mutex _queueMutex;
-    /** A condition variable to manage tasks waiting for a worker */
-    std::condition_variable _taskCondition;
-    
+    /** The number of threads in this pool */
+    int _threads;
+    /** The number of threads currently taking tasks from the queue */
+    int _running;
     /** Whether or not the thread pool has been marked for shutdown */
     bool _stop;
-    /** The number of child threads that are completed */
-    int _complete;
-    
-    /**
-     * The body function of a single thread.
-     *
-     * This function pulls tasks from the task queue.  
-     *
-     * This implementation is safe to use with std::thread.
-     */
-    void threadFunc();
 
     /**
-     * The body function of a single thread.
-     *
-     * This function pulls tasks from the task queue.
+     * The body of a single thread of this pool.
      *
-     * This static implementation uses the SDL thread API.  It should be used
-     * on Android and Windows, which have special thread requirements.
+     * This runs tasks from the queue, in order, until it is empty or the
+     * pool has been stopped.
      */
-    static int sdlThreadFunc(void* ptr);
-    
+    void drain();
 
 #pragma mark Constructors
 public:
@@ -125,7 +112,7 @@ public:
      * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate a thread pool 
      * on the heap, use one of the static constructors instead.
      */
-    ThreadPool() :_stop(false), _complete(0) { }
+    ThreadPool() : _threads(0), _running(0), _stop(false) { }
     
     /**
      * Deletes this thread pool, destroying all resources.
@@ -154,6 +141,8 @@ public:
      * 4 is generally a good number, even if you have a lot of tasks.  Much
      * more than the number of cores on a machine is counter-productive.
      *
+     * A pool must have at least one thread.
+     *
      * @param threads   the number of threads in this pool
      *
      * @return true if the threed pool is initialized properly, false otherwise.
@@ -169,6 +158,8 @@ public:
      * 4 is generally a good number, even if you have a lot of tasks.  Much
      * more than the number of cores on a machine is counter-productive.
      *
+     * A pool must have at least one thread.
+     *
      * @param threads   the number of threads in this pool
      *
      * @return a newly allocated thread pool with the given number of threads.
@@ -210,7 +201,7 @@ public:
      *
      * @return whether the thread pool has been stopped.
      */
-    bool isStopped() const { return _stop; }
+    bool isStopped() const { return _scheduler != nullptr && _scheduler->isStopped(); }
     
     /**
      * Returns whether the thread pool has been shut down.
@@ -219,7 +210,18 @@ public:
      *
      * @return whether the thread pool has been shut down.
      */
-    bool isShutdown() const { return _workers.size() == _complete; }
+    bool isShutdown() const { return _scheduler == nullptr || _scheduler->isShutdown(); }
+
+    /**
+     * Returns the scheduler running the tasks of this pool.
+     *
+     * This can be used to submit tasks with handles or dependencies to the
+     * same threads. Those tasks are not part of the queue of this pool, so
+     * they are not ordered with the tasks added by {@link addTask}.
+     *
+     * @return the scheduler running the tasks of this pool.
+     */
+    const std::shared_ptr<TaskScheduler>& getScheduler() const { return _scheduler; }
   
 private:  
     /** Copying is only allowed via shared pointer. */
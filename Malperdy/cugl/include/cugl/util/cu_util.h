@@ -36,5 +36,7 @@
 #include "CUFreeList.h"
 #include "CUGreedyFreeList.h"
 #include "CUThreadPool.h"
+#include "CUTaskScheduler.h"
+#include "CUProfiler.h"
 
 #endif /* __CU_UTIL_PKG_H__ */
@@ -46,6 +46,7 @@
 //  Version: 5/20/19
 //
 #include <cugl/cugl.h>
+#include <cugl/util/CUProfiler.h>
 
 using namespace cugl;
 
@@ -444,6 +445,7 @@ void AssetManager::loadDirectoryAsync(const std::string& directory, LoaderCallba
     }
     
     _workers->addTask([=](void) {
+        CU_PROFILE_ZONE("AssetManager::loadDirectory");
         std::shared_ptr<JsonValue> json = reader->readJson();
         loadDirectoryAsync(json,callback);
         _preload = false;
@@ -45,6 +45,7 @@
 //
 #include <cugl/assets/CUTextureLoader.h>
 #include <cugl/base/CUApplication.h>
+#include <cugl/util/CUProfiler.h>
 #include <SDL/SDL_image.h>
 
 using namespace cugl;
@@ -200,6 +201,7 @@ SDL_Surface* TextureLoader::preload(const std::string& source) {
  * @param callback  An optional callback for asynchronous loading
  */
 void TextureLoader::materialize(const std::string& key, SDL_Surface* surface, LoaderCallback callback) {
+    CU_PROFILE_ZONE("TextureLoader::materialize");
     std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
     
     bool success = false;
@@ -251,6 +253,7 @@ void TextureLoader::materialize(const std::string& key, SDL_Surface* surface, Lo
  * @param callback  An optional callback for asynchronous loading
  */
 void TextureLoader::materialize(const std::shared_ptr<JsonValue>& json, SDL_Surface* surface, LoaderCallback callback) {
+    CU_PROFILE_ZONE("TextureLoader::materialize");
     std::shared_ptr<Texture> texture = Texture::allocWithData(surface->pixels, surface->w, surface->h);
     std::string key = json->key();
 
@@ -316,6 +319,7 @@ bool TextureLoader::read(const std::string key, const std::string source, Loader
         _queue.erase(key);
     } else {
         _loader->addTask([=](void) {
+            CU_PROFILE_ZONE("TextureLoader::preload");
             SDL_Surface* surface = this->preload(source);
             Application::get()->schedule([=](void){
                 this->materialize(key,surface,callback);
@@ -385,6 +389,7 @@ bool TextureLoader::read(const std::shared_ptr<JsonValue>& json, LoaderCallback
         _queue.erase(key);
     } else {
         _loader->addTask([=](void) {
+            CU_PROFILE_ZONE("TextureLoader::preload");
             SDL_Surface* surface = this->preload(source);
             Application::get()->schedule([=](void){
                 this->materialize(json,surface,callback);
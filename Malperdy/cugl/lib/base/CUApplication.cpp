@@ -35,6 +35,7 @@
 #include <cugl/render/CUTexture.h>
 #include <cugl/input/CUInput.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUProfiler.h>
 #include <algorithm>
 #include <vector>
 
@@ -115,6 +116,7 @@ void Application::dispose() {
  */
 bool Application::init() {
     _state = State::STARTUP;
+    CU_PROFILE_THREAD("Main");
 
 
     // Initializate the video
@@ -264,30 +266,49 @@ bool Application::getInput() {
  * @return false if the application should quit next frame
  */
 bool Application::step() {
+    bool running;
+
     // Get input before doing the next time
-    bool running = getInput();
+    {
+        CU_PROFILE_ZONE("Application::input");
+        running = getInput();
+    }
 
     // Get a (more) precising measurement for simulation
     Timestamp poststep;
     Uint32 micros   = (Uint32)poststep.ellapsedMicros(_start);
     _start.mark();
     if (running &&  _state == State::FOREGROUND) {
-        processCallbacks((micros)/1000);
-        //processCallbacks(millis);
+        CU_PROFILE_ZONE("Application::step");
+        {
+            CU_PROFILE_ZONE("Application::callbacks");
+            processCallbacks((micros)/1000);
+            //processCallbacks(millis);
+        }
 
         _fpswindow.pop_front();
         _fpswindow.push_back(1000000.0f/micros);
-        update(micros/1000000.0f);
+        {
+            CU_PROFILE_ZONE("Application::update");
+            update(micros/1000000.0f);
+        }
 
-        glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
-        glStencilMask(0xffffffff);
-        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        {
+            CU_PROFILE_ZONE("Application::draw");
+            glClearColor(_clearColor.r, _clearColor.g, _clearColor.b, _clearColor.a);
+            glStencilMask(0xffffffff);
+            glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-        draw();
-        Display::get()->refresh();
+            draw();
+        }
+        {
+            CU_PROFILE_ZONE("Application::refresh");
+            Display::get()->refresh();
+        }
     } else {
         running = _state == State::BACKGROUND;
     }
+    CU_PROFILE_FRAME();
 
 	// Sleep the remainder
     poststep.mark();
@@ -63,7 +63,10 @@ using namespace cugl::physics2;
 Obstacle::Obstacle() :
 _scene(nullptr),
 _debug(nullptr),
-_listener(nullptr)
+_listener(nullptr),
+_prevAngle(0.0f),
+_currAngle(0.0f),
+_captured(false)
 { }
 
 /**
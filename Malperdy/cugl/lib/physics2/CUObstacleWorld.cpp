@@ -48,6 +48,7 @@
 #include <box2d/b2_collision.h>
 #include <cugl/physics2/CUObstacleWorld.h>
 #include <cugl/physics2/CUObstacle.h>
+#include <cugl/util/CUProfiler.h>
 
 using namespace cugl;
 using namespace cugl::physics2;
@@ -361,16 +362,48 @@ void ObstacleWorld::setGravity(const Vec2 gravity) {
  * @param delta Number of seconds since last animation frame
  */
 void ObstacleWorld::update(float dt) {
-    // Turn the physics engine crank.
-    _world->Step((_lockstep ? _stepssize : dt),_itvelocity,_itposition);
+    CU_PROFILE_ZONE("ObstacleWorld::update");
+    {
+        // Turn the physics engine crank.
+        CU_PROFILE_ZONE("ObstacleWorld::step");
+        _world->Step((_lockstep ? _stepssize : dt),_itvelocity,_itposition);
+    }
     
     // Post process all objects after physics (this updates graphics)
+    CU_PROFILE_ZONE("ObstacleWorld::obstacles");
     for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
         Obstacle* obj = it->get();
         obj->update(dt);
     }
 }
 
+/**
+ * Keeps the transform of every object as the one at the end of a step.
+ *
+ * Each object also keeps the transform it had at the capture before, so
+ * that it can be drawn partway between the two when the display refreshes
+ * more often than the physics steps. This should be called once all of the
+ * changes of a step are done, which may include changes made after
+ * {@link update}.
+ */
+void ObstacleWorld::captureTransforms() {
+    for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
+        (*it)->captureTransform();
+    }
+}
+
+/**
+ * Makes every object forget its previous transform.
+ *
+ * This should be called when objects jump somewhere instead of moving
+ * there, so that none of them are drawn sliding to where they jumped.
+ */
+void ObstacleWorld::snapTransforms() {
+    for(auto it = _objects.begin() ; it != _objects.end(); ++it) {
+        (*it)->snapTransform();
+    }
+}
+
 /**
  * Returns true if the object is in bounds.
  *
@@ -45,6 +45,7 @@
 //
 #include <cugl/math/cu_math.h>
 #include <cugl/util/CUDebug.h>
+#include <cugl/util/CUProfiler.h>
 #include <cugl/render/CUSpriteBatch.h>
 #include <cugl/render/CUVertexBuffer.h>
 #include <cugl/render/CUTexture.h>
@@ -1140,7 +1141,9 @@ void SpriteBatch::end() {
 void SpriteBatch::flush() {
     if (_indxSize == 0 || _vertSize == 0) {
         return;
-    } else if (_context->first != _indxSize) {
+    }
+    CU_PROFILE_ZONE("SpriteBatch::flush");
+    if (_context->first != _indxSize) {
         record();
     }
     
@@ -0,0 +1,490 @@
+//
+//  CUProfiler.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  Module for a low-overhead, hierarchical profiler of scoped zones. Every
+//  thread records into its own ring buffer, which can be exported as Chrome
+//  trace-event JSON or summarized per frame.
+//
+//  This module is empty unless CUGL is compiled with CU_PROFILE defined.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/16/26
+//
+#include <cugl/util/CUProfiler.h>
+
+#ifdef CU_PROFILE
+#include <cugl/util/CUTimestamp.h>
+#include <cugl/io/CUTextWriter.h>
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <stdio.h>
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Buffers
+
+/**
+ * A single recorded zone.
+ *
+ * The fields are atomic only so that reading a zone while its slot is being
+ * overwritten is not undefined. Relaxed atomic loads and stores of this size
+ * are plain moves on every platform we support.
+ */
+struct ProfileEvent {
+    /** The zone name */
+    std::atomic<const char*> name;
+    /** When the zone started, in nanoseconds */
+    std::atomic<Uint64> start;
+    /** When the zone ended, in nanoseconds */
+    std::atomic<Uint64> end;
+    /** How many zones this zone is nested in */
+    std::atomic<Uint32> depth;
+};
+
+/**
+ * The ring buffer of zones for a single thread.
+ *
+ * Only the owning thread writes events, depth, and head. Everything else
+ * belongs to the profiler and is guarded by the registry lock.
+ */
+class Profiler::Buffer {
+public:
+    /** The recorded zones, indexed by their count modulo the capacity */
+    ProfileEvent events[CU_PROFILE_CAPACITY];
+    /** The number of zones ever recorded in this buffer */
+    std::atomic<Uint64> head;
+    /** How many zones the owning thread is currently inside */
+    Uint32 depth;
+    /** The thread id in the exported trace */
+    Uint32 tid;
+    /** The thread name in the exported trace */
+    std::string name;
+    /** The first zone that has not been cleared */
+    Uint64 first;
+    /** The first zone that has not been added to the summary */
+    Uint64 summarized;
+
+    /** Creates an empty buffer for the given thread id */
+    Buffer(Uint32 id) : head(0), depth(0), tid(id), first(0), summarized(0) {
+        name = "Thread "+std::to_string(id);
+    }
+};
+
+/** A copy of a recorded zone, taken by the reader */
+struct ProfileSample {
+    /** The zone name */
+    const char* name;
+    /** When the zone started, in nanoseconds */
+    Uint64 start;
+    /** When the zone ended, in nanoseconds */
+    Uint64 end;
+    /** How many zones this zone is nested in */
+    Uint32 depth;
+};
+
+/** The per-frame totals of a single zone */
+struct ProfileStat {
+    /** The zone name */
+    std::string name;
+    /** The shallowest depth the zone was seen at */
+    Uint32 depth;
+    /** The time spent in the zone during the current frame */
+    Uint64 time;
+    /** The times the zone ran during the current frame */
+    Uint32 count;
+    /** The time spent in the zone in each of the last frames */
+    Uint64 times[CU_PROFILE_WINDOW];
+    /** The times the zone ran in each of the last frames */
+    Uint32 counts[CU_PROFILE_WINDOW];
+};
+
+/** Everything shared between threads, guarded by its lock */
+struct ProfileRegistry {
+    /** The lock for everything else in the registry */
+    std::mutex mutex;
+    /** The buffer of every thread that has recorded a zone */
+    std::vector<std::unique_ptr<Profiler::Buffer>> buffers;
+    /** The totals of every zone, in the order they were first seen */
+    std::vector<ProfileStat> stats;
+    /** The index of each zone in stats, by name pointer */
+    std::unordered_map<const char*, size_t> byPointer;
+    /** The index of each zone in stats, by name */
+    std::unordered_map<std::string, size_t> byName;
+    /** The length of each of the last frames */
+    Uint64 frames[CU_PROFILE_WINDOW];
+    /** The number of frames summarized */
+    Uint64 frameCount = 0;
+    /** When the last frame ended */
+    Uint64 lastFrame = 0;
+};
+
+/** The buffer of the current thread */
+static thread_local Profiler::Buffer* _local = nullptr;
+/** Whether zones are recorded */
+static std::atomic<bool> _enabled(true);
+
+/**
+ * Returns the registry, creating it on first use.
+ *
+ * @return the registry
+ */
+static ProfileRegistry& registry() {
+    static ProfileRegistry result;
+    return result;
+}
+
+/**
+ * Copies the zones of a buffer from the given index onward.
+ *
+ * Zones that may have been overwritten while they were copied are thrown
+ * away. The registry lock must be held.
+ *
+ * @param buffer    the buffer to read
+ * @param from      the first zone to copy
+ * @param out       the vector to append the zones to
+ *
+ * @return the index after the last zone copied
+ */
+static Uint64 snapshot(Profiler::Buffer* buffer, Uint64 from, std::vector<ProfileSample>& out) {
+    Uint64 head = buffer->head.load(std::memory_order_acquire);
+    Uint64 index = std::max(from, head > CU_PROFILE_CAPACITY ? head-CU_PROFILE_CAPACITY : (Uint64)0);
+    size_t mark = out.size();
+    for(Uint64 ii = index; ii < head; ii++) {
+        ProfileEvent& event = buffer->events[ii % CU_PROFILE_CAPACITY];
+        ProfileSample sample;
+        sample.name  = event.name.load(std::memory_order_relaxed);
+        sample.start = event.start.load(std::memory_order_relaxed);
+        sample.end   = event.end.load(std::memory_order_relaxed);
+        sample.depth = event.depth.load(std::memory_order_relaxed);
+        out.push_back(sample);
+    }
+
+    // The owner may be writing the slot of zone 'after' right now
+    std::atomic_thread_fence(std::memory_order_acquire);
+    Uint64 after = buffer->head.load(std::memory_order_relaxed);
+    Uint64 valid = after+1 > CU_PROFILE_CAPACITY ? after+1-CU_PROFILE_CAPACITY : 0;
+    if (valid > index) {
+        size_t drop = (size_t)std::min(valid-index, head-index);
+        out.erase(out.begin()+mark, out.begin()+mark+drop);
+    }
+    return head;
+}
+
+/**
+ * Appends the given string to a JSON string, escaping it.
+ *
+ * @param out   the JSON being built
+ * @param s     the string to append
+ */
+static void escape(std::string& out, const std::string& s) {
+    for(auto it = s.begin(); it != s.end(); ++it) {
+        if (*it == '"' || *it == '\\') {
+            out.push_back('\\');
+            out.push_back(*it);
+        } else if ((unsigned char)*it < 0x20) {
+            out.push_back(' ');
+        } else {
+            out.push_back(*it);
+        }
+    }
+}
+
+#pragma mark -
+#pragma mark Recording
+/**
+ * Returns the current time in nanoseconds.
+ *
+ * The time is measured from when the profiler was first used, with a
+ * steady clock.
+ *
+ * @return the current time in nanoseconds.
+ */
+Uint64 Profiler::now() {
+    static const timestamp_t epoch = cuclock_t::now();
+    return (Uint64)std::chrono::duration_cast<std::chrono::nanoseconds>(cuclock_t::now()-epoch).count();
+}
+
+/**
+ * Returns the buffer for the current thread, creating it if needed.
+ *
+ * @return the buffer for the current thread.
+ */
+Profiler::Buffer* Profiler::local() {
+    if (_local == nullptr) {
+        ProfileRegistry& reg = registry();
+        std::unique_lock<std::mutex> lk(reg.mutex);
+        reg.buffers.emplace_back(new Buffer((Uint32)reg.buffers.size()+1));
+        _local = reg.buffers.back().get();
+    }
+    return _local;
+}
+
+/**
+ * Adds one to the depth of the current thread, returning the old depth.
+ *
+ * @param buffer    the buffer of the current thread
+ *
+ * @return the depth of the zone being entered
+ */
+Uint32 Profiler::enter(Buffer* buffer) {
+    return buffer->depth++;
+}
+
+/**
+ * Records a zone in the buffer of the current thread.
+ *
+ * This is called by {@link ProfileZone} when it goes out of scope. It
+ * should not be necessary to call it directly.
+ *
+ * @param buffer    the buffer of the current thread
+ * @param name      the zone name
+ * @param start     when the zone started, in nanoseconds
+ * @param end       when the zone ended, in nanoseconds
+ * @param depth     how many zones this zone is nested in
+ */
+void Profiler::record(Buffer* buffer, const char* name, Uint64 start, Uint64 end, Uint32 depth) {
+    buffer->depth = depth;
+    Uint64 head = buffer->head.load(std::memory_order_relaxed);
+    ProfileEvent& event = buffer->events[head % CU_PROFILE_CAPACITY];
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    event.depth.store(depth, std::memory_order_relaxed);
+    buffer->head.store(head+1, std::memory_order_release);
+}
+
+/**
+ * Sets whether zones are recorded.
+ *
+ * Zones that have already started are still recorded when they end.
+ * Profiling is enabled by default.
+ *
+ * @param value whether zones are recorded
+ */
+void Profiler::setEnabled(bool value) {
+    _enabled.store(value, std::memory_order_relaxed);
+}
+
+/**
+ * Returns true if zones are recorded.
+ *
+ * @return true if zones are recorded.
+ */
+bool Profiler::isEnabled() {
+    return _enabled.load(std::memory_order_relaxed);
+}
+
+/**
+ * Sets the name of the current thread in the exported trace.
+ *
+ * @param name  the thread name
+ */
+void Profiler::setThreadName(const std::string& name) {
+    Buffer* buffer = local();
+    std::unique_lock<std::mutex> lk(registry().mutex);
+    buffer->name = name;
+}
+
+
+#pragma mark -
+#pragma mark Reporting
+/**
+ * Marks the end of an animation frame.
+ *
+ * Every zone recorded since the last frame, on any thread, is added to
+ * the rolling summary. This should be called once per frame on the main
+ * thread, which {@link Application} does at the end of each step.
+ */
+void Profiler::frame() {
+    ProfileRegistry& reg = registry();
+    std::unique_lock<std::mutex> lk(reg.mutex);
+
+    std::vector<ProfileSample> samples;
+    for(auto it = reg.buffers.begin(); it != reg.buffers.end(); ++it) {
+        Buffer* buffer = it->get();
+        buffer->summarized = snapshot(buffer, std::max(buffer->summarized,buffer->first), samples);
+    }
+
+    for(auto it = samples.begin(); it != samples.end(); ++it) {
+        size_t index;
+        auto found = reg.byPointer.find(it->name);
+        if (found != reg.byPointer.end()) {
+            index = found->second;
+        } else {
+            // The same literal may have a different address in each file
+            std::string name(it->name);
+            auto named = reg.byName.find(name);
+            if (named != reg.byName.end()) {
+                index = named->second;
+            } else {
+                index = reg.stats.size();
+                reg.stats.emplace_back();
+                ProfileStat& stat = reg.stats.back();
+                stat.name = name;
+                stat.depth = it->depth;
+                stat.time = 0;
+                stat.count = 0;
+                std::fill(stat.times, stat.times+CU_PROFILE_WINDOW, 0);
+                std::fill(stat.counts, stat.counts+CU_PROFILE_WINDOW, 0);
+                reg.byName[name] = index;
+            }
+            reg.byPointer[it->name] = index;
+        }
+        ProfileStat& stat = reg.stats[index];
+        stat.depth = std::min(stat.depth, it->depth);
+        stat.time += it->end-it->start;
+        stat.count++;
+    }
+
+    Uint64 now = Profiler::now();
+    size_t slot = (size_t)(reg.frameCount % CU_PROFILE_WINDOW);
+    reg.frames[slot] = reg.frameCount > 0 ? now-reg.lastFrame : 0;
+    reg.lastFrame = now;
+    reg.frameCount++;
+    for(auto it = reg.stats.begin(); it != reg.stats.end(); ++it) {
+        it->times[slot]  = it->time;
+        it->counts[slot] = it->count;
+        it->time  = 0;
+        it->count = 0;
+    }
+}
+
+/**
+ * Returns the rolling summary of the last frames.
+ *
+ * Each line is a zone, indented by how deeply it is nested, with the
+ * average and longest time it took per frame over the last
+ * CU_PROFILE_WINDOW frames, and how many times it ran per frame. The
+ * zones are in the order they were first seen.
+ *
+ * @return the rolling summary of the last frames.
+ */
+std::string Profiler::getSummary() {
+    ProfileRegistry& reg = registry();
+    std::unique_lock<std::mutex> lk(reg.mutex);
+
+    size_t window = (size_t)std::min(reg.frameCount,(Uint64)CU_PROFILE_WINDOW);
+    if (window == 0) {
+        return "";
+    }
+
+    char line[256];
+    Uint64 total = 0;
+    Uint64 most  = 0;
+    for(size_t ii = 0; ii < window; ii++) {
+        total += reg.frames[ii];
+        most = std::max(most,reg.frames[ii]);
+    }
+    snprintf(line, sizeof(line), "%-32s %8.3f %8.3f\n", "frame (avg/max ms)",
+             total/(window*1e6), most/1e6);
+    std::string result(line);
+
+    for(auto it = reg.stats.begin(); it != reg.stats.end(); ++it) {
+        total = most = 0;
+        Uint64 calls = 0;
+        for(size_t ii = 0; ii < window; ii++) {
+            total += it->times[ii];
+            most = std::max(most,it->times[ii]);
+            calls += it->counts[ii];
+        }
+        std::string name = std::string(2*std::min(it->depth,(Uint32)8),' ')+it->name;
+        snprintf(line, sizeof(line), "%-32s %8.3f %8.3f %6.1f\n", name.c_str(),
+                 total/(window*1e6), most/1e6, (double)calls/window);
+        result += line;
+    }
+    return result;
+}
+
+/**
+ * Writes every zone still in the buffers as Chrome trace-event JSON.
+ *
+ * The file can be opened in chrome://tracing or https://ui.perfetto.dev.
+ * This does not clear the buffers.
+ *
+ * @param path  the path to write to
+ *
+ * @return true if the trace was written
+ */
+bool Profiler::exportTrace(const std::string& path) {
+    std::shared_ptr<TextWriter> writer = TextWriter::alloc(path);
+    if (writer == nullptr) {
+        return false;
+    }
+
+    ProfileRegistry& reg = registry();
+    std::unique_lock<std::mutex> lk(reg.mutex);
+
+    writer->write("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+    char number[64];
+    std::vector<ProfileSample> samples;
+    for(auto it = reg.buffers.begin(); it != reg.buffers.end(); ++it) {
+        Buffer* buffer = it->get();
+        std::string tid = std::to_string(buffer->tid);
+        std::string entry = first ? "\n" : ",\n";
+        entry += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"+tid+",\"args\":{\"name\":\"";
+        escape(entry, buffer->name);
+        entry += "\"}}";
+        writer->write(entry);
+        first = false;
+
+        samples.clear();
+        snapshot(buffer, buffer->first, samples);
+        for(auto jt = samples.begin(); jt != samples.end(); ++jt) {
+            entry = ",\n{\"name\":\"";
+            escape(entry, jt->name);
+            entry += "\",\"ph\":\"X\",\"pid\":1,\"tid\":"+tid;
+            // Trace events are in microseconds
+            snprintf(number, sizeof(number), ",\"ts\":%.3f,\"dur\":%.3f}",
+                     jt->start/1000.0, (jt->end-jt->start)/1000.0);
+            entry += number;
+            writer->write(entry);
+        }
+    }
+    writer->write("\n]}\n");
+    writer->close();
+    return true;
+}
+
+/**
+ * Throws away every recorded zone and the rolling summary.
+ */
+void Profiler::clear() {
+    ProfileRegistry& reg = registry();
+    std::unique_lock<std::mutex> lk(reg.mutex);
+    for(auto it = reg.buffers.begin(); it != reg.buffers.end(); ++it) {
+        Buffer* buffer = it->get();
+        buffer->first = buffer->head.load(std::memory_order_acquire);
+        buffer->summarized = buffer->first;
+    }
+    reg.stats.clear();
+    reg.byPointer.clear();
+    reg.byName.clear();
+    reg.frameCount = 0;
+}
+
+#endif /* CU_PROFILE */
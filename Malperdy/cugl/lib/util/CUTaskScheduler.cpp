@@ -0,0 +1,486 @@
+//
+//  CUTaskScheduler.cpp
+//  Cornell University Game Library (CUGL)
+//
+//  Module for a work-stealing scheduler of asynchronous tasks. Each worker
+//  thread has its own deque of tasks, and steals from the other workers when
+//  it runs out. Tasks have handles, futures, and dependencies.
+//
+//  CUGL MIT License:
+//      This software is provided 'as-is', without any express or implied
+//      warranty.  In no event will the authors be held liable for any damages
+//      arising from the use of this software.
+//
+//      Permission is granted to anyone to use this software for any purpose,
+//      including commercial applications, and to alter it and redistribute it
+//      freely, subject to the following restrictions:
+//
+//      1. The origin of this software must not be misrepresented; you must not
+//      claim that you wrote the original software. If you use this software
+//      in a product, an acknowledgment in the product documentation would be
+//      appreciated but is not required.
+//
+//      2. Altered source versions must be plainly marked as such, and must not
+//      be misrepresented as being the original software.
+//
+//      3. This notice may not be removed or altered from any source distribution.
+//
+//  Author: agent
+//  Version: 10/16/26
+//
+#include <cugl/util/CUTaskScheduler.h>
+#include <cugl/util/CUProfiler.h>
+#include <algorithm>
+
+using namespace cugl;
+
+#pragma mark -
+#pragma mark Tasks
+
+/**
+ * A task, as shared between the scheduler and its handles.
+ *
+ * A task is queued once waiting drops to 0. It starts at one more than the
+ * number of unfinished dependencies, and submit() removes that extra one
+ * once every dependency has been registered, so a dependency finishing
+ * partway through cannot queue the task early.
+ */
+class TaskHandle::Task {
+public:
+    /** The scheduler that runs this task */
+    TaskScheduler* owner;
+    /** The task function, or nullptr for a task that only joins others */
+    std::function<void()> work;
+    /** The number of unfinished dependencies, plus one until submitted */
+    std::atomic<int> waiting;
+    /** Whether the task has finished */
+    std::atomic<bool> finished;
+    /** A mutex lock for finished and dependents */
+    std::mutex mutex;
+    /** The tasks that depend on this one */
+    std::vector<std::shared_ptr<Task>> dependents;
+
+    /** Creates an unfinished task for the given scheduler */
+    Task(TaskScheduler* scheduler, const std::function<void()>& func) :
+    owner(scheduler), work(func), waiting(1), finished(false) {}
+};
+
+/** The scheduler whose worker is the current thread, if any */
+static thread_local TaskScheduler* _current = nullptr;
+/** The worker index of the current thread, if it is a worker */
+static thread_local int _index = -1;
+
+/** The arguments of an SDL worker thread */
+struct TaskWorkerArgs {
+    /** The scheduler of the worker */
+    TaskScheduler* self;
+    /** The index of the worker */
+    int index;
+};
+
+/**
+ * Returns true if the task has finished.
+ *
+ * A handle that refers to no task is always finished.
+ *
+ * @return true if the task has finished.
+ */
+bool TaskHandle::isDone() const {
+    return _task == nullptr || _task->finished.load();
+}
+
+/**
+ * Blocks until the task has finished.
+ *
+ * The calling thread runs other tasks of the same scheduler while it
+ * waits, so this is safe to call from inside a task.
+ */
+void TaskHandle::wait() const {
+    if (_task != nullptr && !_task->finished.load()) {
+        _task->owner->wait(_task);
+    }
+}
+
+
+#pragma mark -
+#pragma mark Constructors
+/**
+ * Disposes this scheduler, releasing all memory.
+ *
+ * This method will block until every worker thread has completed its
+ * current task. Tasks that have not started are thrown away.
+ */
+void TaskScheduler::dispose() {
+    stop();
+    _threads.clear();
+    _workers.clear();
+    _shared.clear();
+    _queued = 0;
+    _complete = 0;
+    _stop = false;
+}
+
+/**
+ * Initializes a scheduler with the given number of threads.
+ *
+ * If threads is 0, the scheduler has one worker for every core but one,
+ * leaving a core for the main thread. A scheduler always has at least
+ * one worker.
+ *
+ * @param threads   the number of threads in this scheduler
+ *
+ * @return true if the scheduler is initialized properly, false otherwise.
+ */
+bool TaskScheduler::init(int threads) {
+    if (threads <= 0) {
+        threads = (int)std::thread::hardware_concurrency()-1;
+    }
+    threads = std::max(threads,1);
+
+    // Every deque must exist before any worker can steal from it
+    for (int index = 0; index < threads; ++index) {
+        _workers.emplace_back(new Worker());
+    }
+    for (int index = 0; index < threads; ++index) {
+#ifdef CU_SDL_THREADS
+        TaskWorkerArgs* args = new TaskWorkerArgs();
+        args->self  = this;
+        args->index = index;
+        _threads.emplace_back(SDL_CreateThread(TaskScheduler::sdlThreadFunc,"Task Worker",(void*)args));
+#else
+        _threads.emplace_back(std::thread(std::bind(&TaskScheduler::threadFunc, this, index)));
+#endif
+    }
+    return true;
+}
+
+
+#pragma mark -
+#pragma mark Thread Execution
+/**
+ * Queues a task whose dependencies have all finished.
+ *
+ * The task goes on the deque of the calling thread if it is a worker of
+ * this scheduler, and on the shared queue otherwise.
+ *
+ * @param task      the task to queue
+ * @param shared    whether to always use the shared queue
+ */
+void TaskScheduler::enqueue(const std::shared_ptr<TaskHandle::Task>& task, bool shared) {
+    if (!shared && _current == this && _index >= 0 && _index < (int)_workers.size()) {
+        Worker* worker = _workers[_index].get();
+        std::unique_lock<std::mutex> lk(worker->mutex);
+        worker->tasks.push_back(task);
+    } else {
+        std::unique_lock<std::mutex> lk(_sharedMutex);
+        _shared.push_back(task);
+    }
+    _queued++;
+
+    // Sleepers count themselves before they check for work, so none is missed
+    if (_sleepers.load() > 0) {
+        std::unique_lock<std::mutex> lk(_sleepMutex);
+        _sleepCondition.notify_one();
+    }
+}
+
+/**
+ * Takes the next task for the calling thread, if there is one.
+ *
+ * @param index the worker index of the calling thread, or -1 for none
+ *
+ * @return the next task, or nullptr if every queue is empty
+ */
+std::shared_ptr<TaskHandle::Task> TaskScheduler::take(int index) {
+    std::shared_ptr<TaskHandle::Task> result = nullptr;
+
+    // Our own newest task first, as its data is most likely still in cache
+    if (index >= 0) {
+        Worker* worker = _workers[index].get();
+        std::unique_lock<std::mutex> lk(worker->mutex);
+        if (!worker->tasks.empty()) {
+            result = std::move(worker->tasks.back());
+            worker->tasks.pop_back();
+        }
+    }
+
+    if (result == nullptr) {
+        std::unique_lock<std::mutex> lk(_sharedMutex);
+        if (!_shared.empty()) {
+            result = std::move(_shared.front());
+            _shared.pop_front();
+        }
+    }
+
+    // Steal the oldest task of the next worker that has one
+    size_t count = _workers.size();
+    for(size_t ii = 1; result == nullptr && ii <= count; ii++) {
+        size_t victim = (index+ii) % count;
+        if ((int)victim == index) {
+            continue;
+        }
+        Worker* worker = _workers[victim].get();
+        std::unique_lock<std::mutex> lk(worker->mutex);
+        if (!worker->tasks.empty()) {
+            result = std::move(worker->tasks.front());
+            worker->tasks.pop_front();
+        }
+    }
+
+    if (result != nullptr) {
+        _queued--;
+    }
+    return result;
+}
+
+/**
+ * Runs the given task, and queues any task that was only waiting on it.
+ *
+ * @param task  the task to run
+ */
+void TaskScheduler::execute(const std::shared_ptr<TaskHandle::Task>& task) {
+    if (task->work != nullptr) {
+        CU_PROFILE_ZONE("TaskScheduler::task");
+        task->work();
+        task->work = nullptr;
+    }
+
+    std::vector<std::shared_ptr<TaskHandle::Task>> dependents;
+    {
+        std::unique_lock<std::mutex> lk(task->mutex);
+        task->finished = true;
+        dependents.swap(task->dependents);
+    }
+
+    // Wake anyone waiting on this task
+    if (_sleepers.load() > 0) {
+        std::unique_lock<std::mutex> lk(_sleepMutex);
+        _sleepCondition.notify_all();
+    }
+
+    for(auto it = dependents.begin(); it != dependents.end(); ++it) {
+        if (--(*it)->waiting == 0) {
+            (*it)->owner->enqueue(*it);
+        }
+    }
+}
+
+/**
+ * Runs the next task for the calling thread, if there is one.
+ *
+ * @return true if a task was run
+ */
+bool TaskScheduler::runOne() {
+    std::shared_ptr<TaskHandle::Task> task = take(_current == this ? _index : -1);
+    if (task == nullptr) {
+        return false;
+    }
+    execute(task);
+    return true;
+}
+
+/**
+ * Blocks until the given task has finished, running other tasks meanwhile.
+ *
+ * @param task  the task to wait on
+ */
+void TaskScheduler::wait(const std::shared_ptr<TaskHandle::Task>& task) {
+    while (!task->finished.load()) {
+        if (runOne()) {
+            continue;
+        }
+        _sleepers++;
+        {
+            std::unique_lock<std::mutex> lk(_sleepMutex);
+            _sleepCondition.wait(lk, [&]() {
+                return task->finished.load() || _queued.load() > 0;
+            });
+        }
+        _sleepers--;
+    }
+}
+
+/**
+ * The body function of a single worker thread.
+ *
+ * @param index the index of the worker
+ */
+void TaskScheduler::threadFunc(int index) {
+    _current = this;
+    _index = index;
+    CU_PROFILE_THREAD("TaskScheduler");
+    while (!_stop) {
+        if (runOne()) {
+            continue;
+        }
+        _sleepers++;
+        {
+            std::unique_lock<std::mutex> lk(_sleepMutex);
+            _sleepCondition.wait(lk, [&]() {
+                return _stop.load() || _queued.load() > 0;
+            });
+        }
+        _sleepers--;
+    }
+    _current = nullptr;
+    _index = -1;
+    _complete++;
+}
+
+/**
+ * The body function of a single worker thread.
+ *
+ * This static implementation uses the SDL thread API.  It should be used
+ * on Android and Windows, which have special thread requirements.
+ */
+int TaskScheduler::sdlThreadFunc(void* ptr) {
+    TaskWorkerArgs* args = (TaskWorkerArgs*)ptr;
+    TaskScheduler* self = args->self;
+    int index = args->index;
+    delete args;
+    self->threadFunc(index);
+    return 0;
+}
+
+
+#pragma mark -
+#pragma mark Task Management
+/**
+ * Submits a task, returning a handle to it.
+ *
+ * The task will not run until every task it depends on has finished.
+ * Handles that refer to no task are ignored.
+ *
+ * @param work          the task function
+ * @param dependencies  the tasks that must finish first
+ *
+ * @return a handle to the task
+ */
+TaskHandle TaskScheduler::submit(const std::function<void()>& work,
+                                 const std::vector<TaskHandle>& dependencies) {
+    std::shared_ptr<TaskHandle::Task> task = std::make_shared<TaskHandle::Task>(this,work);
+    for(auto it = dependencies.begin(); it != dependencies.end(); ++it) {
+        TaskHandle::Task* dependency = it->_task.get();
+        if (dependency == nullptr) {
+            continue;
+        }
+        std::unique_lock<std::mutex> lk(dependency->mutex);
+        if (!dependency->finished) {
+            task->waiting++;
+            dependency->dependents.push_back(task);
+        }
+    }
+    if (--task->waiting == 0) {
+        enqueue(task);
+    }
+    return TaskHandle(task);
+}
+
+/**
+ * Submits a task to the back of the shared queue, returning a handle to it.
+ *
+ * Unlike {@link submit}, this never puts the task on the deque of the
+ * calling worker, even when called from a task. When the scheduler has
+ * one worker, tasks posted this way run one at a time in the order they
+ * were posted, which is how ThreadPool keeps the order of its tasks.
+ *
+ * @param work  the task function
+ *
+ * @return a handle to the task
+ */
+TaskHandle TaskScheduler::post(const std::function<void()>& work) {
+    std::shared_ptr<TaskHandle::Task> task = std::make_shared<TaskHandle::Task>(this,work);
+    task->waiting = 0;
+    enqueue(task,true);
+    return TaskHandle(task);
+}
+
+/**
+ * Runs the given function over the range [begin,end), in parallel.
+ *
+ * The range is split into chunks of at most grain indices, and the
+ * function is called with the start and end of each chunk. If grain is
+ * 0, the chunks are sized so that each worker gets a few of them. The
+ * calling thread works on the chunks too, and this method only returns
+ * once every chunk is done.
+ *
+ * @param begin the start of the range
+ * @param end   the end of the range (exclusive)
+ * @param grain the most indices in a chunk, or 0 to choose
+ * @param body  the function to call on each chunk
+ */
+void TaskScheduler::parallelFor(size_t begin, size_t end, size_t grain,
+                                const std::function<void(size_t,size_t)>& body) {
+    if (end <= begin) {
+        return;
+    }
+    size_t count = end-begin;
+    size_t threads = _workers.size()+1;
+    if (grain == 0) {
+        grain = std::max((size_t)1, (count+4*threads-1)/(4*threads));
+    }
+    size_t chunks = (count+grain-1)/grain;
+    if (chunks == 1 || _workers.empty()) {
+        body(begin,end);
+        return;
+    }
+
+    // Every thread, including this one, takes the next chunk until none are left
+    std::shared_ptr<std::atomic<size_t>> next = std::make_shared<std::atomic<size_t>>(0);
+    auto run = [=,&body]() {
+        size_t chunk;
+        while ((chunk = (*next)++) < chunks) {
+            size_t first = begin+chunk*grain;
+            body(first,std::min(end,first+grain));
+        }
+    };
+
+    // The helpers reference body, so they must all finish before we return
+    std::vector<TaskHandle> helpers;
+    size_t extra = std::min(chunks-1,_workers.size());
+    for(size_t ii = 0; ii < extra; ii++) {
+        helpers.push_back(submit(run));
+    }
+    run();
+    for(auto it = helpers.begin(); it != helpers.end(); ++it) {
+        it->wait();
+    }
+}
+
+/**
+ * Stop the scheduler, marking it for shut down.
+ *
+ * This method blocks until every worker thread has finished its current
+ * task. Tasks that have not started are thrown away, except by a thread
+ * waiting on them, which will run them itself.
+ */
+void TaskScheduler::stop() {
+    {
+        std::unique_lock<std::mutex> lk(_sleepMutex);
+        _stop = true;
+        _sleepCondition.notify_all();
+    }
+
+    for (auto&& thread : _threads) {
+#ifdef CU_SDL_THREADS
+        if (thread != nullptr) {
+            int status;
+            SDL_WaitThread(thread,&status);
+            thread = nullptr;
+        }
+#else
+        if (thread.joinable()) {
+            thread.join();
+        }
+#endif
+    }
+}
+
+/**
+ * Returns true if the calling thread is a worker of this scheduler.
+ *
+ * @return true if the calling thread is a worker of this scheduler.
+ */
+bool TaskScheduler::isWorkerThread() const {
+    return _current == this;
+}
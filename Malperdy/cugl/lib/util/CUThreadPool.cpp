@@ -33,6 +33,7 @@
 //  Version: 11/29/16
 //
 #include <cugl/util/CUThreadPool.h>
+#include <cugl/util/CUProfiler.h>
 
 using namespace cugl;
 
@@ -48,7 +49,13 @@ using namespace cugl;
  */
 void ThreadPool::dispose() {
     stop();
-    while (!isShutdown());
+    if (_scheduler != nullptr) {
+        _scheduler->dispose();
+        _scheduler = nullptr;
+    }
+    _threads = 0;
+    _running = 0;
+    _stop = false;
 }
 
 /**
@@ -63,85 +70,16 @@ void ThreadPool::dispose() {
  * @return true if the threed pool is initialized properly, false otherwise.
  */
 bool ThreadPool::init(int threads) {
-    for (int index = 0; index < threads; ++index) {
-#ifdef CU_SDL_THREADS
-        _workers.emplace_back(SDL_CreateThread(ThreadPool::sdlThreadFunc,"Pool Dispatch",(void*)this));
-#else
-        _workers.emplace_back(std::thread(std::bind(&ThreadPool::threadFunc, this)));
-#endif
-    }
-    return true;
-}
-
-
-#pragma mark -
-#pragma mark Thread Execution
-
-/**
- * The body function of a single thread.
- *
- * This function pulls tasks from the task queue.
- *
- * This implementation is safe to use with std::thread.
- */
-void ThreadPool::threadFunc() {
-    while (!_stop) {
-        std::function<void()> task = nullptr;
-        {   // Lock for save queue access
-            std::unique_lock<std::mutex> lk(_queueMutex);
-            if (_stop) {
-                break;
-            }
-            // Pull the next task off the queue
-            if (!_taskQueue.empty()) {
-                task = std::move(_taskQueue.front());
-                _taskQueue.pop();
-            } else {
-                _taskCondition.wait(lk);
-                continue;
-            }
-        }
-        // Perform the current task
-        task();
-    }
-    _complete++;
-}
-
-/**
- * The body function of a single thread.
- *
- * This function pulls tasks from the task queue.
- *
- * This static implementation uses the SDL thread API.  It should be used
- * on Android and Windows, which have special thread requirements.
- */
-int ThreadPool::sdlThreadFunc(void* ptr) {
-    ThreadPool* self = (ThreadPool*)ptr;
-    while (!self->_stop) {
-        std::function<void()> task = nullptr;
-        {   // Lock for save queue access
-            std::unique_lock<std::mutex> lk(self->_queueMutex);
-            if (self->_stop) {
-                break;
-            }
-            // Pull the next task off the queue
-            if (!self->_taskQueue.empty()) {
-                task = std::move(self->_taskQueue.front());
-                self->_taskQueue.pop();
-            } else {
-                self->_taskCondition.wait(lk);
-                continue;
-            }
-        }
-        // Perform the current task
-        task();
+    // The scheduler treats 0 as one thread per core, which is not what was asked for
+    if (threads < 1) {
+        return false;
     }
-    self->_complete++;
-    return 0;
+    _scheduler = TaskScheduler::alloc(threads);
+    _threads = threads;
+    return _scheduler != nullptr;
 }
 
 
-
 #pragma mark -
 #pragma mark Task Management
 /**
@@ -155,9 +93,22 @@ int ThreadPool::sdlThreadFunc(void* ptr) {
  * @param  task     the task function to add to the thread pool
  */
 void ThreadPool::addTask(const std::function<void()> &task){
-    std::unique_lock<std::mutex> lk(_queueMutex);
-    _taskQueue.emplace(task);
-    _taskCondition.notify_one();
+    if (_scheduler == nullptr) {
+        return;
+    }
+    {   // Lock for safe queue access
+        std::unique_lock<std::mutex> lock(_queueMutex);
+        if (_stop) {
+            return;
+        }
+        _taskQueue.push_back(task);
+        if (_running >= _threads) {
+            // A running thread will get to it
+            return;
+        }
+        _running++;
+    }
+    _scheduler->post([this]() { drain(); });
 }
 
 /**
@@ -168,18 +119,39 @@ void ThreadPool::addTask(const std::function<void()> &task){
  * threads have finished with their tasks.
  */
 void ThreadPool::stop() {
-    {
-        std::unique_lock<std::mutex> lk(_queueMutex);
+    {   // Lock for safe queue access
+        std::unique_lock<std::mutex> lock(_queueMutex);
         _stop = true;
-        _taskCondition.notify_all();
+        _taskQueue.clear();
+    }
+    if (_scheduler != nullptr) {
+        _scheduler->stop();
     }
-    
-    for (auto&& worker : _workers) {
-#ifdef CU_SDL_THREADS
-        int status;
-        SDL_WaitThread(worker,&status);
-#else
-        worker.join();
-#endif
+}
+
+
+#pragma mark -
+#pragma mark Thread Execution
+/**
+ * The body of a single thread of this pool.
+ *
+ * This runs tasks from the queue, in order, until it is empty or the
+ * pool has been stopped.
+ */
+void ThreadPool::drain() {
+    while (true) {
+        std::function<void()> task = nullptr;
+        {   // Lock for safe queue access
+            std::unique_lock<std::mutex> lock(_queueMutex);
+            if (_stop || _taskQueue.empty()) {
+                _running--;
+                return;
+            }
+            task = std::move(_taskQueue.front());
+            _taskQueue.pop_front();
+        }
+        // Perform the current task
+        CU_PROFILE_ZONE("ThreadPool::task");
+        task();
     }
 }
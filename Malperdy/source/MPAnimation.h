@@ -9,99 +9,154 @@
 #ifndef MPAnimation_h
 #define MPAnimation_h
 
-#include <map>
-#include <tuple>
+#include <array>
 #include <cugl/cugl.h>
 
 using namespace cugl;
 
+/** How many frames per second a clip plays at if its frame data doesn't say */
+#define DEFAULT_CLIP_FPS 30.0f
 
-#endif /* MPAnimation_h */
-
-/** The class representing an animation. It holds the corresponding spritesheet as well as frame data for the spire sheet */
+/**
+ * The class representing an animation. It holds the corresponding spritesheet as well as frame data for the sprite sheet.
+ *
+ * The frame data is compiled into a table of clips when the animation is made, so
+ * looking up a clip is just an array index. Every character with the same sprite
+ * sheet should share one Animation.
+ */
 class Animation{
-    
+public:
+    /** Every clip a character can play. Names in the frame data are matched to these when the animation is made */
+    enum class Clip : int {
+        IDLE,
+        RUN,
+        JUMP,
+        DEAD,
+        /** The number of clips, not a clip itself */
+        COUNT,
+        /** No clip, used to make the next clip that is set start over */
+        NONE = COUNT
+    };
+
+    /** Frame data for a single clip */
+    struct ClipData {
+        /** Whether the frame data had this clip at all */
+        bool valid = false;
+        /** The first frame of the clip in the sprite sheet */
+        int start = 0;
+        /** The last frame of the clip in the sprite sheet */
+        int last = 0;
+        /** Whether the clip starts over once it reaches the end */
+        bool loop = false;
+        /** Whether the clip is horizontally flipped in the sprite sheet */
+        bool flip = false;
+        /** How many frames of the clip play per second */
+        float fps = DEFAULT_CLIP_FPS;
+
+        /** Returns how many frames are in the clip */
+        int getLength() const { return last - start + 1; }
+    };
+
 private:
 #pragma mark Attributes
-    
+
     // The sprite sheets
     shared_ptr<Texture> _spritesheet;
-    
+
     // Number of cols, rows, and total frames in the sprite sheet
     int _cols;
     int _rows;
     int _size;
-    
+
     // whether the animations in the spire sheet are forward or backwardss when reading left to right
     bool _reversed;
-    
-    // animation name : (start frame, end frame, loop, flip)
-    map<string, tuple<int, int, bool, bool>> _frames;
-    
+
+    // frame data for each clip, indexed by clip
+    std::array<ClipData, static_cast<int>(Clip::COUNT)> _clips;
+
+    /** Returns the clip with the given name in the frame data, or NONE if there isn't one */
+    static Clip getClip(const string &name) {
+        if (name == "idle") return Clip::IDLE;
+        if (name == "run") return Clip::RUN;
+        if (name == "jump") return Clip::JUMP;
+        if (name == "dead") return Clip::DEAD;
+        return Clip::NONE;
+    }
+
 public:
 #pragma mark Constructors
-    
+
     /** The sheet is the spritesheet for the animation. The framedata is a JSON value obtained from the framedata.json */
     Animation(shared_ptr<Texture> sheet, shared_ptr<JsonValue> framedata){
         _spritesheet = sheet;
-        
+
         // Extract frame data
         _cols = framedata->get("cols")->asInt();
         _rows = framedata->get("rows")->asInt();
         _size = framedata->get("size")->asInt();
         _reversed = framedata->get("reversed")->asString() == "true";
-        
+
         // For each animation specified in the frame data
         int numAnims =  framedata->get("frames")->size();
         for(int i = 0; i< numAnims; i++){
             shared_ptr<JsonValue> ob = framedata->get("frames")->get(i);
-            string key = ob->key();
-            
+            Clip clip = getClip(ob->key());
+            if (clip == Clip::NONE) {
+                CULogError("Unknown animation clip %s", ob->key().c_str());
+                continue;
+            }
+
             // store the animation's start/last frames, as well as whether to loop it and if the animation is horizontally flipped
-            int start = ob->get("start")->asInt();
-            int last = ob->get("last")->asInt();
-            bool loop = ob->get("loop")->asString() == "true";
-            bool flip = ob->get("flip")->asString() == "true";
-            
-            _frames[key] = tuple<int, int, bool, bool>(start, last, loop, flip);
+            ClipData &data = _clips[static_cast<int>(clip)];
+            data.valid = true;
+            data.start = ob->get("start")->asInt();
+            data.last = ob->get("last")->asInt();
+            data.loop = ob->get("loop")->asString() == "true";
+            data.flip = ob->get("flip")->asString() == "true";
+            data.fps = ob->getFloat("fps", DEFAULT_CLIP_FPS);
         }
     };
 
 #pragma mark Accessors
-    
+
     shared_ptr<Texture> getSheet(){
         return _spritesheet;
     }
-    
+
     int getRows(){ return _rows;}
-    
+
     int getCols(){ return _cols;}
-    
+
     int getSize(){ return _size;}
-    
-    bool hasKey(string key){
-        return _frames.count(key) > 0;
-    }
-    
-    int getStart(string key){
-        return std::get<0>(_frames[key]);
-    }
-    
-    int getLast(string key){
-        return std::get<1>(_frames[key]);
-    }
-    
-    bool isLoop(string key){
-        return std::get<2>(_frames[key]);
+
+    bool hasClip(Clip clip) const {
+        return clip != Clip::NONE && _clips[static_cast<int>(clip)].valid;
     }
-    
-    bool isFlip(string key){
-        return std::get<3>(_frames[key]);
+
+    /** Returns the frame data for the given clip, which must not be NONE */
+    const ClipData &getClipData(Clip clip) const {
+        return _clips[static_cast<int>(clip)];
     }
-    
-    bool isReversed(){
+
+    bool isReversed() const {
         return _reversed;
     }
-    
-    
+
+    /**
+     * Returns the frame of the sprite sheet to show for the given clip after
+     * it has been playing for the given amount of time.
+     *
+     * @param clip  The clip that is playing
+     * @param time  How long the clip has been playing, in seconds
+     * @return      The frame to show
+     */
+    int getFrame(Clip clip, float time) const {
+        const ClipData &data = getClipData(clip);
+        int index = static_cast<int>(time * data.fps);
+        index = (data.loop ? index % data.getLength() : std::min(index, data.getLength() - 1));
+        return (_reversed ? data.last - index : data.start + index);
+    }
+
 };
+
+#endif /* MPAnimation_h */
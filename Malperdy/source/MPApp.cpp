@@ -77,6 +77,13 @@ void Malperdy::onStartup() {
  * causing the application to be deleted.
  */
 void Malperdy::onShutdown() {
+    if (_loaded && _gameplay.getRecording() != nullptr) {
+        _gameplay.getRecording()->save(InputRecording::getPath());
+    }
+#ifdef CU_PROFILE
+    // Open in chrome://tracing or Perfetto
+    Profiler::exportTrace(Application::getSaveDirectory() + "profile.json");
+#endif
     _loading.dispose();
     _gameplay.dispose();
     _assets = nullptr;
@@ -90,6 +97,8 @@ void Malperdy::onShutdown() {
 #endif
 
     AudioEngine::stop();
+    // Don't quit partway through writing a save
+    SaveFile::stop();
     Application::onShutdown();  // YOU MUST END with call to parent
 }
 
@@ -109,7 +118,15 @@ void Malperdy::onSuspend() {
     if (_gameplay._mode != 0) {
         _gameplay.pause();
     }
-
+    // We might not come back, so make sure the last save is on disk
+    SaveFile::finish();
+    if (_loaded && _gameplay.getRecording() != nullptr) {
+        _gameplay.getRecording()->save(InputRecording::getPath());
+    }
+#ifdef CU_PROFILE
+    // Open in chrome://tracing or Perfetto
+    Profiler::exportTrace(Application::getSaveDirectory() + "profile.json");
+#endif
 }
 
 /**
@@ -147,6 +164,8 @@ void Malperdy::update(float timestep) {
     } else if (!_loaded) {
         _loading.dispose(); // Disables the input listeners in this mode
         _gameplay.setMode(_loading.getMode());
+        // Keep the input of the session, so a problem someone runs into can be replayed
+        _gameplay.setRecording(true);
         _gameplay.init(_assets);
         _loaded = true;
 
@@ -34,6 +34,8 @@ bool AudioController::sfxMuted = false;
 shared_ptr<AssetManager> AudioController::_assets = make_shared<AssetManager>();
 
 void AudioController::playAudio(string sound, bool loop, float vol, bool isMusic) {
+    // Without an audio engine, as when running headless, there is nothing to play
+    if (AudioEngine::get() == nullptr) return;
     std::shared_ptr<Sound> source = _assets->get<Sound>(sound);
 
     if (isMusic) {
@@ -44,6 +46,7 @@ void AudioController::playAudio(string sound, bool loop, float vol, bool isMusic
 }
 
 bool AudioController::isPlaying(string sound, bool isMusic) {
+    if (AudioEngine::get() == nullptr) return false;
     if (isMusic) {
         return (AudioEngine::get()->getMusicQueue()->current() == sound);
     } else {
@@ -52,6 +55,7 @@ bool AudioController::isPlaying(string sound, bool isMusic) {
 }
 
 void AudioController::stopAudio(string sound, bool isMusic, float fadeAmount) {
+    if (AudioEngine::get() == nullptr) return;
     if (isMusic) {
         //TODO: make it not clear the queue???
         AudioEngine::get()->getMusicQueue()->clear(fadeAmount);
@@ -61,6 +65,7 @@ void AudioController::stopAudio(string sound, bool isMusic, float fadeAmount) {
 }
 
 void AudioController::setVolume(string sound, bool isMusic, float vol, bool isRel) {
+    if (AudioEngine::get() == nullptr) return;
     if (!isMusic) {
         AudioEngine::get()->setVolume(sound, isRel ? (AudioEngine::get()->AudioEngine::getVolume(sound) + vol) : vol);
     } else {
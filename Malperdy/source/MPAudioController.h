@@ -91,6 +91,7 @@ public:
      * @param vol	The relative volume at which to play the music (1 by default)
      */
     static void playGivenMusic(std::shared_ptr<Sound> sound, float vol = 1.0f) {
+        if (AudioEngine::get() == nullptr) return;
         AudioEngine::get()->getMusicQueue()->play(sound, true, vol);
     }
 
@@ -0,0 +1,279 @@
+//
+//  MPChainObstacle.cpp
+//  Malperdy
+//
+//  This class is a static physics object made up of Box2D chain shapes. It is
+//  used for the solid geometry of rooms, after all the polygons of a room and
+//  its neighbors have been merged together by GeometryMerger, along with any
+//  solid polygons that aren't merged.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPChainObstacle.h"
+
+using namespace cugl;
+
+#pragma mark Constructors
+
+/**
+ * Initializes a static chain obstacle at the given position with no chains.
+ *
+ * Chains should be added with addChain() before the obstacle is added to
+ * the world.
+ *
+ * @param pos   The position of the body in physics space
+ * @return      true if the obstacle is initialized properly, false otherwise.
+ */
+bool ChainObstacle::init(const Vec2 pos) {
+    if (!SimpleObstacle::init(pos)) return false;
+    setBodyType(b2_staticBody);
+    _chains.clear();
+    _seams.clear();
+    _polygons.clear();
+    return true;
+}
+
+#pragma mark Chains
+
+/**
+ * Adds the given chain to this obstacle. The vertices are in physics space,
+ * and are converted to be relative to the body.
+ *
+ * Vertices that are too close to the previous one for Box2D to handle are
+ * dropped. If there are not enough vertices left to make a chain, it is
+ * not added at all.
+ *
+ * This change cannot happen immediately. It must wait until the next time
+ * the fixtures are created.
+ *
+ * @param chain The chain to add
+ * @return      Whether the chain was added
+ */
+bool ChainObstacle::addChain(const Chain &chain) {
+    Chain local;
+    if (!toLocal(chain, local)) return false;
+
+    _chains.push_back(local);
+    markDirty(true);
+    return true;
+}
+
+/**
+ * Replaces the seams of this obstacle with the given chains. The vertices
+ * are in physics space, and are converted to be relative to the body.
+ *
+ * Only the seam fixtures are recreated, and if the body already exists
+ * that happens immediately. The rest of the fixtures are left alone.
+ *
+ * @param seams The chains that reach the edge of the room
+ */
+void ChainObstacle::setSeams(const vector<Chain> &seams) {
+    _seams.clear();
+    Chain local;
+    for (auto itr = seams.begin(); itr != seams.end(); ++itr) {
+        if (toLocal(*itr, local)) _seams.push_back(local);
+    }
+
+    if (_body != nullptr) {
+        releaseSeamFixtures();
+        createSeamFixtures();
+    }
+    if (_debug != nullptr) resetDebug();
+}
+
+/**
+ * Returns the given chain relative to the body, with any vertices too
+ * close together for Box2D dropped.
+ *
+ * @param chain The chain in physics space
+ * @param local Set to the chain relative to the body
+ * @return      Whether there are enough vertices left to make a chain
+ */
+bool ChainObstacle::toLocal(const Chain &chain, Chain &local) const {
+    Vec2 pos = getPosition();
+    local = Chain();
+    local.loop = chain.loop;
+    local.prevVertex = chain.prevVertex - pos;
+    local.nextVertex = chain.nextVertex - pos;
+
+    for (auto itr = chain.vertices.begin(); itr != chain.vertices.end(); ++itr) {
+        Vec2 v = (*itr) - pos;
+        if (!local.vertices.empty() && v.distanceSquared(local.vertices.back()) <= b2_linearSlop * b2_linearSlop) continue;
+        local.vertices.push_back(v);
+    }
+
+    // Loops can't repeat their first vertex at the end
+    if (local.loop) {
+        while (local.vertices.size() > 1
+               && local.vertices.back().distanceSquared(local.vertices.front()) <= b2_linearSlop * b2_linearSlop) {
+            local.vertices.pop_back();
+        }
+    }
+
+    return local.vertices.size() >= (local.loop ? 3 : 2);
+}
+
+/**
+ * Adds the given solid polygon to this obstacle. The vertices are in
+ * physics space, and are converted to be relative to the body. Each
+ * triangle of the polygon becomes its own fixture.
+ *
+ * This change cannot happen immediately. It must wait until the next time
+ * the fixtures are created.
+ *
+ * @param poly  The polygon to add, which must be triangulated
+ */
+void ChainObstacle::addPolygon(const Poly2 &poly) {
+    if (poly.getIndices().size() < 3) return;
+    Poly2 local = poly;
+    local -= getPosition();
+    _polygons.push_back(local);
+    markDirty(true);
+}
+
+#pragma mark Physics Methods
+
+/**
+ * Create new fixtures for this body, one for each chain and seam and one
+ * for each triangle of each polygon.
+ */
+void ChainObstacle::createFixtures() {
+    if (_body == nullptr) {
+        return;
+    }
+
+    releaseFixtures();
+
+    for (auto itr = _chains.begin(); itr != _chains.end(); ++itr) {
+        _geoms.push_back(createChainFixture(*itr));
+    }
+    createSeamFixtures();
+
+    b2PolygonShape triangle;
+    b2Vec2 corners[3];
+    for (auto itr = _polygons.begin(); itr != _polygons.end(); ++itr) {
+        const vector<Vec2> &vertices = itr->getVertices();
+        const vector<Uint32> &indices = itr->getIndices();
+        for (size_t ii = 0; ii + 2 < indices.size(); ii += 3) {
+            for (int jj = 0; jj < 3; jj++) {
+                Vec2 v = vertices[indices[ii + jj]];
+                corners[jj].Set(v.x, v.y);
+            }
+            triangle.Set(corners, 3);
+            _fixture.shape = &triangle;
+            _geoms.push_back(_body->CreateFixture(&_fixture));
+        }
+    }
+    markDirty(false);
+}
+
+/**
+ * Release the fixtures for this body.
+ */
+void ChainObstacle::releaseFixtures() {
+    if (_body != nullptr) {
+        for (auto itr = _geoms.begin(); itr != _geoms.end(); ++itr) {
+            _body->DestroyFixture(*itr);
+        }
+    }
+    _geoms.clear();
+    releaseSeamFixtures();
+}
+
+/**
+ * Creates the fixture for the given chain, which is relative to the body.
+ *
+ * @param chain The chain to create the fixture for
+ * @return      The fixture that was created
+ */
+b2Fixture *ChainObstacle::createChainFixture(const Chain &chain) {
+    vector<b2Vec2> verts;
+    verts.reserve(chain.vertices.size());
+    for (auto vItr = chain.vertices.begin(); vItr != chain.vertices.end(); ++vItr) {
+        verts.push_back(b2Vec2(vItr->x, vItr->y));
+    }
+
+    b2ChainShape shape;
+    if (chain.loop) {
+        shape.CreateLoop(verts.data(), (int)verts.size());
+    } else {
+        shape.CreateChain(verts.data(), (int)verts.size(),
+                          b2Vec2(chain.prevVertex.x, chain.prevVertex.y),
+                          b2Vec2(chain.nextVertex.x, chain.nextVertex.y));
+    }
+    _fixture.shape = &shape;
+    return _body->CreateFixture(&_fixture);
+}
+
+/**
+ * Creates a fixture for each seam.
+ */
+void ChainObstacle::createSeamFixtures() {
+    for (auto itr = _seams.begin(); itr != _seams.end(); ++itr) {
+        _seamGeoms.push_back(createChainFixture(*itr));
+    }
+}
+
+/**
+ * Releases the fixtures for the seams.
+ */
+void ChainObstacle::releaseSeamFixtures() {
+    if (_body != nullptr) {
+        for (auto itr = _seamGeoms.begin(); itr != _seamGeoms.end(); ++itr) {
+            _body->DestroyFixture(*itr);
+        }
+    }
+    _seamGeoms.clear();
+}
+
+#pragma mark Debugging
+
+/**
+ * Resets the wireframe for this object to show every chain and polygon.
+ */
+void ChainObstacle::resetDebug() {
+    // Put every chain in one polygon, with a pair of indices for each edge
+    vector<Vec2> verts;
+    vector<Uint32> indices;
+    for (const vector<Chain> *chains : {&_chains, &_seams}) {
+        for (auto itr = chains->begin(); itr != chains->end(); ++itr) {
+            Uint32 first = (Uint32)verts.size();
+            verts.insert(verts.end(), itr->vertices.begin(), itr->vertices.end());
+            for (Uint32 ii = first; ii + 1 < verts.size(); ii++) {
+                indices.push_back(ii);
+                indices.push_back(ii + 1);
+            }
+            if (itr->loop) {
+                indices.push_back((Uint32)verts.size() - 1);
+                indices.push_back(first);
+            }
+        }
+    }
+    for (auto itr = _polygons.begin(); itr != _polygons.end(); ++itr) {
+        Uint32 first = (Uint32)verts.size();
+        verts.insert(verts.end(), itr->getVertices().begin(), itr->getVertices().end());
+        for (Uint32 ii = first; ii < verts.size(); ii++) {
+            indices.push_back(ii);
+            indices.push_back(ii + 1 < verts.size() ? ii + 1 : first);
+        }
+    }
+
+    Poly2 wires(verts);
+    if (_debug == nullptr) {
+        _debug = scene2::WireNode::alloc();
+        _debug->setColor(_dcolor);
+        if (_scene != nullptr) {
+            _scene->addChild(_debug);
+        }
+    }
+    // Vertices are relative to the body, so draw them from the node origin
+    _debug->setAbsolute(true);
+    _debug->setPolygon(wires);
+    _debug->setTraversal(indices);
+    _debug->setPosition(getPosition());
+}
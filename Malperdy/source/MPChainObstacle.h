@@ -0,0 +1,226 @@
+//
+//  MPChainObstacle.h
+//  Malperdy
+//
+//  This class is a static physics object made up of Box2D chain shapes. It is
+//  used for the solid geometry of rooms, after all the polygons of a room and
+//  its neighbors have been merged together by GeometryMerger. A single chain
+//  replaces what used to be many separate polygon fixtures, so there are far
+//  fewer fixtures in the broadphase and no internal edges for characters to
+//  catch on.
+//
+//  Each chain is either a closed loop or an open run of edges with ghost
+//  vertices, which tell Box2D how the run connects to the chains in the
+//  neighboring rooms. Chains are one-sided, so the solid must always be on
+//  the left of each edge.
+//
+//  Solid pieces that aren't merged, like exit blockades, can be added as
+//  polygons. Everything is stored relative to the body, so the whole room
+//  can be moved with a single setPosition().
+//
+//  The chains that reach the edge of the room are kept apart as seams, since
+//  they are the only ones that depend on the neighboring rooms. They can be
+//  replaced on their own, without touching the rest of the fixtures.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPChainObstacle_h
+#define MPChainObstacle_h
+
+#include <cugl/cugl.h>
+#include <cugl/physics2/CUSimpleObstacle.h>
+#include <box2d/b2_chain_shape.h>
+#include <box2d/b2_polygon_shape.h>
+#include <vector>
+
+using namespace cugl;
+
+class ChainObstacle : public physics2::SimpleObstacle {
+public:
+    /**
+     * The vertices of a single chain shape, in physics space.
+     *
+     * If the chain is not a loop, the ghost vertices are the points just
+     * before the first vertex and just after the last one.
+     */
+    struct Chain {
+        /** The vertices of the chain, with the solid to the left of each edge */
+        vector<Vec2> vertices;
+        /** Whether the chain is a closed loop */
+        bool loop = false;
+        /** Ghost vertex connecting to the start of the chain, if it is not a loop */
+        Vec2 prevVertex;
+        /** Ghost vertex connecting to the end of the chain, if it is not a loop */
+        Vec2 nextVertex;
+    };
+
+private:
+    /** This macro disables the copy constructor (not allowed on physics objects) */
+    CU_DISALLOW_COPY_AND_ASSIGN(ChainObstacle);
+
+protected:
+    /** The chains making up this object, relative to the body position */
+    vector<Chain> _chains;
+    /** The chains that reach the edge of the room, relative to the body position */
+    vector<Chain> _seams;
+    /** The solid polygons making up this object, relative to the body position */
+    vector<Poly2> _polygons;
+    /** The fixtures created for each chain, then for each triangle of each polygon */
+    vector<b2Fixture*> _geoms;
+    /** The fixtures created for each seam */
+    vector<b2Fixture*> _seamGeoms;
+
+    /**
+     * Returns the given chain relative to the body, with any vertices too
+     * close together for Box2D dropped.
+     *
+     * @param chain The chain in physics space
+     * @param local Set to the chain relative to the body
+     * @return      Whether there are enough vertices left to make a chain
+     */
+    bool toLocal(const Chain &chain, Chain &local) const;
+
+    /**
+     * Creates the fixture for the given chain, which is relative to the body.
+     *
+     * @param chain The chain to create the fixture for
+     * @return      The fixture that was created
+     */
+    b2Fixture *createChainFixture(const Chain &chain);
+
+    /**
+     * Creates a fixture for each seam.
+     */
+    void createSeamFixtures();
+
+    /**
+     * Releases the fixtures for the seams.
+     */
+    void releaseSeamFixtures();
+
+    /**
+     * Resets the wireframe for this object to show every chain and polygon.
+     */
+    virtual void resetDebug() override;
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates a new chain obstacle with no chains.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    ChainObstacle() : SimpleObstacle() {}
+
+    /**
+     * Destroys this chain obstacle, releasing all resources.
+     */
+    virtual ~ChainObstacle() {
+        CUAssertLog(_body == nullptr, "You must deactive physics before deleting an object");
+    }
+
+    /**
+     * Initializes a static chain obstacle at the given position with no chains.
+     *
+     * Chains should be added with addChain() before the obstacle is added to
+     * the world.
+     *
+     * @param pos   The position of the body in physics space
+     * @return      true if the obstacle is initialized properly, false otherwise.
+     */
+    virtual bool init(const Vec2 pos) override;
+
+    /**
+     * Returns a newly-allocated static chain obstacle at the given position
+     * with no chains.
+     *
+     * @param pos   The position of the body in physics space
+     * @return      A newly-allocated ChainObstacle
+     */
+    static shared_ptr<ChainObstacle> alloc(const Vec2 pos) {
+        shared_ptr<ChainObstacle> result = make_shared<ChainObstacle>();
+        return (result->init(pos) ? result : nullptr);
+    }
+
+#pragma mark Chains
+
+    /**
+     * Adds the given chain to this obstacle. The vertices are in physics space,
+     * and are converted to be relative to the body.
+     *
+     * Vertices that are too close to the previous one for Box2D to handle are
+     * dropped. If there are not enough vertices left to make a chain, it is
+     * not added at all.
+     *
+     * This change cannot happen immediately. It must wait until the next time
+     * the fixtures are created.
+     *
+     * @param chain The chain to add
+     * @return      Whether the chain was added
+     */
+    bool addChain(const Chain &chain);
+
+    /**
+     * Replaces the seams of this obstacle with the given chains. The vertices
+     * are in physics space, and are converted to be relative to the body.
+     *
+     * Only the seam fixtures are recreated, and if the body already exists
+     * that happens immediately. The rest of the fixtures are left alone.
+     *
+     * @param seams The chains that reach the edge of the room
+     */
+    void setSeams(const vector<Chain> &seams);
+
+    /**
+     * Returns the number of chains (and so the number of fixtures) in this
+     * obstacle, including the seams.
+     *
+     * @return  The number of chains in this obstacle
+     */
+    int getChainCount() const {
+        return (int)(_chains.size() + _seams.size());
+    }
+
+    /**
+     * Adds the given solid polygon to this obstacle. The vertices are in
+     * physics space, and are converted to be relative to the body. Each
+     * triangle of the polygon becomes its own fixture.
+     *
+     * This change cannot happen immediately. It must wait until the next time
+     * the fixtures are created.
+     *
+     * @param poly  The polygon to add, which must be triangulated
+     */
+    void addPolygon(const Poly2 &poly);
+
+    /**
+     * Returns the number of solid polygons in this obstacle.
+     *
+     * @return  The number of polygons in this obstacle
+     */
+    int getPolygonCount() const {
+        return (int)_polygons.size();
+    }
+
+#pragma mark Physics Methods
+
+    /**
+     * Create new fixtures for this body, one for each chain and seam and one
+     * for each triangle of each polygon.
+     */
+    virtual void createFixtures() override;
+
+    /**
+     * Release the fixtures for this body.
+     */
+    virtual void releaseFixtures() override;
+};
+
+#endif /* MPChainObstacle_h */
@@ -14,6 +14,7 @@
 
 #include "MPCharacterModel.h"
 #include "MPAudioController.h"
+#include "MPSimClock.h"
 #include <cugl/scene2/graph/CUPolygonNode.h>
 #include <cugl/scene2/graph/CUTexturedNode.h>
 #include <cugl/assets/CUAssetManager.h>
@@ -56,7 +57,7 @@ bool CharacterModel::init(const cugl::Vec2 &pos, float drawScale, shared_ptr<Ani
     nsize = nsize * DUDE_WIDTH / nsize.width; //!! drawScale is effective ignored!
     _drawScale = drawScale;
 
-    setAnimation("run");
+    setAnimation(Animation::Clip::RUN);
 
     // Create physics
     if (CapsuleObstacle::init(pos, nsize)) {
@@ -130,7 +131,7 @@ bool CharacterModel::setMoveState(MovementState newState, int param) {
     // Do what needs to be done when switching into the new state
     switch (newState) {
         case MovementState::STOPPED:
-            setAnimation("idle");
+            setAnimation(Animation::Clip::IDLE);
             _jumped = false;
             break;
         case MovementState::RUNNING:
@@ -143,7 +144,7 @@ bool CharacterModel::setMoveState(MovementState newState, int param) {
             }
 
             _speed = RUN_SPEED * (isSapped ? SAPPED_MULT : 1);
-            setAnimation("run");
+            setAnimation(Animation::Clip::RUN);
             _jumped = false;
             break;
         case MovementState::JUMPING:
@@ -156,7 +157,7 @@ bool CharacterModel::setMoveState(MovementState newState, int param) {
 
             // If character is on a wall, then also give a horizontal velocity away
             //if (_moveState == MovementState::ONWALL) setVX((_faceRight ? 1 : -1) * JUMP_SPEED / 1.8);
-            setAnimation("jump");
+            setAnimation(Animation::Clip::JUMP);
             _jumped = true;
 
             break;
@@ -168,12 +169,12 @@ bool CharacterModel::setMoveState(MovementState newState, int param) {
             // Reduce gravity so that character "sticks" to wall
             setGravityScale(WALL_SLIDE_GRAV_SCALE);
             // Stop moving temporarily as character sticks
-            _currAnimation = "";
+            _restartClip = true;
             _jumped = false;
             break;
         case MovementState::DASHING:
             // Don't allow dashing if dash cooldown hasn't finished
-            if (Timestamp().ellapsedMillis(_dashStart) <= DASH_COOLDOWN) {
+            if (SimClock::ellapsedMillis(_dashStart) <= DASH_COOLDOWN) {
                 return false;
             }
 
@@ -181,7 +182,7 @@ bool CharacterModel::setMoveState(MovementState newState, int param) {
 
             if ((param > 0) != _faceRight) flipDirection();
 
-            _dashStart = Timestamp();
+            _dashStart = SimClock::now();
 
             // Play dash sound since we can actually perform a dash.
             //(this->getPosition() - _worldnode->getPaneTransform().transform(Vec2()) / _scale).norm()
@@ -194,7 +195,7 @@ bool CharacterModel::setMoveState(MovementState newState, int param) {
             setVX(param * RUN_SPEED * DASH_MULTIPLIER * (isSapped ? SAPPED_MULT : 1) * x_scale());
 
             // Freeze animation while dashing
-            _currAnimation = "";
+            _restartClip = true;
             break;
         case MovementState::DEAD:
             // TODO: any changes for swapping into DEAD state
@@ -202,7 +203,7 @@ bool CharacterModel::setMoveState(MovementState newState, int param) {
             setVY(0);
             setBodyType(b2_staticBody);
 
-            setAnimation("dead");
+            setAnimation(Animation::Clip::DEAD);
 
             break;
     }
@@ -357,7 +358,7 @@ void CharacterModel::update(float dt) {
         case MovementState::ONWALL:
             break;
         case MovementState::DASHING:
-            if (Timestamp().ellapsedMillis(_dashStart) > DASH_DURATION) {
+            if (SimClock::ellapsedMillis(_dashStart) > DASH_DURATION) {
                 setMoveState(_dashedOnGround ? MovementState::RUNNING : MovementState::FALLING, 1);
                 _dashedOnGround = false;
             }
@@ -376,49 +377,36 @@ void CharacterModel::update(float dt) {
     }
 
     // Update sapped status
-    if (Timestamp().ellapsedMillis(_dashStart) <= SAPPED_DURATION) {
+    if (SimClock::ellapsedMillis(_dashStart) <= SAPPED_DURATION) {
         isSapped = false;
     }
 
     // UPDATE THE ANIMATION
+    if (_currClip == Animation::Clip::NONE) return;
 
-    // update time since last frame update
-    _elapsed += dt;
-
-    //if (true && (_moveState == MovementState::RUNNING || _moveState == MovementState::JUMPING)) {
-
-    // if it is time to update the frame...
-    float frame_time = FRAME_TIME;
-
+    // Some states play their animation faster or slower than normal
+    float rate = 1;
     switch (_moveState) {
         case MovementState::JUMPING:
-            frame_time *= 2;
+            rate = JUMP_ANIMATION_RATE;
             break;
         case MovementState::DASHING:
-            frame_time *= 0.1;
+            rate = DASH_ANIMATION_RATE;
+            break;
+        default:
             break;
     }
+    _clipTime += dt * rate;
 
-    if (_elapsed > frame_time) {
-
-        // if on the last frame
-        if ((_animation->isReversed() ? _currFrame <= _startframe : _currFrame >= _lastframe)) {
-            // loop the animation if needed
+    // Keep looping clips from building up time forever
+    const Animation::ClipData &clip = _animation->getClipData(_currClip);
+    if (clip.loop) _clipTime = fmod(_clipTime, clip.getLength() / clip.fps);
 
-            if (_loop) {
-                _currFrame = (_animation->isReversed() ? _lastframe : _startframe);
-            }
-        }
-            // if not on the last frame, then increment
-        else {
-            _currFrame = (_animation->isReversed() ? _currFrame - 1 : _currFrame + 1);
-        }
+    int frame = _animation->getFrame(_currClip, _clipTime);
+    if (frame != _currFrame) {
+        _currFrame = frame;
         _node->setFrame(_currFrame);
-        // reset time since last frame update
-        _elapsed = 0;
     }
-    //}
-
 }
 
 
@@ -20,6 +20,7 @@
 #include <cugl/scene2/graph/CUWireNode.h>
 #include <map>
 #include "MPAnimation.h"
+#include "MPSimClock.h"
 
 using namespace cugl;
 
@@ -69,15 +70,17 @@ private:
     /** The texture for the character avatar */
     const string CHARACTER_TEXTURE;
 
-    /** The amount of time in between each frame update */
-    const float FRAME_TIME = 0.03;
+    /** How fast animations play while jumping, relative to their normal speed */
+    const float JUMP_ANIMATION_RATE = 0.5f;
+    /** How fast animations play while dashing, relative to their normal speed */
+    const float DASH_ANIMATION_RATE = 10.0f;
 
     /** The duration in milliseconds of a dash */
     const Uint64 DASH_DURATION = 120;
     const Uint64 DASH_COOLDOWN = 900;
 
     bool isSapped = false;
-    Timestamp sappedTime;
+    double sappedTime = 0;
 
 public:
     /** Enum representing the current state of movement that the character is in */
@@ -107,14 +110,14 @@ protected:
     /** The current maximum number of hearts that this character can have */
     float _maxHearts = 2;
 
-    /** The amount of time since last frame update */
-    float _elapsed = 0;
+    /** How long the current clip has been playing, in seconds of clip time */
+    float _clipTime = 0;
 
     /** represents the actual frame of animation, invariant to texture flips */
     int _currFrame = 0;
 
-    /** the time that the last dash started */
-    Timestamp _dashStart = Timestamp();
+    /** the simulation time that the last dash started */
+    double _dashStart = SimClock::now();
 
     /** whether the character jumped since leaving the ground */
     bool _jumped = false;
@@ -128,12 +131,12 @@ protected:
     /** The dictionary of all character animations */
     shared_ptr<Animation> _animation;
 
-    /** The frame data the current animation */
-    string _currAnimation;
-    int _startframe;
-    int _lastframe;
-    bool _loop;
-    bool _flip;
+    /** The clip that is playing, or NONE if no clip has been set yet */
+    Animation::Clip _currClip = Animation::Clip::NONE;
+    /** Whether setting the clip that is already playing should start it over */
+    bool _restartClip = false;
+    /** Whether the sprite is currently flipped for the clip */
+    bool _flip = false;
 
 #pragma mark Attributes
 
@@ -259,32 +262,28 @@ public:
         _node->setPosition(getPosition() * _drawScale);
     }
 
-    /** Sets the animation to the string specified, and changes the relevant frame data
+    /** Sets the animation to the clip specified, and starts it from the beginning
      * returns whether the animation was swapped successsfully
      */
-    bool setAnimation(string anim) {
+    bool setAnimation(Animation::Clip clip) {
 
         // return false if the animation doesn't exist, or we are already on the animation
-        if (!_animation->hasKey(anim)) return false;
-        if (_currAnimation == anim) return false;
+        if (!_animation->hasClip(clip)) return false;
+        if (_currClip == clip && !_restartClip) return false;
 
-
-        // change frame data
-        _currAnimation = anim;
-        _startframe = _animation->getStart(anim);
-        _lastframe = _animation->getLast(anim);
-        _loop = _animation->isLoop(anim);
+        _currClip = clip;
+        _restartClip = false;
+        _clipTime = 0;
 
         // flip the animation if we need to
-        _node->setVisible(false);
-        if (_flip ^ _animation->isFlip(anim)) {
+        bool flip = _animation->getClipData(clip).flip;
+        if (_flip ^ flip) {
             _node->setScale(_node->getScale() * Vec2(-1, 1));
         }
-        _node->setFrame(_currFrame);
-        _node->setVisible(true);
-        _flip = _animation->isFlip(anim);
+        _flip = flip;
 
-        _currFrame = _animation->isReversed() ? _lastframe : _startframe;
+        _currFrame = _animation->getFrame(clip, 0);
+        _node->setFrame(_currFrame);
         return true;
     }
 
@@ -294,7 +293,7 @@ public:
 
     void slowCharacter() {
         isSapped = true;
-        sappedTime = Timestamp();
+        sappedTime = SimClock::now();
     }
 
     /*void restoreSpeed() {
@@ -420,6 +419,26 @@ public:
      */
     bool setMoveState(MovementState newState, int param = 0);
 
+    /**
+     * Returns the character's current movement state.
+     *
+     * @return  The movement state the character is in
+     */
+    MovementState getMoveState() const {
+        return _moveState;
+    }
+
+    /**
+     * Puts the character back into the STOPPED state, ignoring the rules in
+     * setMoveState about which states can be left. This is only meant for
+     * restoring a checkpoint snapshot, where the character may have died or
+     * been mid-dash since.
+     */
+    void resetMoveState() {
+        _moveState = MovementState::STOPPED;
+        setGravityScale(1.0f);
+    }
+
     /**
      * Sets the current position for this physics body
      *
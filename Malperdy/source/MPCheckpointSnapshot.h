@@ -0,0 +1,117 @@
+//
+//  MPCheckpointSnapshot.h
+//  Malperdy
+//
+//  This is a pure data class that holds everything about the game that can
+//  change between reaching a checkpoint and dying. GameScene takes one of
+//  these every time Reynard activates a checkpoint, and when he dies it puts
+//  everything back the way the snapshot says, in place on the existing grid
+//  and physics world. Nothing is rebuilt and no files are read.
+//
+//  Rooms are stored by pointer, since the same room objects stay alive for the
+//  whole level and only move around the grid. Everything else is stored by value.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPCheckpointSnapshot_h
+#define MPCheckpointSnapshot_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "MPRoomModel.h"
+#include "MPTrapModel.hpp"
+#include "MPCharacterModel.h"
+#include "MPEnemyModel.h"
+
+using namespace cugl;
+
+class CheckpointSnapshot {
+public:
+    /** The state of a single character, in PHYSICS space */
+    struct CharacterState {
+        /** Position of the character's body */
+        Vec2 position;
+        /** Linear velocity of the character's body */
+        Vec2 velocity;
+        /** How much health the character had */
+        float hearts = 0;
+        /** Whether the character was facing right */
+        bool facingRight = true;
+    };
+
+    /** The state of a single key that hasn't been picked up yet, in PHYSICS space */
+    struct KeyState {
+        /** Position of the key */
+        Vec2 position;
+        /** Whether this is a possessed key instead of a regular one */
+        bool possessed = false;
+        /** Whether the key was flying towards Reynard */
+        bool pathFinding = false;
+    };
+
+    /** Every cell of the room table in row-major HOUSE space order, so the permutation of rooms */
+    vector<shared_ptr<RoomModel>> rooms;
+
+    /** The state of the trap in each room, in the same order as [rooms] (SPAWN if there is no trap) */
+    vector<TrapModel::TrapState> trapStates;
+
+    /** The swap history up to the snapshot */
+    vector<vector<Vec2>> swapHistory;
+
+    /** Reynard's state */
+    CharacterState reynard;
+
+    /** The IDs of the keys Reynard was carrying */
+    vector<int> reynardKeyIDs;
+
+    /** The state of every enemy, in the order they spawn in the level */
+    vector<CharacterState> enemies;
+
+    /** What every enemy was doing, in the same order as [enemies] */
+    vector<EnemyModel::BehaviorState> enemyBehaviors;
+
+    /** Every key in the level that hadn't been picked up yet */
+    vector<KeyState> keys;
+
+    /** Indices of every checkpoint that had been activated */
+    vector<int> activatedCheckpoints;
+
+#pragma mark Helpers
+
+    /**
+     * Returns the state of the given character.
+     *
+     * @param character The character to take a snapshot of
+     * @return          The character's state
+     */
+    static CharacterState captureCharacter(const shared_ptr<CharacterModel> &character) {
+        CharacterState state;
+        state.position = character->getPosition();
+        state.velocity = character->getLinearVelocity();
+        state.hearts = character->getHearts();
+        state.facingRight = character->isFacingRight();
+        return state;
+    }
+
+    /**
+     * Puts the given character back into the given state. Characters that were
+     * alive in the snapshot are brought back to life if they died since.
+     *
+     * @param character The character to restore
+     * @param state     The state to restore the character to
+     */
+    static void restoreCharacter(const shared_ptr<CharacterModel> &character, const CharacterState &state) {
+        character->setPosition(state.position);
+        character->setLinearVelocity(state.velocity);
+        character->setHearts(state.hearts);
+        if (state.hearts > 0) character->resetMoveState();
+        if (character->isFacingRight() != state.facingRight) character->flipDirection();
+    }
+};
+
+#endif /* MPCheckpointSnapshot_h */
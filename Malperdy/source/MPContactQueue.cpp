@@ -0,0 +1,100 @@
+//
+//  MPContactQueue.cpp
+//  Malperdy
+//
+//  This class collects the contact events that Box2D raises during a physics
+//  step, so that the game can react to them after the step.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPContactQueue.h"
+
+#pragma mark Recording
+
+/**
+ * Records that the given contact started touching. This is meant to be
+ * called from the world's onBeginContact callback.
+ *
+ * @param contact   The contact that started touching
+ */
+void ContactQueue::beginContact(b2Contact *contact) {
+    // Only the first contact between two fixtures counts
+    int &count = _touching[getKey(contact->GetFixtureA(), contact->GetFixtureB())];
+    if (count++ > 0) return;
+
+    b2WorldManifold manifold;
+    contact->GetWorldManifold(&manifold);
+
+    ContactEvent event;
+    event.type = ContactEvent::Type::BEGIN;
+    event.fixtureA = contact->GetFixtureA();
+    event.fixtureB = contact->GetFixtureB();
+    event.normal = manifold.normal;
+    event.pointCount = contact->GetManifold()->pointCount;
+    push(event);
+}
+
+/**
+ * Records that the given contact stopped touching. This is meant to be
+ * called from the world's onEndContact callback.
+ *
+ * @param contact   The contact that stopped touching
+ */
+void ContactQueue::endContact(b2Contact *contact) {
+    // Ignore pairs that were cleared, and pairs that still have another contact
+    auto itr = _touching.find(getKey(contact->GetFixtureA(), contact->GetFixtureB()));
+    if (itr == _touching.end()) return;
+    if (--(itr->second) > 0) return;
+    _touching.erase(itr);
+
+    ContactEvent event;
+    event.type = ContactEvent::Type::END;
+    event.fixtureA = contact->GetFixtureA();
+    event.fixtureB = contact->GetFixtureB();
+    event.normal = b2Vec2_zero;
+    event.pointCount = 0;
+    push(event);
+}
+
+/**
+ * Adds the given event, dispatching it right away if the world isn't stepping.
+ *
+ * @param event The event to add
+ */
+void ContactQueue::push(const ContactEvent &event) {
+    _events.push_back(event);
+    // Anything outside a step comes from a body going away, so it can't wait
+    if (_world == nullptr || !_world->IsLocked()) flush();
+}
+
+#pragma mark Dispatching
+
+/**
+ * Dispatches every event recorded since the last flush, in order. This
+ * must be called after the world is updated but before it is garbage
+ * collected, while every recorded fixture still exists.
+ *
+ * The callbacks may add, move or remove obstacles, but must not destroy
+ * bodies directly.
+ */
+void ContactQueue::flush() {
+    // Events pushed by a callback are picked up by the loop that is already running
+    if (_flushing) return;
+    _flushing = true;
+    for (size_t i = 0; i < _events.size(); i++) {
+        // Copy the event, since a callback can add more and move the buffer
+        ContactEvent event = _events[i];
+        if (event.type == ContactEvent::Type::BEGIN) {
+            if (onBeginContact) onBeginContact(event);
+        } else {
+            if (onEndContact) onEndContact(event);
+        }
+    }
+    _events.clear();
+    _flushing = false;
+}
@@ -0,0 +1,158 @@
+//
+//  MPContactQueue.h
+//  Malperdy
+//
+//  This class collects the contact events that Box2D raises during a physics
+//  step, so that the game can react to them after the step instead of from
+//  inside the solver. GameScene hooks it up to the world's contact callbacks
+//  and calls flush() right after the world has been updated.
+//
+//  Events are tracked per fixture pair rather than per Box2D contact. A chain
+//  shape makes a separate contact for every edge that touches a fixture, so a
+//  character standing on a seam would otherwise get two begins from the same
+//  ground. A begin is only queued when a pair starts touching, and an end only
+//  when it stops touching altogether. This keeps begins and ends balanced.
+//
+//  Events raised outside of a step come from bodies being disabled or
+//  destroyed. Their fixtures may be gone by the next flush, so they are
+//  dispatched right away instead.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPContactQueue_h
+#define MPContactQueue_h
+
+#include <cugl/cugl.h>
+#include <box2d/b2_contact.h>
+#include <box2d/b2_fixture.h>
+#include <box2d/b2_world.h>
+#include <vector>
+#include <map>
+
+using namespace cugl;
+
+/** A single contact event, recorded while the physics world was stepping */
+struct ContactEvent {
+    /** Whether the fixtures started or stopped touching */
+    enum class Type {
+        BEGIN,
+        END
+    };
+
+    /** Whether the fixtures started or stopped touching */
+    Type type;
+    /** The first fixture in the contact */
+    b2Fixture *fixtureA;
+    /** The second fixture in the contact */
+    b2Fixture *fixtureB;
+    /** The contact normal in world space, pointing from A to B */
+    b2Vec2 normal;
+    /** The number of contact points when the event was recorded */
+    int pointCount;
+
+    /** Returns the first fixture in the contact */
+    b2Fixture *GetFixtureA() const { return fixtureA; }
+
+    /** Returns the second fixture in the contact */
+    b2Fixture *GetFixtureB() const { return fixtureB; }
+};
+
+class ContactQueue {
+private:
+    /** The world whose contacts are being recorded */
+    b2World *_world;
+    /** The events recorded since the last flush, in the order they happened */
+    vector<ContactEvent> _events;
+    /** How many Box2D contacts are touching for every fixture pair that is touching */
+    map<pair<b2Fixture *, b2Fixture *>, int> _touching;
+    /** Whether events are being dispatched right now */
+    bool _flushing;
+
+    /**
+     * Returns the key for the given fixture pair, the same whichever way around it is.
+     */
+    static pair<b2Fixture *, b2Fixture *> getKey(b2Fixture *a, b2Fixture *b) {
+        return (a < b ? make_pair(a, b) : make_pair(b, a));
+    }
+
+    /**
+     * Adds the given event, dispatching it right away if the world isn't stepping.
+     *
+     * @param event The event to add
+     */
+    void push(const ContactEvent &event);
+
+public:
+    /** Called for every pair of fixtures that starts touching */
+    std::function<void(const ContactEvent &event)> onBeginContact;
+    /** Called for every pair of fixtures that stops touching */
+    std::function<void(const ContactEvent &event)> onEndContact;
+
+#pragma mark Constructors
+
+    /**
+     * Creates an empty queue that isn't attached to a world.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    ContactQueue() : _world(nullptr), _flushing(false) {}
+
+    /**
+     * Returns a newly allocated queue for the given world.
+     *
+     * @param world The world whose contacts will be recorded
+     * @return      A newly allocated ContactQueue
+     */
+    static shared_ptr<ContactQueue> alloc(b2World *world) {
+        shared_ptr<ContactQueue> result = make_shared<ContactQueue>();
+        result->_world = world;
+        return result;
+    }
+
+#pragma mark Recording
+
+    /**
+     * Records that the given contact started touching. This is meant to be
+     * called from the world's onBeginContact callback.
+     *
+     * @param contact   The contact that started touching
+     */
+    void beginContact(b2Contact *contact);
+
+    /**
+     * Records that the given contact stopped touching. This is meant to be
+     * called from the world's onEndContact callback.
+     *
+     * @param contact   The contact that stopped touching
+     */
+    void endContact(b2Contact *contact);
+
+#pragma mark Dispatching
+
+    /**
+     * Dispatches every event recorded since the last flush, in order. This
+     * must be called after the world is updated but before it is garbage
+     * collected, while every recorded fixture still exists.
+     *
+     * The callbacks may add, move or remove obstacles, but must not destroy
+     * bodies directly.
+     */
+    void flush();
+
+    /**
+     * Forgets every recorded event and every touching pair without
+     * dispatching anything. This should be called before the world is cleared.
+     */
+    void clear() {
+        _events.clear();
+        _touching.clear();
+    }
+};
+
+#endif /* MPContactQueue_h */
@@ -0,0 +1,162 @@
+//
+//  MPDebugDraw.cpp
+//  Malperdy
+//
+//  This class draws everything shown in debug mode, rebuilt from scratch each
+//  frame as a single mesh of line segments in physics space.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPDebugDraw.h"
+#include <box2d/b2_contact.h>
+#include <box2d/b2_collision.h>
+
+/** Converts a Box2D color to a CUGL one */
+static Color4 toColor(const b2Color &color) {
+    return Color4(Color4f(color.r, color.g, color.b, color.a));
+}
+
+/** Converts a Box2D vector to a CUGL one */
+static Vec2 toVec2(const b2Vec2 &v) {
+    return Vec2(v.x, v.y);
+}
+
+#pragma mark World Drawing
+
+void DebugDraw::WorldDraw::DrawPolygon(const b2Vec2 *vertices, int32 vertexCount, const b2Color &color) {
+    for (int32 i = 0; i < vertexCount; i++) {
+        owner->addSegment(toVec2(vertices[i]), toVec2(vertices[(i + 1) % vertexCount]), toColor(color));
+    }
+}
+
+void DebugDraw::WorldDraw::DrawSolidPolygon(const b2Vec2 *vertices, int32 vertexCount, const b2Color &color) {
+    DrawPolygon(vertices, vertexCount, color);
+}
+
+void DebugDraw::WorldDraw::DrawCircle(const b2Vec2 &center, float radius, const b2Color &color) {
+    Vec2 c = toVec2(center);
+    Vec2 prev = c + Vec2(radius, 0);
+    for (int i = 1; i <= DEBUG_CIRCLE_SEGMENTS; i++) {
+        float angle = 2 * M_PI * i / DEBUG_CIRCLE_SEGMENTS;
+        Vec2 next = c + Vec2(cosf(angle), sinf(angle)) * radius;
+        owner->addSegment(prev, next, toColor(color));
+        prev = next;
+    }
+}
+
+void DebugDraw::WorldDraw::DrawSolidCircle(const b2Vec2 &center, float radius, const b2Vec2 &/*axis*/, const b2Color &color) {
+    DrawCircle(center, radius, color);
+}
+
+void DebugDraw::WorldDraw::DrawSegment(const b2Vec2 &p1, const b2Vec2 &p2, const b2Color &color) {
+    owner->addSegment(toVec2(p1), toVec2(p2), toColor(color));
+}
+
+void DebugDraw::WorldDraw::DrawPoint(const b2Vec2 &p, float /*size*/, const b2Color &color) {
+    owner->addPoint(toVec2(p), DEBUG_CONTACT_SIZE, toColor(color));
+}
+
+#pragma mark Constructors
+
+/**
+ * Initializes an empty debug draw.
+ *
+ * @return  true if initialization was successful, false otherwise
+ */
+bool DebugDraw::init() {
+    if (!SceneNode::init()) return false;
+    _mesh.command = GL_LINES;
+    _worldDraw.owner = this;
+    _worldDraw.SetFlags(b2Draw::e_shapeBit);
+    return true;
+}
+
+#pragma mark Drawing
+
+/**
+ * Adds a line segment between the two given points.
+ *
+ * @param p1        The start of the segment in physics space
+ * @param p2        The end of the segment in physics space
+ * @param color     The color of the segment
+ */
+void DebugDraw::addSegment(const Vec2 &p1, const Vec2 &p2, const Color4 &color) {
+    SpriteVertex2 vert;
+    vert.color = color.getPacked();
+
+    vert.position = p1;
+    _mesh.indices.push_back((Uint32)_mesh.vertices.size());
+    _mesh.vertices.push_back(vert);
+    vert.position = p2;
+    _mesh.indices.push_back((Uint32)_mesh.vertices.size());
+    _mesh.vertices.push_back(vert);
+}
+
+/**
+ * Adds a small cross centered on the given point.
+ *
+ * @param p         The point in physics space
+ * @param size      Half the width of the cross
+ * @param color     The color of the cross
+ */
+void DebugDraw::addPoint(const Vec2 &p, float size, const Color4 &color) {
+    addSegment(p - Vec2(size, size), p + Vec2(size, size), color);
+    addSegment(p - Vec2(size, -size), p + Vec2(size, -size), color);
+}
+
+/**
+ * Adds the outline of every fixture in the given world, and a cross at
+ * every point where two fixtures are touching.
+ *
+ * @param world     The physics world to draw
+ */
+void DebugDraw::addWorld(b2World *world) {
+    if (world == nullptr) return;
+
+    // Let Box2D walk the fixtures, but only while this is drawing
+    world->SetDebugDraw(&_worldDraw);
+    world->DebugDraw();
+    world->SetDebugDraw(nullptr);
+
+    b2WorldManifold manifold;
+    for (b2Contact *contact = world->GetContactList(); contact != nullptr; contact = contact->GetNext()) {
+        if (!contact->IsTouching()) continue;
+        contact->GetWorldManifold(&manifold);
+        for (int32 i = 0; i < contact->GetManifold()->pointCount; i++) {
+            addPoint(toVec2(manifold.points[i]), DEBUG_CONTACT_SIZE, DEBUG_CONTACT_COLOR);
+        }
+    }
+}
+
+/**
+ * Removes everything that has been added.
+ *
+ * @param release   Whether to also free the memory that was used
+ */
+void DebugDraw::clear(bool release) {
+    _mesh.vertices.clear();
+    _mesh.indices.clear();
+    if (release) {
+        _mesh.vertices.shrink_to_fit();
+        _mesh.indices.shrink_to_fit();
+    }
+}
+
+/**
+ * Draws every segment that has been added in a single batch.
+ *
+ * @param batch     The SpriteBatch to draw with
+ * @param transform The global transformation matrix
+ * @param tint      The tint to blend with the segment colors
+ */
+void DebugDraw::draw(const std::shared_ptr<SpriteBatch> &batch, const Affine2 &transform, Color4 tint) {
+    if (_mesh.vertices.empty()) return;
+    batch->setColor(tint);
+    batch->setTexture(Texture::getBlank());
+    batch->drawMesh(_mesh, transform);
+}
@@ -0,0 +1,145 @@
+//
+//  MPDebugDraw.h
+//  Malperdy
+//
+//  This class draws everything shown in debug mode: the outline of every
+//  fixture in the physics world, the contact points between them, and any
+//  raycasts that were added during the frame.
+//
+//  Nothing is kept from one frame to the next. Everything is added again each
+//  frame as line segments in physics space, and drawn together as a single
+//  mesh. While debug mode is off nothing is added at all, and the mesh is
+//  emptied, so it costs nothing. Obstacles should not be given a debug scene
+//  of their own.
+//
+//  This node draws in PHYSICS coordinates, so it should be added to a node that
+//  is scaled from physics space to screen space.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPDebugDraw_h
+#define MPDebugDraw_h
+
+#include <cugl/cugl.h>
+#include <box2d/b2_draw.h>
+#include <box2d/b2_world.h>
+
+using namespace cugl;
+
+/** Color of the contact points */
+#define DEBUG_CONTACT_COLOR Color4::YELLOW
+/** Half the width of the cross drawn at each contact point, in physics space */
+#define DEBUG_CONTACT_SIZE 0.1f
+/** How many segments a circle is drawn with */
+#define DEBUG_CIRCLE_SEGMENTS 16
+
+class DebugDraw : public scene2::SceneNode {
+private:
+    /** Passes what Box2D draws on to the debug draw as line segments */
+    class WorldDraw : public b2Draw {
+    public:
+        /** The debug draw that everything is added to */
+        DebugDraw *owner = nullptr;
+
+        void DrawPolygon(const b2Vec2 *vertices, int32 vertexCount, const b2Color &color) override;
+        void DrawSolidPolygon(const b2Vec2 *vertices, int32 vertexCount, const b2Color &color) override;
+        void DrawCircle(const b2Vec2 &center, float radius, const b2Color &color) override;
+        void DrawSolidCircle(const b2Vec2 &center, float radius, const b2Vec2 &axis, const b2Color &color) override;
+        void DrawSegment(const b2Vec2 &p1, const b2Vec2 &p2, const b2Color &color) override;
+        void DrawTransform(const b2Transform &/*xf*/) override {}
+        void DrawPoint(const b2Vec2 &p, float size, const b2Color &color) override;
+    };
+
+    /** Every line segment added this frame, as pairs of vertices */
+    Mesh<SpriteVertex2> _mesh;
+    /** Adapter used to draw the physics world */
+    WorldDraw _worldDraw;
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates an empty debug draw.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    DebugDraw() : SceneNode() {}
+
+    /**
+     * Initializes an empty debug draw.
+     *
+     * @return  true if initialization was successful, false otherwise
+     */
+    bool init() override;
+
+    /**
+     * Returns a newly allocated, empty debug draw.
+     *
+     * @return  A newly allocated DebugDraw
+     */
+    static shared_ptr<DebugDraw> alloc() {
+        shared_ptr<DebugDraw> result = make_shared<DebugDraw>();
+        return (result->init() ? result : nullptr);
+    }
+
+#pragma mark Drawing
+
+    /**
+     * Adds a line segment between the two given points.
+     *
+     * @param p1        The start of the segment in physics space
+     * @param p2        The end of the segment in physics space
+     * @param color     The color of the segment
+     */
+    void addSegment(const Vec2 &p1, const Vec2 &p2, const Color4 &color);
+
+    /**
+     * Adds a small cross centered on the given point.
+     *
+     * @param p         The point in physics space
+     * @param size      Half the width of the cross
+     * @param color     The color of the cross
+     */
+    void addPoint(const Vec2 &p, float size, const Color4 &color);
+
+    /**
+     * Adds the outline of every fixture in the given world, and a cross at
+     * every point where two fixtures are touching.
+     *
+     * @param world     The physics world to draw
+     */
+    void addWorld(b2World *world);
+
+    /**
+     * Removes everything that has been added.
+     *
+     * @param release   Whether to also free the memory that was used
+     */
+    void clear(bool release = false);
+
+    /**
+     * Returns how many line segments have been added since the last clear.
+     *
+     * @return  The number of line segments
+     */
+    size_t getSegmentCount() const {
+        return _mesh.vertices.size() / 2;
+    }
+
+    /**
+     * Draws every segment that has been added in a single batch.
+     *
+     * @param batch     The SpriteBatch to draw with
+     * @param transform The global transformation matrix
+     * @param tint      The tint to blend with the segment colors
+     */
+    void draw(const std::shared_ptr<SpriteBatch> &batch, const Affine2 &transform, Color4 tint) override;
+};
+
+#endif /* MPDebugDraw_h */
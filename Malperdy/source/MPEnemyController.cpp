@@ -16,13 +16,11 @@
 #define VELOCITY    10
 #define DUDE_JUMP   5.5f
 
-/** Radius within which an enemy will detect Reynard, squared */
-#define DETECTION_RADIUS_SQUARED 115000.0f
-
 #include "MPEnemyController.h"
 
 shared_ptr<physics2::ObstacleWorld> EnemyController::_obstacleWorld = nullptr;
 shared_ptr<ReynardController> EnemyController::_reynard = nullptr;
+shared_ptr<DebugDraw> EnemyController::_debugDraw = nullptr;
 
 /**
  * Initializes a new controller for the character at the given position.
@@ -67,8 +65,8 @@ void EnemyController::update(float delta) {
         return;
     }
 
-    // Raycast to Reynard
-    reyCast();
+    // Look for walls in front
+    checkWallInFront();
 
     // Handle what the enemy does depending on their current behavior state
     switch (_character->getBehaveState()) {
@@ -139,91 +137,19 @@ void EnemyController::update(float delta) {
 #pragma mark Behavior Methods
 
 /**
- * Helper debug function that updates a debug line drawn to help with raycasting.
- * 
- * It creates the line between the two given points and attaches it to the given
- * parent node with the given name. If there is an existing line with that name
- * already attached to the parent, it will be removed first.
- * 
- * Both points should be given in world space, and will be transformed accordingly when
- * the resulting line is attached to the given node.
- * 
- * @param p1		The first point to create the line with in world space
- * @param p2		The second point to create the line with in world space
- * @param parent	The node to attach the created line to
- * @param name		The name to give to the line, to track what to remove
- * @param color		The color of the resulting line (green by default)
- * @param width		The width of the resulting line (5 by default)
- * @return linePoly	The line between the two given points as a PolygonNode
- */
-void updateLine(Vec2 p1, Vec2 p2, shared_ptr<scene2::SceneNode> parent, string name, Color4 color = Color4(0, 0, 0, 0), float width = 5.0f) {
-    // Create line
-    Path2 line;
-    vector<Vec2> points;
-    points.push_back(parent->worldToNodeCoords(p1));
-    points.push_back(parent->worldToNodeCoords(p2));
-    line.set(points);
-    SimpleExtruder se = SimpleExtruder(line);
-    se.calculate(width);
-    shared_ptr<scene2::PolygonNode> linePoly = scene2::PolygonNode::alloc();
-    linePoly->setPolygon(se.getPolygon());
-    linePoly->setColor(color);
-    linePoly->setAbsolute(true);
-
-    // Remove old line if any
-    parent->removeChildByName(name);
-    // Now add updated line to parent
-    parent->addChildWithName(linePoly, name);
-}
-
-/**
- * Performs a raycast from this enemy to Reynard. If the raycast succeeds, then the enemy's
- * target and/or target location will be updated accordingly. The new values of these variables
- * will then drive changing between behavior states in the update() method of this class.
- * 
- * This method is called and performed at the start of each frame in the update() method
- * above, but the actual raycast is performed asynchronously. Therefore, there may be a
- * slight delay in a raycast succeeding and the enemy's behavior changing, although that's
- * probably fine because it simulates slow brain.
+ * Performs a short raycast in front of this enemy, and has it jump or turn around
+ * if there is a wall in the way.
+ *
+ * Whether the enemy can see Reynard is handled by EnemyPerception, not here.
  */
-void EnemyController::reyCast() {
-    // Draw line from enemy to Reynard
-    //updateLine(getPosition(), _reynard->getPosition(), _character->_node, "toReynard", Color4::RED);
-
-    // Raycast to Reynard's location
-    // Note that the raycast will detect all fixtures in its path, and it will not necessarily
-    // do so in any specific order. We will need to identify what the first fixture in the
-    // raycast's path is, as that's the one that actually matters.
-    _obstacleWorld->rayCast(
-            // This callback controls how the ray cast proceeds by returning a float.
-            // If -1, it ignores this fixture and continues. If 0, it terminates the
-            // ray cast. If 1, it does not clip the ray and continues. Finally, for
-            // any fraction, it clips the ray at that point.
-            [this](b2Fixture *fixture, const Vec2 point, const Vec2 normal, float fraction) -> float {
-                // Draw line from enemy to point of impact
-                if (_debug)
-                    updateLine(getScenePosition(), point * _character->_drawScale, _character->_node, "cast", Color4::RED, 5.0f);
-
-                // If Reynard is a fixture in the path, then set the point to start going to
-                // Otherwise, set the point as a "null" value
-                bool isMyBody = _reynard->isMyBody(fixture->GetBody());
-                _raycastCache = isMyBody ? point : Vec2(-1, -1);
-                if (!isMyBody) {
-                    return -1;
-                }
-                return fraction;
-            },
-            _character->getPosition(), _reynard->getCharacter()->getPosition());
-
-
+void EnemyController::checkWallInFront() {
     float cast_horizon = static_cast<float>(5 * (_character->isFacingRight() ? 1 : -1) * (_character->getBehaveState() == EnemyModel::BehaviorState::PATROLLING ? 0.2 : 1));
     // TODO: move this somewhere more appropriate
     // Wall jump if there's a wall in front
     //bool wallInFront = false;
     _obstacleWorld->rayCast(
             [this](b2Fixture *fixture, const Vec2 point, const Vec2 normal, float fraction) -> float {
-                if (_debug)
-                    updateLine(getScenePosition(), point * _character->_drawScale, _character->_node, "cast", Color4::RED, 5.0f);
+                if (_debugDraw != nullptr) _debugDraw->addSegment(_character->getPosition(), point, Color4::RED);
                 if ((!_character->isJumping())
                         && _character->isGrounded()
                         && (!_reynard->isMyBody(fixture->GetBody()))
@@ -244,27 +170,4 @@ void EnemyController::reyCast() {
                 return fraction;
             },
             _character->getPosition(), _character->getPosition() + Vec2(cast_horizon, -0.3));
-
-    // If the closest hit fixture really was Reynard, then set this enemy's target accordingly and set new target location
-    if (_raycastCache != Vec2(-1, -1)) {
-        _target = _reynard->getCharacter();
-        _targetLoc = _raycastCache;
-    }
-        // Otherwise, clear the target, as the enemy has thus lost track of Reynard
-    else {
-        _target = nullptr;
-    }
-
-    // Reset raycast cache for next raycast
-    _raycastCache = Vec2(-1, -1);
 }
-
-bool EnemyController::isDebug() const {
-    return _debug;
-}
-
-void EnemyController::setDebug(bool debug) {
-    _debug = debug;
-}
-
-
@@ -20,10 +20,14 @@
 #include "MPCharacterController.h"
 #include "MPEnemyModel.h"
 #include "MPReynardController.h"
+#include "MPDebugDraw.h"
 
 /** How many seconds Reynard must be within an enemy's detection radius before the enemy realizes that he is there */
 #define DETECTION_TIME 0.8f
 
+/** Radius within which an enemy will detect Reynard, squared */
+#define DETECTION_RADIUS_SQUARED 115000.0f
+
 class EnemyController : public CharacterController<EnemyModel, EnemyController> {
 
 protected:
@@ -32,29 +36,23 @@ protected:
     static shared_ptr<physics2::ObstacleWorld> _obstacleWorld;
     /** Static reference to Reynard */
     static shared_ptr<ReynardController> _reynard;
+    /** Static reference to where raycasts are drawn, or null if debug mode is off */
+    static shared_ptr<DebugDraw> _debugDraw;
 
     /** The target that this enemy is currently pursuing, or null if there is none */
     shared_ptr<CharacterModel> _target = nullptr;
     /** The location in physics space that this enemy will be trying to move to, or (-1, -1) if there is no such location */
     Vec2 _targetLoc = Vec2(-1, -1);
-    /** Vector cache to temporarily store values in when handling raycasting, because there may be multiple fixtures */
-    Vec2 _raycastCache = Vec2(-1, -1);
 
     // COOLDOWNS
     /** How long Reynard has been in the enemy's detection radius so far */
     float _detectTime = 0.0f;
 
-
-    bool _debug = false;
 public:
 
     /** Whether this enemy drops a key on death */
     bool _isKeyed = false;
 
-    bool isDebug() const;
-
-    void setDebug(bool debug);
-
 
 public:
 
@@ -103,6 +101,46 @@ public:
         _reynard = reynard;
     }
 
+    /**
+     * Sets where all enemies draw their raycasts. This should be set when debug
+     * mode is turned on, and set back to null when it is turned off.
+     *
+     * @param draw  The debug draw to add raycasts to, or null to not draw them
+     */
+    static void setDebugDraw(shared_ptr<DebugDraw> draw) {
+        _debugDraw = draw;
+    }
+
+    /**
+     * Tells this enemy whether it can see Reynard. If it can, he becomes its target
+     * and the given point becomes its target location. Otherwise the enemy loses
+     * track of him. The new target drives changing between behavior states in
+     * the update() method of this class.
+     *
+     * This is called by EnemyPerception once per frame, before the enemy is updated.
+     *
+     * @param visible   Whether this enemy can see Reynard
+     * @param point     Where this enemy sees Reynard in physics space
+     */
+    void setSighting(bool visible, Vec2 point) {
+        if (visible && _reynard != nullptr) {
+            _target = _reynard->getCharacter();
+            _targetLoc = point;
+        } else {
+            _target = nullptr;
+        }
+    }
+
+    /**
+     * Forgets Reynard and how long he has been noticed for. This is used when
+     * the controller is reused for a different enemy.
+     */
+    void resetTracking() {
+        _target = nullptr;
+        _targetLoc = Vec2(-1, -1);
+        _detectTime = 0.0f;
+    }
+
 #pragma mark -
 #pragma mark Behavior Methods
 private:
@@ -118,16 +156,12 @@ private:
     }
 
     /**
-     * Performs a raycast from this enemy to Reynard. If the raycast succeeds, then the enemy's
-     * target location [_targetLoc] will be updated accordingly. The new value of [_targetLoc]
-     * will then drive changing between behavior states in the update() method of this class.
+     * Performs a short raycast in front of this enemy, and has it jump or turn around
+     * if there is a wall in the way.
      *
-     * This method is called and performed at the start of each frame in the update() method
-     * above, but the actual raycast is performed asynchronously. Therefore, there may be a
-     * slight delay in a raycast succeeding and the enemy's behavior changing, although that's
-     * probably fine because it simulates slow brain.
+     * Whether the enemy can see Reynard is handled by EnemyPerception, not here.
      */
-    void reyCast();
+    void checkWallInFront();
 
 };
 
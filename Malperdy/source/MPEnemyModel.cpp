@@ -71,7 +71,6 @@ bool EnemyModel::init(const cugl::Vec2 &pos, float drawScale, shared_ptr<Animati
 
     // Have enemies be stopped by default
     _moveState = MovementState::STOPPED;
-    _currAnimation = "run";
     // Also have enemies be patrolling by default
     _behaveState = BehaviorState::PATROLLING;
 
@@ -0,0 +1,129 @@
+//
+//  MPEnemyPerception.cpp
+//  Malperdy
+//
+//  This class handles whether each enemy can see Reynard, doing a limited
+//  number of line of sight raycasts per frame.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPEnemyPerception.h"
+
+/**
+ * Keeps the given fixture as the closest one so far if it blocks sight, and
+ * clips the ray there. Anything that can be seen through is skipped.
+ */
+float EnemyPerception::SightCallback::ReportFixture(b2Fixture *fixture, const b2Vec2 &point, const b2Vec2 &/*normal*/, float fraction) {
+    if (fixture->IsSensor() || fixture->GetBody() == self) return -1;
+    if (registry != nullptr) {
+        EntityRegistry::EntityType type = registry->getType(fixture->GetBody());
+        if (type == EntityRegistry::EntityType::ENEMY || type == EntityRegistry::EntityType::TRAP
+            || type == EntityRegistry::EntityType::KEY || type == EntityRegistry::EntityType::POSSESSED_KEY) return -1;
+    }
+    closest = fixture;
+    this->point = point;
+    return fraction;
+}
+
+#pragma mark Updating
+
+/**
+ * Works out which enemies can see Reynard, and passes the result on to
+ * each enemy. This should be called once per frame, before the enemies
+ * are updated.
+ *
+ * @param world     The physics world to raycast in
+ * @param grid      The grid, used to find what room everyone is in
+ * @param reynard   Reynard's controller
+ * @param enemies   Every enemy in the level
+ */
+void EnemyPerception::update(b2World *world, const shared_ptr<GridModel> &grid, const shared_ptr<ReynardController> &reynard,
+                             const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies) {
+    _rayCount = 0;
+    if (world == nullptr || grid == nullptr || reynard == nullptr || enemies == nullptr || enemies->empty()) return;
+    if (_sights.size() != enemies->size()) _sights.resize(enemies->size());
+    if (_cursor >= _sights.size()) _cursor = 0;
+
+    Vec2 reynardPos = reynard->getScenePosition();
+    Vec2 reynardRoom = grid->worldSpaceToRoom(reynardPos);
+
+    // Work out who needs to look, starting after whoever looked last
+    _batch.clear();
+    size_t count = _sights.size();
+    for (size_t n = 0; n < count; n++) {
+        size_t i = (_cursor + n) % count;
+        shared_ptr<EnemyController> enemy = enemies->at(i);
+        Sight &sight = _sights[i];
+
+        // Frozen and dead enemies don't look at anything, and patrolling ones
+        // only notice Reynard inside their detection radius
+        if (!enemy->getCharacter()->isEnabled() || enemy->isDead()
+            || (enemy->getCharacter()->getBehaveState() == EnemyModel::BehaviorState::PATROLLING
+                && enemy->getScenePosition().distanceSquared(reynardPos) >= DETECTION_RADIUS_SQUARED)) {
+            sight = Sight();
+            continue;
+        }
+
+        // What was seen is out of date once either of them is in a different room
+        Vec2 enemyRoom = grid->worldSpaceToRoom(enemy->getScenePosition());
+        if (enemyRoom != sight.enemyRoom || reynardRoom != sight.reynardRoom) sight.valid = false;
+        if (!sight.valid && _batch.size() < SIGHT_RAY_BUDGET) {
+            sight.enemyRoom = enemyRoom;
+            sight.reynardRoom = reynardRoom;
+            _batch.push_back((int)i);
+        }
+    }
+
+    // Spend whatever is left refreshing results that are still valid
+    for (size_t n = 0; n < count && _batch.size() < SIGHT_RAY_BUDGET; n++) {
+        size_t i = (_cursor + n) % count;
+        if (_sights[i].valid) _batch.push_back((int)i);
+    }
+    if (!_batch.empty()) _cursor = (_batch.back() + 1) % count;
+
+    // Now do all the raycasts together. Box2D only reads the world while casting, and
+    // every raycast writes a different result, so they can be spread across threads
+    b2Body *reynardBody = reynard->getCharacter()->getBody();
+    Vec2 to = reynard->getCharacter()->getPosition();
+    auto cast = [&](size_t first, size_t last) {
+        SightCallback callback;
+        callback.registry = _registry.get();
+        for (size_t n = first; n < last; n++) {
+            shared_ptr<EnemyController> enemy = enemies->at(_batch[n]);
+            Sight &sight = _sights[_batch[n]];
+            Vec2 from = enemy->getCharacter()->getPosition();
+            sight.valid = true;
+
+            // Box2D can't cast a ray with no length, but there's nothing in the way either
+            if (from == to) {
+                sight.visible = true;
+                sight.point = to;
+                continue;
+            }
+
+            callback.self = enemy->getCharacter()->getBody();
+            callback.closest = nullptr;
+            world->RayCast(&callback, b2Vec2(from.x, from.y), b2Vec2(to.x, to.y));
+
+            // Reynard is only visible if he's the first solid thing the ray hits
+            sight.visible = (callback.closest != nullptr && callback.closest->GetBody() == reynardBody);
+            sight.point = (sight.visible ? Vec2(callback.point.x, callback.point.y) : Vec2(-1, -1));
+        }
+    };
+    if (_tasks != nullptr) {
+        _tasks->parallelFor(0, _batch.size(), SIGHT_RAY_GRAIN, cast);
+    } else {
+        cast(0, _batch.size());
+    }
+    _rayCount = (int)_batch.size();
+
+    // Let every enemy know what it can see
+    for (size_t i = 0; i < count; i++) {
+        enemies->at(i)->setSighting(_sights[i].visible, _sights[i].point);
+    }
+}
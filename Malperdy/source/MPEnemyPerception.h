@@ -0,0 +1,164 @@
+//
+//  MPEnemyPerception.h
+//  Malperdy
+//
+//  This class handles whether each enemy can see Reynard. It does all of the
+//  raycasts for line of sight once per frame, before the enemies are updated,
+//  and hands each enemy the result.
+//
+//  Enemies that are dead, frozen or too far from Reynard don't get a raycast
+//  at all. The rest are limited to a fixed number of raycasts per frame. An
+//  enemy whose result is out of date, because it or Reynard moved to a different
+//  room or the level geometry changed, goes first. Any raycasts left over are
+//  spent refreshing the other enemies in turn. Until an enemy gets its raycast,
+//  it keeps the last thing it saw.
+//
+//  Only solid geometry blocks sight. Sensors, other characters, keys and traps
+//  are seen through.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPEnemyPerception_h
+#define MPEnemyPerception_h
+
+#include <cugl/cugl.h>
+#include <box2d/b2_world.h>
+#include <box2d/b2_world_callbacks.h>
+#include <vector>
+#include "MPEnemyController.h"
+#include "MPReynardController.h"
+#include "MPGridModel.h"
+#include "MPEntityRegistry.h"
+
+using namespace cugl;
+
+/** The most line of sight raycasts that will be done in a single frame */
+#define SIGHT_RAY_BUDGET 8
+/** The fewest raycasts handed to a single thread, since a raycast is too quick to be worth one each */
+#define SIGHT_RAY_GRAIN 2
+
+class EnemyPerception {
+private:
+    /** What a single enemy last saw */
+    struct Sight {
+        /** Whether this is worth keeping, or the enemy needs a new raycast */
+        bool valid = false;
+        /** Whether Reynard was visible */
+        bool visible = false;
+        /** Where the raycast hit Reynard in physics space, if he was visible */
+        Vec2 point = Vec2(-1, -1);
+        /** The enemy's room when the raycast was done */
+        Vec2 enemyRoom = Vec2(-1, -1);
+        /** Reynard's room when the raycast was done */
+        Vec2 reynardRoom = Vec2(-1, -1);
+    };
+
+    /** Raycast callback that keeps the closest fixture that blocks sight */
+    class SightCallback : public b2RayCastCallback {
+    public:
+        /** Registry used to tell which fixtures can be seen through */
+        EntityRegistry *registry = nullptr;
+        /** The body of the enemy doing the looking */
+        b2Body *self = nullptr;
+        /** The closest fixture that blocks sight so far */
+        b2Fixture *closest = nullptr;
+        /** Where the closest fixture was hit */
+        b2Vec2 point;
+
+        float ReportFixture(b2Fixture *fixture, const b2Vec2 &point, const b2Vec2 &normal, float fraction) override;
+    };
+
+    /** What each enemy last saw, by index in GameScene's list of enemies */
+    vector<Sight> _sights;
+    /** Indices of the enemies getting a raycast this frame */
+    vector<int> _batch;
+    /** The enemy to start from when refreshing results that are still valid */
+    size_t _cursor = 0;
+    /** How many raycasts were done last frame */
+    int _rayCount = 0;
+    /** Registry used to tell which fixtures can be seen through */
+    shared_ptr<EntityRegistry> _registry;
+    /** Scheduler to spread the raycasts across, or nullptr to do them all on the calling thread */
+    shared_ptr<TaskScheduler> _tasks;
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates a perception system that hasn't seen anything yet.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    EnemyPerception() {}
+
+    /**
+     * Returns a newly allocated perception system.
+     *
+     * @param registry  The registry for the bodies in the world
+     * @return          A newly allocated EnemyPerception
+     */
+    static shared_ptr<EnemyPerception> alloc(const shared_ptr<EntityRegistry> &registry) {
+        shared_ptr<EnemyPerception> result = make_shared<EnemyPerception>();
+        result->_registry = registry;
+        return result;
+    }
+
+    /**
+     * Sets the scheduler to spread the raycasts across. Without one, every
+     * raycast is done on the thread that calls update().
+     *
+     * @param tasks     The scheduler to use, or nullptr for none
+     */
+    void setScheduler(const shared_ptr<TaskScheduler> &tasks) {
+        _tasks = tasks;
+    }
+
+#pragma mark Updating
+
+    /**
+     * Works out which enemies can see Reynard, and passes the result on to
+     * each enemy. This should be called once per frame, before the enemies
+     * are updated.
+     *
+     * @param world     The physics world to raycast in
+     * @param grid      The grid, used to find what room everyone is in
+     * @param reynard   Reynard's controller
+     * @param enemies   Every enemy in the level
+     */
+    void update(b2World *world, const shared_ptr<GridModel> &grid, const shared_ptr<ReynardController> &reynard,
+                const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies);
+
+    /**
+     * Marks every result as out of date. This should be called whenever the
+     * level geometry changes.
+     */
+    void invalidate() {
+        for (auto itr = _sights.begin(); itr != _sights.end(); ++itr) itr->valid = false;
+    }
+
+    /**
+     * Forgets everything. This should be called whenever the enemies are replaced.
+     */
+    void clear() {
+        _sights.clear();
+        _cursor = 0;
+        _rayCount = 0;
+    }
+
+    /**
+     * Returns how many raycasts were done in the last update.
+     *
+     * @return  The number of raycasts done in the last update
+     */
+    int getRayCount() const {
+        return _rayCount;
+    }
+};
+
+#endif /* MPEnemyPerception_h */
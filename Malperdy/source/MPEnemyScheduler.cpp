@@ -0,0 +1,72 @@
+//
+//  MPEnemyScheduler.cpp
+//  Malperdy
+//
+//  This class decides how often each enemy's behavior gets updated, based on
+//  how close it is to Reynard.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPEnemyScheduler.h"
+
+#pragma mark Updating
+
+/**
+ * Puts every enemy in its tier and updates the ones that are due.
+ *
+ * @param dt        The amount of time that has passed since the last frame
+ * @param grid      The grid, used to find what room everyone is in
+ * @param reynard   Reynard's controller
+ * @param enemies   Every enemy in the level
+ */
+void EnemyScheduler::update(float dt, const shared_ptr<GridModel> &grid, const shared_ptr<ReynardController> &reynard,
+                            const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies) {
+    _counts[0] = _counts[1] = _counts[2] = 0;
+    if (grid == nullptr || reynard == nullptr || enemies == nullptr) return;
+    if (_slots.size() != enemies->size()) _slots.resize(enemies->size());
+    _frame++;
+
+    shared_ptr<RoomTable> table = grid->getRoomTable();
+    Vec2 reynardRoom = grid->worldSpaceToRoom(reynard->getScenePosition());
+    int region = table->getRegion(reynardRoom.x, reynardRoom.y);
+    int sublevel = table->getSublevel(reynardRoom.x, reynardRoom.y);
+
+    for (size_t i = 0; i < enemies->size(); i++) {
+        shared_ptr<EnemyController> enemy = enemies->at(i);
+        Slot &slot = _slots[i];
+
+        // Work out which tier the enemy is in now
+        Vec2 room = grid->worldSpaceToRoom(enemy->getScenePosition());
+        Tier tier;
+        if (!enemy->getCharacter()->isEnabled()) {
+            tier = Tier::FROZEN;
+        } else if (abs(room.x - reynardRoom.x) <= 1 && abs(room.y - reynardRoom.y) <= 1) {
+            tier = Tier::FULL;
+        } else if (table->getRegion(room.x, room.y) == region && table->getSublevel(room.x, room.y) == sublevel) {
+            tier = Tier::REDUCED;
+        } else {
+            tier = Tier::FROZEN;
+        }
+        _counts[static_cast<int>(tier)]++;
+
+        if (tier == Tier::FROZEN) {
+            // Put the body to sleep once, when the enemy first freezes
+            if (slot.tier != Tier::FROZEN) enemy->getCharacter()->setAwake(false);
+            slot.elapsed = 0;
+            slot.tier = tier;
+            continue;
+        }
+        slot.tier = tier;
+        slot.elapsed += dt;
+
+        // Enemies in the REDUCED tier take turns, so they don't all update on the same frame
+        if (tier == Tier::REDUCED && (_frame + i) % AI_REDUCED_INTERVAL != 0) continue;
+        enemy->update(slot.elapsed);
+        slot.elapsed = 0;
+    }
+}
@@ -0,0 +1,120 @@
+//
+//  MPEnemyScheduler.h
+//  Malperdy
+//
+//  This class decides how often each enemy's behavior gets updated, based on
+//  how close it is to Reynard. Enemies are put into one of three tiers every
+//  frame:
+//
+//  - FULL: in Reynard's room or a room next to it. Updated every frame.
+//  - REDUCED: somewhere else in Reynard's sublevel. Updated every few frames,
+//    with all the time since their last update passed in at once.
+//  - FROZEN: in another sublevel, or in a room that isn't active. Not updated
+//    at all, and their bodies are put to sleep.
+//
+//  Time spent in REDUCED is never lost, so timed behavior like noticing Reynard
+//  takes just as long as it would at full rate. An enemy that moves up to FULL
+//  gets whatever time it had built up on its next update. Time spent FROZEN is
+//  dropped, since nothing should happen to a frozen enemy.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPEnemyScheduler_h
+#define MPEnemyScheduler_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "MPEnemyController.h"
+#include "MPReynardController.h"
+#include "MPGridModel.h"
+
+using namespace cugl;
+
+/** How many frames apart enemies in the REDUCED tier are updated */
+#define AI_REDUCED_INTERVAL 4
+
+class EnemyScheduler {
+public:
+    /** How often an enemy gets updated */
+    enum class Tier {
+        FULL,
+        REDUCED,
+        FROZEN
+    };
+
+private:
+    /** Scheduling state of a single enemy */
+    struct Slot {
+        /** The tier the enemy was in last frame */
+        Tier tier = Tier::FULL;
+        /** Time that has passed since the enemy was last updated */
+        float elapsed = 0;
+    };
+
+    /** Scheduling state of each enemy, by index in GameScene's list of enemies */
+    vector<Slot> _slots;
+    /** How many frames have been scheduled, used to spread out REDUCED updates */
+    unsigned int _frame = 0;
+    /** How many enemies were in each tier last frame */
+    int _counts[3] = {0, 0, 0};
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates a scheduler that hasn't scheduled anything yet.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    EnemyScheduler() {}
+
+    /**
+     * Returns a newly allocated scheduler.
+     *
+     * @return  A newly allocated EnemyScheduler
+     */
+    static shared_ptr<EnemyScheduler> alloc() {
+        return make_shared<EnemyScheduler>();
+    }
+
+#pragma mark Updating
+
+    /**
+     * Puts every enemy in its tier and updates the ones that are due.
+     *
+     * @param dt        The amount of time that has passed since the last frame
+     * @param grid      The grid, used to find what room everyone is in
+     * @param reynard   Reynard's controller
+     * @param enemies   Every enemy in the level
+     */
+    void update(float dt, const shared_ptr<GridModel> &grid, const shared_ptr<ReynardController> &reynard,
+                const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies);
+
+    /**
+     * Forgets every enemy. This should be called whenever the enemies are replaced.
+     */
+    void clear() {
+        _slots.clear();
+        _counts[0] = _counts[1] = _counts[2] = 0;
+    }
+
+#pragma mark Profiling
+
+    /**
+     * Returns how many enemies were in the given tier last frame.
+     *
+     * @param tier  The tier to count
+     * @return      The number of enemies in that tier
+     */
+    int getCount(Tier tier) const {
+        return _counts[static_cast<int>(tier)];
+    }
+};
+
+#endif /* MPEnemyScheduler_h */
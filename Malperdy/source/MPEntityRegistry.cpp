@@ -0,0 +1,89 @@
+//
+//  MPEntityRegistry.cpp
+//  Malperdy
+//
+//  This class keeps track of what every body in the physics world belongs to,
+//  so that a contact can be sorted out in constant time.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPEntityRegistry.h"
+
+#pragma mark Registering
+
+/**
+ * Registers the given obstacle as the given entity. The obstacle must
+ * already be in the world, so that it has a body to attach the handle to.
+ *
+ * @param obstacle  The obstacle to register
+ * @param entity    What the obstacle belongs to
+ * @return          The handle of the entity, or NO_ENTITY if the obstacle has no body
+ */
+int EntityRegistry::add(const shared_ptr<physics2::Obstacle> &obstacle, const Entity &entity) {
+    b2Body *body = (obstacle == nullptr ? nullptr : obstacle->getBody());
+    if (body == nullptr) return NO_ENTITY;
+
+    // Don't leak whatever was attached before
+    release(body);
+
+    int handle;
+    if (_free.empty()) {
+        handle = (int)_entities.size();
+        _entities.push_back(entity);
+    } else {
+        handle = _free.back();
+        _free.pop_back();
+        _entities[handle] = entity;
+    }
+    body->GetUserData().pointer = ((uintptr_t)handle << 1) | 1;
+    return handle;
+}
+
+/**
+ * Releases the entity attached to the given body, if any. The body is
+ * treated as unknown from now on.
+ *
+ * @param body  The body to release
+ */
+void EntityRegistry::release(b2Body *body) {
+    releaseHandle(getHandle(body));
+}
+
+/**
+ * Releases the entity with the given handle, if any. This is for when the
+ * body has to be destroyed first, so that the contacts it ends on the way out
+ * can still be classified.
+ *
+ * @param handle    The handle to release
+ */
+void EntityRegistry::releaseHandle(int handle) {
+    if (handle < 0 || handle >= (int)_entities.size() || _entities[handle].type == EntityType::NONE) return;
+
+    // Let go of the entity now, but keep the handle until the body is gone
+    _entities[handle] = Entity();
+    _released.push_back(handle);
+}
+
+/**
+ * Frees every handle released so far so it can be used again. This must
+ * only be called right after the world's garbage collection, once every
+ * released body has been removed.
+ */
+void EntityRegistry::collect() {
+    _free.insert(_free.end(), _released.begin(), _released.end());
+    _released.clear();
+}
+
+/**
+ * Forgets every entity. This should be called whenever the world is cleared.
+ */
+void EntityRegistry::clear() {
+    _entities.clear();
+    _free.clear();
+    _released.clear();
+}
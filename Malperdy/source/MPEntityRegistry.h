@@ -0,0 +1,198 @@
+//
+//  MPEntityRegistry.h
+//  Malperdy
+//
+//  This class keeps track of what every body in the physics world belongs to,
+//  so that a contact can be sorted out in constant time instead of by checking
+//  its bodies against every enemy, key and room in the level.
+//
+//  Each registered body gets a handle to an Entity, which says what kind of
+//  thing the body is and which one. The handle is stored in the body's Box2D
+//  user data. CUGL already puts a pointer to the Obstacle there, so handles
+//  are stored shifted up with the lowest bit set. Pointers never have that bit
+//  set, so a body that was never registered is simply treated as unknown.
+//
+//  Handles are only reused once the body they were attached to is gone from the
+//  world. Releasing a handle forgets the entity right away, but the slot isn't
+//  free again until collect() is called after the world's garbage collection.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPEntityRegistry_h
+#define MPEntityRegistry_h
+
+#include <cugl/cugl.h>
+#include <box2d/b2_body.h>
+#include <vector>
+#include "MPTrapModel.hpp"
+#include "MPCheckpointKey.h"
+#include "MPCheckpointKeyCrazy.hpp"
+
+using namespace cugl;
+
+/** Handle of a body that isn't registered */
+#define NO_ENTITY -1
+
+class EntityRegistry {
+public:
+    /** The kinds of thing a body can belong to */
+    enum class EntityType {
+        /** Not registered, or already released */
+        NONE,
+        REYNARD,
+        ENEMY,
+        TRAP,
+        KEY,
+        POSSESSED_KEY,
+        /** The solid geometry of a room, including any exit blockade, or the bounds of the world */
+        TERRAIN
+    };
+
+    /** What a single body belongs to */
+    struct Entity {
+        /** What kind of thing the body belongs to */
+        EntityType type = EntityType::NONE;
+        /** Index of the enemy in GameScene's list of enemies, if it's an enemy */
+        int index = -1;
+        /** The trap, if it's a trap */
+        shared_ptr<TrapModel> trap;
+        /** The key, if it's a regular key */
+        shared_ptr<CheckpointKey> key;
+        /** The key, if it's a possessed key */
+        shared_ptr<CheckpointKeyCrazy> possessedKey;
+    };
+
+private:
+    /** Every entity, indexed by handle */
+    vector<Entity> _entities;
+    /** Handles that can be given out again */
+    vector<int> _free;
+    /** Handles that have been released, but whose bodies might still be in the world */
+    vector<int> _released;
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates an empty registry.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    EntityRegistry() {}
+
+    /**
+     * Returns a newly allocated empty registry.
+     *
+     * @return  A newly allocated EntityRegistry
+     */
+    static shared_ptr<EntityRegistry> alloc() {
+        return make_shared<EntityRegistry>();
+    }
+
+#pragma mark Registering
+
+    /**
+     * Registers the given obstacle as the given entity. The obstacle must
+     * already be in the world, so that it has a body to attach the handle to.
+     *
+     * @param obstacle  The obstacle to register
+     * @param entity    What the obstacle belongs to
+     * @return          The handle of the entity, or NO_ENTITY if the obstacle has no body
+     */
+    int add(const shared_ptr<physics2::Obstacle> &obstacle, const Entity &entity);
+
+    /**
+     * Releases the entity attached to the given body, if any. The body is
+     * treated as unknown from now on.
+     *
+     * @param body  The body to release
+     */
+    void release(b2Body *body);
+
+    /**
+     * Releases the entity with the given handle, if any. This is for when the
+     * body has to be destroyed first, so that the contacts it ends on the way out
+     * can still be classified.
+     *
+     * @param handle    The handle to release
+     */
+    void releaseHandle(int handle);
+
+    /**
+     * Releases the entity attached to the given obstacle's body, if any.
+     *
+     * @param obstacle  The obstacle to release
+     */
+    void release(const shared_ptr<physics2::Obstacle> &obstacle) {
+        if (obstacle != nullptr) release(obstacle->getBody());
+    }
+
+    /**
+     * Frees every handle released so far so it can be used again. This must
+     * only be called right after the world's garbage collection, once every
+     * released body has been removed.
+     */
+    void collect();
+
+    /**
+     * Forgets every entity. This should be called whenever the world is cleared.
+     */
+    void clear();
+
+#pragma mark Lookup
+
+    /**
+     * Returns the handle attached to the given body.
+     *
+     * @param body  The body to look up
+     * @return      The handle of the body's entity, or NO_ENTITY if it isn't registered
+     */
+    static int getHandle(b2Body *body) {
+        if (body == nullptr) return NO_ENTITY;
+        uintptr_t data = body->GetUserData().pointer;
+        return (data & 1) ? (int)(data >> 1) : NO_ENTITY;
+    }
+
+    /**
+     * Returns the entity the given body belongs to.
+     *
+     * @param body  The body to look up
+     * @return      The body's entity, or nullptr if it isn't registered
+     */
+    const Entity *get(b2Body *body) const {
+        int handle = getHandle(body);
+        if (handle < 0 || handle >= (int)_entities.size()) return nullptr;
+        const Entity *entity = &_entities[handle];
+        return (entity->type == EntityType::NONE ? nullptr : entity);
+    }
+
+    /**
+     * Returns what kind of thing the given body belongs to.
+     *
+     * @param body  The body to look up
+     * @return      The type of the body's entity, or NONE if it isn't registered
+     */
+    EntityType getType(b2Body *body) const {
+        const Entity *entity = get(body);
+        return (entity == nullptr ? EntityType::NONE : entity->type);
+    }
+
+    /**
+     * Returns whether the given body belongs to a character, Reynard or an enemy.
+     *
+     * @param body  The body to look up
+     * @return      Whether the body belongs to a character
+     */
+    bool isCharacter(b2Body *body) const {
+        EntityType type = getType(body);
+        return type == EntityType::REYNARD || type == EntityType::ENEMY;
+    }
+};
+
+#endif /* MPEntityRegistry_h */
@@ -26,40 +26,32 @@ EnvController::EnvController() {
 
 /* Updates the environment */
 void EnvController::update(Vec2 dragCoords, bool zoomedOut, const shared_ptr<ReynardController> &reynard, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies) {
-    Vec2 newReyRoom = _grid->worldSpaceToRoom(reynard->getScenePosition());
+    // Find everyone's room with the same transform, and let the occupancy grid lock and unlock rooms as they move
+    shared_ptr<OccupancyGrid> occupancy = _grid->getOccupancy();
+    Affine2 worldToGrid = _grid->getWorldToGridTransform();
+    Vec2 newReyRoom = _grid->gridSpaceToRoom(worldToGrid.transform(reynard->getScenePosition()));
+    occupancy->beginFrame();
+    occupancy->track(reynard->getCharacter().get(), newReyRoom);
 
-    if (!isSwappable(_toSwap, reynard, enemies)) {
-        deselectRoom();
-    }
+    // Only keep the rooms around Reynard and on screen active
+    _grid->updateActivation(newReyRoom, _viewRooms);
 
     // Apply fog to external objects
-    vector<Vec2> newEnemyPrevs = vector<Vec2>();
-    int enemyInd = 0;
     for (auto i = enemies->begin(); i != enemies->end(); i++) {
-        Vec2 enemyRoom = _grid->worldSpaceToRoom((*i)->getScenePosition());
-        bool isFogged = _grid->isRoomFogged(enemyRoom);
-        if (isFogged) (*i)->getSceneNode()->setColor(Color4(Vec4(0.2, 0.2, 0.2, 1)));
-        else (*i)->getSceneNode()->setColor(Color4::WHITE);
-
-        // If this enemy is in a new room, handle lock changes accordingly
-        if (_enemyPrevs.size() != 0 && enemyRoom != _enemyPrevs[enemyInd]) {
-            // Unlock old room
-            _grid->getRoom(_enemyPrevs[enemyInd])->unlockRoom();
-            // Lock new room
-            _grid->getRoom(enemyRoom)->lockRoom();
-        }
-
-        newEnemyPrevs.push_back(enemyRoom);
-        enemyInd++;
+        Vec2 enemyRoom = _grid->gridSpaceToRoom(worldToGrid.transform((*i)->getScenePosition()));
+        occupancy->track((*i)->getCharacter().get(), enemyRoom);
+
+        // Freeze enemies outside the activation window, since the ground under them is disabled
+        (*i)->getCharacter()->setEnabled(_grid->isRoomActive(enemyRoom));
+        // Only retint when the enemy's room or its fog changed
+        Color4 tint = _grid->isRoomFogged(enemyRoom) ? Color4(Vec4(0.2, 0.2, 0.2, 1)) : Color4::WHITE;
+        if ((*i)->getSceneNode()->getColor() != tint) (*i)->getSceneNode()->setColor(tint);
     }
-    if (swapIndex < _swapHistory.size()) {
-        for (int i = swapIndex; i < _swapHistory.size(); ++i) {
-            bool a = _grid->getRoom(_swapHistory[i][0])->updateSwap();
-            bool b = _grid->getRoom(_swapHistory[i][1])->updateSwap();
-            if (a && b) {
-                swapIndex = i + 1;
-            }
-        }
+    // Anyone who didn't report in was taken out of the world
+    occupancy->endFrame();
+
+    if (!isSwappable(_toSwap)) {
+        deselectRoom();
     }
     // Update lock icons
     //if (zoomedOut && !_prevZoomOut) setLockVisibility(true, reynard, enemies);
@@ -87,34 +79,28 @@ void EnvController::update(Vec2 dragCoords, bool zoomedOut, const shared_ptr<Rey
 
     // Update previous variables & defog rooms
     if (!_reyPrev.equals(newReyRoom)) {
-        // Change lock status of rooms Reynard was/is in, as necessary
-        if (_grid->getRoom(_reyPrev) != nullptr && _grid->getRoom(newReyRoom) != nullptr) {
-            _grid->getRoom(_reyPrev)->unlockRoom();
-            _grid->getRoom(newReyRoom)->lockRoom();
-        }
-
         // Defog
         _reyPrev = newReyRoom;
         defogSurrounding(_reyPrev);
     }
+    // Retint only the rooms whose fog changed
+    _grid->applyFogChanges();
     _prevZoomOut = zoomedOut;
-    _enemyPrevs = newEnemyPrevs;
 }
 
 /*
 * Selects the room at the given location
 * Selection is for the purpose of being swapped with another room in swapWithSelected
-* Does not currently check if the room is swappable
+* Will not use a room that isn't swappable
 *
 * @param coords     the coordinates of the selection in screen space
-* @param reynard    the controller for reynard
 *
 * @return true if room was successfully selected, and false otherwise
 */
-bool EnvController::selectRoom(Vec2 coords, const shared_ptr<ReynardController> &reynard, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies) {
+bool EnvController::selectRoom(Vec2 coords) {
     Vec2 room = _grid->screenSpaceToRoom(coords);
 
-    if (isSwappable(room, reynard, enemies)) {
+    if (isSwappable(room)) {
         lookSelected(room);
         _toSwap = room;
         return true;
@@ -127,23 +113,22 @@ bool EnvController::selectRoom(Vec2 coords, const shared_ptr<ReynardController>
 /*
 * Swaps the room at the given location with the selected room
 * If room at given location is the selected room, deselects the room
-* Does not currently check if the room is swappable
+* Will not use a room that isn't swappable
 *
 * @param coords     the coordinates of the selection in screen space
-* @param reynard    the controller for reynard
 *
 * @return	true if rooms were successfully swapped
 *			false if room was the same as selected room & is now deselected
 *			false if no swap occurred
 */
-bool EnvController::swapWithSelected(Vec2 coords, const shared_ptr<ReynardController> &reynard, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies) {
+bool EnvController::swapWithSelected(Vec2 coords) {
     if (!hasSelected()) {
         return false;
     }
 
     Vec2 room2 = _grid->screenSpaceToRoom(coords);
-    bool invalid = !isSwappable(room2, reynard, enemies);
-    invalid = invalid || !isSwappable(_toSwap, reynard, enemies);
+    bool invalid = !isSwappable(room2);
+    invalid = invalid || !isSwappable(_toSwap);
     invalid = invalid || (room2.x == _toSwap.x && room2.y == _toSwap.y); // can't be the sam room
 
     if (invalid) {
@@ -182,16 +167,13 @@ void EnvController::deselectRoom() {
  * Checks if the room satisfies the conditions to be swappable
  *
  * @param room       the row and column of the room to check
- * @param reynard    the controller for reynard
- * @param enemies    the controllers for the enemies
  *
  * @ return true if room doesn't contain Reynard, enemies or a checkpoint
 */
-bool EnvController::isSwappable(Vec2 room, const shared_ptr<ReynardController> &reynard, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies) {
+bool EnvController::isSwappable(Vec2 room) {
     // Fail if room doesn't exist, is permalocked, fogged, or occupied
     if (_grid->getRoom(room) == nullptr || _grid->getRoom(room)->permlocked ||
-            _grid->isRoomFogged(room) || containsEnemies(room, enemies) ||
-            containsReynard(room, reynard))
+            _grid->isRoomFogged(room) || _grid->getOccupancy()->isOccupied(room))
         return false;
     // check if the room contains a checkpoint
     shared_ptr<TrapModel> trap = _grid->getRoom(room)->getTrap();
@@ -201,39 +183,6 @@ bool EnvController::isSwappable(Vec2 room, const shared_ptr<ReynardController> &
     return true;
 }
 
-/*
-* Checks whether Reynard is inside the indicated room
-*
-* @param room		the row and column of the room to check
-* @param reynard    the controller for reynard
-* 
-* @return true if Reynard is inside the given room
-*/
-bool EnvController::containsReynard(Vec2 room, const shared_ptr<ReynardController> &reynard) {
-    Vec2 pos = reynard->getScenePosition(); //reynard's center
-    Vec2 cRoom = _grid->worldSpaceToRoom(pos);
-    return room.equals(cRoom);
-}
-
-/*
-* Checks whether any enemies are inside the indicated room
-*
-* @param room       the row and column of the room to check
-* @param reynard    the controllers for the enemies
-*
-* @return true if at least one enemy is inside the given room
-*/
-bool EnvController::containsEnemies(Vec2 room, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies) {
-    bool isTrue = false;
-    for (auto i = enemies->begin(); i != enemies->end(); i++) {
-        Vec2 pos = (*i)->getScenePosition();
-        Vec2 cRoom = _grid->worldSpaceToRoom(pos);
-        isTrue = isTrue || room.equals(cRoom);
-    }
-
-    return isTrue;
-}
-
 /*
 * Removes fog of war from the eight rooms adjacent to this one, if they exist
 * Also defogs the specified room.
@@ -241,14 +190,7 @@ bool EnvController::containsEnemies(Vec2 room, const shared_ptr<vector<shared_pt
 * @param room   the row and column of the central room
 */
 void EnvController::defogSurrounding(Vec2 room) {
-    for (float x = -1; x <= 1; x++) {
-        for (float y = -1; y <= 1; y++) {
-            // Doesn't have to check if room exists, since GridModel does
-            Vec2 newRoom = room + Vec2(x, y);
-            _grid->setRoomFog(newRoom, false);
-            lookUnfogged(newRoom);
-        }
-    }
+    _grid->revealAround(room, 1);
 }
 
 #pragma mark Appearance Setters
@@ -282,12 +224,6 @@ void EnvController::lookFogged(Vec2 room) {
     }
 }
 
-/* Sets the room to have no fog of war */
-void EnvController::lookUnfogged(Vec2 room) {
-    if (_grid->getRoom(room)) {
-        _grid->getRoom(room)->setColor(Color4::WHITE);
-    }
-}
 
 EnvController::~EnvController() {
     _grid = nullptr;
@@ -301,4 +237,15 @@ void EnvController::setSwapHistory(const vector<vector<Vec2>> &swapHistory) {
     _swapHistory = swapHistory;
 }
 
+/*
+* Replaces the swap history with the given one after the rooms have been put
+* back in place
+*
+* @param swapHistory    the swap history to go back to
+*/
+void EnvController::restoreSwapHistory(const vector<vector<Vec2>> &swapHistory) {
+    deselectRoom();
+    _swapHistory = swapHistory;
+}
+
 
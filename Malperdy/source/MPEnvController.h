@@ -32,24 +32,25 @@ private:
     /* Reynard's room the previous update */
     Vec2 _reyPrev;
 
-    /* Enemies' rooms the previous update */
-    vector<Vec2> _enemyPrevs;
-
     /* Whether the game was zoomed out the previous update */
     bool _prevZoomOut;
 
+    /* The rooms currently on screen, from the lower left room to the upper right one */
+    Rect _viewRooms;
+
     /* History of room swaps as a list of pairs of rooms that have been swapped */
     vector<vector<Vec2>> _swapHistory;
 public:
     void setSwapHistory(const vector<vector<Vec2>> &swapHistory);
 
-private:
+    /*
+    * Replaces the swap history with the given one after the rooms have been put
+    * back in place
+    *
+    * @param swapHistory    the swap history to go back to
+    */
+    void restoreSwapHistory(const vector<vector<Vec2>> &swapHistory);
 
-    /**
-     * how many pairs of rooms finished swapping
-     */
-    int swapIndex = 0;
-public:
     const vector<vector<Vec2>> &getSwapHistory() const;
 
 public:
@@ -81,17 +82,32 @@ public:
     */
     void update(Vec2 dragCoords, bool zoomedOut, const shared_ptr<ReynardController> &reynard, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies);
 
+    /*
+    * Sets the part of the world that is currently on screen, so that all the
+    * rooms in it are kept active
+    *
+    * The corners must already have the world pane's pan and zoom undone,
+    * as the pane only applies them when it draws
+    *
+    * @param min    the lower left corner of the screen in world space
+    * @param max    the upper right corner of the screen in world space
+    */
+    void setView(Vec2 min, Vec2 max) {
+        Vec2 minRoom = _grid->worldSpaceToRoom(min);
+        Vec2 maxRoom = _grid->worldSpaceToRoom(max);
+        _viewRooms = Rect(minRoom, Size(maxRoom - minRoom));
+    }
+
     /*
     * Selects the room at the given location
     * Selection is for the purpose of being swapped with another room in swapWithSelected
-    * Will not select a room if it contains Reynard
+    * Will not select a room that isn't swappable
     *
     * @param coords     the coordinates of the selection in worldspace
-    * @param reynard    the controller for reynard
     *
     * @return true if room was successfully selected, and false otherwise
     */
-    bool selectRoom(Vec2 coords, const shared_ptr<ReynardController> &reynard, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies);
+    bool selectRoom(Vec2 coords);
 
     /*
     * Returns whether there is currently a room selected
@@ -105,19 +121,18 @@ public:
     /*
     * Swaps the room at the given location with the selected room
     * If room at given location is the selected room, deselects the room
-    * Will not swap a room if it contains Reynard
+    * Will not swap a room that isn't swappable
     *
     * Will deselect the currently selected room on a successful swap,
     * or on an attempt to swap a room with itself
     *
     * @param coords     the coordinates of the selection in worldspace
-    * @param reynard    the controller for reynard
     *
     * @return   true if rooms were successfully swapped
     *           false if room was the same as selected room
     *           false if no swap occurred
     */
-    bool swapWithSelected(Vec2 coords, const shared_ptr<ReynardController> &reynard, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies);
+    bool swapWithSelected(Vec2 coords);
 
     /* Deselects the currently selected room, if one is selected */
     void deselectRoom();
@@ -162,13 +177,9 @@ public:
      */
     void zoomOut() {
         deselectRoom();
-        for (int x = 0; x < _grid->getWidth(); x++) {
-            for (int y = 0; y < _grid->getHeight(); y++) {
-                if (_grid->getRoom(x, y) == nullptr) continue;
-
-                _grid->getRoom(x, y)->zoomOut();
-            }
-        }
+        _grid->forEachRoom([](int, int, const shared_ptr<RoomModel> &room) {
+            room->zoomOut();
+        });
     }
 
     /**
@@ -178,13 +189,9 @@ public:
      */
     void zoomIn() {
         deselectRoom();
-        for (int x = 0; x < _grid->getWidth(); x++) {
-            for (int y = 0; y < _grid->getHeight(); y++) {
-                if (_grid->getRoom(x, y) == nullptr) continue;
-
-                _grid->getRoom(x, y)->zoomIn();
-            }
-        }
+        _grid->forEachRoom([](int, int, const shared_ptr<RoomModel> &room) {
+            room->zoomIn();
+        });
     }
 
 private:
@@ -194,32 +201,10 @@ private:
     * Checks if the room satisfies the conditions to be swappable
     * 
     * @param room       the row and column of the room to check
-    * @param reynard    the controller for reynard
-    * @param enemies    the controllers for the enemies
     * 
     * @ return true if room doesn't contain Reynard, enemies or a checkpoint
     */
-    bool isSwappable(Vec2 room, const shared_ptr<ReynardController> &reynard, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies);
-
-    /*
-    * Checks whether Reynard is inside the indicated room
-    *
-    * @param room       the row and column of the room to check
-    * @param reynard    the controller for reynard
-    *
-    * @return true if Reynard is inside the given room
-    */
-    bool containsReynard(Vec2 room, const shared_ptr<ReynardController> &reynard);
-
-    /*
-    * Checks whether any enemies are inside the indicated room
-    *
-    * @param room       the row and column of the room to check
-    * @param enemies    the controllers for the enemies
-    *
-    * @return true if at least one enemy is inside the given room
-    */
-    bool containsEnemies(Vec2 room, const shared_ptr<vector<shared_ptr<EnemyController>>> &enemies);
+    bool isSwappable(Vec2 room);
 
     /*
     * Removes fog of war from the eight rooms adjacent to this one, if they exist
@@ -242,9 +227,6 @@ private:
 
     /* Sets the room to have fog of war */
     void lookFogged(Vec2 room);
-
-    /* Sets the room to have no fog of war */
-    void lookUnfogged(Vec2 room);
 };
 
 
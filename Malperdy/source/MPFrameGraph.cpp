@@ -0,0 +1,103 @@
+//
+//  MPFrameGraph.cpp
+//  Malperdy
+//
+//  This class runs the phases of a tick as a graph of tasks, ordered by the
+//  resources each phase reads and writes.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPFrameGraph.h"
+
+#pragma mark Building
+
+/**
+ * Adds a phase to the end of the graph. It will run after every phase
+ * already in the graph that it conflicts with.
+ *
+ * @param name      The name of the phase, which must outlive the graph
+ * @param reads     The resources the phase reads
+ * @param writes    The resources the phase writes
+ * @param affinity  Which threads the phase can run on
+ * @param work      What the phase does
+ */
+void FrameGraph::addPhase(const char *name, Uint32 reads, Uint32 writes, Affinity affinity, const std::function<void()> &work) {
+    Phase phase;
+    phase.name = name;
+    phase.reads = reads;
+    phase.writes = writes;
+    phase.affinity = affinity;
+    phase.work = work;
+
+    // Reading after a write, writing after a read, and writing after a write all have to keep their order
+    for (size_t i = 0; i < _phases.size(); i++) {
+        const Phase &earlier = _phases[i];
+        if ((reads & earlier.writes) || (writes & earlier.writes) || (writes & earlier.reads)) {
+            phase.after.push_back(i);
+        }
+    }
+    _phases.push_back(phase);
+}
+
+#pragma mark Running
+
+/**
+ * Runs a single phase on the calling thread.
+ *
+ * @param phase The phase to run
+ */
+void FrameGraph::runPhase(const Phase &phase) {
+    CU_PROFILE_ZONE(phase.name);
+    phase.work();
+}
+
+/**
+ * Runs every phase once, returning when they are all done. This must be
+ * called from the main thread.
+ *
+ * Without a scheduler, every phase runs on the main thread in the order
+ * they were added.
+ *
+ * @param scheduler The scheduler to run phases on, or nullptr for none
+ */
+void FrameGraph::run(const shared_ptr<TaskScheduler> &scheduler) {
+    if (scheduler == nullptr) {
+        for (auto itr = _phases.begin(); itr != _phases.end(); ++itr) {
+            runPhase(*itr);
+        }
+        return;
+    }
+
+    _tasks.assign(_phases.size(), TaskHandle());
+    for (size_t i = 0; i < _phases.size(); i++) {
+        const Phase &phase = _phases[i];
+        // Pinned phases have already run by the time anything later is reached, so they have no task
+        vector<TaskHandle> after;
+        for (auto itr = phase.after.begin(); itr != phase.after.end(); ++itr) {
+            if (_tasks[*itr].isValid()) after.push_back(_tasks[*itr]);
+        }
+
+        if (phase.affinity == Affinity::MAIN) {
+            // Waiting runs other phases on this thread rather than sitting idle
+            for (auto itr = after.begin(); itr != after.end(); ++itr) {
+                itr->wait();
+            }
+            runPhase(phase);
+        } else {
+            _tasks[i] = scheduler->submit([&phase]() {
+                runPhase(phase);
+            }, after);
+        }
+    }
+
+    for (auto itr = _tasks.begin(); itr != _tasks.end(); ++itr) {
+        itr->wait();
+    }
+    // Let go of the tasks, and what they hold onto, until the next tick
+    _tasks.clear();
+}
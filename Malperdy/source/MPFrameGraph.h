@@ -0,0 +1,158 @@
+//
+//  MPFrameGraph.h
+//  Malperdy
+//
+//  This class runs the phases of a tick as a graph of tasks, so that phases
+//  that don't touch the same things can run on different cores at once.
+//
+//  Each phase declares the resources it reads and the ones it writes, as bit
+//  flags. A phase runs after every phase added before it that writes
+//  something it reads or writes, or reads something it writes. Phases that
+//  share nothing can run at the same time. Since conflicting phases always
+//  run in the order they were added, a tick plays out exactly as if every
+//  phase ran one after the other in that order, which keeps replays exact.
+//
+//  Phases that have to stay on the main thread, like anything that might
+//  make GL calls or play sounds, are pinned there. The main thread goes through the phases
+//  in order, handing the rest to the workers as soon as it reaches them and
+//  running the pinned ones itself once what they depend on is done. So the
+//  pinned phases should be added after the ones that can run anywhere, to
+//  give the workers something to do in the meantime.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPFrameGraph_h
+#define MPFrameGraph_h
+
+#include <cugl/cugl.h>
+#include <functional>
+#include <vector>
+
+using namespace cugl;
+
+class FrameGraph {
+public:
+    /** Which threads a phase can run on */
+    enum class Affinity {
+        /** Only the main thread, which calls run() */
+        MAIN,
+        /**
+         * Any worker, or the main thread while it waits.
+         *
+         * These phases must not touch audio, GL, or anything else that is only
+         * safe on the main thread, including indirectly through the models
+         * they update. When in doubt, use MAIN.
+         */
+        ANY
+    };
+
+private:
+    /** A single phase of the tick */
+    struct Phase {
+        /** The name of the phase, for the profiler */
+        const char *name;
+        /** The resources the phase reads */
+        Uint32 reads;
+        /** The resources the phase writes */
+        Uint32 writes;
+        /** Which threads the phase can run on */
+        Affinity affinity;
+        /** What the phase does */
+        std::function<void()> work;
+        /** The phases that must be done before this one starts */
+        vector<size_t> after;
+    };
+
+    /** Every phase, in the order they were added */
+    vector<Phase> _phases;
+    /** The task of each phase while the graph runs */
+    vector<TaskHandle> _tasks;
+
+    /**
+     * Runs a single phase on the calling thread.
+     *
+     * @param phase The phase to run
+     */
+    static void runPhase(const Phase &phase);
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates a graph with no phases.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    FrameGraph() {}
+
+    /**
+     * Returns a newly allocated graph with no phases.
+     *
+     * @return  A newly allocated FrameGraph
+     */
+    static shared_ptr<FrameGraph> alloc() {
+        return make_shared<FrameGraph>();
+    }
+
+#pragma mark Building
+
+    /**
+     * Adds a phase to the end of the graph. It will run after every phase
+     * already in the graph that it conflicts with.
+     *
+     * @param name      The name of the phase, which must outlive the graph
+     * @param reads     The resources the phase reads
+     * @param writes    The resources the phase writes
+     * @param affinity  Which threads the phase can run on
+     * @param work      What the phase does
+     */
+    void addPhase(const char *name, Uint32 reads, Uint32 writes, Affinity affinity, const std::function<void()> &work);
+
+    /**
+     * Removes every phase.
+     */
+    void clear() {
+        _phases.clear();
+        _tasks.clear();
+    }
+
+    /**
+     * Returns how many phases are in the graph.
+     *
+     * @return  The number of phases
+     */
+    size_t getPhaseCount() const {
+        return _phases.size();
+    }
+
+    /**
+     * Returns the phases that must be done before the given one starts.
+     *
+     * @param phase The index of the phase, in the order it was added
+     * @return      The indices of the phases it waits on
+     */
+    const vector<size_t> &getDependencies(size_t phase) const {
+        return _phases[phase].after;
+    }
+
+#pragma mark Running
+
+    /**
+     * Runs every phase once, returning when they are all done. This must be
+     * called from the main thread.
+     *
+     * Without a scheduler, every phase runs on the main thread in the order
+     * they were added.
+     *
+     * @param scheduler The scheduler to run phases on, or nullptr for none
+     */
+    void run(const shared_ptr<TaskScheduler> &scheduler);
+};
+
+#endif /* MPFrameGraph_h */
@@ -18,6 +18,7 @@
 #include <box2d/b2_collision.h>
 
 #include <ctime>
+#include <cstring>
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -146,19 +147,44 @@ bool GameScene::init(const std::shared_ptr<AssetManager> &assets, const Rect rec
 
     // Start up the input handler
     _assets = assets;
-    _input.init();
+    if (_headless) {
+        _input.initScripted();
+    } else {
+        _input.init();
+    }
+
+    // Every session starts at the same simulation time, so it can be replayed
+    SimClock::reset();
+    _lastHurt = SimClock::now();
+    _accumulator = 0;
+    if (_recording != nullptr) _recording->begin(_mode);
 
     TrapModel::ASSETS = _assets;
 
     // Create the world and attach the listeners.
     _world = physics2::ObstacleWorld::alloc(rect, gravity);
+    _registry = EntityRegistry::alloc();
+    _perception = EnemyPerception::alloc(_registry);
+    _scheduler = EnemyScheduler::alloc();
+    // Leave a core for the main thread, which runs phases too while it waits
+    _tasks = TaskScheduler::alloc();
+    _perception->setScheduler(_tasks);
+    buildFrameGraph();
     _world->activateCollisionCallbacks(true);
-    _world->onBeginContact = [this](b2Contact *contact) {
+    // Contacts are recorded during the step and handled once it is over
+    _contacts = ContactQueue::alloc(_world->getWorld());
+    _contacts->onBeginContact = [this](const ContactEvent &contact) {
         beginContact(contact);
     };
-    _world->onEndContact = [this](b2Contact *contact) {
+    _contacts->onEndContact = [this](const ContactEvent &contact) {
         endContact(contact);
     };
+    _world->onBeginContact = [this](b2Contact *contact) {
+        _contacts->beginContact(contact);
+    };
+    _world->onEndContact = [this](b2Contact *contact) {
+        _contacts->endContact(contact);
+    };
 
     _world->beforeSolve = [this](b2Contact *contact, const b2Manifold *oldManifold) {
         beforeSolve(contact, oldManifold);
@@ -176,8 +202,15 @@ bool GameScene::init(const std::shared_ptr<AssetManager> &assets, const Rect rec
     _debugnode = scene2::ScrollPane::allocWithBounds(10, 10); // Number does not matter when constraint is false
     _debugnode->setScale(_scale);
     _debugnode->setMinZoom(0.5);// Debug node draws in PHYSICS coordinates
+    _debugDraw = DebugDraw::alloc();
+    _debugnode->addChild(_debugDraw);
     setDebug(false);
 
+    // The debug root is scaled, but shifting its position moves it in screen space like the world
+    _interpolator = RenderInterpolator::alloc(_world, _scale);
+    _interpolator->addPane(_worldnode, _worldnode);
+    _interpolator->addPane(_worldnode, _debugnode);
+
     _winNode = scene2::Label::allocWithText("VICTORY!", _assets->get<Font>(PRIMARY_FONT));
     _winNode->setAnchor(Vec2::ANCHOR_CENTER);
     _winNode->setBackground(Color4::BLACK);
@@ -185,6 +218,18 @@ bool GameScene::init(const std::shared_ptr<AssetManager> &assets, const Rect rec
     _winNode->setPadding(dimen.width / 2, dimen.height / 2, dimen.width / 2, dimen.height / 2);
     setComplete(false);
 
+#ifdef CU_PROFILE
+    // What the profiler measured over the last second, shown in debug mode
+    _profileNode = scene2::Label::allocWithTextBox(Size(dimen.width * 4, dimen.height * 4), "", _assets->get<Font>(PRIMARY_FONT));
+    _profileNode->setAnchor(Vec2::ANCHOR_TOP_LEFT);
+    _profileNode->setScale(0.25);
+    _profileNode->setPosition(Vec2(30, getSize().height - 140));
+    _profileNode->setForeground(STATIC_COLOR);
+    _profileNode->setHorizontalAlignment(HorizontalAlign::LEFT);
+    _profileNode->setVerticalAlignment(VerticalAlign::TOP);
+    _profileNode->setVisible(false);
+#endif
+
     _health = scene2::PolygonNode::allocWithTexture(_assets->get<Texture>("healthbar"));
     _health->setAnchor(Vec2::ANCHOR_TOP_LEFT);
     Vec2 padding = Vec2(30, -20);
@@ -212,19 +257,18 @@ bool GameScene::init(const std::shared_ptr<AssetManager> &assets, const Rect rec
     addChild(_pause);
 
     addChild(_winNode);
+#ifdef CU_PROFILE
+    addChild(_profileNode);
+#endif
 
     // Give all enemies a reference to the ObstacleWorld for raycasting
     EnemyController::setObstacleWorld(_world);
     if (_mode == 1) {
 
-        vector<std::string> file_path_list = vector<std::string>(2);
-        file_path_list[0] = Application::get()->getSaveDirectory();
-        file_path_list[1] = "state.json";
-        if (filetool::file_exists(cugl::filetool::join_path(file_path_list))) {
-            cugl::filetool::file_delete(cugl::filetool::join_path(file_path_list));
-        }
+        SaveFile::erase();
 
         populate();
+        captureSnapshot();
     } else {
         revert(false);
     }
@@ -233,7 +277,7 @@ bool GameScene::init(const std::shared_ptr<AssetManager> &assets, const Rect rec
     _complete = false;
 
     // XNA nostalgia
-    Application::get()->setClearColor(Color4f::BLACK);
+    if (!_headless) Application::get()->setClearColor(Color4f::BLACK);
 
     // Finally start playing level music
     AudioController::playMusic(LEVEL_MUSIC);
@@ -249,9 +293,24 @@ void GameScene::dispose() {
         removeAllChildren();
         _input.dispose();
         _world = nullptr;
+        _registry = nullptr;
+        _contacts = nullptr;
+        _perception = nullptr;
+        _scheduler = nullptr;
+        _frameGraph = nullptr;
+        _tasks = nullptr;
+        _enemySpawns.clear();
+        _enemyPool.clear();
+        _populatedRegions.clear();
         _worldnode = nullptr;
         _debugnode = nullptr;
+        _debugDraw = nullptr;
+        _interpolator = nullptr;
+        EnemyController::setDebugDraw(nullptr);
         _winNode = nullptr;
+#ifdef CU_PROFILE
+        _profileNode = nullptr;
+#endif
         _health = nullptr;
         _keyUI = nullptr;
         _pause = nullptr;
@@ -288,9 +347,15 @@ void GameScene::revert(bool totalReset) {
     _reynardController = nullptr;
     _grid = nullptr;
     _envController = nullptr;
+    _contacts->clear();
     _world->clear();
+    _registry->clear();
+    _perception->clear();
+    _scheduler->clear();
     _worldnode->removeAllChildren();
-    _debugnode->removeAllChildren();
+    _debugDraw->clear();
+    _interpolator->clear();
+    _interpolator->snap();
     _gamestate.reset();
     _enemies = nullptr;
     setComplete(false);
@@ -302,9 +367,12 @@ void GameScene::revert(bool totalReset) {
         for (int i = 0; i < _checkpointSwapLen; i++) {
             _envController->swapRoomOnGrid(_swapHistory[i][0], _swapHistory[i][1], true);
         }
+        // Fog is by cell, so it has to go back after the rooms are in place
+        _grid->setFogBits(_checkpointFog);
         _reynardController->getCharacter()->setPosition(_checkpointReynardPos);
-        for (int i = 0; i < _enemies->size(); i++) {
-            (*_enemies)[i]->getCharacter()->setPosition(_checkpointEnemyPos[i]);
+        for (size_t i = 0; i < _enemySpawns.size(); i++) {
+            _enemySpawns[i].state.position = _checkpointEnemyPos[i];
+            if (_enemySpawns[i].enemy != nullptr) _enemySpawns[i].enemy->getCharacter()->setPosition(_checkpointEnemyPos[i]);
         }
         for (int index: _checkpointActivatedCheckpoints) {
             _envController->getGrid()->getCheckpoints()[index]->setTrapState(TrapModel::TrapState::ACTIVATED);
@@ -312,6 +380,114 @@ void GameScene::revert(bool totalReset) {
             _envController->getGrid()->getCheckpoints()[index]->unlock();
         }
     }
+
+    // Deaths from here on respawn in place
+    captureSnapshot();
+}
+
+/**
+ * Takes a snapshot of everything that can change before the next checkpoint,
+ * so that respawn() can put it back.
+ */
+void GameScene::captureSnapshot() {
+    _snapshot = make_shared<CheckpointSnapshot>();
+
+    // Rooms and traps
+    _snapshot->rooms = _grid->getRoomTable()->getRooms();
+    for (auto itr = _snapshot->rooms.begin(); itr != _snapshot->rooms.end(); ++itr) {
+        shared_ptr<TrapModel> trap = (*itr) == nullptr ? nullptr : (*itr)->getTrap();
+        _snapshot->trapStates.push_back(trap == nullptr ? TrapModel::TrapState::SPAWN : trap->getTrapState());
+    }
+    _snapshot->swapHistory = _envController->getSwapHistory();
+    _snapshot->activatedCheckpoints = _checkpointActivatedCheckpoints;
+
+    // Characters
+    _snapshot->reynard = CheckpointSnapshot::captureCharacter(_reynardController->getCharacter());
+    _snapshot->reynardKeyIDs = _reynardController->getKeyIDs();
+    for (auto itr = _enemySpawns.begin(); itr != _enemySpawns.end(); ++itr) {
+        if (itr->enemy != nullptr) {
+            _snapshot->enemies.push_back(CheckpointSnapshot::captureCharacter(itr->enemy->getCharacter()));
+            _snapshot->enemyBehaviors.push_back(itr->enemy->getCharacter()->getBehaveState());
+        } else {
+            _snapshot->enemies.push_back(itr->state);
+            _snapshot->enemyBehaviors.push_back(itr->behavior);
+        }
+    }
+
+    // Keys that haven't been picked up
+    for (auto itr = _keys.begin(); itr != _keys.end(); ++itr) {
+        _snapshot->keys.push_back({(*itr)->getPosition(), false, (*itr)->isPathFinding()});
+    }
+    for (auto itr = _keysCrazy.begin(); itr != _keysCrazy.end(); ++itr) {
+        _snapshot->keys.push_back({(*itr)->getPosition(), true, (*itr)->isPathFinding()});
+    }
+}
+
+/**
+ * Puts the game back the way it was at the last snapshot, in place on the
+ * existing grid and physics world. This is much faster than revert, since
+ * nothing is rebuilt and no files are read.
+ *
+ * Falls back to revert if there is no snapshot.
+ */
+void GameScene::respawn() {
+    if (_snapshot == nullptr || _grid == nullptr || !_grid->restoreRooms(_snapshot->rooms)) {
+        revert(false);
+        return;
+    }
+
+    // Rooms and traps
+    for (size_t i = 0; i < _snapshot->rooms.size(); i++) {
+        shared_ptr<RoomModel> room = _snapshot->rooms[i];
+        if (room != nullptr && room->getTrap() != nullptr) room->getTrap()->setTrapState(_snapshot->trapStates[i]);
+    }
+    _envController->restoreSwapHistory(_snapshot->swapHistory);
+    _checkpointActivatedCheckpoints = _snapshot->activatedCheckpoints;
+
+    // Characters, with Reynard always coming back at full health like a fresh start
+    CheckpointSnapshot::restoreCharacter(_reynardController->getCharacter(), _snapshot->reynard);
+    _reynardController->getCharacter()->setHearts(REYNARD_MAX_HEARTS);
+    _reynardController->getCharacter()->resetMoveState();
+    _reynardController->setKeyIDs(_snapshot->reynardKeyIDs);
+    for (size_t i = 0; i < _enemySpawns.size() && i < _snapshot->enemies.size(); i++) {
+        EnemySpawn &spawn = _enemySpawns[i];
+        spawn.state = _snapshot->enemies[i];
+        spawn.behavior = _snapshot->enemyBehaviors[i];
+        // Enemies that aren't in the world yet come back with the region they were in then
+        int region = getRegionAt(spawn.state.position);
+        if (region != NO_REGION) spawn.region = region;
+        if (spawn.enemy != nullptr) {
+            CheckpointSnapshot::restoreCharacter(spawn.enemy->getCharacter(), spawn.state);
+            spawn.enemy->getCharacter()->setBehaveState(spawn.behavior);
+        }
+    }
+
+    // Replace all the keys with the ones from the snapshot
+    for (auto itr = _keys.begin(); itr != _keys.end(); ++itr) {
+        _worldnode->removeChild((*itr)->getSceneNode());
+        _registry->release(*itr);
+        (*itr)->markRemoved(true);
+    }
+    _keys.clear();
+    for (auto itr = _keysCrazy.begin(); itr != _keysCrazy.end(); ++itr) {
+        _worldnode->removeChild((*itr)->getSceneNode());
+        _registry->release(*itr);
+        (*itr)->markRemoved(true);
+    }
+    _keysCrazy.clear();
+    deadKeyEnemyLocs->clear();
+    for (auto itr = _snapshot->keys.begin(); itr != _snapshot->keys.end(); ++itr) {
+        createKey(itr->position, itr->possessed, itr->pathFinding);
+    }
+
+    // Per-life state of the scene
+    scrollingOffset = Vec2();
+    keepRedFrames = 0;
+    corner_num_frames_workaround = 0;
+    _gamestate.reset();
+    setComplete(false);
+    // Everyone jumped back to the checkpoint, so don't draw them sliding there
+    _interpolator->snap();
 }
 
 /**
@@ -335,6 +511,7 @@ void GameScene::populateEnv() {
 #pragma mark Rooms
     _grid = _envController->getGrid();
     _grid->init(_assets, _scale);
+    _grid->setEntityRegistry(_registry);
 
     _worldnode->addChild(_grid);
     _grid->setScale(0.4);
@@ -342,13 +519,12 @@ void GameScene::populateEnv() {
     //_grid->setPosition(0,-240);
 
     // Populate physics obstacles for grid
-    shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> physics_objects = _grid->getPhysicsObjects();
-    for (vector<shared_ptr<physics2::PolygonObstacle>>::iterator itr = physics_objects->begin(); itr != physics_objects->end(); ++itr) {
+    shared_ptr<vector<shared_ptr<physics2::Obstacle>>> physics_objects = _grid->getPhysicsObjects();
+    for (vector<shared_ptr<physics2::Obstacle>>::iterator itr = physics_objects->begin(); itr != physics_objects->end(); ++itr) {
         _world->addObstacle(*itr);
-        (*itr)->setDebugScene(_debugnode);
-        (*itr)->setDebugColor(Color4::RED);
         // CULog("populate: %f %f ", (*itr)->getPosition().x);
     }
+    _grid->registerPhysics();
 
     // Start the camera above Reynard and pan to him
     _worldnode->applyPan(Vec2(0, -500));
@@ -408,33 +584,37 @@ void GameScene::populateReynard() {
     Vec2 pos_temp = _reynardController->getCharacter()->getPosition();
     _reynardController->getCharacter()->setPosition(Vec2(4, 3));
     addObstacle(_reynardController->getCharacter(), _reynardController->getCharacter()->_node); // Put this at the very front
+    EntityRegistry::Entity entity;
+    entity.type = EntityRegistry::EntityType::REYNARD;
+    _registry->add(_reynardController->getCharacter(), entity);
     _reynardController->getCharacter()->setPosition(pos_temp);
 }
 
 /**
- * Places all the enemies for the active regions in the game world.
+ * Sets up every enemy in the level, and places the ones for the active
+ * regions in the game world. The rest are only placed once their region
+ * becomes active.
  */
 void GameScene::populateEnemies() {
-    /*shared_ptr<vector<shared_ptr<RegionModel>>> _activeRegions = _grid->getActiveRegions();
-    for (vector<shared_ptr<RegionModel>>::iterator itr = _activeRegions->begin();
-         itr != _activeRegions->end(); ++itr)
-    {
-        populateEnemiesInRegion(*itr);
-    }*/
-
-
-    shared_ptr<Animation> rabbit_animations = make_shared<Animation>(_assets->get<Texture>("rabbit_all"), _assets->get<JsonValue>("framedata2")->get("rabbit"));
+    _rabbitAnimations = make_shared<Animation>(_assets->get<Texture>("rabbit_all"), _assets->get<JsonValue>("framedata2")->get("rabbit"));
 
     // Initialize new enemy
     _enemies = make_shared<vector<std::shared_ptr<EnemyController>>>();
+    _enemySpawns.clear();
+    _enemyPool.clear();
+    _populatedRegions.clear();
 
-    // For each enemy to spawn
+    // Record every enemy to spawn, without creating any of them yet
+    shared_ptr<RoomTable> table = _grid->getRoomTable();
     for (auto itr = _grid->_enemySpawnInfo->begin(); itr != _grid->_enemySpawnInfo->end();
          ++itr) {
+        EnemySpawn spawn;
         Vec2 enemyCoords;
         // Note that these are in HOUSE space, so first go to ROOM? space
         enemyCoords.x = ((*itr).first).x - _grid->getOriginX() + 0;
-        enemyCoords.y = ((*itr).first).y - _grid->getOriginY() + 0.5f;
+        enemyCoords.y = ((*itr).first).y - _grid->getOriginY() + 0;
+        spawn.region = table->getRegion(enemyCoords.x, enemyCoords.y);
+        enemyCoords.y += 0.5f;
         // Then ROOM to GRID space?
         enemyCoords = _grid->roomSpaceToGrid(enemyCoords);
         // Then go from GRID space to WORLD space
@@ -442,133 +622,183 @@ void GameScene::populateEnemies() {
         // Then go to PHYSICS space
         enemyCoords /= _scale;
 
-        // Now create the actual enemy
-        _enemies->push_back(EnemyController::alloc(enemyCoords, _scale, rabbit_animations));
-
-        // Add enemy to physics world
-        Vec2 posTemp = _enemies->back()->getCharacter()->getPosition();
-        _enemies->back()->getCharacter()->setPosition(Vec2(4, 3));
-
-        _enemies->back()->setObstacleWorld(_world);
-        _enemies->back()->setReynardController(_reynardController);
-        _enemies->back()->_isKeyed = (*itr).second;
-
-        addObstacle(_enemies->back()->getCharacter(), _enemies->back()->getCharacter()->_node);
-
-        _enemies->back()->getCharacter()->setPosition(posTemp);
+        spawn.keyed = (*itr).second;
+        spawn.state.position = enemyCoords;
+        spawn.state.hearts = DEFAULT_ENEMY_MAX_HEARTS;
+        _enemySpawns.push_back(spawn);
     }
 
-    _checkpointEnemyPos = vector<Vec2>();
+    // Only place the enemies around Reynard to begin with
+    Vec2 reynardRoom = _grid->worldSpaceToRoom(_reynardController->getScenePosition());
+    _grid->updateActivation(reynardRoom, Rect(reynardRoom, Size::ZERO));
+    streamEnemies();
+
+    _checkpointEnemyPos = getEnemyPositions();
     _checkpointReynardPos = _reynardController->getCharacter()->getPosition();
-    for (auto enemy: *_enemies) {
-        _checkpointEnemyPos.push_back(enemy->getCharacter()->getPosition());
-    }
 }
 
 /**
- * NOT CURRENTLY USED
- * 
- * Places the enemies for the given region in the game world.
+ * Places the enemies for the given region in the game world, picking up
+ * where each of them left off the last time the region was active.
  *
- * Allows us to populate enemies on a per-region basis, instead
- * of loading them all in at once and potentially causing runtime
- * issues.
+ * Controllers are taken from the pool of despawned enemies when there are
+ * any, so a region coming back doesn't create anything new.
  *
  * @param region    The region to populate the enemies for.
  */
 void GameScene::populateEnemiesInRegion(shared_ptr<RegionModel> region) {
+    for (auto itr = _enemySpawns.begin(); itr != _enemySpawns.end(); ++itr) {
+        if (itr->region != region->getNumber() || itr->enemy != nullptr) continue;
 
-    // NOT CURRENTLY USED
-
-    shared_ptr<Animation> rabbit_animations = make_shared<Animation>(_assets->get<Texture>("rabbit_all"), _assets->get<JsonValue>("framedata2")->get("rabbit"));
-
-    // Initialize new enemy
-    _enemies = make_shared<vector<std::shared_ptr<EnemyController>>>();
-
-
-    // get Level data from the JSON
-    shared_ptr<JsonValue> levelJSON = _assets->get<JsonValue>(region->getName());
-    // get the layer containing entities
-    shared_ptr<JsonValue> entityLayer;
-    for (int i = 0; i < levelJSON->get("layers")->size(); i++) {
-        if (levelJSON->get("layers")->get(i)->get("name")->asString() == "entities") {
-            entityLayer = levelJSON->get("layers")->get(i);
-        }
-    }
-    // get the entity tileset offset from levelJSON
-    int entity_offset;
-    for (int i = 0; i < levelJSON->get("tilesets")->size(); i++) {
-        if (levelJSON->get("tilesets")->get(i)->get("source")->asString().find("entities") != string::npos) {
-            entity_offset = levelJSON->get("tilesets")->get(i)->get("firstgid")->asInt();
+        shared_ptr<EnemyController> enemy;
+        if (_enemyPool.empty()) {
+            enemy = EnemyController::alloc(itr->state.position, _scale, _rabbitAnimations);
+        } else {
+            enemy = _enemyPool.back();
+            _enemyPool.pop_back();
+            enemy->resetTracking();
         }
-    }
+        enemy->setObstacleWorld(_world);
+        enemy->setReynardController(_reynardController);
+        enemy->_isKeyed = itr->keyed;
 
-    // For each tile in the entity layer,
-    for (int i = 0; i < entityLayer->get("data")->size(); i++) {
-
-        // if there is something in the tile
-        if (entityLayer->get("data")->get(i)->asInt() != 0) {
-            int tile = entityLayer->get("data")->get(i)->asInt() - entity_offset;
-
-            // determine if the entity corresponds to an enemy
-            shared_ptr<JsonValue> temp1 = _assets->get<JsonValue>("tileset_entities")->get("tiles");
-            string temp = temp1->get(tile - temp1->get(0)->get("id")->asInt())->get("image")->asString();
-
-            // if it is an enemy...
-            // TODO: change code in this if statement to add key enemy instead of regular enemy
-            if (temp.find("keyenemy") != string::npos) {
-                // Get enemy location, converting from tile space
-                int room = i / ROOM_HEIGHT / ROOM_WIDTH;
-                int x = room % (levelJSON->get("width")->asInt() / ROOM_WIDTH);
-                int y = room / (levelJSON->get("width")->asInt() / ROOM_WIDTH);
-                Vec2 enemypos = Vec2(x, levelJSON->get("height")->asInt() / ROOM_HEIGHT - 1 - y);
-
-                // initialize it
-                //                _enemies->push_back(EnemyController::alloc(enemypos * Vec2(12,8), _scale, rabbit_animations));
-                _enemies->push_back(EnemyController::alloc(Vec2::ZERO, _scale, rabbit_animations));
+        // Add enemy to physics world
+        enemy->getCharacter()->setPosition(Vec2(4, 3));
+        addObstacle(enemy->getCharacter(), enemy->getCharacter()->_node);
 
-                _enemies->back()->setObstacleWorld(_world);
-                _enemies->back()->setReynardController(_reynardController);
-                addObstacle(_enemies->back()->getCharacter(), _enemies->back()->getCharacter()->_node);
+        // Then put it back the way it was
+        CheckpointSnapshot::restoreCharacter(enemy->getCharacter(), itr->state);
+        enemy->getCharacter()->setBehaveState(itr->behavior);
+        itr->enemy = enemy;
+    }
+}
 
-                _enemies->back()->getCharacter()->setPosition((enemypos + Vec2::ZERO) * Vec2(23, 12));
-            } else if (temp.find("enemy") != string::npos) {
+/**
+ * Takes the enemies for the given region out of the game world, keeping
+ * their state so they pick up where they left off when the region is
+ * populated again. Their controllers go back in the pool.
+ *
+ * @param region    The region to take the enemies out of.
+ */
+void GameScene::depopulateEnemiesInRegion(shared_ptr<RegionModel> region) {
+    for (auto itr = _enemySpawns.begin(); itr != _enemySpawns.end(); ++itr) {
+        if (itr->region != region->getNumber() || itr->enemy == nullptr) continue;
+        depopulateEnemy(*itr);
+    }
+}
 
-                // Get enemy location, converting from tile space
-                int room = i / ROOM_HEIGHT / ROOM_WIDTH;
-                int x = room % (levelJSON->get("width")->asInt() / ROOM_WIDTH);
-                int y = room / (levelJSON->get("width")->asInt() / ROOM_WIDTH);
-                Vec2 enemypos = Vec2(x, levelJSON->get("height")->asInt() / ROOM_HEIGHT - 1 - y);
+/**
+ * Takes the given enemy out of the game world, keeping its state so it
+ * picks up where it left off when its region is populated again. Its
+ * controller goes back in the pool.
+ *
+ * @param spawn     The enemy to take out of the game world.
+ */
+void GameScene::depopulateEnemy(EnemySpawn &spawn) {
+    shared_ptr<EnemyController> enemy = spawn.enemy;
+    spawn.state = CheckpointSnapshot::captureCharacter(enemy->getCharacter());
+    spawn.behavior = enemy->getCharacter()->getBehaveState();
+
+    // Take the body out right away so the controller can be reused this frame.
+    // The entity is kept until then, so the contacts it ends still reach the enemy.
+    int handle = EntityRegistry::getHandle(enemy->getCharacter()->getBody());
+    _world->removeObstacle(enemy->getCharacter().get());
+    _registry->releaseHandle(handle);
+    _worldnode->removeChild(enemy->getCharacter()->_node);
+
+    _enemyPool.push_back(enemy);
+    spawn.enemy = nullptr;
+}
 
-                // initialize it
-                //                _enemies->push_back(EnemyController::alloc(enemypos * Vec2(ROOM_WIDTH,ROOM_HEIGHT), _scale, rabbit_animations));
-                _enemies->push_back(EnemyController::alloc(Vec2::ZERO, _scale, rabbit_animations));
+/**
+ * Returns the number of the region at the given position, or NO_REGION if
+ * the position isn't in one.
+ *
+ * @param position  The position in PHYSICS space
+ * @return          The number of the region at the position
+ */
+int GameScene::getRegionAt(Vec2 position) {
+    Vec2 room = _grid->worldSpaceToRoom(position * _scale);
+    return _grid->getRoomTable()->getRegion(room.x, room.y);
+}
 
-                _enemies->back()->setObstacleWorld(_world);
-                _enemies->back()->setReynardController(_reynardController);
-                addObstacle(_enemies->back()->getCharacter(), _enemies->back()->getCharacter()->_node);
+/**
+ * Populates the enemies for every region that has become active, and
+ * depopulates the ones for every region that is no longer active.
+ *
+ * Each enemy goes with the region it is in now, so one that wandered out
+ * of its spawn region is only taken out with the region it is in.
+ */
+void GameScene::streamEnemies() {
+    shared_ptr<vector<shared_ptr<RegionModel>>> active = _grid->getActiveRegions();
+    bool changed = false;
+
+    // Enemies wander, so each one goes with the region it is in now, not the one it spawned in
+    for (auto itr = _enemySpawns.begin(); itr != _enemySpawns.end(); ++itr) {
+        if (itr->enemy == nullptr) continue;
+        int region = getRegionAt(itr->enemy->getCharacter()->getPosition());
+        if (region != NO_REGION) itr->region = region;
+    }
 
-                //_enemies->back()->getCharacter()->setPosition(enemypos);
-                _enemies->back()->getCharacter()->setPosition((enemypos + Vec2::ZERO) * Vec2(20, 14));
-                //_enemies->back()->getCharacter()->setPosition((enemypos + Vec2(1, 1)) * Vec2(8.2, 5.1));
-            }
+    // Depopulate first, so their controllers can be reused right away
+    for (auto itr = _populatedRegions.begin(); itr != _populatedRegions.end();) {
+        if (find(active->begin(), active->end(), *itr) == active->end()) {
+            depopulateEnemiesInRegion(*itr);
+            itr = _populatedRegions.erase(itr);
+            changed = true;
+        } else {
+            ++itr;
         }
     }
+    // That includes anyone who wandered into a region that isn't populated
+    for (auto itr = _enemySpawns.begin(); itr != _enemySpawns.end(); ++itr) {
+        if (itr->enemy == nullptr) continue;
+        int region = itr->region;
+        auto populated = find_if(_populatedRegions.begin(), _populatedRegions.end(),
+                                 [region](const shared_ptr<RegionModel> &r) { return r->getNumber() == region; });
+        if (populated == _populatedRegions.end()) {
+            depopulateEnemy(*itr);
+            changed = true;
+        }
+    }
+    for (auto itr = active->begin(); itr != active->end(); ++itr) {
+        if (find(_populatedRegions.begin(), _populatedRegions.end(), *itr) == _populatedRegions.end()) {
+            populateEnemiesInRegion(*itr);
+            _populatedRegions.push_back(*itr);
+            changed = true;
+        }
+    }
+    if (!changed) return;
+
+    // Rebuild the list of enemies in the world, keeping them in spawn order
+    _enemies->clear();
+    for (auto itr = _enemySpawns.begin(); itr != _enemySpawns.end(); ++itr) {
+        if (itr->enemy == nullptr) continue;
+        _enemies->push_back(itr->enemy);
+
+        EntityRegistry::Entity entity;
+        entity.type = EntityRegistry::EntityType::ENEMY;
+        entity.index = (int)_enemies->size() - 1;
+        _registry->add(itr->enemy->getCharacter(), entity);
+    }
 
-    // Initialize EnemyController with the final animation map and store in vector of enemies
-    //_enemies->push_back(EnemyController::alloc(Vec2(3, 3), _scale, rabbit_animations));
-
-    //        for(shared_ptr<EnemyController> enemy : *_enemies){
-    //            enemy->setObstacleWorld(_world);
-    //            enemy->setReynardController(_reynardController);
-    //            addObstacle(enemy->getCharacter(), enemy->getCharacter()->_node); // Put
-    //        }
+    // Anything kept by position in the list is out of date
+    _perception->clear();
+    _scheduler->clear();
+}
 
-    _checkpointEnemyPos = vector<Vec2>();
-    _checkpointReynardPos = _reynardController->getCharacter()->getPosition();
-    for (auto enemy: *_enemies) {
-        _checkpointEnemyPos.push_back(enemy->getCharacter()->getPosition());
+/**
+ * Returns the position of every enemy in the level in PHYSICS space, in
+ * spawn order, whether or not it is in the game world right now.
+ *
+ * @return  The position of every enemy
+ */
+vector<Vec2> GameScene::getEnemyPositions() {
+    vector<Vec2> result;
+    for (auto itr = _enemySpawns.begin(); itr != _enemySpawns.end(); ++itr) {
+        result.push_back(itr->enemy != nullptr ? itr->enemy->getCharacter()->getPosition() : itr->state.position);
     }
+    return result;
 }
 
 /**
@@ -644,8 +874,6 @@ void GameScene::placeEnvImage(float x, float y, float scale, string TextureName)
 void GameScene::addObstacle(const std::shared_ptr<physics2::Obstacle> &obj,
         const std::shared_ptr<scene2::SceneNode> &node) {
     _world->addObstacle(obj);
-    obj->setDebugScene(_debugnode);
-    obj->setDebugColor(Color4::RED);
 
     // Position the scene graph node (enough for static objects)
     _worldnode->addChild(node);
@@ -658,6 +886,8 @@ void GameScene::addObstacle(const std::shared_ptr<physics2::Obstacle> &obj,
             weak->setPosition(obs->getPosition() * _scale);
             weak->setAngle(obs->getAngle());
         });
+        // Between ticks, it is drawn partway between where the last tick moved it from and to
+        _interpolator->add(obj, node);
     }
 }
 
@@ -667,6 +897,53 @@ void GameScene::addObstacle(const std::shared_ptr<physics2::Obstacle> &obj,
 float frameAcc = 0;
 int fps = 0;
 
+/**
+ * Reads the input, and then runs the simulation for as many ticks as the
+ * time that has passed calls for.
+ *
+ * With a fixed step, time that doesn't make up a whole tick is carried over
+ * to the next frame. If the game falls too far behind to catch up, the time
+ * it can't catch up on is dropped.
+ *
+ * @param  dt   Number of seconds since last animation frame
+ */
+void GameScene::update(float dt) {
+    CU_PROFILE_ZONE("GameScene::update");
+    {
+        CU_PROFILE_ZONE("GameScene::input");
+        _input.update(dt);
+    }
+    if (!_fixedStep) {
+        tick(dt);
+        return;
+    }
+
+    _accumulator = std::min(_accumulator + dt, FIXED_STEP * MAX_STEPS_PER_FRAME);
+    while (_accumulator >= FIXED_STEP) {
+        _accumulator -= FIXED_STEP;
+        tick(FIXED_STEP);
+    }
+}
+
+/**
+ * Runs a single tick of the simulation, recording its input if the
+ * session is being recorded.
+ *
+ * @param  dt   The length of the tick, in seconds
+ */
+void GameScene::tick(float dt) {
+    CU_PROFILE_ZONE("GameScene::tick");
+    _input.beginTick();
+    if (_recording != nullptr) _recording->record(_input.getFrame());
+
+    SimClock::advance(dt);
+    step(dt);
+    _interpolator->capture();
+
+    if (_recording != nullptr) _recording->addState(getStateHash());
+    _input.endTick();
+}
+
 /**
  * Executes the core gameplay loop of this world.
  *
@@ -675,15 +952,29 @@ int fps = 0;
  * This method is called after input is read, but before collisions are resolved.
  * The very last thing that it should do is apply forces to the appropriate objects.
  *
- * @param  delta    Number of seconds since last animation frame
+ * @param  dt   The length of the tick, in seconds
  */
-void GameScene::update(float dt) {
-    _input.update(dt);
+void GameScene::step(float dt) {
+    CU_PROFILE_ZONE("GameScene::step");
     Vec2 inputPos = inputToGameCoords(_input.getPosition());
 
-    _envController->getGrid()->update(dt);
+    {
+        CU_PROFILE_ZONE("GameScene::geometry");
+        _envController->getGrid()->update(dt);
+
+        _world->garbageCollect();
+        _registry->collect();
 
-    _world->garbageCollect();
+        // Add physics for any rooms whose geometry changed since the last frame
+        bool geometryChanged = _grid->isPhysicsDirty();
+        shared_ptr<vector<shared_ptr<physics2::Obstacle>>> rebuilt = _grid->updatePhysicsGeometry();
+        for (auto itr = rebuilt->begin(); itr != rebuilt->end(); ++itr) {
+            _world->addObstacle(*itr);
+        }
+        _grid->registerPhysics();
+        // Anything the enemies saw before the rooms changed is out of date
+        if (geometryChanged) _perception->invalidate();
+    }
 
     // Clear regions if we hit the debug key
     if (_input.didClearRegion1()) {
@@ -698,10 +989,6 @@ void GameScene::update(float dt) {
     if (_input.didDebug()) {
         setDebug(!isDebug());
         //_worldnode->setVisible(!_worldnode->isVisible());
-        vector<std::shared_ptr<EnemyController>>::iterator itr;
-        for (itr = _enemies->begin(); itr != _enemies->end(); ++itr) {
-            (*itr)->setDebug(true);
-        }
     }
 
     // Reset Process toggled by key command
@@ -794,14 +1081,16 @@ void GameScene::update(float dt) {
     }
     if (usingClick && !_gamestate.zoomed_in() && _input.didPress()) {
         if (_envController->hasSelected()) {
-            if (_envController->swapWithSelected(inputPos, _reynardController, _enemies)) {
+            if (_envController->swapWithSelected(inputPos)) {
                 AudioController::playSFX(SWAP_SOUND);
+                // Anyone in the swapped rooms moved with them
+                _interpolator->snap();
             } else {
                 AudioController::playSFX(NOSWAP_SOUND);
             }
             triedSwap = true;
         } else {
-            _envController->selectRoom(inputPos, _reynardController, _enemies);
+            _envController->selectRoom(inputPos);
         }
     }
     if (_gamestate.isPaused()) {
@@ -826,10 +1115,12 @@ void GameScene::update(float dt) {
     // Room swap by drag
     if (usingDrag && !_gamestate.zoomed_in()) {
         if (_input.didPress() && !triedSwap) {
-            _envController->selectRoom(inputPos, _reynardController, _enemies);
+            _envController->selectRoom(inputPos);
         } else if (_input.didEndDrag() && _envController->hasSelected()) {
-            if (_envController->swapWithSelected(inputPos, _reynardController, _enemies)) {
+            if (_envController->swapWithSelected(inputPos)) {
                 AudioController::playSFX(SWAP_SOUND);
+                // Anyone in the swapped rooms moved with them
+                _interpolator->snap();
             } else {
                 AudioController::playSFX(NOSWAP_SOUND);
             }
@@ -880,7 +1171,7 @@ void GameScene::update(float dt) {
     }
 
     if (_reynardController->getCharacter()->getHearts() <= 0) {
-        revert(false);
+        respawn();
         return;
     }
 
@@ -895,11 +1186,16 @@ void GameScene::update(float dt) {
         _envController->zoomOut();
     }
 
-    float scaled_dt = _gamestate.getScaledDtForPhysics(dt);
-    // TODO: Why does both these updates exist you only need the _world one
-    _reynardController->update(scaled_dt);
-    _world->update(scaled_dt);
-    _world->garbageCollect();
+    {
+        CU_PROFILE_ZONE("GameScene::physics");
+        float scaled_dt = _gamestate.getScaledDtForPhysics(dt);
+        // TODO: Why does both these updates exist you only need the _world one
+        _reynardController->update(scaled_dt);
+        _world->update(scaled_dt);
+        _contacts->flush();
+        _world->garbageCollect();
+        _registry->collect();
+    }
 
     // TODO debugging area. Disable for releases
     if ((!_reynardController->getCharacter()->isOnWall()) && abs(_reynardController->getCharacter()->getLinearVelocity().x) <= 0.5) {
@@ -917,79 +1213,173 @@ void GameScene::update(float dt) {
         // CULog("likely Error 02: Reynard jumping slow. See MPGameScene.c update() and breakpoint here");
     }
 
-    // Camera following reynard, with some non-linear smoothing
-    Vec2 currentTranslation = _worldnode->getPaneTransform().getTranslation();
-    Vec2 reynardScreenPosition = _worldnode->getPaneTransform().transform(_reynardController->getSceneNode()->getPosition());
-    //Vec2 reynardScreenPosition = _worldnode->getPaneTransform().transform(_enemies->back()->getSceneNode()->getPosition());
-
-    bool faceRight = _reynardController->getCharacter()->isFacingRight();
-    Vec2 reynardVelocity = _reynardController->getCharacter()->getLinearVelocity();
+    // The rest of the tick runs as a graph of phases, spread across cores wherever they touch different things
+    _tickDt = dt;
+    _dragCoords = progressCoords;
+    _frameGraph->run(_tasks);
 
-    _worldnode->applyPan(_gamestate.getPan(currentTranslation, reynardScreenPosition - scrollingOffset, _scale, getSize(), faceRight, reynardVelocity));
-    _worldnode->applyZoom(_gamestate.getZoom(_worldnode->getZoom()));
-
-    // Copy World's zoom and transform
-    _debugnode->applyPan(-_debugnode->getPaneTransform().transform(Vec2()));
-    _debugnode->applyPan(_worldnode->getPaneTransform().transform(Vec2()) / _scale);
-    _debugnode->applyZoom(1 / _debugnode->getZoom());
-    _debugnode->applyZoom(_worldnode->getZoom());
-
-    // Update all enemies
-    vector<std::shared_ptr<EnemyController>>::iterator itr;
-    for (itr = _enemies->begin(); itr != _enemies->end(); ++itr) {
-        (*itr)->update(dt);
-    }
+    lastFramePos = _input.getPosition();
 
-    // Update the environment
-    _envController->update(progressCoords, !_gamestate.zoomed_in(), _reynardController, _enemies);
+}
 
-    // Update the health UI
-    if (_reynardController->getCharacter()->getHearts() >= 3) {
-        if (_health->getName() != "3") {
-            _health->setTexture("textures/Health_Bar_Full.png");
-            _health->setName("3");
-        }
-    } else if (_reynardController->getCharacter()->getHearts() == 2) {
-        if (_health->getName() != "2") {
-            _health->setTexture("textures/Health_Bar_Two_Third.png");
-            _health->setName("2");
-        }
-    } else if (_reynardController->getCharacter()->getHearts() == 1) {
-        if (_health->getName() != "1") {
-            _health->setTexture("textures/Health_Bar_One_Third.png");
-            _health->setName("1");
-        }
-    } else if (_reynardController->getCharacter()->getHearts() <= 0) {
-        if (_health->getName() != "0") {
-            _health->setTexture("textures/Health_Bar_None.png");
-            _health->setName("0");
+/**
+ * Declares the phases that run after the physics step each tick, along with
+ * what each one reads and writes.
+ *
+ * The phases are added in the order they used to run in, so the frame graph
+ * only ever lets two of them overlap if neither touches what the other
+ * writes. Anything that could make GL calls or play sounds stays on the
+ * main thread.
+ */
+void GameScene::buildFrameGraph() {
+    _frameGraph = FrameGraph::alloc();
+
+    _frameGraph->addPhase("GameScene::camera", RES_REYNARD | RES_GAMESTATE, RES_CAMERA, FrameGraph::Affinity::ANY, [this]() {
+        // Camera following reynard, with some non-linear smoothing
+        Vec2 currentTranslation = _worldnode->getPaneTransform().getTranslation();
+        Vec2 reynardScreenPosition = _worldnode->getPaneTransform().transform(_reynardController->getSceneNode()->getPosition());
+        //Vec2 reynardScreenPosition = _worldnode->getPaneTransform().transform(_enemies->back()->getSceneNode()->getPosition());
+
+        bool faceRight = _reynardController->getCharacter()->isFacingRight();
+        Vec2 reynardVelocity = _reynardController->getCharacter()->getLinearVelocity();
+
+        _worldnode->applyPan(_gamestate.getPan(currentTranslation, reynardScreenPosition - scrollingOffset, _scale, getSize(), faceRight, reynardVelocity));
+        _worldnode->applyZoom(_gamestate.getZoom(_worldnode->getZoom()));
+
+        // Copy World's zoom and transform
+        _debugnode->applyPan(-_debugnode->getPaneTransform().transform(Vec2()));
+        _debugnode->applyPan(_worldnode->getPaneTransform().transform(Vec2()) / _scale);
+        _debugnode->applyZoom(1 / _debugnode->getZoom());
+        _debugnode->applyZoom(_worldnode->getZoom());
+    });
+
+    // Redraw the physics world for debug mode, before the enemies add their raycasts.
+    // This swaps Box2D's debug draw hook, but nothing else in the tick uses it, so it only reads the world
+    _frameGraph->addPhase("GameScene::debugDraw", RES_WORLD, RES_DEBUG, FrameGraph::Affinity::ANY, [this]() {
+        if (!_debug) return;
+        _debugDraw->clear();
+        _debugDraw->addWorld(_world->getWorld());
+    });
+
+    // Work out which enemies can see Reynard before they act on it
+    _frameGraph->addPhase("GameScene::perception", RES_WORLD | RES_GRID | RES_REYNARD | RES_REGISTRY,
+                          RES_ENEMIES | RES_PERCEPTION, FrameGraph::Affinity::ANY, [this]() {
+        _perception->update(_world->getWorld(), _grid, _reynardController, _enemies);
+    });
+
+    // Update the enemies, less often the further they are from Reynard.
+    // Changing how an enemy moves can play a sound, and audio is only safe on the main thread
+    _frameGraph->addPhase("GameScene::enemies", RES_GRID | RES_REYNARD | RES_PERCEPTION,
+                          RES_WORLD | RES_ENEMIES | RES_DEBUG, FrameGraph::Affinity::MAIN, [this]() {
+        _scheduler->update(_tickDt, _grid, _reynardController, _enemies);
+    });
+
+    // Update the environment, which turns rooms and enemies on and off in the physics world
+    // It reads the camera so the rooms it keeps on are the ones the camera shows this tick
+    _frameGraph->addPhase("GameScene::environment", RES_REYNARD | RES_GAMESTATE | RES_CAMERA,
+                          RES_WORLD | RES_GRID | RES_ENEMIES, FrameGraph::Affinity::ANY, [this]() {
+        // The pane only applies its pan and zoom when it draws, so undo them by hand to find the
+        // corners of the screen in the world. getSize() is the display size in scene units, which
+        // is the same scaling inputToGameCoords applies to the pane's translation
+        Affine2 screenToWorld = _worldnode->getPaneTransform().getInverse();
+        _envController->setView(screenToWorld.transform(Vec2::ZERO), screenToWorld.transform(Vec2(getSize())));
+        _envController->update(_dragCoords, !_gamestate.zoomed_in(), _reynardController, _enemies);
+    });
+
+    // Swapping textures can load them, so the HUD stays on the main thread.
+    // It comes before streaming so this thread has something to do while the workers run
+    _frameGraph->addPhase("GameScene::hud", RES_REYNARD, RES_HUD, FrameGraph::Affinity::MAIN, [this]() {
+        // Update the health UI
+        if (_reynardController->getCharacter()->getHearts() >= 3) {
+            if (_health->getName() != "3") {
+                _health->setTexture("textures/Health_Bar_Full.png");
+                _health->setName("3");
+            }
+        } else if (_reynardController->getCharacter()->getHearts() == 2) {
+            if (_health->getName() != "2") {
+                _health->setTexture("textures/Health_Bar_Two_Third.png");
+                _health->setName("2");
+            }
+        } else if (_reynardController->getCharacter()->getHearts() == 1) {
+            if (_health->getName() != "1") {
+                _health->setTexture("textures/Health_Bar_One_Third.png");
+                _health->setName("1");
+            }
+        } else if (_reynardController->getCharacter()->getHearts() <= 0) {
+            if (_health->getName() != "0") {
+                _health->setTexture("textures/Health_Bar_None.png");
+                _health->setName("0");
+            }
         }
-    }
 
-    // Update the key UI
-    if (_reynardController->getKeysCount() >= 3) {
-        if (_keyUI->getName() != "3") {
-            _keyUI->setTexture("textures/keys_three.png");
-            _keyUI->setName("3");
-        }
-    } else if (_reynardController->getKeysCount() == 2) {
-        if (_keyUI->getName() != "2") {
-            _keyUI->setTexture("textures/keys_two.png");
-            _keyUI->setName("2");
+        // Update the key UI
+        if (_reynardController->getKeysCount() >= 3) {
+            if (_keyUI->getName() != "3") {
+                _keyUI->setTexture("textures/keys_three.png");
+                _keyUI->setName("3");
+            }
+        } else if (_reynardController->getKeysCount() == 2) {
+            if (_keyUI->getName() != "2") {
+                _keyUI->setTexture("textures/keys_two.png");
+                _keyUI->setName("2");
+            }
+        } else if (_reynardController->getKeysCount() == 1) {
+            if (_keyUI->getName() != "1") {
+                _keyUI->setTexture("textures/keys_one.png");
+                _keyUI->setName("1");
+            }
+        } else if (_reynardController->getKeysCount() <= 0) {
+            if (_keyUI->getName() != "0") {
+                _keyUI->setTexture("textures/keys_none.png");
+                _keyUI->setName("0");
+            }
         }
-    } else if (_reynardController->getKeysCount() == 1) {
-        if (_keyUI->getName() != "1") {
-            _keyUI->setTexture("textures/keys_one.png");
-            _keyUI->setName("1");
+    });
+
+    // Bring in and take out enemies as their regions come and go
+    _frameGraph->addPhase("GameScene::streaming", RES_REYNARD | RES_GRID,
+                          RES_WORLD | RES_ENEMIES | RES_PERCEPTION | RES_REGISTRY | RES_SCENE,
+                          FrameGraph::Affinity::MAIN, [this]() {
+        streamEnemies();
+    });
+}
+
+/**
+ * Returns a hash of the state of the simulation, from the positions and
+ * velocities of Reynard and the enemies. Two runs that have played out
+ * the same way have the same hash.
+ *
+ * @return the hash of the simulation state
+ */
+Uint32 GameScene::getStateHash() {
+    Uint32 hash = 2166136261u;
+    auto add = [&hash](float value) {
+        Uint32 bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 4; i++) {
+            hash ^= (bits >> (8 * i)) & 0xFF;
+            hash *= 16777619u;
         }
-    } else if (_reynardController->getKeysCount() <= 0) {
-        if (_keyUI->getName() != "0") {
-            _keyUI->setTexture("textures/keys_none.png");
-            _keyUI->setName("0");
+    };
+
+    if (_reynardController != nullptr) {
+        shared_ptr<ReynardModel> reynard = _reynardController->getCharacter();
+        add(reynard->getPosition().x);
+        add(reynard->getPosition().y);
+        add(reynard->getLinearVelocity().x);
+        add(reynard->getLinearVelocity().y);
+        add(reynard->getHearts());
+    }
+    if (_enemies != nullptr) {
+        for (auto itr = _enemies->begin(); itr != _enemies->end(); ++itr) {
+            shared_ptr<EnemyModel> enemy = (*itr)->getCharacter();
+            add(enemy->getPosition().x);
+            add(enemy->getPosition().y);
+            add(enemy->getLinearVelocity().x);
+            add(enemy->getLinearVelocity().y);
         }
     }
-    lastFramePos = _input.getPosition();
-
+    return hash;
 }
 
 #pragma mark -
@@ -1011,30 +1401,30 @@ bool GameScene::isEnemyDetectFixture(b2Fixture *fixture) {
     return (fixture->GetUserData().pointer == 10);
 }
 
-b2Fixture *GameScene::getReynardFixture(b2Contact *contact) {
+b2Fixture *GameScene::getReynardFixture(const ContactEvent &contact) {
     // We assume that you have checked to see that at least
     // one of the bodies in the contact event have been
     // verified to be a Reynard object
     // assert(isReynardCollision(contact))
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
+    b2Body *body1 = contact.GetFixtureA()->GetBody();
+    b2Body *body2 = contact.GetFixtureB()->GetBody();
     if (body1 == _reynardController->getCharacter()->getBody() ||
             body2 == _reynardController->getCharacter()->getBody()) {
-        return contact->GetFixtureA();
+        return contact.GetFixtureA();
     } else {
-        return contact->GetFixtureB();
+        return contact.GetFixtureB();
     }
 }
 
-b2Fixture *GameScene::getEnemyFixture(b2Contact *contact) {
+b2Fixture *GameScene::getEnemyFixture(const ContactEvent &contact) {
     // TODO this function is not right. Also what if both are enemies?
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
+    b2Body *body1 = contact.GetFixtureA()->GetBody();
+    b2Body *body2 = contact.GetFixtureB()->GetBody();
     if (body1 == _reynardController->getCharacter()->getBody() ||
             body2 == _reynardController->getCharacter()->getBody()) {
-        return contact->GetFixtureA();
+        return contact.GetFixtureA();
     } else {
-        return contact->GetFixtureB();
+        return contact.GetFixtureB();
     }
 }
 
@@ -1046,31 +1436,18 @@ b2Fixture *GameScene::getEnemyFixture(b2Contact *contact) {
 * @return  trap type if one body is a trap
         or UNTYPED if neither body is a trap
 */
-shared_ptr<TrapModel> GameScene::isTrapCollision(b2Contact *contact) {
-    if (_grid == nullptr)
-        return nullptr;
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
-    shared_ptr<RoomModel> room;
-    for (int col = 0; col < _grid->getWidth(); col++) {
-        for (int row = 0; row < _grid->getHeight(); row++) {
-            room = _grid->getRoom(col, row);
-            if (room != nullptr && room->getTrap() != nullptr) {
-                shared_ptr<TrapModel> _trap = _grid->getRoom(col, row)->getTrap();
-                b2Body *body = _trap->getObstacle()->getBody();
-                bool isCollision = body == body1 || body == body2;
-                if (isCollision)
-                    return _trap;
-            }
-        }
+shared_ptr<TrapModel> GameScene::isTrapCollision(const ContactEvent &contact) {
+    const EntityRegistry::Entity *entity = _registry->get(contact.GetFixtureA()->GetBody());
+    if (entity == nullptr || entity->type != EntityRegistry::EntityType::TRAP) {
+        entity = _registry->get(contact.GetFixtureB()->GetBody());
     }
-    return nullptr;
+    if (entity == nullptr || entity->type != EntityRegistry::EntityType::TRAP) return nullptr;
+    return entity->trap;
 }
 
-bool GameScene::isReynardCollision(b2Contact *contact) {
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
-    return body1 == _reynardController->getCharacter()->getBody() || body2 == _reynardController->getCharacter()->getBody();
+bool GameScene::isReynardCollision(const ContactEvent &contact) {
+    return _registry->getType(contact.GetFixtureA()->GetBody()) == EntityRegistry::EntityType::REYNARD
+           || _registry->getType(contact.GetFixtureB()->GetBody()) == EntityRegistry::EntityType::REYNARD;
 }
 
 /**
@@ -1080,19 +1457,7 @@ bool GameScene::isReynardCollision(b2Contact *contact) {
  * @return      Whether the given body belongs to a character in the scene
  */
 bool GameScene::isCharacterBody(b2Body *body) {
-    if (_reynardController != nullptr) {
-        // Return true if it's Reynard
-        if (body == _reynardController->getCharacter()->getBody())
-            return true;
-    }
-    // Otherwise check against the enemies and return true if it's one of them
-    for (auto itr = _enemies->begin(); itr != _enemies->end(); ++itr) {
-        if ((*itr)->getCharacter()->getBody() == body)
-            return true;
-    }
-
-    // If not, return false
-    return false;
+    return _registry->isCharacter(body);
 }
 
 /**
@@ -1102,9 +1467,9 @@ bool GameScene::isCharacterBody(b2Body *body) {
  * @param contact   Contact event generated by beginContact / endContact callbacks
  * @return          Pointer to the character's body, or nullptr if collision isn't character-on-object
  */
-b2Body *GameScene::getCharacterBodyInObjectCollision(b2Contact *contact) {
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
+b2Body *GameScene::getCharacterBodyInObjectCollision(const ContactEvent &contact) {
+    b2Body *body1 = contact.GetFixtureA()->GetBody();
+    b2Body *body2 = contact.GetFixtureB()->GetBody();
 
     //// Only characters have their body user data set to something nonzero
     //// Thus, it's a character-on-object collision if only one of these bodies has nonzero user data
@@ -1130,7 +1495,7 @@ b2Body *GameScene::getCharacterBodyInObjectCollision(b2Contact *contact) {
  * @param body  The body of the character to get the controller for
  * @return      Pointer to Reynard's controller if he's in the collision, or nullptr otherwise
  */
-shared_ptr<EnemyController> GameScene::getEnemyControllerInCollision(b2Contact *contact) {
+shared_ptr<EnemyController> GameScene::getEnemyControllerInCollision(const ContactEvent &contact) {
     //// Get body user data and convert to BodyData
     // CharacterController<EnemyModel, EnemyController>::BodyData* bodyData =
     //     static_cast<CharacterController<EnemyModel, EnemyController>::BodyData*>
@@ -1145,26 +1510,26 @@ shared_ptr<EnemyController> GameScene::getEnemyControllerInCollision(b2Contact *
 
     // return make_shared<EnemyController>(*enemyPtr);
 
-    // Check body against all enemies in level
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
-    for (auto itr = _enemies->begin(); itr != _enemies->end(); ++itr) {
-        if (((*itr)->getCharacter()->getBody() == body1) || ((*itr)->getCharacter()->getBody() == body2))
-            return (*itr);
+    // Look up what each body belongs to
+    const EntityRegistry::Entity *entity = _registry->get(contact.GetFixtureA()->GetBody());
+    if (entity == nullptr || entity->type != EntityRegistry::EntityType::ENEMY) {
+        entity = _registry->get(contact.GetFixtureB()->GetBody());
     }
 
     // If not an enemy, return nullptr
-    return nullptr;
+    if (entity == nullptr || entity->type != EntityRegistry::EntityType::ENEMY
+        || _enemies == nullptr || entity->index < 0 || entity->index >= (int)_enemies->size()) return nullptr;
+    return (*_enemies)[entity->index];
 }
 
-bool GameScene::isThisAReynardWallContact(b2Contact *contact, bool reynardIsRight) {
+bool GameScene::isThisAReynardWallContact(const ContactEvent &contact, bool reynardIsRight) {
     b2Fixture *reynardFixture;
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
+    b2Body *body1 = contact.GetFixtureA()->GetBody();
+    b2Body *body2 = contact.GetFixtureB()->GetBody();
     if (body1 == _reynardController->getCharacter()->getBody()) {
-        reynardFixture = contact->GetFixtureA();
+        reynardFixture = contact.GetFixtureA();
     } else {
-        reynardFixture = contact->GetFixtureB();
+        reynardFixture = contact.GetFixtureB();
     }
     if (reynardIsRight && isCharacterRightFixture(reynardFixture)) {
         return true;
@@ -1172,14 +1537,14 @@ bool GameScene::isThisAReynardWallContact(b2Contact *contact, bool reynardIsRigh
         return !reynardIsRight && isCharacterLeftFixture(reynardFixture);
 }
 
-bool GameScene::isThisAEnemyWallContact(b2Contact *contact, bool enemyIsRight, shared_ptr<EnemyController> enemy) {
+bool GameScene::isThisAEnemyWallContact(const ContactEvent &contact, bool enemyIsRight, shared_ptr<EnemyController> enemy) {
     b2Fixture *enemyFixture;
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
+    b2Body *body1 = contact.GetFixtureA()->GetBody();
+    b2Body *body2 = contact.GetFixtureB()->GetBody();
     if (body1 == enemy->getCharacter()->getBody()) {
-        enemyFixture = contact->GetFixtureA();
+        enemyFixture = contact.GetFixtureA();
     } else {
-        enemyFixture = contact->GetFixtureB();
+        enemyFixture = contact.GetFixtureB();
     }
     if (enemyIsRight && isCharacterRightFixture(enemyFixture)) {
         return true;
@@ -1187,26 +1552,26 @@ bool GameScene::isThisAEnemyWallContact(b2Contact *contact, bool enemyIsRight, s
         return !enemyIsRight && isCharacterLeftFixture(enemyFixture);
 }
 
-bool GameScene::isThisAEnemyGroundContact(b2Contact *contact, shared_ptr<EnemyController> enemy) {
+bool GameScene::isThisAEnemyGroundContact(const ContactEvent &contact, shared_ptr<EnemyController> enemy) {
     b2Fixture *enemyFixture;
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
+    b2Body *body1 = contact.GetFixtureA()->GetBody();
+    b2Body *body2 = contact.GetFixtureB()->GetBody();
     if (body1 == enemy->getCharacter()->getBody()) {
-        enemyFixture = contact->GetFixtureA();
+        enemyFixture = contact.GetFixtureA();
     } else {
-        enemyFixture = contact->GetFixtureB();
+        enemyFixture = contact.GetFixtureB();
     }
     return isCharacterGroundFixture(enemyFixture);
 }
 
-bool GameScene::isThisAReynardGroundContact(b2Contact *contact) {
+bool GameScene::isThisAReynardGroundContact(const ContactEvent &contact) {
     b2Fixture *reynardFixture;
-    b2Body *body1 = contact->GetFixtureA()->GetBody();
-    b2Body *body2 = contact->GetFixtureB()->GetBody();
+    b2Body *body1 = contact.GetFixtureA()->GetBody();
+    b2Body *body2 = contact.GetFixtureB()->GetBody();
     if (body1 == _reynardController->getCharacter()->getBody()) {
-        reynardFixture = contact->GetFixtureA();
+        reynardFixture = contact.GetFixtureA();
     } else {
-        reynardFixture = contact->GetFixtureB();
+        reynardFixture = contact.GetFixtureB();
     }
     return isCharacterGroundFixture(reynardFixture);
 }
@@ -1263,7 +1628,7 @@ void GameScene::resolveEnemyWallJumpOntoTrap(float enemyVY, shared_ptr<EnemyCont
     //    enemy->getCharacter()->setVY(-1 * enemyVY);
 }
 
-void GameScene::beginContact(b2Contact *contact) {
+void GameScene::beginContact(const ContactEvent &contact) {
     // TODO: all of these collisions need to apply for every character, not just Reynard
     // Try to get the character, assuming it's a character-on-object collision
     b2Body *charInCharOnObject = getCharacterBodyInObjectCollision(contact);
@@ -1275,33 +1640,20 @@ void GameScene::beginContact(b2Contact *contact) {
 #pragma mark REYNARD COLLISION SECTION
         if (enemy == nullptr) {
             // KEY COLLISIONS
-            if (_keys.size() > 0 || _keysCrazy.size() > 0) {
-                b2Body *body1 = contact->GetFixtureA()->GetBody();
-                b2Body *body2 = contact->GetFixtureB()->GetBody();
-                b2Body *kBody;
-
-                // Regular keys
-                for (int i = 0; i < _keys.size(); i++) {
-                    shared_ptr<CheckpointKey> k = _keys.at(i);
-                    kBody = k->getBody();
-                    if (kBody == body1 || kBody == body2) {
-                        // Only remove the key if Reynard successfully picks it up
-                        if (_reynardController->pickupKey(k->getID())) removeKey(k);
-                            // Otherwise turn it into a regular key
-                        else {k->setIsPathFinding(false);}
-                    }
-                }
-
-                // Now do possessed keys
-                for (int i = 0; i < _keysCrazy.size(); i++) {
-                    shared_ptr<CheckpointKeyCrazy> k = _keysCrazy.at(i);
-                    kBody = k->getBody();
-                    if (kBody == body1 || kBody == body2) {
-                        // Only remove the key if Reynard successfully picks it up
-                        if (_reynardController->pickupKey(k->getID())) removeKeyCrazy(k);
-                    }
-                }
-
+            b2Body *other = (charInCharOnObject == contact.GetFixtureA()->GetBody())
+                            ? contact.GetFixtureB()->GetBody() : contact.GetFixtureA()->GetBody();
+            const EntityRegistry::Entity *otherEntity = _registry->get(other);
+            if (otherEntity != nullptr && otherEntity->type == EntityRegistry::EntityType::KEY) {
+                // Hold on to the key, since removing it releases the entity
+                shared_ptr<CheckpointKey> k = otherEntity->key;
+                // Only remove the key if Reynard successfully picks it up
+                if (_reynardController->pickupKey(k->getID())) removeKey(k);
+                    // Otherwise turn it into a regular key
+                else {k->setIsPathFinding(false);}
+            } else if (otherEntity != nullptr && otherEntity->type == EntityRegistry::EntityType::POSSESSED_KEY) {
+                shared_ptr<CheckpointKeyCrazy> k = otherEntity->possessedKey;
+                // Only remove the key if Reynard successfully picks it up
+                if (_reynardController->pickupKey(k->getID())) removeKeyCrazy(k);
             }
             bool reynardIsRight = _reynardController->getCharacter()->isFacingRight();
 #pragma mark TRAP COLLISION CODE
@@ -1329,11 +1681,8 @@ void GameScene::beginContact(b2Contact *contact) {
                 if (!cp->isLocked() || (cp->isLocked() && _reynardController->getKeysCount() > 0)) {
 
                     _checkpointSwapLen = static_cast<int>(_envController->getSwapHistory().size());
-                    _checkpointEnemyPos = vector<Vec2>();
+                    _checkpointEnemyPos = getEnemyPositions();
                     _checkpointReynardPos = _reynardController->getCharacter()->getPosition();
-                    for (auto thisEnemy: *_enemies) {
-                        _checkpointEnemyPos.push_back(thisEnemy->getCharacter()->getPosition());
-                    }
 
                     // Only use a key if the checkpoint isn't already activated and it needs a key
                     if (!trap->isActivated() && cp->isLocked()) _reynardController->useKey();
@@ -1354,6 +1703,7 @@ void GameScene::beginContact(b2Contact *contact) {
                         }
                     }
                     rewriteSaveFile();
+                    captureSnapshot();
                 }
             } else if (trapType == TrapModel::TrapType::GOAL) {
                 setComplete(true);
@@ -1411,8 +1761,8 @@ void GameScene::beginContact(b2Contact *contact) {
     }
         //// Random key collisions
         //else if (_keys.size()>0 || _keysCrazy.size()>0) {
-        //    b2Body *body1 = contact->GetFixtureA()->GetBody();
-        //    b2Body *body2 = contact->GetFixtureB()->GetBody();
+        //    b2Body *body1 = contact.GetFixtureA()->GetBody();
+        //    b2Body *body2 = contact.GetFixtureB()->GetBody();
         //
         //    for (int i = 0; i < _keys.size(); i++){
         //        shared_ptr<CheckpointKey> k = _keys.at(i);
@@ -1442,7 +1792,7 @@ void GameScene::beginContact(b2Contact *contact) {
     }
 }
 
-void GameScene::endContact(b2Contact *contact) {
+void GameScene::endContact(const ContactEvent &contact) {
     b2Body *charInCharOnObject = getCharacterBodyInObjectCollision(contact);
     if (charInCharOnObject != 0) {
         // Now try to get if it's an enemy-on-object collision
@@ -1539,10 +1889,9 @@ Size GameScene::computeActiveSize() const {
 }
 
 void GameScene::dealReynardDamage() {
-    std::chrono::duration<float> diff = std::chrono::system_clock::now() - _lastHurt;
-    if (diff.count() > 3) {
+    if (SimClock::now() - _lastHurt > 3) {
         _reynardController->getCharacter()->setHearts(_reynardController->getCharacter()->getHearts() - SPIKE_DAMAGE);
-        _lastHurt = std::chrono::system_clock::now();
+        _lastHurt = SimClock::now();
         _reynardController->getSceneNode()->setColor(Color4(255, 80, 80, 255));
         keepRedFrames = 5;
     }
@@ -1550,12 +1899,20 @@ void GameScene::dealReynardDamage() {
 
 /**
  * Render the scene. As this class is a scene and have many child node, calling super render will be enough
- * A placeholder for future usage.
+ * Moving bodies and the camera are drawn partway between the last two ticks, by how much
+ * time has passed since the last one, and put back once the scene is drawn.
  * @param batch The SpriteBatch to draw with.
-
  */
 void GameScene::render(const std::shared_ptr<SpriteBatch> &batch) {
+    CU_PROFILE_ZONE("GameScene::render");
+#ifdef CU_PROFILE
+    if (_debug) _profileNode->setText(Profiler::getSummary());
+#endif
+    // Draw partway through the tick that the time left over is heading into
+    float alpha = (_fixedStep ? _accumulator / FIXED_STEP : 1.0f);
+    _interpolator->begin(alpha);
     Scene2::render(batch);
+    _interpolator->end();
 }
 
 /* Converts input coordinates to coordinates in the game world */
@@ -1578,6 +1935,11 @@ void GameScene::createKey(Vec2 pos, bool isPossesed, bool isPathFinding) {
         n->setScale(.2);
         k->setIsPathFinding(isPathFinding);
         _keysCrazy.push_back(k);
+
+        EntityRegistry::Entity entity;
+        entity.type = EntityRegistry::EntityType::POSSESSED_KEY;
+        entity.possessedKey = k;
+        _registry->add(k, entity);
     } else {
         std::shared_ptr<CheckpointKey> k = CheckpointKey::alloc(Vec2(0, 0), Size(1.0f, 1.0f));
         k->setSceneNode(n);
@@ -1588,6 +1950,11 @@ void GameScene::createKey(Vec2 pos, bool isPossesed, bool isPathFinding) {
         k->setIsPathFinding(isPathFinding);
         _keys.push_back(k);
 
+        EntityRegistry::Entity entity;
+        entity.type = EntityRegistry::EntityType::KEY;
+        entity.key = k;
+        _registry->add(k, entity);
+
         //CULog("Position: (%f, %f)", pos.x, pos.y);
     }
 }
@@ -1600,6 +1967,7 @@ void GameScene::removeKey(shared_ptr<CheckpointKey> k) {
     while (itr != _keys.end()) {
         if ((*itr) == k && (*itr) != nullptr && !((*itr)->isRemoved())) {
             _worldnode->removeChild(k->getSceneNode());
+            _registry->release(*itr);
             (*itr)->markRemoved(true);
             itr = _keys.erase(itr);
         } else {
@@ -1616,8 +1984,11 @@ void GameScene::removeKeyCrazy(shared_ptr<CheckpointKeyCrazy> k) {
     while (itr != _keysCrazy.end()) {
         if ((*itr) == k && (*itr) != nullptr && !((*itr)->isRemoved())) {
             _worldnode->removeChild(k->getSceneNode());
+            _registry->release(*itr);
             (*itr)->markRemoved(true);
             itr = _keysCrazy.erase(itr);
+        } else {
+            ++itr;
         }
     }
 }
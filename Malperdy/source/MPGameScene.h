@@ -30,6 +30,17 @@
 #include "MPEnvController.h"
 #include "MPAudioController.h"
 #include "MPTutorial.hpp"
+#include "MPCheckpointSnapshot.h"
+#include "MPSaveFile.h"
+#include "MPEntityRegistry.h"
+#include "MPContactQueue.h"
+#include "MPEnemyPerception.h"
+#include "MPEnemyScheduler.h"
+#include "MPDebugDraw.h"
+#include "MPInputRecording.h"
+#include "MPSimClock.h"
+#include "MPRenderInterpolator.h"
+#include "MPFrameGraph.h"
 
 /** Reynard's start location */
 // y-position is approx 6 * y-origin of first region
@@ -42,6 +53,35 @@
 #define ROOM_WIDTH 12
 #define ROOM_HEIGHT 8
 
+/** The length of a single tick of the simulation, in seconds */
+#define FIXED_STEP (1.0f / 60.0f)
+/** The most ticks run in a single frame, so a long frame can't make the next one longer */
+#define MAX_STEPS_PER_FRAME 5
+
+// What the phases of a tick read and write, so the frame graph knows which can overlap
+/** The Box2D world and every body in it */
+#define RES_WORLD       0x0001
+/** The grid, its rooms, fog and occupancy */
+#define RES_GRID        0x0002
+/** Reynard's controller, model and scene node */
+#define RES_REYNARD     0x0004
+/** The enemies in the game world, their scene nodes and the enemy scheduler */
+#define RES_ENEMIES     0x0008
+/** What each enemy can see */
+#define RES_PERCEPTION  0x0010
+/** The pan and zoom of the world and debug panes */
+#define RES_CAMERA      0x0020
+/** The game state controller */
+#define RES_GAMESTATE   0x0040
+/** The debug draw */
+#define RES_DEBUG       0x0080
+/** The entity registry */
+#define RES_REGISTRY    0x0100
+/** Which nodes are in the scene graph */
+#define RES_SCENE       0x0200
+/** The health bar and key count */
+#define RES_HUD         0x0400
+
 /**
  * This class is the primary gameplay constroller for the demo.
  *
@@ -70,9 +110,17 @@ protected:
 
     /** Reference to the debug root of the scene graph */
     std::shared_ptr<cugl::scene2::ScrollPane> _debugnode;
+    /** Draws physics outlines, contacts and raycasts each frame while debug mode is on */
+    std::shared_ptr<DebugDraw> _debugDraw;
+    /** Draws moving bodies and the camera partway between ticks */
+    std::shared_ptr<RenderInterpolator> _interpolator;
 
     /** Reference to the win root of the scene graph */
     std::shared_ptr<cugl::scene2::Label> _winNode;
+#ifdef CU_PROFILE
+    /** Shows the profiler summary while debug mode is on */
+    std::shared_ptr<cugl::scene2::Label> _profileNode;
+#endif
 
     /** Reference to the health bar scene node */
     std::shared_ptr<cugl::scene2::PolygonNode> _health;
@@ -99,9 +147,56 @@ protected:
     /** Mark set to handle more sophisticated collision callbacks */
     std::unordered_set<b2Fixture *> _sensorFixtures;
 
-    /** References to all the enemy controllers */
+    /** An enemy in the level, whether or not it is in the game world right now */
+    struct EnemySpawn {
+        /** The region the enemy is in, which decides when it is in the game world */
+        int region = NO_REGION;
+        /** Whether this enemy drops a key on death */
+        bool keyed = false;
+        /** The enemy's controller while it is in the game world, or nullptr otherwise */
+        std::shared_ptr<EnemyController> enemy;
+        /** The enemy's state when it was last taken out of the game world, in PHYSICS space */
+        CheckpointSnapshot::CharacterState state;
+        /** What the enemy was doing when it was last taken out of the game world */
+        EnemyModel::BehaviorState behavior = EnemyModel::BehaviorState::PATROLLING;
+    };
+
+    /** References to the controllers of the enemies in the game world, in spawn order */
     std::shared_ptr<vector<std::shared_ptr<EnemyController>>> _enemies;
 
+    /** Every enemy in the level, in spawn order */
+    vector<EnemySpawn> _enemySpawns;
+
+    /** Controllers of enemies that were taken out of the game world, ready to be reused */
+    vector<std::shared_ptr<EnemyController>> _enemyPool;
+
+    /** The regions whose enemies are in the game world */
+    vector<std::shared_ptr<RegionModel>> _populatedRegions;
+
+    /** The animations shared by every enemy */
+    std::shared_ptr<Animation> _rabbitAnimations;
+
+    /** What each body in the physics world belongs to, for classifying contacts */
+    std::shared_ptr<EntityRegistry> _registry;
+
+    /** Contacts from the last physics step, waiting to be handled */
+    std::shared_ptr<ContactQueue> _contacts;
+
+    /** Line of sight from every enemy to Reynard */
+    std::shared_ptr<EnemyPerception> _perception;
+
+    /** Decides how often each enemy gets updated */
+    std::shared_ptr<EnemyScheduler> _scheduler;
+
+    /** The worker threads that the end of each tick is spread across */
+    std::shared_ptr<cugl::TaskScheduler> _tasks;
+    /** The phases at the end of each tick, and what each one reads and writes */
+    std::shared_ptr<FrameGraph> _frameGraph;
+    /** The length of the tick being run, for the frame graph */
+    float _tickDt = 0;
+    /** Where the room being dragged is this tick, or (-1,-1) if there is none, for the frame graph */
+    Vec2 _dragCoords = Vec2(-1, -1);
+
     /** References to all the tutorials */
     std::shared_ptr<vector<std::shared_ptr<Tutorial>>> _tutorials;
 
@@ -116,6 +211,8 @@ protected:
 
     vector<int> _checkpointActivatedCheckpoints;
     vector<Vec2> _checkpointEnemyPos;
+    /** The fog of war bitmap of the grid at the last checkpoint, or empty if there is none */
+    vector<Uint8> _checkpointFog;
 
     /** A store position of reynard before reset*/
     Vec2 _checkpointReynardPos = REYNARD_START;
@@ -126,6 +223,9 @@ protected:
     /** A store position of room swapping history */
     vector<vector<Vec2>> _swapHistory;
 
+    /** Everything needed to respawn at the last checkpoint without rebuilding the level */
+    shared_ptr<CheckpointSnapshot> _snapshot;
+
     /**Workaround for wall jump corner stuck*/
     int corner_num_frames_workaround = 0;
 
@@ -146,6 +246,16 @@ protected:
     /** Whether we're showing the region exit or not */
     bool showingRegExit = false;
 
+    /** Whether the game is being run without a player, with scripted input */
+    bool _headless = false;
+
+    /** Whether the simulation runs in ticks of FIXED_STEP, rather than once a frame */
+    bool _fixedStep = true;
+    /** Time that has passed but not been simulated yet, in seconds */
+    float _accumulator = 0;
+    /** The input for every tick since init(), or nullptr if the session isn't recorded */
+    shared_ptr<InputRecording> _recording;
+
 public:
 
     /*
@@ -157,6 +267,93 @@ public:
         _mode = mode;
     }
 
+    /**
+     * Sets whether the game runs without anyone watching or playing it, as a
+     * test driver does. This must be called before init().
+     *
+     * Headless, input comes from a script given through getInput(), instead of
+     * from the mouse, keyboard or touchscreen. Audio is skipped whenever there
+     * is no audio engine, so a headless driver should not start one, and it
+     * should never call render().
+     *
+     * @param value Whether the game is headless
+     */
+    void setHeadless(bool value) {
+        _headless = value;
+    }
+
+    /**
+     * Returns whether the game runs without anyone watching or playing it.
+     *
+     * @return whether the game is headless
+     */
+    bool isHeadless() const {
+        return _headless;
+    }
+
+    /**
+     * Returns the input controller, so that a headless driver can give it a script.
+     *
+     * @return the input controller
+     */
+    InputController &getInput() {
+        return _input;
+    }
+
+    /**
+     * Sets whether the simulation runs in ticks of FIXED_STEP. With a fixed
+     * step, update() runs however many ticks fit in the time that has passed,
+     * so the game plays out the same no matter the frame rate. Otherwise it
+     * runs a single tick of however long the frame was.
+     *
+     * Only a session with a fixed step can be replayed.
+     *
+     * @param value Whether the simulation has a fixed step
+     */
+    void setFixedStep(bool value) {
+        _fixedStep = value;
+        _accumulator = 0;
+    }
+
+    /**
+     * Returns whether the simulation runs in ticks of FIXED_STEP.
+     *
+     * @return whether the simulation has a fixed step
+     */
+    bool isFixedStep() const {
+        return _fixedStep;
+    }
+
+    /**
+     * Sets whether the input of every tick is recorded, so that the session
+     * can be replayed. This must be called before init(), which starts the
+     * recording over.
+     *
+     * @param value Whether to record the session
+     */
+    void setRecording(bool value) {
+        _recording = (value ? InputRecording::alloc() : nullptr);
+    }
+
+    /**
+     * Returns the recording of the session since init(), or nullptr if the
+     * session isn't being recorded.
+     *
+     * @return the recording of the session
+     */
+    shared_ptr<InputRecording> getRecording() const {
+        return _recording;
+    }
+
+    /**
+     * Returns a hash of the state of the simulation, from the positions and
+     * velocities of Reynard and the enemies. Two runs that have played out
+     * the same way have the same hash.
+     *
+     * @return the hash of the simulation state
+     */
+    Uint32 getStateHash();
+
     void pause() {
         _gamestate.pause();
     }
@@ -164,9 +361,9 @@ public:
 protected:
 
     /**
-     * Last time reynard hurt
+     * Simulation time reynard was last hurt
      */
-    std::chrono::time_point<std::chrono::system_clock> _lastHurt = std::chrono::system_clock::now();
+    double _lastHurt = 0;
 
 
 #pragma mark Internal Object Management
@@ -194,12 +391,15 @@ protected:
     void populateReynard();
 
     /**
-     * Places all the enemies for the active regions in the game world.
+     * Sets up every enemy in the level, and places the ones for the active
+     * regions in the game world. The rest are only placed once their region
+     * becomes active.
      */
     void populateEnemies();
 
     /**
-     * Places the enemies for the given region in the game world.
+     * Places the enemies for the given region in the game world, picking up
+     * where each of them left off the last time the region was active.
      * 
      * Allows us to populate enemies on a per-region basis, instead
      * of loading them all in at once and potentially causing runtime
@@ -209,6 +409,50 @@ protected:
      */
     void populateEnemiesInRegion(shared_ptr<RegionModel> region);
 
+    /**
+     * Takes the enemies for the given region out of the game world, keeping
+     * their state so they pick up where they left off when the region is
+     * populated again. Their controllers go back in the pool.
+     *
+     * @param region    The region to take the enemies out of.
+     */
+    void depopulateEnemiesInRegion(shared_ptr<RegionModel> region);
+
+    /**
+     * Takes the given enemy out of the game world, keeping its state so it
+     * picks up where it left off when its region is populated again. Its
+     * controller goes back in the pool.
+     *
+     * @param spawn     The enemy to take out of the game world.
+     */
+    void depopulateEnemy(EnemySpawn &spawn);
+
+    /**
+     * Populates the enemies for every region that has become active, and
+     * depopulates the ones for every region that is no longer active.
+     *
+     * Each enemy goes with the region it is in now, so one that wandered out
+     * of its spawn region is only taken out with the region it is in.
+     */
+    void streamEnemies();
+
+    /**
+     * Returns the number of the region at the given position, or NO_REGION if
+     * the position isn't in one.
+     *
+     * @param position  The position in PHYSICS space
+     * @return          The number of the region at the position
+     */
+    int getRegionAt(Vec2 position);
+
+    /**
+     * Returns the position of every enemy in the level in PHYSICS space, in
+     * spawn order, whether or not it is in the game world right now.
+     *
+     * @return  The position of every enemy
+     */
+    vector<Vec2> getEnemyPositions();
+
     /**
      * Place all the tutorials at their correct locations in Region 1.
      */
@@ -225,135 +469,36 @@ protected:
 public:
     /**
      * Save all the states of the game to a file
+     *
+     * The file is written in the background, so this doesn't hold up the frame.
      */
     void rewriteSaveFile() {
-        //Init a JSON file
-        vector<std::string> file_path_list = vector<std::string>(2);
-        file_path_list[0] = Application::get()->getSaveDirectory();
-        file_path_list[1] = "state.json";
-        if (filetool::file_exists(cugl::filetool::join_path(file_path_list))) {
-            cugl::filetool::file_delete(cugl::filetool::join_path(file_path_list));
-        }
-        shared_ptr<JsonWriter> jw = JsonWriter::alloc(cugl::filetool::join_path(file_path_list));
-        if (jw == nullptr) {
-            CULog("GameScene.h: Saving failed");
-            return;
-        }
-
-        /**
-         * JSON structure:
-         * "state.json"
-         *  - "EnemyPos" :      [enemy1Pos's x, enemy1Pos's y, ...]
-         *  - "ReynardPos" :    [reynardPos's x, reynardPos's y]
-         *  - "RoomSwap" :     [Swap1-Room1-x, Swap1-Room1-y, Swap1-Room2-x, Swap1-Room2-y, Swap2....]
-         */
-        //Init json objects
-        std::shared_ptr<JsonValue> jsonRoot = JsonValue::alloc(JsonValue::Type::ObjectType);
-        jsonRoot->initObject();
-
-        // JSON - Enemy
-        std::shared_ptr<JsonValue> jsonEnemyPos = JsonValue::alloc(JsonValue::Type::ArrayType);
-        jsonEnemyPos->initArray();
-        for (auto thisEnemy: *_enemies) {
-            jsonEnemyPos->appendValue(thisEnemy->getCharacter()->getPosition().x);
-            jsonEnemyPos->appendValue(thisEnemy->getCharacter()->getPosition().y);
-        }
-        jsonRoot->appendChild("EnemyPos", jsonEnemyPos);
-
-        // JSON - Reynard
-        std::shared_ptr<JsonValue> jsonReynardPos = JsonValue::alloc(JsonValue::Type::ArrayType);
-        jsonReynardPos->initArray();
-        jsonReynardPos->appendValue(_reynardController->getCharacter()->getPosition().x);
-        jsonReynardPos->appendValue(_reynardController->getCharacter()->getPosition().y);
-        jsonRoot->appendChild("ReynardPos", jsonReynardPos);
-
-        // JSON - Checkpoint
-        std::shared_ptr<JsonValue> jsonCheckpoints = JsonValue::alloc(JsonValue::Type::ArrayType);
-        for (int i: _checkpointActivatedCheckpoints) {
-            float fi = i;
-            jsonCheckpoints->appendValue(fi);
-        }
-        jsonRoot->appendChild("ActivatedCheckpoints", jsonCheckpoints);
-
-        // JSON - Room Swapping
-        std::shared_ptr<JsonValue> jsonRoomSwap = JsonValue::alloc(JsonValue::Type::ArrayType);
-        jsonRoomSwap->initArray();
-        int hisotoryLen = static_cast<int>(_envController->getSwapHistory().size());
-        for (int i = 0; i < hisotoryLen; i++) {
-            jsonRoomSwap->appendValue(_envController->getSwapHistory()[i][0].x);
-            jsonRoomSwap->appendValue(_envController->getSwapHistory()[i][0].y);
-            jsonRoomSwap->appendValue(_envController->getSwapHistory()[i][1].x);
-            jsonRoomSwap->appendValue(_envController->getSwapHistory()[i][1].y);
-        }
-        jsonRoot->appendChild("RoomSwap", jsonRoomSwap);
-
-        // Save JSON file
-        jw->writeJson(jsonRoot);
-        jw->flush();
-        jw->close();
+        SaveFile::Data data;
+        data.enemyPositions = getEnemyPositions();
+        data.reynardPosition = _reynardController->getCharacter()->getPosition();
+        data.activatedCheckpoints = _checkpointActivatedCheckpoints;
+        data.swapHistory = _envController->getSwapHistory();
+        data.fog = _grid->getFogBits();
+        SaveFile::save(data);
     }
 
     /**
-    * Save all the states of the game to a file
+    * Read all the states of the game from the save file
+    *
+    * @return whether there was a valid save file to read
     */
     bool readSaveFile() {
-        //Init a JSON
-        vector<std::string> file_path_list = vector<std::string>(2);
-        file_path_list[0] = Application::get()->getSaveDirectory();
-        file_path_list[1] = "state.json";
-        if (!filetool::file_exists(cugl::filetool::join_path(file_path_list))) {
-            return false;
-        }
-        shared_ptr<JsonReader> jr = JsonReader::alloc(cugl::filetool::join_path(file_path_list));
-        jr->reset();
-        if (!jr->ready()) {
-            cugl::filetool::file_delete(cugl::filetool::join_path(file_path_list));
-            return false;
-        }
-        std::shared_ptr<JsonValue> jsonRoot = jr->readJson();
-
-        //Read files
-        if (jsonRoot->get("EnemyPos") == nullptr
-                || jsonRoot->get("ReynardPos") == nullptr
-                || jsonRoot->get("RoomSwap") == nullptr
-                || jsonRoot->get("ActivatedCheckpoints") == nullptr) {
-            cugl::filetool::file_delete(cugl::filetool::join_path(file_path_list));
-            return false;
-        }
-        std::vector<float> enemyPos1D = jsonRoot->get("EnemyPos")->asFloatArray();
-        std::vector<float> reynardPos1D = jsonRoot->get("ReynardPos")->asFloatArray();
-        std::vector<float> swapHistory1D = jsonRoot->get("RoomSwap")->asFloatArray();
-        std::vector<int> activatedcheckpts1D = jsonRoot->get("ActivatedCheckpoints")->asIntArray();
-        if (enemyPos1D.size() % 2 != 0 || reynardPos1D.size() != 2 || swapHistory1D.size() % 4 != 0) {
-            cugl::filetool::file_delete(cugl::filetool::join_path(file_path_list));
+        SaveFile::Data data;
+        if (!SaveFile::load(data)) {
             return false;
         }
 
-        // JSON - Enemy
-        int index = 0;
-        _checkpointEnemyPos = vector<Vec2>();
-        for (int i = 0; i < enemyPos1D.size(); i += 2) {
-            _checkpointEnemyPos.push_back(Vec2(enemyPos1D[index], enemyPos1D[index + 1]));
-        }
-
-        // JSON - Checkpoint
-        _checkpointActivatedCheckpoints = activatedcheckpts1D;
-
-        // JSON - Reynard
-        _checkpointReynardPos = Vec2(reynardPos1D[0], reynardPos1D[1]);
-
-        // JSON - Room Swapping
-        std::shared_ptr<JsonValue> jsonRoomSwap = JsonValue::alloc(JsonValue::Type::ObjectType);
-        jsonRoomSwap->initArray();
-        _checkpointSwapLen = static_cast<int>(swapHistory1D.size() / 4);
-        int hisotoryLen = static_cast<int>(swapHistory1D.size());
-        _swapHistory = vector<vector<Vec2>>();
-        for (int i = 0; i < hisotoryLen; i += 4) {
-            vector<Vec2> thisSwap = vector<Vec2>();
-            thisSwap.push_back(Vec2(swapHistory1D[i], swapHistory1D[i + 1]));
-            thisSwap.push_back(Vec2(swapHistory1D[i + 2], swapHistory1D[i + 3]));
-            _swapHistory.push_back(thisSwap);
-        }
+        _checkpointEnemyPos = data.enemyPositions;
+        _checkpointActivatedCheckpoints = data.activatedCheckpoints;
+        _checkpointReynardPos = data.reynardPosition;
+        _checkpointSwapLen = static_cast<int>(data.swapHistory.size());
+        _swapHistory = data.swapHistory;
+        _checkpointFog = data.fog;
 
         return true;
     }
@@ -495,6 +640,12 @@ public:
     void setDebug(bool value) {
         _debug = value;
         _debugnode->setVisible(value);
+        // Nothing is drawn or kept while debug mode is off
+        if (!value) _debugDraw->clear(true);
+        EnemyController::setDebugDraw(value ? _debugDraw : nullptr);
+#ifdef CU_PROFILE
+        if (_profileNode != nullptr) _profileNode->setVisible(value);
+#endif
     }
 
     /**
@@ -528,12 +679,36 @@ public:
     /**
      * The method called to update the game mode.
      *
-     * This method contains any gameplay code that is not an OpenGL call.
+     * This method reads the input, and then runs the simulation for as many
+     * ticks as the time that has passed calls for.
      *
      * @param timestep  The amount of time (in seconds) since the last frame
      */
     void update(float timestep);
 
+    /**
+     * Runs a single tick of the simulation, recording its input if the
+     * session is being recorded.
+     *
+     * @param timestep  The length of the tick, in seconds
+     */
+    void tick(float timestep);
+
+    /**
+     * Declares the phases that run after the physics step each tick, along
+     * with what each one reads and writes.
+     */
+    void buildFrameGraph();
+
+    /**
+     * Steps the game forward by a single tick.
+     *
+     * This method contains any gameplay code that is not an OpenGL call.
+     *
+     * @param timestep  The length of the tick, in seconds
+     */
+    void step(float timestep);
+
 #pragma mark Drawing
 
     /**
@@ -555,6 +730,21 @@ public:
      */
     void revert(bool totalReset);
 
+    /**
+     * Takes a snapshot of everything that can change before the next checkpoint,
+     * so that respawn() can put it back.
+     */
+    void captureSnapshot();
+
+    /**
+     * Puts the game back the way it was at the last snapshot, in place on the
+     * existing grid and physics world. This is much faster than revert, since
+     * nothing is rebuilt and no files are read.
+     *
+     * Falls back to revert if there is no snapshot.
+     */
+    void respawn();
+
 
 #pragma mark -
 #pragma mark Collision Handling
@@ -611,7 +801,7 @@ public:
      *
      * @param  contact  Contact event generated by beginContact / endContact callbacks
      */
-    b2Fixture *getReynardFixture(b2Contact *contact);
+    b2Fixture *getReynardFixture(const ContactEvent &contact);
 
     /**
      * Helper function that returns the fixture associated with the Enemy
@@ -625,7 +815,7 @@ public:
      *
      * @param  contact  Contact event generated by beginContact / endContact callbacks
      */
-    b2Fixture *getEnemyFixture(b2Contact *contact);
+    b2Fixture *getEnemyFixture(const ContactEvent &contact);
 
     /**
      * Detects if a collision includes a trap object, and if so returns the trap type
@@ -635,7 +825,7 @@ public:
      * @return  trap type if one body is a trap
                 or UNTYPED if neither body is a trap
      */
-    shared_ptr<TrapModel> isTrapCollision(b2Contact *contact);
+    shared_ptr<TrapModel> isTrapCollision(const ContactEvent &contact);
 
     /**
      * Detects if a collision includes a tutorial object, and if so returns the tutorial's pointer
@@ -645,7 +835,7 @@ public:
      * @return  trap type if one body is a trap
                 or UNTYPED if neither body is a trap
      */
-    shared_ptr<Tutorial> isTutorialCollision(b2Contact *contact);
+    shared_ptr<Tutorial> isTutorialCollision(const ContactEvent &contact);
 
 
     /**
@@ -657,7 +847,7 @@ public:
      *
      * @param  contact  Contact event generated by beginContact / endContact callbacks
      */
-    bool isReynardCollision(b2Contact *contact);
+    bool isReynardCollision(const ContactEvent &contact);
 
     /**
      * Returns whether the given body belongs to a character in the scene.
@@ -674,7 +864,7 @@ public:
      * @param contact   Contact event generated by beginContact / endContact callbacks
      * @return          Pointer to the character's body, or nullptr if collision isn't character-on-object
      */
-    b2Body *getCharacterBodyInObjectCollision(b2Contact *contact);
+    b2Body *getCharacterBodyInObjectCollision(const ContactEvent &contact);
 
     /**
      * Returns a pointer to the relevant enemy controller if it is involved in the collision; otherwise
@@ -688,7 +878,7 @@ public:
      * @param body  The body of the character to get the controller for
      * @return      Pointer to the enemy controller if it's in the collision, or nullptr otherwise
      */
-    shared_ptr<EnemyController> getEnemyControllerInCollision(b2Contact *contact);
+    shared_ptr<EnemyController> getEnemyControllerInCollision(const ContactEvent &contact);
 
     /**
      * Helper function that checks if a contact event is a Reynard <> Wall contact
@@ -698,7 +888,7 @@ public:
      * @param  contact  Contact event generated by beginContact / endContact callbacks
      * @param  reynardIsRight  Boolean corresponding to the direction Reynard is facing
      */
-    bool isThisAReynardWallContact(b2Contact *contact, bool reynardIsRight);
+    bool isThisAReynardWallContact(const ContactEvent &contact, bool reynardIsRight);
 
     /**
      * Helper function that checks if a contact event is a Reynard <> Ground contact
@@ -707,7 +897,7 @@ public:
      *
      * @param  contact  Contact event generated by beginContact / endContact callbacks
      */
-    bool isThisAReynardGroundContact(b2Contact *contact);
+    bool isThisAReynardGroundContact(const ContactEvent &contact);
 
     /**
      * Resolver function that fires when Reynard makes contact with a wall
@@ -743,23 +933,24 @@ public:
     /**
      * Processes the start of a collision
      *
-     * This method is called when we first get a collision between two objects.  We use
-     * this method to test if it is the "right" kind of collision and to execute resolvers when
-     * needed.
+     * This method is called after the physics step for every pair of fixtures that started
+     * touching during it.  We use this method to test if it is the "right" kind of collision
+     * and to execute resolvers when needed.
      *
      * @param  contact  The two bodies that collided
      */
-    void beginContact(b2Contact *contact);
+    void beginContact(const ContactEvent &contact);
 
     /**
      * Processes the end of a collision
      *
-     * This method is called when we end a collision between two objects.  We use
+     * This method is called after the physics step for every pair of fixtures that stopped
+     * touching during it, or right away if a body was disabled or destroyed.  We use
      * this method to reset resolvers.
      *
      * @param  contact  The two bodies that have ended colliding
      */
-    void endContact(b2Contact *contact);
+    void endContact(const ContactEvent &contact);
 
     /**
      * Handles any modifications necessary before collision re
@@ -780,9 +971,9 @@ public:
 
     void resolveEnemyWallOnContact(shared_ptr<EnemyController> enemy);
 
-    bool isThisAEnemyWallContact(b2Contact *contact, bool enemyIsRight, shared_ptr<EnemyController> enemy);
+    bool isThisAEnemyWallContact(const ContactEvent &contact, bool enemyIsRight, shared_ptr<EnemyController> enemy);
 
-    bool isThisAEnemyGroundContact(b2Contact *contact, shared_ptr<EnemyController> enemy);
+    bool isThisAEnemyGroundContact(const ContactEvent &contact, shared_ptr<EnemyController> enemy);
 
     void resolveEnemyGroundOnContact(shared_ptr<EnemyController> enemy);
 
@@ -16,6 +16,7 @@
 #define MPGameStateController_h
 
 #include <cugl/cugl.h>
+#include "MPSimClock.h"
 
 class GameStateController {
 private:
@@ -32,8 +33,8 @@ private:
     float maxZoom = 2.4;
     float minZoom = 1;
     float superMinZoom = 0.6;
-    std::chrono::duration<unsigned long long> fourSeconds = std::chrono::seconds(4);
-    std::chrono::time_point<std::chrono::system_clock> sinceResume = std::chrono::system_clock::now() - fourSeconds;
+    /** The simulation time of the last resume, far enough back that the countdown is over */
+    double sinceResume = SimClock::now() - 4;
 public:
     /**
      * Change parameter as you need
@@ -92,7 +93,7 @@ public:
 
     void unpause() {
         paused = false;
-        sinceResume = std::chrono::system_clock::now();
+        sinceResume = SimClock::now();
     }
 
     void pauseSwitch() {
@@ -112,8 +113,7 @@ public:
     }
 
     float secondsAfterResume() {
-        std::chrono::duration<float> diff = std::chrono::system_clock::now() - sinceResume;
-        return diff.count();
+        return (float)(SimClock::now() - sinceResume);
     }
 
 
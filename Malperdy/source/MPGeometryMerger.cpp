@@ -0,0 +1,296 @@
+//
+//  MPGeometryMerger.cpp
+//  Malperdy
+//
+//  This class merges the solid polygons of rooms into the chains used by
+//  ChainObstacle. The polygons of a room and its neighbors are unioned with
+//  clipper, then the outline of the union is cut back down to the room's cell.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPGeometryMerger.h"
+#include <clipper/clipper.hpp>
+
+using namespace cugl;
+
+/** How many clipper units there are per unit of the input, since clipper only works with integers */
+#define MERGE_RESOLUTION 16.0f
+/** How far to look off an edge to see which side of a cell border it's on */
+#define MERGE_NUDGE 0.5f
+/** Distance under which two points are considered the same */
+#define MERGE_EPSILON 0.01f
+
+#pragma mark Helpers
+
+/**
+ * Converts the given point to clipper's integer coordinates.
+ *
+ * @param v The point to convert
+ * @return  The point in clipper coordinates
+ */
+static ClipperLib::IntPoint toClipper(const Vec2 v) {
+    return ClipperLib::IntPoint((ClipperLib::cInt)roundf(v.x * MERGE_RESOLUTION),
+                                (ClipperLib::cInt)roundf(v.y * MERGE_RESOLUTION));
+}
+
+/**
+ * Adds the given path to the clipper input, so that it is wound counterclockwise.
+ * Degenerate paths are skipped.
+ *
+ * @param path  The path to add
+ * @param paths The clipper input to add it to
+ */
+static void addOriented(ClipperLib::Path &path, ClipperLib::Paths &paths) {
+    if (path.size() < 3 || ClipperLib::Area(path) == 0) return;
+    if (!ClipperLib::Orientation(path)) ClipperLib::ReversePath(path);
+    paths.push_back(path);
+}
+
+/**
+ * Returns whether the given point is strictly inside the given rectangle.
+ *
+ * @param p     The point to check
+ * @param rect  The rectangle to check against
+ * @return      Whether the point is inside the rectangle, not on its border
+ */
+static bool strictlyInside(const Vec2 p, const Rect &rect) {
+    return (rect.getMinX() < p.x && p.x < rect.getMaxX()
+            && rect.getMinY() < p.y && p.y < rect.getMaxY());
+}
+
+/**
+ * Clips the segment from a to b to the given rectangle. If any of the segment
+ * is inside, t0 and t1 are set to the parameters along the segment of where
+ * that part starts and ends.
+ *
+ * @param a     The start of the segment
+ * @param b     The end of the segment
+ * @param rect  The rectangle to clip to
+ * @param t0    Set to where the part inside the rectangle starts
+ * @param t1    Set to where the part inside the rectangle ends
+ * @return      Whether any of the segment is inside the rectangle
+ */
+static bool clipSegment(const Vec2 a, const Vec2 b, const Rect &rect, float &t0, float &t1) {
+    Vec2 d = b - a;
+    float p[4] = {-d.x, d.x, -d.y, d.y};
+    float q[4] = {a.x - rect.getMinX(), rect.getMaxX() - a.x, a.y - rect.getMinY(), rect.getMaxY() - a.y};
+
+    t0 = 0;
+    t1 = 1;
+    for (int k = 0; k < 4; k++) {
+        if (p[k] == 0) {
+            // Parallel to this side, so it's either all in or all out
+            if (q[k] < 0) return false;
+            continue;
+        }
+        float t = q[k] / p[k];
+        if (p[k] < 0) {
+            if (t > t1) return false;
+            if (t > t0) t0 = t;
+        } else {
+            if (t < t0) return false;
+            if (t < t1) t1 = t;
+        }
+    }
+    return true;
+}
+
+/**
+ * Unions the given clipper paths and returns the outlines of the result.
+ *
+ * @param input The paths to union, wound so that solids are counterclockwise
+ * @return      The outlines of the union
+ */
+static vector<vector<Vec2>> unionPaths(const ClipperLib::Paths &input) {
+    ClipperLib::Clipper clipper;
+    ClipperLib::Paths solution;
+    clipper.AddPaths(input, ClipperLib::ptSubject, true);
+    clipper.Execute(ClipperLib::ctUnion, solution, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    // Get rid of the extra vertices left where triangles met along a straight edge
+    ClipperLib::CleanPolygons(solution);
+
+    vector<vector<Vec2>> outlines;
+    for (auto pItr = solution.begin(); pItr != solution.end(); ++pItr) {
+        if (pItr->size() < 3) continue;
+        outlines.push_back(vector<Vec2>());
+        for (auto vItr = pItr->begin(); vItr != pItr->end(); ++vItr) {
+            outlines.back().push_back(Vec2(vItr->X / MERGE_RESOLUTION, vItr->Y / MERGE_RESOLUTION));
+        }
+    }
+    return outlines;
+}
+
+#pragma mark Merging
+
+/**
+ * Unions all the given polygons together and returns the outlines of the
+ * result. Each outline is a closed loop with the solid to the left of
+ * every edge, so outer boundaries go counterclockwise and holes go
+ * clockwise.
+ *
+ * The polygons must be triangulated, as they are when loaded by RoomModel.
+ *
+ * @param polys The polygons to union
+ * @return      The outlines of the union
+ */
+vector<vector<Vec2>> GeometryMerger::unionPolygons(const vector<Poly2> &polys) {
+    ClipperLib::Paths input;
+    ClipperLib::Path path;
+
+    for (auto itr = polys.begin(); itr != polys.end(); ++itr) {
+        const vector<Vec2> &verts = itr->getVertices();
+        const vector<Uint32> &indices = itr->getIndices();
+
+        // Untriangulated polygons are just an outline
+        if (indices.empty()) {
+            path.clear();
+            for (auto vItr = verts.begin(); vItr != verts.end(); ++vItr) {
+                path.push_back(toClipper(*vItr));
+            }
+            addOriented(path, input);
+            continue;
+        }
+
+        // Otherwise add each triangle and let clipper stitch them back together
+        for (size_t ii = 0; ii + 2 < indices.size(); ii += 3) {
+            path.clear();
+            for (size_t jj = 0; jj < 3; jj++) {
+                path.push_back(toClipper(verts[indices[ii + jj]]));
+            }
+            addOriented(path, input);
+        }
+    }
+
+    return unionPaths(input);
+}
+
+/**
+ * Unions outlines returned by unionPolygons() together and returns the
+ * outlines of the result. The outlines keep their winding, so holes stay
+ * holes.
+ *
+ * @param outlines  The outlines to union
+ * @return          The outlines of the union
+ */
+vector<vector<Vec2>> GeometryMerger::unionOutlines(const vector<vector<Vec2>> &outlines) {
+    ClipperLib::Paths input;
+    input.reserve(outlines.size());
+    for (auto oItr = outlines.begin(); oItr != outlines.end(); ++oItr) {
+        input.push_back(ClipperLib::Path());
+        for (auto vItr = oItr->begin(); vItr != oItr->end(); ++vItr) {
+            input.back().push_back(toClipper(*vItr));
+        }
+    }
+    return unionPaths(input);
+}
+
+/**
+ * Returns whether every vertex of the given outline is strictly inside the
+ * given cell. Such an outline never touches the geometry of another cell,
+ * so it is the same no matter what is next to the cell.
+ *
+ * @param outline   The outline to check
+ * @param cell      The cell to check against
+ * @return          Whether the outline is strictly inside the cell
+ */
+bool GeometryMerger::isInsideCell(const vector<Vec2> &outline, const Rect &cell) {
+    for (auto itr = outline.begin(); itr != outline.end(); ++itr) {
+        if (!strictlyInside(*itr, cell)) return false;
+    }
+    return true;
+}
+
+/**
+ * Returns the parts of the given outlines that belong to the given cell.
+ *
+ * An outline entirely inside the cell is kept as a loop. Otherwise, it is
+ * cut into open chains, and each chain gets ghost vertices from the part
+ * of the outline just outside the cell. Edges that lie along the border
+ * of the cell belong to the cell on the solid side.
+ *
+ * @param outlines  Outlines from unionPolygons()
+ * @param cell      The cell to cut the outlines down to
+ * @return          The chains inside the cell
+ */
+vector<ChainObstacle::Chain> GeometryMerger::clipToCell(const vector<vector<Vec2>> &outlines, const Rect &cell) {
+    vector<ChainObstacle::Chain> chains;
+
+    for (auto oItr = outlines.begin(); oItr != outlines.end(); ++oItr) {
+        const vector<Vec2> &outline = *oItr;
+        int n = (int)outline.size();
+
+        // Find the part of each edge that belongs to this cell
+        vector<bool> kept(n, false);
+        vector<Vec2> starts(n), ends(n);
+        bool allKept = true;
+        for (int i = 0; i < n; i++) {
+            Vec2 a = outline[i];
+            Vec2 b = outline[(i + 1) % n];
+            float t0, t1;
+            if (clipSegment(a, b, cell, t0, t1) && t1 > t0) {
+                starts[i] = a + (b - a) * t0;
+                ends[i] = a + (b - a) * t1;
+
+                // The solid is to the left of the edge, so nudge that way to see whose it is
+                Vec2 d = ends[i] - starts[i];
+                if (d.length() > MERGE_EPSILON) {
+                    Vec2 solid = (starts[i] + ends[i]) / 2 + Vec2(-d.y, d.x).getNormalization() * MERGE_NUDGE;
+                    kept[i] = strictlyInside(solid, cell);
+                }
+            }
+            allKept = allKept && kept[i] && starts[i].distance(a) < MERGE_EPSILON && ends[i].distance(b) < MERGE_EPSILON;
+        }
+
+        // The whole outline is in this cell
+        if (allKept) {
+            ChainObstacle::Chain loop;
+            loop.loop = true;
+            loop.vertices = outline;
+            chains.push_back(loop);
+            continue;
+        }
+
+        // Otherwise, start walking from just after a break so no chain wraps around the start
+        int first = 0;
+        for (int i = 0; i < n; i++) {
+            int prev = (i + n - 1) % n;
+            if (kept[i] && (!kept[prev] || ends[prev].distance(starts[i]) >= MERGE_EPSILON)) {
+                first = i;
+                break;
+            }
+        }
+
+        ChainObstacle::Chain chain;
+        bool open = false;
+        for (int k = 0; k < n; k++) {
+            int i = (first + k) % n;
+            if (!kept[i]) continue;
+
+            if (!open) {
+                // Ghost vertex is whatever comes before the start along the outline
+                chain = ChainObstacle::Chain();
+                chain.vertices.push_back(starts[i]);
+                chain.prevVertex = (starts[i].distance(outline[i]) < MERGE_EPSILON)
+                                   ? outline[(i + n - 1) % n] : outline[i];
+                open = true;
+            }
+            chain.vertices.push_back(ends[i]);
+
+            // Close the chain if the next edge doesn't carry on from this one
+            int next = (i + 1) % n;
+            if (k == n - 1 || !kept[next] || ends[i].distance(starts[next]) >= MERGE_EPSILON) {
+                chain.nextVertex = (ends[i].distance(outline[next]) < MERGE_EPSILON)
+                                   ? outline[(i + 2) % n] : outline[next];
+                chains.push_back(chain);
+                open = false;
+            }
+        }
+    }
+
+    return chains;
+}
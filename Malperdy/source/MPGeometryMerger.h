@@ -0,0 +1,87 @@
+//
+//  MPGeometryMerger.h
+//  Malperdy
+//
+//  This class merges the solid polygons of rooms into the chains used by
+//  ChainObstacle. The polygons of a room and its neighbors are unioned with
+//  clipper, so that walls and floors that continue across a room boundary
+//  become a single outline. That outline is then cut back down to the cell
+//  of one room, keeping the ghost vertices that connect each cut end to the
+//  rest of the outline.
+//
+//  Since every room only keeps the part of the outline inside its own cell,
+//  each room can still be its own physics object and move when it is swapped.
+//  Outlines that stay strictly inside a cell never change, so only the ones
+//  reaching the edges of the rooms next to a swap need to be merged again.
+//
+//  Everything here is in whatever coordinate space the caller passes in, as
+//  long as it's consistent. GridModel uses the grid node's space.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPGeometryMerger_h
+#define MPGeometryMerger_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "MPChainObstacle.h"
+
+using namespace cugl;
+
+class GeometryMerger {
+public:
+    /**
+     * Unions all the given polygons together and returns the outlines of the
+     * result. Each outline is a closed loop with the solid to the left of
+     * every edge, so outer boundaries go counterclockwise and holes go
+     * clockwise.
+     *
+     * The polygons must be triangulated, as they are when loaded by RoomModel.
+     *
+     * @param polys The polygons to union
+     * @return      The outlines of the union
+     */
+    static vector<vector<Vec2>> unionPolygons(const vector<Poly2> &polys);
+
+    /**
+     * Unions outlines returned by unionPolygons() together and returns the
+     * outlines of the result. The outlines keep their winding, so holes stay
+     * holes.
+     *
+     * @param outlines  The outlines to union
+     * @return          The outlines of the union
+     */
+    static vector<vector<Vec2>> unionOutlines(const vector<vector<Vec2>> &outlines);
+
+    /**
+     * Returns whether every vertex of the given outline is strictly inside the
+     * given cell. Such an outline never touches the geometry of another cell,
+     * so it is the same no matter what is next to the cell.
+     *
+     * @param outline   The outline to check
+     * @param cell      The cell to check against
+     * @return          Whether the outline is strictly inside the cell
+     */
+    static bool isInsideCell(const vector<Vec2> &outline, const Rect &cell);
+
+    /**
+     * Returns the parts of the given outlines that belong to the given cell.
+     *
+     * An outline entirely inside the cell is kept as a loop. Otherwise, it is
+     * cut into open chains, and each chain gets ghost vertices from the part
+     * of the outline just outside the cell. Edges that lie along the border
+     * of the cell belong to the cell on the solid side.
+     *
+     * @param outlines  Outlines from unionPolygons()
+     * @param cell      The cell to cut the outlines down to
+     * @return          The chains inside the cell
+     */
+    static vector<ChainObstacle::Chain> clipToCell(const vector<vector<Vec2>> &outlines, const Rect &cell);
+};
+
+#endif /* MPGeometryMerger_h */
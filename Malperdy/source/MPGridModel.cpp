@@ -21,38 +21,26 @@
 
 using namespace cugl;
 
-#pragma mark Constructors
-
 /**
- * Initializes and returns a grid of rooms with the given dimensions.
+ * Returns the contents of the file at the given path, relative to the assets,
+ * or an empty string if it couldn't be read.
  *
- * @param width     The width/number of columns of rooms that the grid should have
- * @param height    The height/number of rows of rooms that the grid should have
- * @return          The initialized grid with the given dimensions
+ * @param file  The path of the file, relative to the asset directory
+ * @return      The contents of the file
  */
-shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> GridModel::initGrid(int width, int height) {
-    // Initialize grid
-    shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> grid =
-            make_shared<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>>();
-    // Initialize RoomModel cache to temporarily store RoomModels
-    shared_ptr<RoomModel> room;
-
-    // Fill the grid with uninstantiated rooms
-    for (int y = 0; y < height; y++) {
-        // Initialize vector for a row of rooms
-        shared_ptr<vector<shared_ptr<RoomModel>>> roomRow = make_shared<vector<shared_ptr<RoomModel>>>();
-
-        for (int x = 0; x < width; x++) {
-            room = make_shared<RoomModel>();
-            roomRow->push_back(room);
-        }
-        // Add row of rooms to the grid
-        grid->push_back(roomRow);
-    }
-
-    return grid;
+static string readAsset(const string &file) {
+    string path = Application::get()->getAssetDirectory() + file;
+    SDL_RWops *stream = SDL_RWFromFile(path.c_str(), "rb");
+    if (stream == nullptr) return string();
+    Sint64 size = SDL_RWsize(stream);
+    string contents(size > 0 ? (size_t)size : 0, '\0');
+    size_t read = (size > 0 ? SDL_RWread(stream, &contents[0], 1, contents.size()) : 0);
+    SDL_RWclose(stream);
+    return (read == contents.size() ? contents : string());
 }
 
+#pragma mark Constructors
+
 /**
  * Deafult init
  * @param assets: the asset manager of the game
@@ -63,17 +51,32 @@ bool GridModel::init(shared_ptr<AssetManager> assets, float scale) {
     _assets = assets;
     _physics_scale = scale;
 
-    // Get JSON for the world metadata and parse for constants
+    // Get JSON for the world metadata, which still picks the backgrounds
     shared_ptr<JsonValue> worldJSON = assets->get<JsonValue>("world");
 
+    // Get the compiled level, or compile it now if it wasn't shipped with the game.
+    // A pack made from different JSON than what is there now is out of date, so don't trust it
+    Uint32 sourceHash = LevelCompiler::hashSources(worldJSON, readAsset);
+    shared_ptr<LevelPack> pack = LevelPack::allocWithAsset(LEVEL_PACK_FILE);
+    if (pack != nullptr && pack->getHeader().sourceHash != sourceHash) {
+        CULog("GridModel.cpp: Level pack is out of date, rerun the level pack tool");
+        pack = nullptr;
+    }
+    if (pack == nullptr) {
+        CULog("GridModel.cpp: No usable level pack, compiling the level from JSON");
+        pack = LevelPack::allocWithBytes(LevelCompiler::compile(worldJSON, [](const string &file) {
+            shared_ptr<JsonReader> reader = JsonReader::allocWithAsset(file);
+            return (reader == nullptr ? nullptr : reader->readJson());
+        }, sourceHash));
+        if (pack == nullptr) return false;
+    }
+    const LevelPack::Header &header = pack->getHeader();
+
     // Get room dimensions in tiles
-    _roomWidth = worldJSON->get("roomWidth")->asInt();
-    _roomHeight = worldJSON->get("roomHeight")->asInt();
+    _roomWidth = header.roomWidth;
+    _roomHeight = header.roomHeight;
     // The size of each tile in pixels
-    _tileSize = worldJSON->get("tileSize")->asInt();
-
-    // Get the tileset for the rooms
-    _roomsTileset = assets->get<JsonValue>("tileset_rooms");
+    _tileSize = header.tileSize;
 
     /**************************************************************/
     // REGIONS
@@ -81,15 +84,11 @@ bool GridModel::init(shared_ptr<AssetManager> assets, float scale) {
     // First give all the regions access to the backgrounds they'll need
     RegionModel::setBackgrounds(assets, worldJSON);
 
-    // Get the list of regions in the world
-    vector<shared_ptr<JsonValue>> regions = worldJSON->get("regions")->children();
-
-    // Initialize Rect for region bounds
-    Rect _regionBounds = Rect();
-
-    // Now build each region based on the corresponding JSON metadata
-    for (shared_ptr<JsonValue> regionMetadata: regions) {
-        initRegion(regionMetadata);
+    // The world bounds only depend on the region metadata, so compute them up front
+    // so that the room table can be allocated before any rooms are created
+    for (int k = 0; k < pack->getRegionCount(); k++) {
+        const LevelPack::Region &region = pack->getRegion(k);
+        _bounds = _bounds.merge(Rect(region.originX, region.originY, region.width, region.height));
     }
 
     // Set the size and origin based on the full world bounds
@@ -98,8 +97,35 @@ bool GridModel::init(shared_ptr<AssetManager> assets, float scale) {
     _originX = _bounds.getMinX();
     _originY = _bounds.getMinY();
 
-    // For now, make all regions active at once
-    _activeRegions = _regions;
+    // Allocate the table that will store every room in the world
+    _rooms = RoomTable::alloc(_originX, _originY, _size.x, _size.y);
+    // Everything starts active until the first activation update
+    _active.assign(_size.x * _size.y, true);
+    // Nobody is in any room until the characters first report in
+    _occupancy = OccupancyGrid::alloc(_rooms);
+
+    // Now build each region from the pack
+    for (int k = 0; k < pack->getRegionCount(); k++) {
+        initRegion(*pack, k + 1);
+    }
+
+    // Every room starts out fogged
+    _fog.assign((_rooms->getWidth() * _rooms->getHeight() + 7) / 8, 0);
+    _fogChanges.clear();
+    _rooms->forEachRoom([this](int x, int y, const shared_ptr<RoomModel> &) {
+        int index = y * _rooms->getWidth() + x;
+        _fog[index >> 3] |= (1 << (index & 7));
+    });
+
+    // Every region starts active until the first activation update
+    _activeRegions = make_shared<vector<shared_ptr<RegionModel>>>(*_regions);
+    _activeRoomCounts.assign(_regions->size(), 0);
+    for (int y = 0; y < _rooms->getHeight(); y++) {
+        for (int x = 0; x < _rooms->getWidth(); x++) {
+            int region = _rooms->getRegion(x, y);
+            if (region != NO_REGION && region <= (int)_activeRoomCounts.size()) _activeRoomCounts[region - 1]++;
+        }
+    }
 
     // Fill any empty spaces with solid rooms
     //for (int y = 0; y < _size.y; y++) {
@@ -126,234 +152,99 @@ bool GridModel::init(shared_ptr<AssetManager> assets, float scale) {
  * in grid space are the region's origin, which will be used to organize the regions,
  * but otherwise regions only care about where things are relative to their origin.
  *
- * @param regionMetadata    The JSONValue for the metadata of the region to be initialized
+ * The region's rooms are placed directly into the RoomTable, which must already
+ * have been allocated to cover the region.
+ *
+ * @param pack      The level pack holding the region
+ * @param number    The number of the region in the grid, from 1
  */
-void GridModel::initRegion(shared_ptr<JsonValue> regionMetadata) {
-    int width = regionMetadata->getInt("width");
-    int height = regionMetadata->getInt("height");
-    int originX = regionMetadata->getInt("originX");
-    int originY = regionMetadata->getInt("originY");
+void GridModel::initRegion(const LevelPack &pack, int number) {
+    const LevelPack::Region &metadata = pack.getRegion(number - 1);
+    int originX = metadata.originX;
+    int originY = metadata.originY;
 
     // First create a new region with the given metadata
     shared_ptr<RegionModel> region = RegionModel::alloc(
-            regionMetadata->getString("name"),
-            regionMetadata->getInt("type"),
-            width, height, originX, originY
+            pack.getString(metadata.name), metadata.type,
+            metadata.width, metadata.height, originX, originY, number, _rooms
     );
     _regions->push_back(region);
 
-    // Now load in the actual region JSON
-    shared_ptr<JsonValue> regionJSON = _assets->get<JsonValue>(regionMetadata->getString("name"));
-
-    // Initialize grid for a sublevel layer (dimensions are the dimensions of the region)
-    shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> sublevel = initGrid(width, height);
-
-    // Start reading data from the JSON
-    shared_ptr<JsonValue> layers = regionJSON->get("layers");
-
-    // INSTANTIATING TRAPS
-    // Find the offset for the entities tileset
-    int entity_offset = 0;
-    int room_offset = 0;
-    shared_ptr<JsonValue> tilesets = regionJSON->get("tilesets");
-
-    // loop through the tilesets of the level
-    for (int i = 0; i < tilesets->size(); i++) {
-
-        // if the tileset is the entities tileset, set the tileset offset
-        if (tilesets->get(i)->get("source")->asString().find("entities") != string::npos) {
-            entity_offset = tilesets->get(i)->get("firstgid")->asInt();
-        }
-
-        // if the tileset is the entities tileset, set the tileset offset
-        if (tilesets->get(i)->get("source")->asString().find("rooms") != string::npos) {
-            room_offset = tilesets->get(i)->get("firstgid")->asInt();
-        }
-    }
-
-    // INSTANTIATING ROOMS
-
-    // Room JSON cache
-    shared_ptr<JsonValue> roomJSON;
-    // Whether the room is solid
-    bool isSolid = false;
-
-    // Initialize variables to determine sublevel bounds
-    int xMin, yMin, xMax, yMax;
-
-    // Go through each layer to find the sublevel layers
-    for (int i = 0; i < layers->size(); i++) {
-        shared_ptr<JsonValue> layer = layers->get(i);
-
-        // Parse each sublevel if the layer name contains "sublevel"
-        if (layer->get("name")->asString().find("sublevel") != string::npos) {
-            // Set min coords to high values and max coords to low values
-            xMin = width;
-            yMin = height;
-            xMax = 0;
-            yMax = 0;
-
-            // For each room in the sublevel
-            for (int j = 0; j < layer->get("data")->size() / _roomWidth / _roomHeight; j++) {
-                isSolid = false;
-
-                // These coordinates are from the UPPER left
-                int x = j % width;
-                int y = (j / width);
-
-                // The room ID
-                int bottom_corner = x * _roomWidth + (y + 1) * _roomWidth * width * _roomHeight - _roomWidth * width;
-                int room_id = layer->get("data")->get(bottom_corner)->asInt();
-
-                // If room ID = 0, there's no room there, so go on to the next room
-                if (!room_id) continue;
-
-                //string im = _roomsTileset->get("tiles")->get(room_id - room_offset)->get("image")->asString();
-                shared_ptr<JsonValue> json1 = _roomsTileset->get("tiles");
-                json1 = json1->get(room_id - room_offset);
-                json1 = json1->get("image");
-                string im = json1->asString();
-
-                // Get the ID/name of the desired room type
-                string roomID;
-                if (im.rfind("solid") != string::npos) {
-                    roomID = "room_solid";
-                    isSolid = true;
-                } else {
-                    int p = im.rfind("room");
-                    roomID = im.substr(p);
-                    roomID = roomID.substr(0, roomID.length() - 4);
-                }
-
-                // Flip the y, so now the coordinates are from the lower left
-                y = height - 1 - y;
-
-                // instantiate the room and add it as a child
-                // Make sure to place it at the right place in GRID space
-                sublevel->at(y)->at(x)->init(x + originX, y + originY, roomID, region->getType(),
-                        isSolid ? nullptr : RegionModel::getRandBG(region->getType()));
-                if (isSolid) sublevel->at(y)->at(x)->setSolid();
-                addChild(sublevel->at(y)->at(x));
-
-                // Update min/max bounds if needed
-                if (x <= xMin && y <= yMin) {
-                    xMin = x;
-                    yMin = y;
-                }
-                if (x >= xMax && y >= yMax) {
-                    xMax = x;
-                    yMax = y;
-                }
-            }
-            // Store the final sublevel in the region
-            // Sublevel origin is the min bound
-            region->addSublevel(xMin, yMin, xMax - xMin + 1, yMax - yMin + 1, sublevel);
-        }
+    // ROOMS
+    const LevelPack::Cell *cells = pack.getCells(metadata);
+    for (Uint32 i = 0; i < metadata.cellCount; i++) {
+        const LevelPack::Cell &cell = cells[i];
+
+        // instantiate the room and add it as a child
+        // Make sure to place it at the right place in GRID space
+        shared_ptr<RoomModel> room = make_shared<RoomModel>();
+        room->init(cell.x + originX, cell.y + originY, pack.getString(cell.roomID), region->getType(),
+                cell.solid ? nullptr : RegionModel::getRandBG(region->getType()));
+        if (cell.solid) room->setSolid();
+        addChild(room);
+
+        // Store it in the room table, tagged with its sublevel
+        // Table is in HOUSE space, so convert from REGION space
+        _rooms->setCell(cell.x + originX - _originX, cell.y + originY - _originY, room,
+                number, cell.sublevel);
     }
 
-    // TRAPS
-
-    // create a map that maps values in data[] to entity names
-    map<int, string> tile_to_traps = map<int, string>();
-    shared_ptr<JsonValue> ent = _assets->get<JsonValue>("tileset_entities");
-
-    // TODO: add more options for entities
-    // go through all tiles in the entities tileset
-    for (int i = 0; i < ent->get("tiles")->size(); i++) {
-
-        // depending on the type of tile, add its mapping
-        shared_ptr<JsonValue> the_tile = ent->get("tiles")->get(i);
-
-        // if the tile represents reynard, then add a mapping for reynard according to the tile id
-        if (the_tile->get("image")->asString().find("reynard") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "reynard";
-        } else if (the_tile->get("image")->asString().find("spike") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "spike";
-        } else if (the_tile->get("image")->asString().find("trapdoor") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "trapdoor";
-        } else if (the_tile->get("image")->asString().find("keycheckpoint") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "keycheckpoint";
-        } else if (the_tile->get("image")->asString().find("checkpoint") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "checkpoint";
-        } else if (the_tile->get("image")->asString().find("keyenemy") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "keyenemy";
-        } else if (the_tile->get("image")->asString().find("key.png") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "key";
-        } else if (the_tile->get("image")->asString().find("locked") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "locked";
-        } else if (the_tile->get("image")->asString().find("sap") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "sap";
-        } else if (the_tile->get("image")->asString().find("exit") != string::npos) {
-            tile_to_traps[the_tile->get("id")->asInt() + entity_offset] = "exit";
-        }
+    // Sublevels have to be added after their rooms are in the table
+    const LevelPack::Sublevel *sublevels = pack.getSublevels(metadata);
+    for (Uint32 i = 0; i < metadata.sublevelCount; i++) {
+        region->addSublevel(sublevels[i].x, sublevels[i].y, sublevels[i].width, sublevels[i].height);
     }
 
-    // now, go through the data, and for each encountered entity, if it is a trap then add it to the appropriate room
-    // first, loop through the level layers again
-    for (int i = 0; i < regionJSON->get("layers")->size(); i++) {
-        shared_ptr<JsonValue> layer = regionJSON->get("layers")->get(i);
-
-        // if the layer is a tilelayer...
-        if (layer->get("name")->asString().find("entities") != string::npos) {
-            vector<int> data = layer->get("data")->asIntArray();
-
-            // loop through its data
-            for (int j = 0; j < data.size(); j++) {
-
-                // if the data element represents an entity
-                if (data.at(j) != 0) {
-
-                    // calculate the room coordinate that the data element is in
-                    int curr_row = ((_roomHeight * height - 1) - (j / (_roomWidth * width))) / _roomHeight;
-                    int curr_col = (j % (_roomWidth * width)) / _roomWidth;
-
-                    // Transform from REGION to GRID space
-                    curr_col += originX;
-                    curr_row += originY;
-
-                    // if the tile is a trap, then add it
-                    if (tile_to_traps[data.at(j)] == "trapdoor") {
-                        getRoom(curr_col, curr_row)->initTrap(TrapModel::TrapType::TRAPDOOR);
-                    } else if (tile_to_traps[data.at(j)] == "spike") {
-                        getRoom(curr_col, curr_row)->initTrap(TrapModel::TrapType::SPIKE);
-                    } else if (tile_to_traps[data.at(j)].find("checkpoint") != string::npos) {
-                        // Add locked checkpoint to the region
-                        getRoom(curr_col, curr_row)->initTrap(TrapModel::TrapType::CHECKPOINT,
-                                tile_to_traps[data.at(j)].find("key") != string::npos);
-                        // Add checkpoint to the region
-                        region->addCheckpoint(dynamic_cast<Checkpoint *>(&(*(getRoom(curr_col, curr_row)->getTrap())))->getID(),
-                                curr_col, curr_row);
-                        // Lock it by default
-                        getRoom(curr_col, curr_row)->setPermlocked();
-                        checkpoints.push_back(dynamic_cast<Checkpoint *>(&(*(getRoom(curr_col, curr_row)->getTrap()))));
-                    } else if (tile_to_traps[data.at(j)].find("enemy") != string::npos) {
-                        // Store enemy spawn location in HOUSE space and whether or not it has a key
-                        _enemySpawnInfo->emplace_back(Vec2(curr_col, curr_row),
-                                tile_to_traps[data.at(j)].find("key") != string::npos);
-                    } else if (tile_to_traps[data.at(j)] == "sap") {
-                        // TODO: make sure this works
-                        getRoom(curr_col, curr_row)->initTrap(TrapModel::TrapType::SAP);
-                    } else if (tile_to_traps[data.at(j)] == "locked") {
-                        // TODO: make sure this works
-                        getRoom(curr_col, curr_row)->setPermlocked();
-                    } else if (tile_to_traps[data.at(j)] == "key") {
-                        // TODO: add key in this room (using curr_col / curr_row)
-                        // Need to transform by region origin to get coords in HOUSE space
-                        _loneKeyLocs->push_back(Vec2(curr_col, curr_row));
-                    }
-                        // ADD KEY ENEMY IN GAMESCENE WHERE THE OTHER ENEMY IS INSTANTIATED
-                        // Gamescene line 401
-                    else if (tile_to_traps[data.at(j)] == "exit") {
-                        // Mark the exit rooms
-                        region->setExitRoom(curr_col, curr_row, _assets->get<Texture>("blocked"));
-                    }
-                }
+    // ENTITIES
+    const LevelPack::Entity *entities = pack.getEntities(metadata);
+    for (Uint32 i = 0; i < metadata.entityCount; i++) {
+        const LevelPack::Entity &entity = entities[i];
+
+        // Transform from REGION to GRID space
+        int curr_col = entity.x + originX;
+        int curr_row = entity.y + originY;
+        shared_ptr<RoomModel> room = region->getRoom(curr_col, curr_row);
+
+        switch (entity.type) {
+            case LevelPack::EntityType::TRAPDOOR:
+                if (room != nullptr) room->initTrap(TrapModel::TrapType::TRAPDOOR);
+                break;
+            case LevelPack::EntityType::SPIKE:
+                if (room != nullptr) room->initTrap(TrapModel::TrapType::SPIKE);
+                break;
+            case LevelPack::EntityType::SAP:
+                if (room != nullptr) room->initTrap(TrapModel::TrapType::SAP);
+                break;
+            case LevelPack::EntityType::CHECKPOINT:
+            case LevelPack::EntityType::KEY_CHECKPOINT: {
+                if (room == nullptr) break;
+                // Add locked checkpoint to the room
+                room->initTrap(TrapModel::TrapType::CHECKPOINT,
+                        entity.type == LevelPack::EntityType::KEY_CHECKPOINT);
+                Checkpoint *checkpoint = dynamic_cast<Checkpoint *>(&(*(room->getTrap())));
+                // Link the checkpoint to the sublevel it's in
+                region->addCheckpointToSublevel(checkpoint->getID(), entity.sublevel);
+                // Lock it by default
+                room->setPermlocked();
+                checkpoints.push_back(checkpoint);
+                break;
             }
+            case LevelPack::EntityType::KEY_ENEMY:
+                // Store enemy spawn location in GRID space and whether or not it has a key
+                _enemySpawnInfo->emplace_back(Vec2(curr_col, curr_row), true);
+                break;
+            case LevelPack::EntityType::LOCKED:
+                if (room != nullptr) room->setPermlocked();
+                break;
+            case LevelPack::EntityType::KEY:
+                _loneKeyLocs->push_back(Vec2(curr_col, curr_row));
+                break;
+            case LevelPack::EntityType::EXIT:
+                // Mark the exit rooms
+                region->setExitRoom(curr_col, curr_row, _assets->get<Texture>("blocked"));
+                break;
         }
     }
-
-    // Update the world bounds based on this region's bounds
-    _bounds = _bounds.merge(region->getBounds());
 }
 
 #pragma mark Destructors
@@ -365,47 +256,10 @@ void GridModel::initRegion(shared_ptr<JsonValue> regionMetadata) {
  * disposed, a room may not be used until it is initialized again.
  */
 void GridModel::dispose() {
+    _swaps->clear();
     removeAllChildren();
 };
 
-#pragma mark Accessors
-
-/**
- * Returns the pointer to the room located in the xth column
- * from the left and the yth row from the bottom in HOUSE space.
- *
- * If the coordinate is out of bounds, then a null pointer is
- * returned.
- *
- * @param x The column from the left that the desired room is located in
- * @param y The row from the bottom that the desired room is located in
- * @return  The room located at the given coordinates
- */
-shared_ptr<RoomModel> GridModel::getRoom(int x, int y) {
-    // Transform these HOUSE coordinates to GRID space
-    x += _originX;
-    y += _originY;
-    int region = getRegion(x, y);
-    return (region == 0) ? nullptr : _regions->at(region - 1)->getRoom(x, y);
-};
-
-/**
- * Helper function that returns the number of the region that the given
- * GRID space coordinates are located within.
- *
- * @param x     An x-coordinate in GRID space
- * @param y     A y-coordinate in GRID space
- * @return      The region # (1-3) that these coordinates are in, or 0 if not found
- */
-int GridModel::getRegion(int x, int y) {
-    for (int k = 0; k < _regions->size(); k++) {
-        if (_regions->at(k)->isInRegion(x, y)) {
-            return (k + 1);
-        }
-    }
-    return 0;
-}
-
 #pragma mark Setters
 
 /**
@@ -414,17 +268,16 @@ int GridModel::getRegion(int x, int y) {
  *
  * Returns whether or not the room was set successfully.
  *
- * @param x     The column from the left that the desired room is located in (GRID space)
- * @param y     The row from the bottom that the desired room is located in (GRID space)
+ * Only cells that are part of a sublevel can hold a room.
+ *
+ * @param x     The column from the left that the desired room is located in (HOUSE space)
+ * @param y     The row from the bottom that the desired room is located in (HOUSE space)
  * @param room  The room to be placed at the given coordinates
  * @return      Whether the room was set successfully
  */
 bool GridModel::setRoom(int x, int y, shared_ptr<RoomModel> room) {
-    // Transform these HOUSE coordinates to GRID space
-    //x += _originX;
-    //y += _originY;
-    int regionNum = getRegion(x, y);
-    return (regionNum == 0) ? false : _regions->at(regionNum - 1)->setRoom(x, y, room);
+    if (_rooms == nullptr || _rooms->getSublevel(x, y) == NO_SUBLEVEL) return false;
+    return _rooms->setRoom(x, y, room);
 };
 
 /**
@@ -455,49 +308,84 @@ bool GridModel::swapRooms(Vec2 pos1, Vec2 pos2, bool forced) {
     // Update Room1's location accordingly
     room1->setPosition(pos2 + gridOrigin, !forced);
 
-    // For each obstacle in room1
-    for (vector<shared_ptr<physics2::PolygonObstacle>>::iterator itr =
-            getPhysicsGeometryAt(pos1.y, pos1.x)->begin();
-         itr != getPhysicsGeometryAt(pos1.y, pos1.x)->end(); ++itr) {
-
-        // convert the position from physics to world space
-        Vec2 newPos = (*itr)->getPosition() * _physics_scale;
-        // Now world space to grid node space
-        newPos = this->worldToNodeCoords(newPos);
-        // offset the obstacles in grid space
-        newPos.x -= (pos1.x - pos2.x) * DEFAULT_ROOM_WIDTH;
-        newPos.y -= (pos1.y - pos2.y) * DEFAULT_ROOM_HEIGHT;
-        // convert back to physics space
-        newPos = this->nodeToWorldCoords(newPos) / _physics_scale;
-        (*itr)->setPosition(newPos);
-    }
-
-    // For each obstacle in room2
-    for (vector<shared_ptr<physics2::PolygonObstacle>>::iterator itr =
-            getPhysicsGeometryAt(pos2.y, pos2.x)->begin();
-         itr != getPhysicsGeometryAt(pos2.y, pos2.x)->end(); ++itr) {
-
-        // convert the position from physics to grid space
-        Vec2 newPos = (*itr)->getPosition() * _physics_scale;
-        newPos = this->worldToNodeCoords(newPos);
-        // offset the obstacles in grid space
-        newPos.x += (pos1.x - pos2.x) * DEFAULT_ROOM_WIDTH;
-        newPos.y += (pos1.y - pos2.y) * DEFAULT_ROOM_HEIGHT;
-        // convert back to physics space
-        newPos = this->nodeToWorldCoords(newPos) / _physics_scale;
-        (*itr)->setPosition(newPos);
-    }
-
-    // swap the vectors of obstacles in _physicsGeometry
-    // create a temp holder
-    shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> tempPhysics =
-            getPhysicsGeometryAt(pos1.y, pos1.x);
-    setPhysicsGeometryAt(pos1.y, pos1.x, getPhysicsGeometryAt(pos2.y, pos2.x));
-    setPhysicsGeometryAt(pos2.y, pos2.x, tempPhysics);
+    // Slide the rooms over, or stop any old slide if they were put right in place
+    if (forced) {
+        _swaps->cancel(room1);
+        _swaps->cancel(room2);
+    } else {
+        _swaps->start(room1);
+        _swaps->start(room2);
+    }
+
+    // The rooms take their physics with them, so each one moves as a whole
+    int index1 = pos1.y * _rooms->getWidth() + pos1.x;
+    int index2 = pos2.y * _rooms->getWidth() + pos2.x;
+    swap(_physicsGeometry[index1], _physicsGeometry[index2]);
+    // So does any full rebuild they were waiting on
+    vector<bool>::swap(_physicsDirty[index1], _physicsDirty[index2]);
+    Vec2 offset = getCellToPhysicsTransform(pos1.x, pos1.y).transform(Vec2::ZERO)
+                  - getCellToPhysicsTransform(pos2.x, pos2.y).transform(Vec2::ZERO);
+    moveCellPhysics(index1, offset);
+    moveCellPhysics(index2, -offset);
+
+    // Fog stays with the rooms
+    bool fog1 = getFogBit(index1);
+    setFogBit(index1, getFogBit(index2));
+    setFogBit(index2, fog1);
+
+    // Anyone in the cells stayed put, so the rooms take on the locks of the cells they moved into
+    _occupancy->syncLocks(pos1);
+    _occupancy->syncLocks(pos2);
+
+    // The rooms now take on the activation of the cells they moved into
+    setCellActive(index1, isRoomActive(pos1));
+    setCellActive(index2, isRoomActive(pos2));
+
+    // The rooms have new neighbors, so only the geometry along their seams has to be merged again
+    markSeamsDirty(pos1);
+    markSeamsDirty(pos2);
 
     return true;
 };
 
+/**
+ * Rearranges the rooms in the grid to match the given room table contents,
+ * as returned by getRoomTable()->getRooms() at an earlier point. Rooms are
+ * moved with forced swaps, so they snap into place without animating and
+ * their physics move with them.
+ *
+ * Returns false if the given rooms aren't a rearrangement of the current ones.
+ *
+ * @param rooms The rooms to restore, in row-major HOUSE space order
+ * @return      Whether the rooms were restored successfully
+ */
+bool GridModel::restoreRooms(const vector<shared_ptr<RoomModel>> &rooms) {
+    if (_rooms == nullptr || rooms.size() != _rooms->getRooms().size()) return false;
+    int width = _rooms->getWidth();
+    int size = (int)rooms.size();
+
+    // Where every room currently is, so each one can be found without searching
+    unordered_map<RoomModel *, int> where;
+    for (int i = 0; i < size; i++) {
+        if (_rooms->getRooms()[i] != nullptr) where[_rooms->getRooms()[i].get()] = i;
+    }
+
+    // Put each cell's room in place, which takes at most one swap per cell
+    for (int i = 0; i < size; i++) {
+        shared_ptr<RoomModel> displaced = _rooms->getRooms()[i];
+        if (rooms[i] == nullptr || rooms[i] == displaced) continue;
+
+        auto found = where.find(rooms[i].get());
+        if (found == where.end()) return false;
+        int j = found->second;
+
+        if (!swapRooms(Vec2(i % width, i / width), Vec2(j % width, j / width), true)) return false;
+        where[rooms[i].get()] = i;
+        if (displaced != nullptr) where[displaced.get()] = j;
+    }
+    return true;
+}
+
 /**
  *
  * Returns whether the two rooms with the given HOUSE space coordinates can be swapped.
@@ -510,66 +398,158 @@ bool GridModel::swapRooms(Vec2 pos1, Vec2 pos2, bool forced) {
  * @return      Whether the rooms can be swappedd
  */
 bool GridModel::canSwap(Vec2 room1, Vec2 room2) {
-    // Transform from HOUSE to GRID space
-    room1.x += _originX;
-    room1.y += _originY;
-    room2.x += _originX;
-    room2.y += _originY;
+    if (_rooms == nullptr) return false;
 
     // Can't swap if in different regions or in different sublevels within the same region
-    for (auto itr = _regions->begin(); itr != _regions->end(); ++itr) {
-        if ((*itr)->areInSameSublevel(room1.x, room1.y, room2.x, room2.y))
-            return true;
-    }
-    return false;
+    int sublevel1 = _rooms->getSublevel(room1.x, room1.y);
+    return (sublevel1 != NO_SUBLEVEL
+            && sublevel1 == _rooms->getSublevel(room2.x, room2.y)
+            && _rooms->getRegion(room1.x, room1.y) == _rooms->getRegion(room2.x, room2.y));
 };
 
 /**
+ * Returns a shared pointer to the vector of physics objects that compose
+ * the geometry of all rooms in the grid, with the level bounds included.
  *
- * Flattens _physicsGeometry, adds the bounds, and returns this vector
+ * The geometry is only built the first time this is called. After that,
+ * changes are applied incrementally with updatePhysicsGeometry().
  *
- * @return a flat version of _physicsGeometry, with the level bounds included
+ * @return  Shared pointer to vector of physics objects for room geometry
  */
-shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> GridModel::getPhysicsObjects() {
+shared_ptr<vector<shared_ptr<physics2::Obstacle>>> GridModel::getPhysicsObjects() {
     // flat vector to store all room obstacles
-    shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> obstacles = make_shared<vector<shared_ptr<physics2::PolygonObstacle>>>();
-
-    calculatePhysicsGeometry();
+    shared_ptr<vector<shared_ptr<physics2::Obstacle>>> obstacles = make_shared<vector<shared_ptr<physics2::Obstacle>>>();
 
-    // For each room in the grid
-    for (int col = 0; col < _size.x; col++) {
-        for (int row = 0; row < _size.y; row++) {
+    if (_physicsGeometry.empty()) calculatePhysicsGeometry();
 
-            // For each polygon in the room
-            for (auto itr = getPhysicsGeometryAt(row, col)->begin();
-                 itr != getPhysicsGeometryAt(row, col)->end(); ++itr) {
-                // add the obstacle to the flat vector
-                obstacles->push_back(*itr);
-            }
-        }
+    // For each room in the grid, add its obstacles to the flat vector
+    for (auto cellItr = _physicsGeometry.begin(); cellItr != _physicsGeometry.end(); ++cellItr) {
+        if (cellItr->body) obstacles->push_back(cellItr->body);
+        if (cellItr->trap) obstacles->push_back(cellItr->trap);
     }
 
     // MAKE BOUNDS OF LEVEL
 
-    // Get room dimensions scaled by grid scale
-    Vec2 roomscale = Vec2(DEFAULT_ROOM_WIDTH * getScaleX(), DEFAULT_ROOM_HEIGHT * getScaleY());
-    // Create path for level bounds
-    Path2 path = Path2(Rect(_originX * roomscale.x, _originY * roomscale.y,
-            _size.x * roomscale.x, _size.y * roomscale.y));
-    path.closed = true;
-    // Create geometry for level bounds
-    SimpleExtruder se = SimpleExtruder();
-    se.set(path);
-    se.calculate(0.1f);
-    shared_ptr<physics2::PolygonObstacle> ob = physics2::PolygonObstacle::alloc(se.getPolygon() / _physics_scale, Vec2::ZERO);
-    ob->setBodyType(b2_staticBody);
-    obstacles->push_back(ob);
+    if (_boundsObstacle == nullptr) {
+        // Get room dimensions scaled by grid scale
+        Vec2 roomscale = Vec2(DEFAULT_ROOM_WIDTH * getScaleX(), DEFAULT_ROOM_HEIGHT * getScaleY());
+        // Create path for level bounds
+        Path2 path = Path2(Rect(_originX * roomscale.x, _originY * roomscale.y,
+                _size.x * roomscale.x, _size.y * roomscale.y));
+        path.closed = true;
+        // Create geometry for level bounds
+        SimpleExtruder se = SimpleExtruder();
+        se.set(path);
+        se.calculate(0.1f);
+        _boundsObstacle = physics2::PolygonObstacle::alloc(se.getPolygon() / _physics_scale, Vec2::ZERO);
+        _boundsObstacle->setBodyType(b2_staticBody);
+    }
+    obstacles->push_back(_boundsObstacle);
+    EntityRegistry::Entity entity;
+    entity.type = EntityRegistry::EntityType::TERRAIN;
+    _pendingEntities.emplace_back(_boundsObstacle, entity);
 
     /// END MAKING BOUNDS OF LEVEL
 
     return obstacles;
 };
 
+/**
+ * Marks the physics objects of the room at the given HOUSE space coordinates
+ * as out of date, so they will be rebuilt by the next call to
+ * updatePhysicsGeometry().
+ *
+ * @param coord The coordinates of the room in (column, row) form
+ */
+void GridModel::markPhysicsDirty(Vec2 coord) {
+    if (_rooms == nullptr || !_rooms->inBounds(coord.x, coord.y) || _physicsDirty.empty()) return;
+
+    int index = (int)coord.y * _rooms->getWidth() + (int)coord.x;
+    if (!_physicsDirty[index]) {
+        _physicsDirty[index] = true;
+        _numPhysicsDirty++;
+    }
+}
+
+/**
+ * Marks the seams of the room at the given HOUSE space coordinates and of
+ * every room next to it in the same sublevel as out of date, since their
+ * merged geometry depends on each other. The rest of their physics is
+ * left alone.
+ *
+ * @param coord The coordinates of the room in (column, row) form
+ */
+void GridModel::markSeamsDirty(Vec2 coord) {
+    if (_rooms == nullptr || _seamsDirty.empty()) return;
+    int region = _rooms->getRegion(coord.x, coord.y);
+    int sublevel = _rooms->getSublevel(coord.x, coord.y);
+    if (sublevel == NO_SUBLEVEL) return;
+
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int x = coord.x + dx;
+            int y = coord.y + dy;
+            if (_rooms->getRegion(x, y) != region || _rooms->getSublevel(x, y) != sublevel) continue;
+
+            int index = y * _rooms->getWidth() + x;
+            if (!_seamsDirty[index]) {
+                _seamsDirty[index] = true;
+                _numSeamsDirty++;
+            }
+        }
+    }
+}
+
+/**
+ * Rebuilds the physics objects for every room that has been marked dirty
+ * since the last call. The old objects for those rooms are marked as removed,
+ * so the ObstacleWorld will drop them on its next garbage collection.
+ *
+ * Only the rooms that changed are rebuilt, so this is cheap to call every frame.
+ *
+ * @return  The newly created physics objects, which must be added to the world
+ */
+shared_ptr<vector<shared_ptr<physics2::Obstacle>>> GridModel::updatePhysicsGeometry() {
+    shared_ptr<vector<shared_ptr<physics2::Obstacle>>> obstacles = make_shared<vector<shared_ptr<physics2::Obstacle>>>();
+
+    // Nothing to do in the common case where no room has changed
+    if (!isPhysicsDirty()) return obstacles;
+
+    int width = _rooms->getWidth();
+    int size = (int)_physicsDirty.size();
+    for (int i = 0; i < size; i++) {
+        if (_physicsDirty[i]) {
+            // A full build merges the seams as well
+            shared_ptr<vector<shared_ptr<physics2::Obstacle>>> built = buildRoomPhysics(i % width, i / width);
+            obstacles->insert(obstacles->end(), built->begin(), built->end());
+        } else if (_seamsDirty[i]) {
+            // The room's body moved with it, so only the seams it shares with its new neighbors change
+            buildRoomSeams(i % width, i / width);
+        }
+        _physicsDirty[i] = false;
+        _seamsDirty[i] = false;
+    }
+    _numPhysicsDirty = 0;
+    _numSeamsDirty = 0;
+
+    return obstacles;
+}
+
+/**
+ * Registers every physics object built since the last call with the
+ * entity registry. This must be called once the objects returned by
+ * getPhysicsObjects() or updatePhysicsGeometry() are in the world.
+ */
+void GridModel::registerPhysics() {
+    if (_registry) {
+        for (auto itr = _pendingEntities.begin(); itr != _pendingEntities.end(); ++itr) {
+            // Skip anything that was replaced again before it made it into the world
+            if (!itr->first->isRemoved()) _registry->add(itr->first, itr->second);
+        }
+    }
+    _pendingEntities.clear();
+}
+
 #pragma mark Helpers
 
 Poly2 GridModel::convertToScreen(Poly2 poly) {
@@ -580,112 +560,467 @@ Poly2 GridModel::convertToScreen(Poly2 poly) {
     return Poly2(verts);
 };
 
+/**
+ * Returns the transform from the given node's coordinates to the coordinates of
+ * the given ancestor. This only looks at local transforms, so it doesn't depend on
+ * where the ancestor currently is.
+ *
+ * @param node      The node to transform from
+ * @param ancestor  An ancestor of the node to transform into
+ * @return          The node to ancestor transform
+ */
+static Affine2 getNodeToAncestorTransform(const scene2::SceneNode *node, const scene2::SceneNode *ancestor) {
+    Affine2 result = Affine2::IDENTITY;
+    while (node != nullptr && node != ancestor) {
+        result *= node->getNodeToParentTransform();
+        node = node->getParent();
+    }
+    return result;
+}
+
+/**
+ * Builds the physics objects for every room in the grid from scratch.
+ */
 void GridModel::calculatePhysicsGeometry() {
-    _physicsGeometry = make_shared<vector<shared_ptr<vector<shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>>>>>>();
+    int width = _rooms->getWidth();
+    int height = _rooms->getHeight();
+
+    // Remove anything left over from a previous build
+    for (int i = 0; i < (int)_physicsGeometry.size(); i++) {
+        releaseCellPhysics(i);
+    }
+    _physicsGeometry.assign(width * height, CellPhysics());
+    _physicsDirty.assign(width * height, false);
+    _numPhysicsDirty = 0;
+    _seamsDirty.assign(width * height, false);
+    _numSeamsDirty = 0;
 
-    // Trap cache
-    shared_ptr<TrapModel> trap;
-    // Room cache
-    shared_ptr<RoomModel> room;
+    // Fixtures there would be if every triangle of every polygon were its own fixture
+    int unmergedFixtures = 0;
+    // Fixtures there actually are after merging
+    int mergedFixtures = 0;
 
-    int fillerInd = 0;
     // For each room in the world
-    for (int row = 0; row < _size.y; row++) {
-        _physicsGeometry->push_back(make_shared<vector<shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>>>>());
+    _rooms->forEachRoom([&](int x, int y, const shared_ptr<RoomModel> &room) {
+        shared_ptr<vector<Poly2>> polys = getRoomTypePhysics(room);
+        for (auto itr = polys->begin(); itr != polys->end(); ++itr) {
+            unmergedFixtures += (int)itr->getIndices().size() / 3;
+        }
 
-        for (int col = 0; col < _size.x; col++) {
-            _physicsGeometry->at(row)->push_back(make_shared<vector<shared_ptr<physics2::PolygonObstacle>>>());
+        buildRoomPhysics(x, y);
+        shared_ptr<ChainObstacle> body = getPhysicsGeometryAt(y, x).body;
+        if (body != nullptr) mergedFixtures += body->getChainCount();
+    });
 
-            room = getRoom(col, row);
+    CULog("Room geometry: %d polygon fixtures merged into %d chain fixtures", unmergedFixtures, mergedFixtures);
+}
 
-            // If there's no room here, pull the corresponding solid one from the fillers
-            // This loop happens in the same order that the fillers were created, so we can just pop off
-            if (room == nullptr) {
-                //room = _filler->at(fillerInd);
-                fillerInd++;
-                continue;
-            }
+/**
+ * Returns the geometry of the given room's type in room-local coordinates.
+ * This is shared with every other room of that type.
+ *
+ * @param room  A room whose type's geometry should be returned
+ * @return      The geometry of the room's type
+ */
+shared_ptr<vector<Poly2>> GridModel::getRoomTypePhysics(const shared_ptr<RoomModel> &room) {
+    return RoomModel::getRoomTypeGeometry(room->getRoomID());
+}
 
-            // Get pointers to PolygonNodes with the room's geometry
-            shared_ptr<vector<shared_ptr<scene2::PolygonNode>>> geometry = room->getGeometry();
+/**
+ * Returns the merged geometry of the given room's type in room-local
+ * coordinates, merging it the first time that type is asked for.
+ *
+ * @param room  A room whose type's geometry should be returned
+ * @return      The merged geometry of the room's type
+ */
+const GridModel::RoomTypeOutlines &GridModel::getRoomTypeOutlines(const shared_ptr<RoomModel> &room) {
+    auto cached = _roomTypeOutlines.find(room->getRoomID());
+    if (cached != _roomTypeOutlines.end()) return cached->second;
+
+    RoomTypeOutlines &result = _roomTypeOutlines[room->getRoomID()];
+    Rect cell(0, 0, DEFAULT_ROOM_WIDTH, DEFAULT_ROOM_HEIGHT);
+    vector<vector<Vec2>> outlines = GeometryMerger::unionPolygons(*getRoomTypePhysics(room));
+    for (auto itr = outlines.begin(); itr != outlines.end(); ++itr) {
+        if (GeometryMerger::isInsideCell(*itr, cell)) {
+            result.interior.push_back(std::move(*itr));
+        } else {
+            result.border.push_back(std::move(*itr));
+        }
+    }
+    return result;
+}
 
-            // For each polygon in the room
-            if (geometry) {
-                for (vector<shared_ptr<scene2::PolygonNode>>::iterator itr = geometry->begin(); itr != geometry->end(); ++itr) {
-                    // Copy polygon data
-                    Poly2 poly = (*itr)->getPolygon();
-                    // Get node to world transformation and apply to the polygon
-                    poly *= (*itr)->getNodeToWorldTransform();
-                    // Scale to physics space
-                    poly /= _physics_scale;
+/**
+ * Returns the transform from room-local coordinates to physics space for a
+ * room sitting at the given HOUSE space coordinates.
+ *
+ * This uses the cell, not the room node's current position, so that it is
+ * correct even while the room is still animating into place.
+ *
+ * @param x     The column of the room in HOUSE space
+ * @param y     The row of the room in HOUSE space
+ * @return      The room to physics transform
+ */
+Affine2 GridModel::getCellToPhysicsTransform(int x, int y) {
+    // Room to grid, then grid to world, then world to physics
+    Affine2 transform = Affine2::createTranslation((x + _originX) * DEFAULT_ROOM_WIDTH,
+            (y + _originY) * DEFAULT_ROOM_HEIGHT);
+    transform *= getNodeToWorldTransform();
+    transform *= Affine2::createScale(1.0f / _physics_scale);
+    return transform;
+}
 
-                    // Create physics obstacle
-                    shared_ptr<physics2::PolygonObstacle> obstacle = physics2::PolygonObstacle::alloc(poly, Vec2::ZERO);
-                    obstacle->setBodyType(b2_staticBody);
+/**
+ * Moves the physics objects of the cell at the given index by the given
+ * offset, without rebuilding them.
+ *
+ * @param index     The index of the cell in the room table
+ * @param offset    How far to move the objects, in physics space
+ */
+void GridModel::moveCellPhysics(int index, Vec2 offset) {
+    CellPhysics &cell = _physicsGeometry[index];
+    if (cell.body) cell.body->setPosition(cell.body->getPosition() + offset);
+    if (cell.trap) cell.trap->setPosition(cell.trap->getPosition() + offset);
+}
 
-                    getPhysicsGeometryAt(row, col)->push_back(obstacle);
-                }
-            }
+/**
+ * Releases the physics objects of the cell at the given index and marks
+ * them as removed, leaving the cell empty.
+ *
+ * @param index     The index of the cell in the room table
+ */
+void GridModel::releaseCellPhysics(int index) {
+    CellPhysics &cell = _physicsGeometry[index];
+    if (cell.body) {
+        if (_registry) _registry->release(cell.body);
+        cell.body->markRemoved(true);
+    }
+    if (cell.trap) {
+        if (_registry) _registry->release(cell.trap);
+        cell.trap->markRemoved(true);
+    }
+    cell = CellPhysics();
+}
 
-            // TODO: Inspect code for bug
-            // TODO: Why does this have no impact on instantiation
-            // if the room has a trap
-            trap = room->getTrap();
-            if (trap) {
-                shared_ptr<scene2::PolygonNode> pn = trap->getPolyNode();
-                Poly2 p = pn->getPolygon();
-                p *= pn->getNodeToWorldTransform();
-                p /= _physics_scale;
-
-                // Create physics obstacle
-                shared_ptr<physics2::PolygonObstacle> obstacle = physics2::PolygonObstacle::alloc(p, Vec2::ZERO);
-                obstacle->setBodyType(b2_staticBody);
-
-                getPhysicsGeometryAt(row, col)->push_back(obstacle);
-                trap->initObstacle(obstacle);
-                if (trap->getType() == TrapModel::TrapType::TRAPDOOR) {
-                    trap->getObstacle()->setSensor(true);
-                }
-                if (trap->getType() == TrapModel::TrapType::SAP) {
-                    trap->getObstacle()->setSensor(true);
-                }
-                if (trap->getType() == TrapModel::TrapType::CHECKPOINT) {
-                    trap->getObstacle()->setSensor(true);
+/**
+ * Builds the physics objects for the room at the given HOUSE space coordinates,
+ * replacing any it had before. The old objects are marked as removed.
+ *
+ * The room geometry is kept as a single ChainObstacle. Its seams are merged
+ * with the geometry of its neighbors in the same sublevel, so there are no
+ * seams at the room's edges. The room's trap and exit blockade, if any, are
+ * built as well.
+ *
+ * @param x     The column of the room in HOUSE space
+ * @param y     The row of the room in HOUSE space
+ * @return      The physics objects that were created for the room
+ */
+shared_ptr<vector<shared_ptr<physics2::Obstacle>>> GridModel::buildRoomPhysics(int x, int y) {
+    shared_ptr<vector<shared_ptr<physics2::Obstacle>>> obstacles = make_shared<vector<shared_ptr<physics2::Obstacle>>>();
+
+    // Get rid of the old obstacles for this cell
+    int index = y * _rooms->getWidth() + x;
+    releaseCellPhysics(index);
+    CellPhysics &cell = _physicsGeometry[index];
+
+    shared_ptr<RoomModel> room = getRoom(x, y);
+    if (room == nullptr) return obstacles;
+
+    // Bodies are always enabled when added to the world, so disable them afterwards if needed
+    if (!isRoomActive(x, y)) _pendingDeactivate.push_back(index);
+
+    Affine2 cellTransform = getCellToPhysicsTransform(x, y);
+
+    // The body sits at the corner of the cell, so everything in it is relative to the room
+    shared_ptr<ChainObstacle> body = ChainObstacle::alloc(cellTransform.transform(Vec2::ZERO));
+    // Anything strictly inside the room is a loop that never changes, however the rooms are arranged
+    const RoomTypeOutlines &outlines = getRoomTypeOutlines(room);
+    for (auto itr = outlines.interior.begin(); itr != outlines.interior.end(); ++itr) {
+        ChainObstacle::Chain loop;
+        loop.loop = true;
+        loop.vertices.reserve(itr->size());
+        for (auto vItr = itr->begin(); vItr != itr->end(); ++vItr) {
+            loop.vertices.push_back(cellTransform.transform(*vItr));
+        }
+        body->addChain(loop);
+    }
+
+    // If the room has a trap
+    shared_ptr<TrapModel> trap = room->getTrap();
+    if (trap) {
+        shared_ptr<scene2::PolygonNode> pn = trap->getPolyNode();
+        Poly2 p = pn->getPolygon() * getNodeToAncestorTransform(pn.get(), room.get());
+        p *= cellTransform;
+
+        // Create physics obstacle
+        shared_ptr<physics2::PolygonObstacle> obstacle = physics2::PolygonObstacle::alloc(p, Vec2::ZERO);
+        obstacle->setBodyType(b2_staticBody);
+
+        cell.trap = obstacle;
+        obstacles->push_back(obstacle);
+        trap->initObstacle(obstacle);
+        EntityRegistry::Entity entity;
+        entity.type = EntityRegistry::EntityType::TRAP;
+        entity.trap = trap;
+        _pendingEntities.emplace_back(obstacle, entity);
+        if (trap->getType() == TrapModel::TrapType::TRAPDOOR) {
+            trap->getObstacle()->setSensor(true);
+        }
+        if (trap->getType() == TrapModel::TrapType::SAP) {
+            trap->getObstacle()->setSensor(true);
+        }
+        if (trap->getType() == TrapModel::TrapType::CHECKPOINT) {
+            trap->getObstacle()->setSensor(true);
+        }
+    }
+
+    // If the room is an exit room of a region that hasn't been cleared yet
+    int regionNum = _rooms->getRegion(x, y);
+    if (regionNum != NO_REGION) {
+        shared_ptr<RegionModel> region = _regions->at(regionNum - 1);
+        shared_ptr<scene2::PolygonNode> blockade = region->getBlockade(room);
+        if (blockade) {
+            Poly2 blockPoly = blockade->getPolygon() * getNodeToAncestorTransform(blockade.get(), room.get());
+            blockPoly *= cellTransform;
+            body->addPolygon(blockPoly);
+        }
+    }
+
+    // Only rooms with something solid get a body
+    if (body->getChainCount() > 0 || body->getPolygonCount() > 0 || !outlines.border.empty()) {
+        cell.body = body;
+        buildRoomSeams(x, y);
+        obstacles->push_back(body);
+        EntityRegistry::Entity entity;
+        entity.type = EntityRegistry::EntityType::TERRAIN;
+        _pendingEntities.emplace_back(body, entity);
+    }
+
+    return obstacles;
+}
+
+/**
+ * Merges the seams of the room at the given HOUSE space coordinates with its
+ * neighbors in the same sublevel again, and puts them on the room's body.
+ * Nothing else about the body changes.
+ *
+ * Room geometry never leaves its own cell, so only the outlines that reach
+ * the edge of a room can merge with anything, and only those are unioned.
+ *
+ * @param x     The column of the room in HOUSE space
+ * @param y     The row of the room in HOUSE space
+ */
+void GridModel::buildRoomSeams(int x, int y) {
+    CellPhysics &cell = _physicsGeometry[y * _rooms->getWidth() + x];
+    shared_ptr<RoomModel> room = getRoom(x, y);
+    if (room == nullptr || cell.body == nullptr) return;
+
+    // A room that doesn't reach its edges has no seams
+    if (getRoomTypeOutlines(room).border.empty()) return;
+
+    // Gather the outlines reaching the edges of this room and its neighbors in the same
+    // sublevel, in this room's coordinates, so that anything crossing a seam is merged
+    vector<vector<Vec2>> border;
+    int region = _rooms->getRegion(x, y);
+    int sublevel = _rooms->getSublevel(x, y);
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            shared_ptr<RoomModel> neighbor = getRoom(x + dx, y + dy);
+            if (neighbor == nullptr || _rooms->getRegion(x + dx, y + dy) != region
+                || _rooms->getSublevel(x + dx, y + dy) != sublevel) continue;
+
+            Vec2 offset(dx * DEFAULT_ROOM_WIDTH, dy * DEFAULT_ROOM_HEIGHT);
+            const vector<vector<Vec2>> &neighborBorder = getRoomTypeOutlines(neighbor).border;
+            for (auto itr = neighborBorder.begin(); itr != neighborBorder.end(); ++itr) {
+                border.push_back(*itr);
+                for (auto vItr = border.back().begin(); vItr != border.back().end(); ++vItr) {
+                    *vItr += offset;
                 }
             }
         }
     }
 
-    // Also do exit blockade geometry
-    Poly2 blockPoly;
-    shared_ptr<physics2::PolygonObstacle> obstacle;
-    shared_ptr<vector<shared_ptr<RoomModel>>> exitRooms;
-    int counter = 0;
-    // For each region
-    for (auto regItr = _regions->begin(); regItr != _regions->end(); ++regItr) {
-        exitRooms = (*regItr)->getExitRooms();
-        // Don't do this region if exit rooms == nullptr, meaning the region has been cleared
-        if (exitRooms == nullptr) continue;
-        // For each blockade in that region
-        for (auto blockItr = (*regItr)->getBlockades()->begin();
-             blockItr != (*regItr)->getBlockades()->end(); ++blockItr) {
-            blockPoly = (*blockItr)->getPolygon();
-            blockPoly *= (*blockItr)->getNodeToWorldTransform();
-            blockPoly /= _physics_scale;
-
-            // Create physics obstacle
-            obstacle = physics2::PolygonObstacle::alloc(blockPoly, Vec2::ZERO);
-            obstacle->setBodyType(b2_staticBody);
-
-            // Counter will let rooms/blockades align because they were added simultaneously
-            getPhysicsGeometryAt(exitRooms->at(counter)->getPositionY() / DEFAULT_ROOM_HEIGHT,
-                    exitRooms->at(counter)->getPositionX() / DEFAULT_ROOM_WIDTH)->push_back(obstacle);
-            (*regItr)->addBlockadeObs(obstacle);
-
-            counter++;
+    // Keep only the merged outline inside this room, with a chain per piece
+    vector<ChainObstacle::Chain> seams = GeometryMerger::clipToCell(GeometryMerger::unionOutlines(border),
+            Rect(0, 0, DEFAULT_ROOM_WIDTH, DEFAULT_ROOM_HEIGHT));
+    Affine2 cellTransform = getCellToPhysicsTransform(x, y);
+    for (auto itr = seams.begin(); itr != seams.end(); ++itr) {
+        // Bring the chain into physics space
+        for (auto vItr = itr->vertices.begin(); vItr != itr->vertices.end(); ++vItr) {
+            *vItr = cellTransform.transform(*vItr);
         }
-        counter = 0;
+        itr->prevVertex = cellTransform.transform(itr->prevVertex);
+        itr->nextVertex = cellTransform.transform(itr->nextVertex);
     }
+    cell.body->setSeams(seams);
+}
+
+/**
+ * Clears the given region, removing its blockades, and marks its exit rooms
+ * so that their physics are rebuilt without the blockades.
+ *
+ * @param region    The region to clear
+ */
+void GridModel::clearRegion(shared_ptr<RegionModel> region) {
+    // Grab the exit rooms first, since clearing the region forgets them
+    shared_ptr<vector<shared_ptr<RoomModel>>> exitRooms = region->getExitRooms();
+
+    region->clearRegion();
+
+    if (exitRooms == nullptr || _rooms == nullptr) return;
+    for (auto itr = exitRooms->begin(); itr != exitRooms->end(); ++itr) {
+        markPhysicsDirty(_rooms->findRoom(*itr));
+    }
+}
+
+#pragma mark Activation
+
+/**
+ * Moves the activation window to be around the given room and the given
+ * rooms on screen. Rooms within ACTIVE_RADIUS of Reynard or on screen
+ * are activated. Active rooms are only deactivated once they are more
+ * than ACTIVE_HYSTERESIS rooms further out, so rooms at the edge of the
+ * window don't flicker on and off as Reynard moves back and forth.
+ *
+ * Nothing is recomputed if the window hasn't moved.
+ *
+ * @param center    Reynard's room in HOUSE space
+ * @param view      The rooms on screen in HOUSE space, from the lower left room to the upper right one
+ */
+void GridModel::updateActivation(Vec2 center, Rect view) {
+    if (_rooms == nullptr) return;
+
+    // Disable anything that was rebuilt while its room was inactive
+    for (auto itr = _pendingDeactivate.begin(); itr != _pendingDeactivate.end(); ++itr) {
+        if (!_active[*itr]) setCellActive(*itr, false);
+    }
+    _pendingDeactivate.clear();
+
+    if (center == _activeCenter && view.equals(_activeView)) return;
+    _activeCenter = center;
+    _activeView = view;
+
+    int i = 0;
+    for (int y = 0; y < _rooms->getHeight(); y++) {
+        for (int x = 0; x < _rooms->getWidth(); x++, i++) {
+            // Active rooms get some slack before they switch off
+            int slack = _active[i] ? ACTIVE_HYSTERESIS : 0;
+            int distance = max(abs(x - (int)center.x), abs(y - (int)center.y));
+            bool onScreen = (view.getMinX() - slack <= x && x <= view.getMaxX() + slack
+                             && view.getMinY() - slack <= y && y <= view.getMaxY() + slack);
+            bool active = (distance <= ACTIVE_RADIUS + slack) || onScreen;
+
+            if (active != _active[i]) setCellActive(i, active);
+        }
+    }
+
+    // A region is active as long as any of its rooms is
+    if (_activeRegionsChanged) {
+        _activeRegions->clear();
+        for (size_t k = 0; k < _activeRoomCounts.size(); k++) {
+            if (_activeRoomCounts[k] > 0) _activeRegions->push_back(_regions->at(k));
+        }
+        _activeRegionsChanged = false;
+    }
+}
+
+/**
+ * Activates or deactivates the cell at the given index in the room table,
+ * showing or hiding its room and enabling or disabling its physics objects.
+ *
+ * @param index     The index of the cell in the room table
+ * @param active    Whether the cell should be active
+ */
+void GridModel::setCellActive(int index, bool active) {
+    // Keep count of how many active rooms each region has
+    int region = _rooms->getRegion(index % _rooms->getWidth(), index / _rooms->getWidth());
+    if (active != _active[index] && region != NO_REGION && region <= (int)_activeRoomCounts.size()) {
+        int &count = _activeRoomCounts[region - 1];
+        count += (active ? 1 : -1);
+        if (count == (active ? 1 : 0)) _activeRegionsChanged = true;
+    }
+    _active[index] = active;
+
+    shared_ptr<RoomModel> room = _rooms->getRooms()[index];
+    if (room != nullptr) room->setVisible(active);
+
+    if (index < (int)_physicsGeometry.size()) {
+        if (_physicsGeometry[index].body) _physicsGeometry[index].body->setEnabled(active);
+        if (_physicsGeometry[index].trap) _physicsGeometry[index].trap->setEnabled(active);
+    }
+}
+
+#pragma mark Fog of War
+
+/**
+ * Removes the fog of war from every room within the given number of rooms
+ * of the given one, in any direction.
+ *
+ * @param center    The room in the middle, in HOUSE space
+ * @param radius    How many rooms out to reveal
+ * @return          How many rooms had their fog removed
+ */
+int GridModel::revealAround(Vec2 center, int radius) {
+    if (_rooms == nullptr) return 0;
+
+    int revealed = 0;
+    int minX = max((int)center.x - radius, 0);
+    int maxX = min((int)center.x + radius, _rooms->getWidth() - 1);
+    int minY = max((int)center.y - radius, 0);
+    int maxY = min((int)center.y + radius, _rooms->getHeight() - 1);
+    for (int y = minY; y <= maxY; y++) {
+        for (int x = minX; x <= maxX; x++) {
+            int index = y * _rooms->getWidth() + x;
+            if (!getFogBit(index)) continue;
+            setFogBit(index, false);
+            revealed++;
+        }
+    }
+    return revealed;
+}
+
+/**
+ * Sets whether the cell at the given index in the room table has fog of
+ * war, noting the change so its room is updated by applyFogChanges().
+ */
+void GridModel::setFogBit(int index, bool hasFog) {
+    if (getFogBit(index) == hasFog) return;
+    _fog[index >> 3] ^= (1 << (index & 7));
+    _fogChanges.push_back(index);
+}
+
+/**
+ * Updates the appearance of every room whose fog changed since the last
+ * call, leaving every other room alone.
+ */
+void GridModel::applyFogChanges() {
+    for (auto itr = _fogChanges.begin(); itr != _fogChanges.end(); ++itr) {
+        shared_ptr<RoomModel> room = _rooms->getRooms()[*itr];
+        // A cell can change more than once, so go by where it ended up
+        if (room != nullptr) room->setFogged(getFogBit(*itr));
+    }
+    _fogChanges.clear();
+}
+
+/**
+ * Replaces the fog of war of every cell with the given bitmap, as returned
+ * by getFogBits() at an earlier point. Does nothing if the bitmap is for a
+ * table of a different size.
+ *
+ * @param bits  The fog bitmap
+ * @return      Whether the bitmap was applied
+ */
+bool GridModel::setFogBits(const vector<Uint8> &bits) {
+    if (bits.size() != _fog.size()) return false;
+
+    for (int i = 0; i < (int)_fog.size(); i++) {
+        Uint8 changed = _fog[i] ^ bits[i];
+        for (int j = 0; changed != 0; j++, changed >>= 1) {
+            if (changed & 1) _fogChanges.push_back(i * 8 + j);
+        }
+        _fog[i] = bits[i];
+    }
+    return true;
 }
 
 #pragma mark Checkpoints
@@ -715,7 +1050,7 @@ int GridModel::clearCheckpoint(int cID) {
         }
             // If the region is now clear, clear it accordingly
         else if (outcome == 2) {
-            (*regItr)->clearRegion();
+            clearRegion(*regItr);
             // Play sound effect
             AudioController::playSFX(VINE_SOUND);
             // Checkpoint and region cleared
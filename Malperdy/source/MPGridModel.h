@@ -18,12 +18,28 @@
 #include <cugl/cugl.h>
 #include "MPRoomModel.h"
 #include "MPRegionModel.h"
+#include "MPRoomTable.h"
+#include "MPChainObstacle.h"
+#include "MPGeometryMerger.h"
+#include "MPLevelPack.h"
+#include "MPLevelCompiler.h"
 #include "MPCheckpoint.h"
 #include "MPCheckpointKey.h"
 #include "MPCheckpointKeyCrazy.hpp"
+#include "MPEntityRegistry.h"
+#include "MPSwapAnimator.h"
+#include "MPOccupancyGrid.h"
 
 #define DEFAULT_REGION 1
 
+/** The compiled level pack, relative to the assets. Built from the world JSON if it's missing or out of date */
+#define LEVEL_PACK_FILE "json/levels/MP_World.pack"
+
+/** How many rooms away from Reynard (in any direction) rooms are activated */
+#define ACTIVE_RADIUS 2
+/** How many rooms further than that an active room has to get before it's deactivated */
+#define ACTIVE_HYSTERESIS 1
+
 using namespace cugl;
 
 class GridModel : public cugl::scene2::SceneNode {
@@ -38,6 +54,29 @@ public:
     shared_ptr<vector<pair<Vec2, bool>>> _enemySpawnInfo =
             make_shared<vector<pair<Vec2, bool>>>();
 
+    /**
+     * The physics objects of a single cell. Both are authored relative to the
+     * lower left corner of the cell, so moving a room to another cell only
+     * takes one setPosition() for each.
+     */
+    struct CellPhysics {
+        /** The room's solid geometry and exit blockade, as one static body with a fixture per piece */
+        shared_ptr<ChainObstacle> body;
+        /** The room's trap, which is its own body so contacts can tell it apart */
+        shared_ptr<physics2::PolygonObstacle> trap;
+    };
+
+    /**
+     * The merged geometry of a room type in room-local coordinates, split by
+     * whether it can touch the geometry of the rooms next to it.
+     */
+    struct RoomTypeOutlines {
+        /** Outlines strictly inside the room, which are the same wherever the room is */
+        vector<vector<Vec2>> interior;
+        /** Outlines that reach the edge of the room, which are merged with the neighbors */
+        vector<vector<Vec2>> border;
+    };
+
 private:
     /** Reference to asset manager */
     shared_ptr<cugl::AssetManager> _assets;
@@ -49,8 +88,6 @@ private:
     /** Size of each tile in pixels */
     int _tileSize;
 
-    /** Rooms tileset */
-    shared_ptr<JsonValue> _roomsTileset;
 
     /**
      * Size of the entire level, spanning all regions (in units of number of rooms )
@@ -71,22 +108,88 @@ private:
      */
     vector<Checkpoint *> checkpoints;
 
-    /*
-     * The 2D data type for the grid. _grid[i][j] is the ptr to the room at the ith row from the bottom, jth column from the left.
+    /**
+     * Dense row-major table of every room in the grid in HOUSE space, along with the
+     * region and sublevel of each cell. Shared with all the regions.
      */
-    //shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> _grid;
+    shared_ptr<RoomTable> _rooms;
 
-    /*
-     * Holds all the physics objects of the grid
+    /**
+     * Holds all the physics objects of the grid, one entry per cell in the same
+     * row-major HOUSE space order as the room table
      */
-    shared_ptr<vector<shared_ptr<vector<shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>>>>>> _physicsGeometry;
+    vector<CellPhysics> _physicsGeometry;
+
+    /** Whether the physics objects of each cell need to be rebuilt, in the same order as [_physicsGeometry] */
+    vector<bool> _physicsDirty;
+
+    /** Number of cells currently marked in [_physicsDirty] */
+    int _numPhysicsDirty = 0;
+
+    /** Whether the seams of each cell need to be merged again, in the same order as [_physicsGeometry] */
+    vector<bool> _seamsDirty;
+
+    /** Number of cells currently marked in [_seamsDirty] */
+    int _numSeamsDirty = 0;
+
+    /** The merged geometry of every room type seen so far, by room ID */
+    map<string, RoomTypeOutlines> _roomTypeOutlines;
+
+    /** The physics object for the bounds of the level, which never changes */
+    shared_ptr<physics2::PolygonObstacle> _boundsObstacle;
+
+    /** Registry that says what each body in the world belongs to */
+    shared_ptr<EntityRegistry> _registry;
+
+    /** Physics objects built since the last call to registerPhysics(), with what they belong to */
+    vector<pair<shared_ptr<physics2::Obstacle>, EntityRegistry::Entity>> _pendingEntities;
+
+    /** Slides swapped rooms into place */
+    shared_ptr<SwapAnimator> _swaps = SwapAnimator::alloc();
+
+    /** Which room every character is in */
+    shared_ptr<OccupancyGrid> _occupancy;
+
+    // ACTIVATION
+
+    /**
+     * Whether each cell is in the activation window, in the same order as the room table.
+     * Inactive rooms are hidden, their physics objects are disabled, and they aren't updated.
+     */
+    vector<bool> _active;
+
+    /** Inactive cells whose physics were rebuilt, so the new objects need to be disabled once they're in the world */
+    vector<int> _pendingDeactivate;
+
+    /** How many active cells each region has, by region number starting from 1 */
+    vector<int> _activeRoomCounts;
+
+    /** Whether a region has gained its first active cell or lost its last one since the active regions were listed */
+    bool _activeRegionsChanged = false;
+
+    /** Reynard's room in HOUSE space the last time the activation window was updated */
+    Vec2 _activeCenter = Vec2(-1, -1);
+
+    /** The rooms on screen in HOUSE space the last time the activation window was updated */
+    Rect _activeView;
+
+    // FOG OF WAR
+
+    /**
+     * One bit per cell in the same order as the room table, set if the room in
+     * the cell has fog of war. Cells without a room never have fog.
+     */
+    vector<Uint8> _fog;
+
+    /** Cells whose fog changed since the last call to applyFogChanges() */
+    vector<int> _fogChanges;
 
     // REGIONS
 
     /** The regions that form the entire level */
     shared_ptr<vector<shared_ptr<RegionModel>>> _regions = make_shared<vector<shared_ptr<RegionModel>>>();
 
-    /** The regions that Reynard has already unlocked and therefore has access to */
+    /** The regions with at least one room in the activation window */
     shared_ptr<vector<shared_ptr<RegionModel>>> _activeRegions = make_shared<vector<shared_ptr<RegionModel>>>();
 
     /** Filler solid rooms for the empty spaces in the level */
@@ -116,15 +219,6 @@ public:
     }
 
 private:
-    /**
-     * Initializes and returns a grid of rooms with the given dimensions.
-     *
-     * @param width     The width/number of columns of rooms that the grid should have
-     * @param height    The height/number of rows of rooms that the grid should have
-     * @return          The initialized grid with the given dimensions
-     */
-    shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> initGrid(int width, int height);
-
     /**
      * Initializes a region for the game. The region is placed such that its
      * lower left corner, its region origin, is at the given coordinates in the
@@ -134,10 +228,13 @@ private:
      * in grid space are the region's origin, which will be used to organize the regions,
      * but otherwise regions only care about where things are relative to their origin.
      *
-     * @param region    The JSONValue for the metadata of the region to be initialized
-
+     * The region's rooms are placed directly into the RoomTable, which must already
+     * have been allocated to cover the region.
+     *
+     * @param pack      The level pack holding the region
+     * @param number    The number of the region in the grid, from 1
      */
-    void initRegion(shared_ptr<JsonValue> region);
+    void initRegion(const LevelPack &pack, int number);
 
 public:
     /**
@@ -214,11 +311,35 @@ public:
      * @param y The row from the bottom that the desired room is located in
      * @return  The room located at the given coordinates
      */
-    shared_ptr<RoomModel> getRoom(int x, int y);
+    shared_ptr<RoomModel> getRoom(int x, int y) {
+        return (_rooms == nullptr) ? nullptr : _rooms->getRoom(x, y);
+    }
+
+    /**
+     * Returns the table storing every room in the grid, in HOUSE space.
+     *
+     * @return  The grid's room table
+     */
+    shared_ptr<RoomTable> getRoomTable() {
+        return _rooms;
+    }
+
+    /**
+     * Calls the given function on every room in the grid, along with its
+     * coordinates in HOUSE space. Empty cells are skipped.
+     *
+     * The function should have the signature f(int x, int y, const shared_ptr<RoomModel>&).
+     *
+     * @param f     The function to call on each room
+     */
+    template<typename F>
+    void forEachRoom(F f) {
+        if (_rooms != nullptr) _rooms->forEachRoom(f);
+    }
 
     /**
-     * Returns all the active regions, so the ones that Reynard has
-     * already unlocked and therefore has access to.
+     * Returns all the active regions, so the ones with at least one room in
+     * the activation window. The list is updated in place by updateActivation().
      * 
      * @return  The list of active regions
      */
@@ -236,8 +357,8 @@ public:
      * @param col   Column of the room in GRID coordinates
      * @return      Physics objects in the given room
      */
-    shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> getPhysicsGeometryAt(int row, int col) {
-        return (_physicsGeometry->at(row)->at(col));
+    CellPhysics &getPhysicsGeometryAt(int row, int col) {
+        return (_physicsGeometry.at(row * _rooms->getWidth() + col));
     }
 
 private:
@@ -249,16 +370,77 @@ private:
      * @param y     A y-coordinate in GRID space
      * @return      The region # (1-3) that these coordinates are in, or 0 if not found
      */
-    int getRegion(int x, int y);
+    int getRegion(int x, int y) {
+        return (_rooms == nullptr) ? NO_REGION : _rooms->getRegion(x - _originX, y - _originY);
+    }
 
 public:
     /**
      * Returns a shared pointer to the vector of physics objects that compose
      * the geometry of all rooms in the grid.
      *
+     * The geometry is only built the first time this is called. After that,
+     * changes are applied incrementally with updatePhysicsGeometry().
+     *
      * @return  Shared pointer to vector of physics objects for room geometry
      */
-    shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> getPhysicsObjects();
+    shared_ptr<vector<shared_ptr<physics2::Obstacle>>> getPhysicsObjects();
+
+    /**
+     * Marks the physics objects of the room at the given HOUSE space coordinates
+     * as out of date, so they will be rebuilt by the next call to
+     * updatePhysicsGeometry().
+     *
+     * @param coord The coordinates of the room in (column, row) form
+     */
+    void markPhysicsDirty(Vec2 coord);
+
+    /**
+     * Marks the seams of the room at the given HOUSE space coordinates and of
+     * every room next to it in the same sublevel as out of date, since their
+     * merged geometry depends on each other. The rest of their physics is
+     * left alone.
+     *
+     * @param coord The coordinates of the room in (column, row) form
+     */
+    void markSeamsDirty(Vec2 coord);
+
+    /**
+     * Returns whether any physics objects will change on the next call to
+     * updatePhysicsGeometry().
+     *
+     * @return  Whether any physics objects are out of date
+     */
+    bool isPhysicsDirty() const {
+        return _numPhysicsDirty > 0 || _numSeamsDirty > 0;
+    }
+
+    /**
+     * Rebuilds the physics objects for every room that has been marked dirty
+     * since the last call. The old objects for those rooms are marked as removed,
+     * so the ObstacleWorld will drop them on its next garbage collection.
+     *
+     * Only the rooms that changed are rebuilt, so this is cheap to call every frame.
+     *
+     * @return  The newly created physics objects, which must be added to the world
+     */
+    shared_ptr<vector<shared_ptr<physics2::Obstacle>>> updatePhysicsGeometry();
+
+    /**
+     * Sets the registry that the grid's physics objects are registered with.
+     *
+     * @param registry  The registry for the bodies in the world
+     */
+    void setEntityRegistry(const shared_ptr<EntityRegistry> &registry) {
+        _registry = registry;
+    }
+
+    /**
+     * Registers every physics object built since the last call with the
+     * entity registry. This must be called once the objects returned by
+     * getPhysicsObjects() or updatePhysicsGeometry() are in the world.
+     */
+    void registerPhysics();
 
     Vec2 gridSpaceToRoom(Vec2 coord) {
         int x = (static_cast<int>(coord.x) / DEFAULT_ROOM_WIDTH) - _originX;
@@ -274,6 +456,17 @@ public:
         return Vec2(x, y);
     }
 
+    /**
+     * Returns the transform from world space to the grid's node space, so
+     * that many points can be converted to rooms with gridSpaceToRoom()
+     * without working out the transform for each one.
+     *
+     * @return  The world to grid transform
+     */
+    Affine2 getWorldToGridTransform() {
+        return getNodeToWorldTransform().getInverse();
+    }
+
     Vec2 worldSpaceToRoom(Vec2 coord) {
         //Vec2 gridcoords = this->screenToNodeCoords(coord);
         // World to grid space
@@ -297,29 +490,83 @@ public:
     * @return whether the room at the given coordinates has fog of war
     */
     bool isRoomFogged(Vec2 coord) {
-        return getRoom(coord) != nullptr && getRoom(coord)->isFogged();
+        return _rooms != nullptr && _rooms->inBounds(coord.x, coord.y)
+               && getFogBit((int)coord.y * _rooms->getWidth() + (int)coord.x);
     }
 
+    /**
+     * Updates every room in the activation window, and moves any rooms that
+     * are still sliding into place after a swap. Rooms outside of the window,
+     * including their traps, are not updated at all.
+     *
+     * @param dt    Number of seconds since the last frame
+     */
     void update(float dt) {
-        for (int i = 0; i < _regions->size(); i++) {
-            shared_ptr<RegionModel> rm = _regions->at(i);
-
-            int width = rm->getWidth();
-            int height = rm->getHeight();
-
-            for (int row = 0; row < height; row++) {
-                for (int col = 0; col < width; col++) {
-                    // Get room, but convert from REGION to GRID space
-                    shared_ptr<RoomModel> room = rm->getRoom(col + rm->getGridOriginX(),
-                            row + rm->getGridOriginY());
-                    if (room) {
-                        room->update(dt);
-                    }
-                }
-            }
-        }
+        _swaps->update(dt);
+        forEachRoom([this, dt](int x, int y, const shared_ptr<RoomModel> &room) {
+            if (isRoomActive(x, y)) room->update(dt);
+        });
     }
 
+    /**
+     * Returns the animator that slides swapped rooms into place, so that
+     * callers can hear when a room arrives.
+     *
+     * @return  The animator for room swaps
+     */
+    shared_ptr<SwapAnimator> getSwapAnimator() {
+        return _swaps;
+    }
+
+    /**
+     * Returns the index of which room every character is in, which also
+     * keeps occupied rooms locked.
+     *
+     * @return  The occupancy grid for the rooms
+     */
+    shared_ptr<OccupancyGrid> getOccupancy() {
+        return _occupancy;
+    }
+
+#pragma mark Activation
+
+    /**
+     * Returns whether the room at the given HOUSE space coordinates is in the
+     * activation window.
+     *
+     * @param x The column of the room in HOUSE space
+     * @param y The row of the room in HOUSE space
+     * @return  Whether the room is active
+     */
+    bool isRoomActive(int x, int y) {
+        return _rooms != nullptr && _rooms->inBounds(x, y) && _active[y * _rooms->getWidth() + x];
+    }
+
+    /**
+     * Returns whether the room at the given HOUSE space coordinates is in the
+     * activation window.
+     *
+     * @param coord The coordinates of the room in (column, row) form
+     * @return      Whether the room is active
+     */
+    bool isRoomActive(Vec2 coord) {
+        return isRoomActive(coord.x, coord.y);
+    }
+
+    /**
+     * Moves the activation window to be around the given room and the given
+     * rooms on screen. Rooms within ACTIVE_RADIUS of Reynard or on screen
+     * are activated. Active rooms are only deactivated once they are more
+     * than ACTIVE_HYSTERESIS rooms further out, so rooms at the edge of the
+     * window don't flicker on and off as Reynard moves back and forth.
+     *
+     * Nothing is recomputed if the window hasn't moved.
+     *
+     * @param center    Reynard's room in HOUSE space
+     * @param view      The rooms on screen in HOUSE space, from the lower left room to the upper right one
+     */
+    void updateActivation(Vec2 center, Rect view);
+
 #pragma mark Setters
 
     /**
@@ -362,43 +609,191 @@ public:
      */
     bool swapRooms(Vec2 pos1, Vec2 pos2, bool forced);
 
+    /**
+     * Rearranges the rooms in the grid to match the given room table contents,
+     * as returned by getRoomTable()->getRooms() at an earlier point. Rooms are
+     * moved with forced swaps, so they snap into place without animating and
+     * their physics move with them.
+     *
+     * Returns false if the given rooms aren't a rearrangement of the current ones.
+     *
+     * @param rooms The rooms to restore, in row-major HOUSE space order
+     * @return      Whether the rooms were restored successfully
+     */
+    bool restoreRooms(const vector<shared_ptr<RoomModel>> &rooms);
+
     /*
     * Sets the fog of war for the room at the given coordinates.
     * True means contents are hidden. False means they are visible.
     * 
-    * Does nothing if the coordinates are out of bounds.
+    * Does nothing if there is no room there. The room itself isn't
+    * changed until the next call to applyFogChanges().
     */
     void setRoomFog(Vec2 coord, bool hasFog) {
         if (getRoom(coord) != nullptr) {
-            getRoom(coord)->setFogged(hasFog);
+            setFogBit((int)coord.y * _rooms->getWidth() + (int)coord.x, hasFog);
         }
     }
 
     /**
-     * Sets the physics objects of the given room in GRID coordinates.
+     * Removes the fog of war from every room within the given number of rooms
+     * of the given one, in any direction.
      *
-     * @param row   Row of the room in GRID coordinates
-     * @param col   Column of the room in GRID coordinates
-     * @param phys  Physics objects to put in the given room
+     * @param center    The room in the middle, in HOUSE space
+     * @param radius    How many rooms out to reveal
+     * @return          How many rooms had their fog removed
+     */
+    int revealAround(Vec2 center, int radius);
+
+    /**
+     * Updates the appearance of every room whose fog changed since the last
+     * call, leaving every other room alone.
      */
-    void setPhysicsGeometryAt(int row, int col, shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> phys) {
-        _physicsGeometry->at(row)->at(col) = phys;
+    void applyFogChanges();
+
+    /**
+     * Returns the fog of war of every cell as a bitmap, one bit per cell in
+     * the same order as the room table, for saving.
+     *
+     * @return  The fog bitmap
+     */
+    const vector<Uint8> &getFogBits() const {
+        return _fog;
     }
 
+    /**
+     * Replaces the fog of war of every cell with the given bitmap, as returned
+     * by getFogBits() at an earlier point. Does nothing if the bitmap is for a
+     * table of a different size.
+     *
+     * @param bits  The fog bitmap
+     * @return      Whether the bitmap was applied
+     */
+    bool setFogBits(const vector<Uint8> &bits);
+
     /**
      * Clear the given region for debug purposes
      */
     void clearRegion(int r) {
         _regions->at(r - 1)->clearAllCheckpoints();
-        _regions->at(r - 1)->clearRegion();
+        clearRegion(_regions->at(r - 1));
     }
 
 #pragma mark Helpers
 
     Poly2 convertToScreen(Poly2 poly);
 
+    /**
+     * Builds the physics objects for every room in the grid from scratch.
+     */
     void calculatePhysicsGeometry();
 
+private:
+    /**
+     * Builds the physics objects for the room at the given HOUSE space coordinates,
+     * replacing any it had before. The old objects are marked as removed.
+     *
+     * The room geometry is kept as a single ChainObstacle. Its seams are merged
+     * with the geometry of its neighbors in the same sublevel, so there are no
+     * seams at the room's edges. The room's exit blockade, if any, goes in the
+     * same body, and its trap gets a body of its own.
+     *
+     * @param x     The column of the room in HOUSE space
+     * @param y     The row of the room in HOUSE space
+     * @return      The physics objects that were created for the room
+     */
+    shared_ptr<vector<shared_ptr<physics2::Obstacle>>> buildRoomPhysics(int x, int y);
+
+    /**
+     * Merges the seams of the room at the given HOUSE space coordinates with its
+     * neighbors in the same sublevel again, and puts them on the room's body.
+     * Nothing else about the body changes.
+     *
+     * @param x     The column of the room in HOUSE space
+     * @param y     The row of the room in HOUSE space
+     */
+    void buildRoomSeams(int x, int y);
+
+    /**
+     * Returns the merged geometry of the given room's type in room-local
+     * coordinates, merging it the first time that type is asked for.
+     *
+     * @param room  A room whose type's geometry should be returned
+     * @return      The merged geometry of the room's type
+     */
+    const RoomTypeOutlines &getRoomTypeOutlines(const shared_ptr<RoomModel> &room);
+
+    /**
+     * Returns the geometry of the given room's type in room-local coordinates.
+     * This is shared with every other room of that type.
+     *
+     * @param room  A room whose type's geometry should be returned
+     * @return      The geometry of the room's type
+     */
+    shared_ptr<vector<Poly2>> getRoomTypePhysics(const shared_ptr<RoomModel> &room);
+
+    /**
+     * Returns the transform from room-local coordinates to physics space for a
+     * room sitting at the given HOUSE space coordinates.
+     *
+     * This uses the cell, not the room node's current position, so that it is
+     * correct even while the room is still animating into place.
+     *
+     * @param x     The column of the room in HOUSE space
+     * @param y     The row of the room in HOUSE space
+     * @return      The room to physics transform
+     */
+    Affine2 getCellToPhysicsTransform(int x, int y);
+
+    /**
+     * Moves the physics objects of the cell at the given index by the given
+     * offset, without rebuilding them.
+     *
+     * @param index     The index of the cell in the room table
+     * @param offset    How far to move the objects, in physics space
+     */
+    void moveCellPhysics(int index, Vec2 offset);
+
+    /**
+     * Releases the physics objects of the cell at the given index and marks
+     * them as removed, leaving the cell empty.
+     *
+     * @param index     The index of the cell in the room table
+     */
+    void releaseCellPhysics(int index);
+
+    /**
+     * Clears the given region, removing its blockades, and marks its exit rooms
+     * so that their physics are rebuilt without the blockades.
+     *
+     * @param region    The region to clear
+     */
+    void clearRegion(shared_ptr<RegionModel> region);
+
+    /**
+     * Returns whether the cell at the given index in the room table has fog of war.
+     */
+    bool getFogBit(int index) const {
+        return (_fog[index >> 3] >> (index & 7)) & 1;
+    }
+
+    /**
+     * Sets whether the cell at the given index in the room table has fog of
+     * war, noting the change so its room is updated by applyFogChanges().
+     */
+    void setFogBit(int index, bool hasFog);
+
+    /**
+     * Activates or deactivates the cell at the given index in the room table,
+     * showing or hiding its room and enabling or disabling its physics objects.
+     *
+     * @param index     The index of the cell in the room table
+     * @param active    Whether the cell should be active
+     */
+    void setCellActive(int index, bool active);
+
+public:
+
     shared_ptr<physics2::PolygonObstacle> makeStaticFromPath(Path2 path);
 
 #pragma mark Checkpoints
@@ -194,6 +194,23 @@ bool InputController::init() {
     return success;
 }
 
+/**
+ * Initializes the control to be driven by a script instead of by any
+ * devices, for running the game without a window.
+ *
+ * No listeners are attached. Each call to update() takes the next frame
+ * given to pushFrame(), or an empty frame if there are none left.
+ *
+ * @return true if the initialization was successful
+ */
+bool InputController::initScripted() {
+    _timestamp.mark();
+    _scripted = true;
+    _script.clear();
+    _active = true;
+    return true;
+}
+
 /**
  * Deactivates this input controller, releasing all listeners.
  *
@@ -201,7 +218,11 @@ bool InputController::init() {
  * once it is reinitialized.
  */
 void InputController::dispose() {
-    if (_active) {
+    if (_active && _scripted) {
+        _script.clear();
+        _scripted = false;
+        _active = false;
+    } else if (_active) {
 #ifndef CU_TOUCH_SCREEN
         Mouse* mouse = Input::get<Mouse>();
         mouse->removePressListener(_mouseKey);
@@ -231,10 +252,13 @@ void InputController::dispose() {
  * This method also gathers the delta difference in the touches. Depending on
  * the OS, we may see multiple updates of the same touch in a single animation
  * frame, so we need to accumulate all of the data together.
+ *
+ * Button presses are held until endTick(), so a press is never lost on a
+ * frame that runs no ticks of the simulation.
  */
 void InputController::update(float dt) {
-    _prevDown = _currDown;
-    _prevDrag = _currDrag;
+    // A script replaces every device, and is read one frame per tick
+    if (_scripted) return;
 
 #ifndef CU_TOUCH_SCREEN
     Keyboard* keys = Input::get<Keyboard>();
@@ -262,29 +286,29 @@ void InputController::update(float dt) {
     keys->keyDown(KeyCode::ARROW_DOWN);
 
     // REGION CLEAR (DEBUG)
-    _clearReg1Pressed = keys->keyPressed(REGION_1_CLEAR_KEY);
-    _clearReg2Pressed = keys->keyPressed(REGION_2_CLEAR_KEY);
+    _clearReg1Pressed = _clearReg1Pressed || keys->keyPressed(REGION_1_CLEAR_KEY);
+    _clearReg2Pressed = _clearReg2Pressed || keys->keyPressed(REGION_2_CLEAR_KEY);
 
     // USE INTERNAL PRIVATE VARIABLES TO CHANGE THE EXTERNAL FLAGS
-    _resetPressed = _keyReset;
-    _debugPressed = _keyDebug;
-    _exitPressed = _keyExit;
+    _resetPressed = _resetPressed || _keyReset;
+    _debugPressed = _debugPressed || _keyDebug;
+    _exitPressed = _exitPressed || _keyExit;
 
-    _jumpPressed = _spaceDown;
-    _dashRightPressed = _dDown;
-    _dashLeftPressed = _aDown;
-    _zoomInPressed = _eDown;
-    _zoomOutPressed = _qDown;
+    _jumpPressed = _jumpPressed || _spaceDown;
+    _dashRightPressed = _dashRightPressed || _dDown;
+    _dashLeftPressed = _dashLeftPressed || _aDown;
+    _zoomInPressed = _zoomInPressed || _eDown;
+    _zoomOutPressed = _zoomOutPressed || _qDown;
 
 #else
     _currDown = _touchDown && !_inMulti;
     _currPos = _touchPos;
 
-    _zoomOutPressed = _pinchGesture;
-    _zoomInPressed = _zoomGesture;
+    _zoomOutPressed = _zoomOutPressed || _pinchGesture;
+    _zoomInPressed = _zoomInPressed || _zoomGesture;
 
     _isScrolling = _panGesture;
-    _scrollOffset = _panCurr - _panPrev;
+    _scrollOffset += _panCurr - _panPrev;
     _panPrev = _panCurr;
 
     _currDrag = _touchDragging;
@@ -298,9 +322,9 @@ void InputController::update(float dt) {
     float xDist = (_currPos - _touchStartPos).x;
     float yDist = (_currPos - _touchStartPos).y;
     bool vertical = abs(yDist) > abs(xDist);
-    _dashLeftPressed = couldBeSwipe && xDist <= -EVENT_SWIPE_LENGTH && !vertical;
-    _dashRightPressed = couldBeSwipe && xDist >= EVENT_SWIPE_LENGTH && !vertical;
-    _jumpPressed = couldBeSwipe && abs(xDist) < EVENT_SWIPE_LENGTH; //Release to jump
+    _dashLeftPressed = _dashLeftPressed || (couldBeSwipe && xDist <= -EVENT_SWIPE_LENGTH && !vertical);
+    _dashRightPressed = _dashRightPressed || (couldBeSwipe && xDist >= EVENT_SWIPE_LENGTH && !vertical);
+    _jumpPressed = _jumpPressed || (couldBeSwipe && abs(xDist) < EVENT_SWIPE_LENGTH); //Release to jump
     //_jumpPressed = couldBeSwipe && yDist <= -5 && vertical; //SWIPE UP TO JUMP
 
 #endif
@@ -313,6 +337,58 @@ void InputController::update(float dt) {
 #endif
 }
 
+/**
+ * Starts a tick of the simulation. A scripted controller takes the next
+ * frame of its script here, or an empty frame if there are none left.
+ * Otherwise the input polled by update() is used as is.
+ */
+void InputController::beginTick() {
+    if (!_scripted) return;
+    Frame frame;
+    if (!_script.empty()) {
+        frame = _script.front();
+    _script.pop_front();
+    }
+    _currDown = frame.down;
+    _currPos = frame.position;
+    _currDrag = frame.drag;
+    _dragStart = frame.dragStart;
+    _dragEnd = frame.dragEnd;
+    _isScrolling = frame.scrolling;
+    _scrollOffset = frame.scrollOffset;
+    _resetPressed = frame.reset;
+    _debugPressed = frame.debug;
+    _exitPressed = frame.exit;
+    _jumpPressed = frame.jump;
+    _dashRightPressed = frame.dashRight;
+    _dashLeftPressed = frame.dashLeft;
+    _zoomInPressed = frame.zoomIn;
+    _zoomOutPressed = frame.zoomOut;
+    _clearReg1Pressed = frame.clearRegion1;
+    _clearReg2Pressed = frame.clearRegion2;
+}
+
+/**
+ * Ends a tick of the simulation. Presses that the tick has seen are
+ * cleared, and the current press becomes the previous one.
+ */
+void InputController::endTick() {
+    _prevDown = _currDown;
+    _prevDrag = _currDrag;
+    _scrollOffset = Vec2::ZERO;
+
+    _resetPressed = false;
+    _debugPressed = false;
+    _exitPressed = false;
+    _jumpPressed = false;
+    _dashRightPressed = false;
+    _dashLeftPressed = false;
+    _zoomInPressed = false;
+    _zoomOutPressed = false;
+    _clearReg1Pressed = false;
+    _clearReg2Pressed = false;
+}
+
 /* Clears any buffered inputs so that we may start fresh. */
 void InputController::clear() {
     //TODO: update this
@@ -330,6 +406,33 @@ void InputController::clear() {
     _timestamp.mark();
 }
 
+/**
+ * Returns everything read from the input in the last update.
+ *
+ * @return the input for the last frame
+ */
+InputController::Frame InputController::getFrame() const {
+    Frame frame;
+    frame.down = _currDown;
+    frame.position = _currPos;
+    frame.drag = _currDrag;
+    frame.dragStart = _dragStart;
+    frame.dragEnd = _dragEnd;
+    frame.scrolling = _isScrolling;
+    frame.scrollOffset = _scrollOffset;
+    frame.reset = _resetPressed;
+    frame.debug = _debugPressed;
+    frame.exit = _exitPressed;
+    frame.jump = _jumpPressed;
+    frame.dashRight = _dashRightPressed;
+    frame.dashLeft = _dashLeftPressed;
+    frame.zoomIn = _zoomInPressed;
+    frame.zoomOut = _zoomOutPressed;
+    frame.clearRegion1 = _clearReg1Pressed;
+    frame.clearRegion2 = _clearReg2Pressed;
+    return frame;
+}
+
 #pragma mark -
 #pragma mark Mouse Callbacks
 
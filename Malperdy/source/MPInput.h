@@ -16,9 +16,52 @@
 #define __MP_INPUT_H__
 
 #include <cugl/cugl.h>
+#include <deque>
 
 /* This class represents player input in Malperdy. */
 class InputController {
+public:
+    /**
+     * Everything the game reads from the input in a single frame. A scripted
+     * controller is driven by a queue of these instead of by any devices.
+     */
+    struct Frame {
+        /** Whether there is a button/touch press */
+        bool down = false;
+        /** The touch/mouse position */
+        cugl::Vec2 position;
+        /** Whether a drag is happening */
+        bool drag = false;
+        /** The start position of the current drag, or the last drag */
+        cugl::Vec2 dragStart;
+        /** The end position of the last drag */
+        cugl::Vec2 dragEnd;
+        /** Whether the user is scrolling */
+        bool scrolling = false;
+        /** How far the user scrolled */
+        cugl::Vec2 scrollOffset;
+        /** Whether the reset button was pressed */
+        bool reset = false;
+        /** Whether the debug toggle was pressed */
+        bool debug = false;
+        /** Whether the exit button was pressed */
+        bool exit = false;
+        /** Whether the jump button was pressed */
+        bool jump = false;
+        /** Whether the dash right button was pressed */
+        bool dashRight = false;
+        /** Whether the dash left button was pressed */
+        bool dashLeft = false;
+        /** Whether the zoom in button was pressed */
+        bool zoomIn = false;
+        /** Whether the zoom out button was pressed */
+        bool zoomOut = false;
+        /** Whether the key to clear the first region was pressed */
+        bool clearRegion1 = false;
+        /** Whether the key to clear the second region was pressed */
+        bool clearRegion2 = false;
+    };
+
 // Common fields are protected
 protected:
     /** Whether or not this input is active */
@@ -87,6 +130,12 @@ protected:
     /** Whether to auto-clear the second region */
     bool _clearReg2Pressed;
 
+    // SCRIPTING
+    /** Whether this input comes from a script instead of devices */
+    bool _scripted = false;
+    /** Frames still to be played back, oldest first */
+    std::deque<Frame> _script;
+
 // Device-specific fields are kept private
 private:
 
@@ -189,6 +238,17 @@ public:
      */
     bool init();
 
+    /**
+     * Initializes the control to be driven by a script instead of by any
+     * devices, for running the game without a window.
+     *
+     * No listeners are attached. Each call to beginTick() takes the next frame
+     * given to pushFrame(), or an empty frame if there are none left.
+     *
+     * @return true if the initialization was successful
+     */
+    bool initScripted();
+
     /**
      * Disposes of this input controller, releasing all listeners.
      */
@@ -225,9 +285,27 @@ public:
      * This method also gathers the delta difference in the touches. Depending on 
      * the OS, we may see multiple updates of the same touch in a single animation
      * frame, so we need to accumulate all of the data together.
+     *
+     * The simulation can run any number of ticks in a frame, so button presses
+     * are held from here until endTick(). A press on a frame that runs no ticks
+     * goes to the next tick, and a press on a frame that runs several is only
+     * seen by the first.
      */
     void update(float dt);
 
+    /**
+     * Starts a tick of the simulation. A scripted controller takes the next
+     * frame of its script here, or an empty frame if there are none left.
+     * Otherwise the input polled by update() is used as is.
+     */
+    void beginTick();
+
+    /**
+     * Ends a tick of the simulation. Presses that the tick has seen are
+     * cleared, and the current press becomes the previous one.
+     */
+    void endTick();
+
     /* Clears any buffered inputs so that we may start fresh. */
     void clear();
 
@@ -404,6 +482,44 @@ public:
         return _clearReg2Pressed;
     }
 
+#pragma mark -
+#pragma mark Scripting
+
+    /**
+     * Returns whether this input is driven by a script instead of devices.
+     *
+     * @return whether this input is driven by a script
+     */
+    bool isScripted() const {
+        return _scripted;
+    }
+
+    /**
+     * Adds a frame to the end of the script. This does nothing unless the
+     * controller was initialized with initScripted().
+     *
+     * @param frame The frame to play back
+     */
+    void pushFrame(const Frame &frame) {
+        if (_scripted) _script.push_back(frame);
+    }
+
+    /**
+     * Returns how many frames of the script are left to play back.
+     *
+     * @return the number of frames left in the script
+     */
+    size_t getScriptLength() const {
+        return _script.size();
+    }
+
+    /**
+     * Returns everything read from the input for the current tick.
+     *
+     * @return the input for the current tick
+     */
+    Frame getFrame() const;
+
 #pragma mark -
 #pragma mark Mouse Callbacks
 private:
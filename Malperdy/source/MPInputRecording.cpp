@@ -0,0 +1,386 @@
+//
+//  MPInputRecording.cpp
+//  Malperdy
+//
+//  This class records everything the game read from the input on every tick
+//  of a session, as runs of identical frames, so the session can be played
+//  again exactly.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPInputRecording.h"
+#include "MPSaveFile.h"
+#include <cstring>
+
+/** Magic number at the start of every recording ("MPIR") */
+#define RECORDING_MAGIC 0x4D504952
+/** Largest recording body that will be read, so a corrupt header can't make us allocate forever */
+#define RECORDING_MAX_SIZE (64 * 1024 * 1024)
+
+/** Flags for the buttons of a frame, and for which positions were stored after them */
+enum RunFlags : Uint32 {
+    RUN_DOWN = 1 << 0,
+    RUN_DRAG = 1 << 1,
+    RUN_SCROLLING = 1 << 2,
+    RUN_RESET = 1 << 3,
+    RUN_DEBUG = 1 << 4,
+    RUN_EXIT = 1 << 5,
+    RUN_JUMP = 1 << 6,
+    RUN_DASH_RIGHT = 1 << 7,
+    RUN_DASH_LEFT = 1 << 8,
+    RUN_ZOOM_IN = 1 << 9,
+    RUN_ZOOM_OUT = 1 << 10,
+    RUN_CLEAR_REGION_1 = 1 << 11,
+    RUN_CLEAR_REGION_2 = 1 << 12,
+    RUN_POSITION = 1 << 13,
+    RUN_DRAG_START = 1 << 14,
+    RUN_DRAG_END = 1 << 15,
+    RUN_SCROLL_OFFSET = 1 << 16
+};
+
+#pragma mark Encoding Helpers
+
+/**
+ * Appends the given number to the buffer as a varint, 7 bits at a time with
+ * the high bit set on every byte but the last.
+ *
+ * @param buffer    The buffer to append to
+ * @param value     The number to append
+ */
+static void putVarint(vector<Uint8> &buffer, Uint32 value) {
+    while (value >= 0x80) {
+        buffer.push_back((Uint8)(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((Uint8)value);
+}
+
+/**
+ * Appends the given vector to the buffer as two floats of 4 little-endian
+ * bytes each.
+ *
+ * @param buffer    The buffer to append to
+ * @param value     The vector to append
+ */
+static void putVec2(vector<Uint8> &buffer, const Vec2 &value) {
+    float coords[2] = {value.x, value.y};
+    for (float coord : coords) {
+        Uint32 bits;
+        std::memcpy(&bits, &coord, sizeof(bits));
+        for (int i = 0; i < 4; i++) {
+            buffer.push_back((Uint8)(bits >> (8 * i)));
+        }
+    }
+}
+
+/**
+ * Reads a varint from the buffer, starting at the given position.
+ *
+ * @param buffer    The buffer to read from
+ * @param pos       The position to read at, moved past the varint
+ * @param value     Set to the number that was read
+ * @return          Whether there was a whole varint to read
+ */
+static bool getVarint(const vector<Uint8> &buffer, size_t &pos, Uint32 &value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= buffer.size()) return false;
+        Uint8 b = buffer[pos++];
+        value |= (Uint32)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+/**
+ * Reads a vector from the buffer, starting at the given position.
+ *
+ * @param buffer    The buffer to read from
+ * @param pos       The position to read at, moved past the vector
+ * @param value     Set to the vector that was read
+ * @return          Whether there was a whole vector to read
+ */
+static bool getVec2(const vector<Uint8> &buffer, size_t &pos, Vec2 &value) {
+    if (pos + 8 > buffer.size()) return false;
+    float coords[2];
+    for (float &coord : coords) {
+        Uint32 bits = 0;
+        for (int i = 0; i < 4; i++) {
+            bits |= (Uint32)buffer[pos++] << (8 * i);
+        }
+        std::memcpy(&coord, &bits, sizeof(coord));
+    }
+    value.set(coords[0], coords[1]);
+    return true;
+}
+
+/**
+ * Returns whether two frames have exactly the same input.
+ */
+static bool sameFrame(const InputController::Frame &a, const InputController::Frame &b) {
+    return a.down == b.down && a.position == b.position && a.drag == b.drag &&
+           a.dragStart == b.dragStart && a.dragEnd == b.dragEnd &&
+           a.scrolling == b.scrolling && a.scrollOffset == b.scrollOffset &&
+           a.reset == b.reset && a.debug == b.debug && a.exit == b.exit && a.jump == b.jump &&
+           a.dashRight == b.dashRight && a.dashLeft == b.dashLeft &&
+           a.zoomIn == b.zoomIn && a.zoomOut == b.zoomOut &&
+           a.clearRegion1 == b.clearRegion1 && a.clearRegion2 == b.clearRegion2;
+}
+
+/**
+ * Appends a run of identical frames to the buffer. Only the positions that
+ * differ from the previous run are stored.
+ *
+ * @param buffer    The buffer to append to
+ * @param frame     The frame repeated by the run
+ * @param length    How many ticks the run lasts
+ * @param previous  The frame of the run before, or an empty frame if there isn't one
+ */
+static void putRun(vector<Uint8> &buffer, const InputController::Frame &frame, Uint32 length,
+                   const InputController::Frame &previous) {
+    Uint32 flags = 0;
+    if (frame.down) flags |= RUN_DOWN;
+    if (frame.drag) flags |= RUN_DRAG;
+    if (frame.scrolling) flags |= RUN_SCROLLING;
+    if (frame.reset) flags |= RUN_RESET;
+    if (frame.debug) flags |= RUN_DEBUG;
+    if (frame.exit) flags |= RUN_EXIT;
+    if (frame.jump) flags |= RUN_JUMP;
+    if (frame.dashRight) flags |= RUN_DASH_RIGHT;
+    if (frame.dashLeft) flags |= RUN_DASH_LEFT;
+    if (frame.zoomIn) flags |= RUN_ZOOM_IN;
+    if (frame.zoomOut) flags |= RUN_ZOOM_OUT;
+    if (frame.clearRegion1) flags |= RUN_CLEAR_REGION_1;
+    if (frame.clearRegion2) flags |= RUN_CLEAR_REGION_2;
+    if (frame.position != previous.position) flags |= RUN_POSITION;
+    if (frame.dragStart != previous.dragStart) flags |= RUN_DRAG_START;
+    if (frame.dragEnd != previous.dragEnd) flags |= RUN_DRAG_END;
+    if (frame.scrollOffset != previous.scrollOffset) flags |= RUN_SCROLL_OFFSET;
+
+    putVarint(buffer, length);
+    putVarint(buffer, flags);
+    if (flags & RUN_POSITION) putVec2(buffer, frame.position);
+    if (flags & RUN_DRAG_START) putVec2(buffer, frame.dragStart);
+    if (flags & RUN_DRAG_END) putVec2(buffer, frame.dragEnd);
+    if (flags & RUN_SCROLL_OFFSET) putVec2(buffer, frame.scrollOffset);
+}
+
+/**
+ * Reads a run of identical frames from the buffer.
+ *
+ * @param buffer    The buffer to read from
+ * @param pos       The position to read at, moved past the run
+ * @param frame     Holds the frame of the run before, and is set to the frame of this run
+ * @param length    Set to how many ticks the run lasts
+ * @return          Whether there was a whole run to read
+ */
+static bool getRun(const vector<Uint8> &buffer, size_t &pos, InputController::Frame &frame, Uint32 &length) {
+    Uint32 flags;
+    if (!getVarint(buffer, pos, length) || !getVarint(buffer, pos, flags)) return false;
+    frame.down = flags & RUN_DOWN;
+    frame.drag = flags & RUN_DRAG;
+    frame.scrolling = flags & RUN_SCROLLING;
+    frame.reset = flags & RUN_RESET;
+    frame.debug = flags & RUN_DEBUG;
+    frame.exit = flags & RUN_EXIT;
+    frame.jump = flags & RUN_JUMP;
+    frame.dashRight = flags & RUN_DASH_RIGHT;
+    frame.dashLeft = flags & RUN_DASH_LEFT;
+    frame.zoomIn = flags & RUN_ZOOM_IN;
+    frame.zoomOut = flags & RUN_ZOOM_OUT;
+    frame.clearRegion1 = flags & RUN_CLEAR_REGION_1;
+    frame.clearRegion2 = flags & RUN_CLEAR_REGION_2;
+    if ((flags & RUN_POSITION) && !getVec2(buffer, pos, frame.position)) return false;
+    if ((flags & RUN_DRAG_START) && !getVec2(buffer, pos, frame.dragStart)) return false;
+    if ((flags & RUN_DRAG_END) && !getVec2(buffer, pos, frame.dragEnd)) return false;
+    if ((flags & RUN_SCROLL_OFFSET) && !getVec2(buffer, pos, frame.scrollOffset)) return false;
+    return true;
+}
+
+#pragma mark Recording
+
+/**
+ * Returns the path the last session is recorded to.
+ *
+ * @return  The path of the recording in the save directory
+ */
+string InputRecording::getPath() {
+    vector<std::string> file_path_list = vector<std::string>(2);
+    file_path_list[0] = Application::get()->getSaveDirectory();
+    file_path_list[1] = RECORDING_FILE_NAME;
+    return filetool::join_path(file_path_list);
+}
+
+/**
+ * Throws away anything recorded and starts over, for a session starting
+ * in the given mode. Unless it's a new game, the save file is copied in,
+ * so this must be called before the game loads or erases it.
+ *
+ * @param mode  The game mode, as given to GameScene::setMode
+ */
+void InputRecording::begin(int mode) {
+    _mode = mode;
+    _save.clear();
+    _runs.clear();
+    _runCount = 0;
+    _current = InputController::Frame();
+    _currentLength = 0;
+    _written = InputController::Frame();
+    _ticks = 0;
+    _stateHash = 2166136261u;
+
+    // A new game erases the save, so there is nothing to start from
+    if (mode == 1) return;
+    SaveFile::finish();
+    shared_ptr<BinaryReader> reader = BinaryReader::alloc(SaveFile::getPath());
+    if (reader == nullptr) return;
+    Uint8 chunk[4096];
+    size_t read;
+    while ((read = reader->read(chunk, sizeof(chunk))) > 0) {
+        _save.insert(_save.end(), chunk, chunk + read);
+    }
+    reader->close();
+}
+
+/**
+ * Adds the input for the next tick.
+ *
+ * @param frame The input the tick was played with
+ */
+void InputRecording::record(const InputController::Frame &frame) {
+    _ticks++;
+    if (_currentLength > 0 && sameFrame(frame, _current)) {
+        _currentLength++;
+        return;
+    }
+    flush();
+    _current = frame;
+    _currentLength = 1;
+}
+
+/**
+ * Adds the current run to the encoded runs.
+ */
+void InputRecording::flush() {
+    if (_currentLength == 0) return;
+    putRun(_runs, _current, _currentLength, _written);
+    _runCount++;
+    _written = _current;
+    _currentLength = 0;
+}
+
+/**
+ * Writes the recording to the given path. The session can keep recording
+ * afterwards.
+ *
+ * @param path  The path to write to
+ * @return      Whether the recording was written
+ */
+bool InputRecording::save(const string &path) {
+    vector<Uint8> body;
+    putVarint(body, (Uint32)_mode);
+    putVarint(body, (Uint32)_save.size());
+    body.insert(body.end(), _save.begin(), _save.end());
+
+    // The run still going is written too, without ending it
+    putVarint(body, _runCount + (_currentLength > 0 ? 1 : 0));
+    body.insert(body.end(), _runs.begin(), _runs.end());
+    if (_currentLength > 0) putRun(body, _current, _currentLength, _written);
+
+    shared_ptr<BinaryWriter> writer = BinaryWriter::alloc(path);
+    if (writer == nullptr) return false;
+    writer->writeUint32(RECORDING_MAGIC);
+    writer->writeUint32(RECORDING_VERSION);
+    writer->writeUint32(_ticks);
+    writer->writeUint32(_stateHash);
+    writer->writeUint32((Uint32)body.size());
+    writer->write(body.data(), body.size());
+    writer->close();
+    return true;
+}
+
+#pragma mark Playback
+
+/**
+ * Returns the recording saved at the given path.
+ *
+ * @param path  The path of the recording
+ * @return      The recording, or nullptr if it couldn't be read
+ */
+shared_ptr<InputRecording> InputRecording::load(const string &path) {
+    shared_ptr<BinaryReader> reader = BinaryReader::alloc(path);
+    if (reader == nullptr || !reader->ready(20)) return nullptr;
+
+    if (reader->readUint32() != RECORDING_MAGIC) return nullptr;
+    Uint32 version = reader->readUint32();
+    if (version != RECORDING_VERSION) {
+        CULog("MPInputRecording.cpp: Unknown recording version %u", version);
+        return nullptr;
+    }
+    shared_ptr<InputRecording> result = alloc();
+    result->_ticks = reader->readUint32();
+    result->_stateHash = reader->readUint32();
+    Uint32 size = reader->readUint32();
+    if (size > RECORDING_MAX_SIZE) return nullptr;
+
+    vector<Uint8> body(size);
+    if (size > 0 && reader->read(body.data(), size) != size) return nullptr;
+    reader->close();
+
+    size_t pos = 0;
+    Uint32 value;
+    if (!getVarint(body, pos, value)) return nullptr;
+    result->_mode = (int)value;
+    if (!getVarint(body, pos, value) || value > body.size() - pos) return nullptr;
+    result->_save.assign(body.begin() + pos, body.begin() + pos + value);
+    pos += value;
+    if (!getVarint(body, pos, result->_runCount)) return nullptr;
+    result->_runs.assign(body.begin() + pos, body.end());
+
+    // Make sure the runs are whole and add up to the right number of ticks
+    if (result->getFrames().size() != result->_ticks) return nullptr;
+    return result;
+}
+
+/**
+ * Returns the input for every tick, in order.
+ *
+ * @return  The frame for each tick
+ */
+vector<InputController::Frame> InputRecording::getFrames() const {
+    vector<InputController::Frame> frames;
+    frames.reserve(_ticks);
+    InputController::Frame frame;
+    size_t pos = 0;
+    for (Uint32 i = 0; i < _runCount; i++) {
+        Uint32 length;
+        if (!getRun(_runs, pos, frame, length) || length > _ticks - frames.size()) return vector<InputController::Frame>();
+        frames.insert(frames.end(), length, frame);
+    }
+    if (pos != _runs.size()) return vector<InputController::Frame>();
+    // The run still being recorded
+    frames.insert(frames.end(), _currentLength, _current);
+    return frames;
+}
+
+/**
+ * Puts the save file the session started from back in the save directory,
+ * or erases the save if there wasn't one. This must be done before the
+ * replay starts the game.
+ *
+ * @return  Whether the save file was put back
+ */
+bool InputRecording::restoreSave() const {
+    SaveFile::erase();
+    if (_save.empty()) return true;
+    shared_ptr<BinaryWriter> writer = BinaryWriter::alloc(SaveFile::getPath());
+    if (writer == nullptr) return false;
+    writer->write(_save.data(), _save.size());
+    writer->close();
+    return true;
+}
@@ -0,0 +1,187 @@
+//
+//  MPInputRecording.h
+//  Malperdy
+//
+//  This class records everything the game read from the input on every tick
+//  of a session, so the session can be played again exactly, for instance to
+//  look into a performance problem someone ran into. Since the simulation
+//  runs at a fixed timestep on simulation time, the same input on the same
+//  ticks always gives the same game.
+//
+//  Most ticks have the same input as the tick before, so the input is stored
+//  as runs of identical frames. Each run is a varint count, a varint of flags
+//  for the buttons, and then only the positions that changed since the last
+//  run, as floats. A minute of just running takes a few bytes.
+//
+//  A session that continued from a save also needs that save to start from,
+//  so the save file is copied into the recording when it starts. The
+//  recording also keeps a hash of the state of the game after every tick,
+//  which a replay can compare against to check it played out the same way.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPInputRecording_h
+#define MPInputRecording_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "MPInput.h"
+
+using namespace cugl;
+
+/** Name of the recording of the last session in the save directory */
+#define RECORDING_FILE_NAME "session.mprec"
+/** Current version of the recording format */
+#define RECORDING_VERSION 1
+
+class InputRecording {
+private:
+    /** The game mode the session started in, as given to GameScene::setMode */
+    int _mode = 0;
+    /** The save file the session started from, or empty if there wasn't one */
+    vector<Uint8> _save;
+    /** Every finished run of frames, encoded */
+    vector<Uint8> _runs;
+    /** How many runs are in _runs */
+    Uint32 _runCount = 0;
+    /** The frame being repeated by the current run */
+    InputController::Frame _current;
+    /** How many ticks the current run has lasted */
+    Uint32 _currentLength = 0;
+    /** The last frame written to _runs, which the next run is stored against */
+    InputController::Frame _written;
+    /** How many ticks have been recorded */
+    Uint32 _ticks = 0;
+    /** Hash of the state of the game after every tick so far */
+    Uint32 _stateHash = 2166136261u;
+
+    /**
+     * Adds the current run to the encoded runs.
+     */
+    void flush();
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates an empty recording.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    InputRecording() {}
+
+    /**
+     * Returns a newly allocated, empty recording.
+     *
+     * @return  A newly allocated InputRecording
+     */
+    static shared_ptr<InputRecording> alloc() {
+        return make_shared<InputRecording>();
+    }
+
+    /**
+     * Returns the recording saved at the given path.
+     *
+     * @param path  The path of the recording
+     * @return      The recording, or nullptr if it couldn't be read
+     */
+    static shared_ptr<InputRecording> load(const string &path);
+
+    /**
+     * Returns the path the last session is recorded to.
+     *
+     * @return  The path of the recording in the save directory
+     */
+    static string getPath();
+
+#pragma mark Recording
+
+    /**
+     * Throws away anything recorded and starts over, for a session starting
+     * in the given mode. Unless it's a new game, the save file is copied in,
+     * so this must be called before the game loads or erases it.
+     *
+     * @param mode  The game mode, as given to GameScene::setMode
+     */
+    void begin(int mode);
+
+    /**
+     * Adds the input for the next tick.
+     *
+     * @param frame The input the tick was played with
+     */
+    void record(const InputController::Frame &frame);
+
+    /**
+     * Folds the state of the game at the end of a tick into the state hash.
+     *
+     * @param hash  A hash of the state of the game
+     */
+    void addState(Uint32 hash) {
+        _stateHash = (_stateHash ^ hash) * 16777619u;
+    }
+
+    /**
+     * Writes the recording to the given path.
+     *
+     * @param path  The path to write to
+     * @return      Whether the recording was written
+     */
+    bool save(const string &path);
+
+#pragma mark Playback
+
+    /**
+     * Returns the input for every tick, in order.
+     *
+     * @return  The frame for each tick
+     */
+    vector<InputController::Frame> getFrames() const;
+
+    /**
+     * Puts the save file the session started from back in the save directory,
+     * or erases the save if there wasn't one. This must be done before the
+     * replay starts the game.
+     *
+     * @return  Whether the save file was put back
+     */
+    bool restoreSave() const;
+
+#pragma mark Accessors
+
+    /**
+     * Returns the game mode the session started in.
+     *
+     * @return  The game mode, as given to GameScene::setMode
+     */
+    int getMode() const {
+        return _mode;
+    }
+
+    /**
+     * Returns how many ticks have been recorded.
+     *
+     * @return  The number of ticks
+     */
+    Uint32 getTickCount() const {
+        return _ticks;
+    }
+
+    /**
+     * Returns the hash of the state of the game after every tick so far. Two
+     * sessions that played out the same way have the same hash.
+     *
+     * @return  The state hash
+     */
+    Uint32 getStateHash() const {
+        return _stateHash;
+    }
+};
+
+#endif /* MPInputRecording_h */
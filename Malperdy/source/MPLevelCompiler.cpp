@@ -0,0 +1,341 @@
+//
+//  MPLevelCompiler.cpp
+//  Malperdy
+//
+//  This class turns the world JSON and the Tiled JSON for each of its regions
+//  into a level pack, ready to be loaded by LevelPack.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPLevelCompiler.h"
+#include <cstring>
+#include <map>
+
+#pragma mark Helpers
+
+/**
+ * Appends the given records to the end of the buffer.
+ *
+ * @param buffer    The buffer to append to
+ * @param records   The records to append
+ * @return          The offset in the buffer where the records start
+ */
+template<typename T>
+static Uint32 appendTable(vector<Uint8> &buffer, const vector<T> &records) {
+    Uint32 offset = (Uint32)buffer.size();
+    buffer.resize(buffer.size() + records.size() * sizeof(T));
+    if (!records.empty()) std::memcpy(buffer.data() + offset, records.data(), records.size() * sizeof(T));
+    return offset;
+}
+
+/**
+ * Returns the offset of the given string in the string table, adding it if
+ * it isn't there yet.
+ *
+ * @param strings   The string table
+ * @param offsets   The offset of every string already in the table
+ * @param s         The string to add
+ * @return          The offset of the string in the table
+ */
+static Uint32 intern(vector<char> &strings, std::map<string, Uint32> &offsets, const string &s) {
+    auto itr = offsets.find(s);
+    if (itr != offsets.end()) return itr->second;
+    Uint32 offset = (Uint32)strings.size();
+    strings.insert(strings.end(), s.begin(), s.end());
+    strings.push_back('\0');
+    offsets[s] = offset;
+    return offset;
+}
+
+/**
+ * Works out what kind of entity a tile is from the image used for it in the
+ * entities tileset.
+ *
+ * @param image The path of the tile's image
+ * @param type  Set to the type of the entity
+ * @return      Whether the tile is an entity that needs to be placed
+ */
+static bool classifyEntity(const string &image, LevelPack::EntityType &type) {
+    // Order matters, since some names contain others
+    if (image.find("reynard") != string::npos) {
+        // Reynard is placed by GameScene, not by the level
+        return false;
+    } else if (image.find("spike") != string::npos) {
+        type = LevelPack::EntityType::SPIKE;
+    } else if (image.find("trapdoor") != string::npos) {
+        type = LevelPack::EntityType::TRAPDOOR;
+    } else if (image.find("keycheckpoint") != string::npos) {
+        type = LevelPack::EntityType::KEY_CHECKPOINT;
+    } else if (image.find("checkpoint") != string::npos) {
+        type = LevelPack::EntityType::CHECKPOINT;
+    } else if (image.find("keyenemy") != string::npos) {
+        // Plain enemy tiles aren't placed by the level, only key enemies
+        type = LevelPack::EntityType::KEY_ENEMY;
+    } else if (image.find("key.png") != string::npos) {
+        type = LevelPack::EntityType::KEY;
+    } else if (image.find("locked") != string::npos) {
+        type = LevelPack::EntityType::LOCKED;
+    } else if (image.find("sap") != string::npos) {
+        type = LevelPack::EntityType::SAP;
+    } else if (image.find("exit") != string::npos) {
+        type = LevelPack::EntityType::EXIT;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Adds the given bytes to an FNV-1a hash.
+ *
+ * @param hash  The hash so far
+ * @param s     The bytes to add
+ * @return      The hash with the bytes added
+ */
+static Uint32 hashBytes(Uint32 hash, const string &s) {
+    for (char c : s) {
+        hash ^= (Uint8)c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+#pragma mark Compiling
+
+/**
+ * Returns a hash of the given world and every tileset and region file it
+ * refers to. The files are hashed as they are, without parsing them, so
+ * this is much cheaper than compiling the world.
+ *
+ * @param world The world JSON
+ * @param read  Function used to read the tilesets and the regions
+ * @return      The hash of the world and its files
+ */
+Uint32 LevelCompiler::hashSources(const shared_ptr<JsonValue> &world, const Reader &read) {
+    Uint32 hash = 2166136261u;
+    if (world == nullptr) return hash;
+    hash = hashBytes(hash, world->toString(false));
+
+    // Every file the world refers to, with its name so that moving a file changes the hash too
+    vector<string> files;
+    shared_ptr<JsonValue> tilesets = world->get("tilesets");
+    if (tilesets != nullptr) {
+        files.push_back(tilesets->getString("rooms"));
+        files.push_back(tilesets->getString("entities"));
+    }
+    shared_ptr<JsonValue> regions = world->get("regions");
+    if (regions != nullptr) {
+        for (shared_ptr<JsonValue> region : regions->children()) {
+            files.push_back(region->getString("file"));
+        }
+    }
+    for (auto itr = files.begin(); itr != files.end(); ++itr) {
+        hash = hashBytes(hash, *itr);
+        hash = hashBytes(hash, read(*itr));
+    }
+    return hash;
+}
+
+/**
+ * Compiles the given world into a level pack.
+ *
+ * @param world         The world JSON
+ * @param load          Function used to load the tilesets and the regions
+ * @param sourceHash    The hash of the world from hashSources(), stored in the pack
+ * @return              The bytes of the level pack, or nothing if the world couldn't be compiled
+ */
+vector<Uint8> LevelCompiler::compile(const shared_ptr<JsonValue> &world, const Loader &load, Uint32 sourceHash) {
+    if (world == nullptr || world->get("tilesets") == nullptr || world->get("regions") == nullptr) {
+        CULog("MPLevelCompiler.cpp: World is missing its tilesets or regions");
+        return vector<Uint8>();
+    }
+
+    LevelPack::Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = LEVEL_PACK_MAGIC;
+    header.version = LEVEL_PACK_VERSION;
+    header.sourceHash = sourceHash;
+    header.roomWidth = world->getInt("roomWidth");
+    header.roomHeight = world->getInt("roomHeight");
+    header.tileSize = world->getInt("tileSize");
+    int roomWidth = header.roomWidth;
+    int roomHeight = header.roomHeight;
+
+    shared_ptr<JsonValue> roomsTileset = load(world->get("tilesets")->getString("rooms"));
+    shared_ptr<JsonValue> entitiesTileset = load(world->get("tilesets")->getString("entities"));
+    if (roomsTileset == nullptr || entitiesTileset == nullptr) {
+        CULog("MPLevelCompiler.cpp: Couldn't load the tilesets");
+        return vector<Uint8>();
+    }
+
+    // Classify every entity tile once, by its ID within the entities tileset
+    std::map<int, LevelPack::EntityType> entityTypes;
+    shared_ptr<JsonValue> entityTiles = entitiesTileset->get("tiles");
+    for (int i = 0; i < (int)entityTiles->size(); i++) {
+        LevelPack::EntityType type;
+        if (classifyEntity(entityTiles->get(i)->getString("image"), type)) {
+            entityTypes[entityTiles->get(i)->getInt("id")] = type;
+        }
+    }
+
+    vector<LevelPack::Region> regions;
+    vector<LevelPack::Sublevel> sublevels;
+    vector<LevelPack::Cell> cells;
+    vector<LevelPack::Entity> entities;
+    vector<char> strings;
+    std::map<string, Uint32> stringOffsets;
+
+    vector<shared_ptr<JsonValue>> regionList = world->get("regions")->children();
+    for (shared_ptr<JsonValue> regionMetadata : regionList) {
+        LevelPack::Region region;
+        region.name = intern(strings, stringOffsets, regionMetadata->getString("name"));
+        region.type = regionMetadata->getInt("type");
+        region.width = regionMetadata->getInt("width");
+        region.height = regionMetadata->getInt("height");
+        region.originX = regionMetadata->getInt("originX");
+        region.originY = regionMetadata->getInt("originY");
+        region.firstSublevel = (Uint32)sublevels.size();
+        region.firstCell = (Uint32)cells.size();
+        region.firstEntity = (Uint32)entities.size();
+        int width = region.width;
+        int height = region.height;
+
+        shared_ptr<JsonValue> regionJSON = load(regionMetadata->getString("file"));
+        if (regionJSON == nullptr) {
+            CULog("MPLevelCompiler.cpp: Couldn't load region %s", regionMetadata->getString("name").c_str());
+            return vector<Uint8>();
+        }
+        shared_ptr<JsonValue> layers = regionJSON->get("layers");
+
+        // Find where each tileset's IDs start in this region
+        int entity_offset = 0;
+        int room_offset = 0;
+        shared_ptr<JsonValue> tilesets = regionJSON->get("tilesets");
+        for (int i = 0; i < (int)tilesets->size(); i++) {
+            if (tilesets->get(i)->getString("source").find("entities") != string::npos) {
+                entity_offset = tilesets->get(i)->getInt("firstgid");
+            }
+            if (tilesets->get(i)->getString("source").find("rooms") != string::npos) {
+                room_offset = tilesets->get(i)->getInt("firstgid");
+            }
+        }
+
+        // The sublevel each cell of the region ended up in, in REGION space
+        vector<int> cellSublevels(width * height, LEVEL_PACK_NO_SUBLEVEL);
+
+        // ROOMS
+        for (int i = 0; i < (int)layers->size(); i++) {
+            shared_ptr<JsonValue> layer = layers->get(i);
+            if (layer->getString("name").find("sublevel") == string::npos) continue;
+
+            int sublevel = (int)(sublevels.size() - region.firstSublevel);
+            vector<int> data = layer->get("data")->asIntArray();
+
+            // Set min coords to high values and max coords to low values
+            int xMin = width;
+            int yMin = height;
+            int xMax = 0;
+            int yMax = 0;
+
+            for (int j = 0; j < (int)data.size() / roomWidth / roomHeight; j++) {
+                // These coordinates are from the UPPER left
+                int x = j % width;
+                int y = (j / width);
+
+                // The room ID is the tile in the bottom left corner of the room
+                int bottom_corner = x * roomWidth + (y + 1) * roomWidth * width * roomHeight - roomWidth * width;
+                int room_id = data[bottom_corner];
+
+                // If room ID = 0, there's no room there
+                if (!room_id) continue;
+
+                string im = roomsTileset->get("tiles")->get(room_id - room_offset)->getString("image");
+
+                // Get the ID/name of the desired room type
+                LevelPack::Cell cell;
+                if (im.rfind("solid") != string::npos) {
+                    cell.roomID = intern(strings, stringOffsets, "room_solid");
+                    cell.solid = 1;
+                } else {
+                    string roomID = im.substr(im.rfind("room"));
+                    cell.roomID = intern(strings, stringOffsets, roomID.substr(0, roomID.length() - 4));
+                    cell.solid = 0;
+                }
+
+                // Flip the y, so now the coordinates are from the lower left
+                y = height - 1 - y;
+                cell.x = x;
+                cell.y = y;
+                cell.sublevel = sublevel;
+                cells.push_back(cell);
+                cellSublevels[y * width + x] = sublevel;
+
+                // Update min/max bounds if needed
+                if (x <= xMin && y <= yMin) {
+                    xMin = x;
+                    yMin = y;
+                }
+                if (x >= xMax && y >= yMax) {
+                    xMax = x;
+                    yMax = y;
+                }
+            }
+
+            // Sublevel origin is the min bound
+            LevelPack::Sublevel bounds;
+            bounds.x = xMin;
+            bounds.y = yMin;
+            bounds.width = xMax - xMin + 1;
+            bounds.height = yMax - yMin + 1;
+            sublevels.push_back(bounds);
+        }
+
+        // ENTITIES
+        for (int i = 0; i < (int)layers->size(); i++) {
+            shared_ptr<JsonValue> layer = layers->get(i);
+            if (layer->getString("name").find("entities") == string::npos) continue;
+
+            vector<int> data = layer->get("data")->asIntArray();
+            for (int j = 0; j < (int)data.size(); j++) {
+                if (data[j] == 0) continue;
+                auto type = entityTypes.find(data[j] - entity_offset);
+                if (type == entityTypes.end()) continue;
+
+                // Calculate the room coordinate that the tile is in
+                LevelPack::Entity entity;
+                entity.x = (j % (roomWidth * width)) / roomWidth;
+                entity.y = ((roomHeight * height - 1) - (j / (roomWidth * width))) / roomHeight;
+                entity.type = type->second;
+                entity.sublevel = (entity.x >= 0 && entity.x < width && entity.y >= 0 && entity.y < height)
+                                  ? cellSublevels[entity.y * width + entity.x] : LEVEL_PACK_NO_SUBLEVEL;
+                entities.push_back(entity);
+            }
+        }
+
+        region.sublevelCount = (Uint32)sublevels.size() - region.firstSublevel;
+        region.cellCount = (Uint32)cells.size() - region.firstCell;
+        region.entityCount = (Uint32)entities.size() - region.firstEntity;
+        regions.push_back(region);
+    }
+
+    // Lay the tables out after the header, strings last since they aren't aligned
+    vector<Uint8> pack(sizeof(LevelPack::Header));
+    header.regionCount = (Uint32)regions.size();
+    header.sublevelCount = (Uint32)sublevels.size();
+    header.cellCount = (Uint32)cells.size();
+    header.entityCount = (Uint32)entities.size();
+    header.regionOffset = appendTable(pack, regions);
+    header.sublevelOffset = appendTable(pack, sublevels);
+    header.cellOffset = appendTable(pack, cells);
+    header.entityOffset = appendTable(pack, entities);
+    header.stringOffset = appendTable(pack, strings);
+    header.stringSize = (Uint32)strings.size();
+    header.size = (Uint32)pack.size();
+    std::memcpy(pack.data(), &header, sizeof(header));
+    return pack;
+}
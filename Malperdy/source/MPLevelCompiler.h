@@ -0,0 +1,67 @@
+//
+//  MPLevelCompiler.h
+//  Malperdy
+//
+//  This class turns the world JSON and the Tiled JSON for each of its regions
+//  into a level pack (see LevelPack). All the work of reading the Tiled layers
+//  happens here: finding which room type is in each cell, working out the bounds
+//  of each sublevel, and sorting entity tiles into types by their tileset image.
+//
+//  The level pack tool uses this to make the pack that ships with the game.
+//  GridModel also uses it to build a pack in memory when there isn't one, so
+//  the world is always built from a pack either way. Every pack records a hash
+//  of the JSON it was made from, so GridModel can tell when the shipped pack
+//  is out of date and compile the JSON instead.
+//
+//  Besides the usual world JSON fields, this needs a "tilesets" object giving
+//  the paths of the rooms and entities tilesets, and a "file" for each region
+//  giving the path of its Tiled JSON. All paths are relative to the assets.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPLevelCompiler_h
+#define MPLevelCompiler_h
+
+#include <cugl/cugl.h>
+#include <functional>
+#include <vector>
+#include "MPLevelPack.h"
+
+using namespace cugl;
+
+class LevelCompiler {
+public:
+    /** Function that loads the JSON file at the given path, relative to the assets, or returns nullptr */
+    typedef std::function<shared_ptr<JsonValue>(const string &file)> Loader;
+
+    /** Function that reads the file at the given path, relative to the assets, or returns an empty string */
+    typedef std::function<string(const string &file)> Reader;
+
+    /**
+     * Returns a hash of the given world and every tileset and region file it
+     * refers to. The files are hashed as they are, without parsing them, so
+     * this is much cheaper than compiling the world.
+     *
+     * @param world The world JSON
+     * @param read  Function used to read the tilesets and the regions
+     * @return      The hash of the world and its files
+     */
+    static Uint32 hashSources(const shared_ptr<JsonValue> &world, const Reader &read);
+
+    /**
+     * Compiles the given world into a level pack.
+     *
+     * @param world         The world JSON
+     * @param load          Function used to load the tilesets and the regions
+     * @param sourceHash    The hash of the world from hashSources(), stored in the pack
+     * @return              The bytes of the level pack, or nothing if the world couldn't be compiled
+     */
+    static vector<Uint8> compile(const shared_ptr<JsonValue> &world, const Loader &load, Uint32 sourceHash);
+};
+
+#endif /* MPLevelCompiler_h */
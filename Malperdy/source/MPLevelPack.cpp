@@ -0,0 +1,175 @@
+//
+//  MPLevelPack.cpp
+//  Malperdy
+//
+//  This class is a read-only view of a compiled level pack, which holds the
+//  rooms, sublevels and entities of every region, ready for GridModel to use.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPLevelPack.h"
+
+// Android assets live inside the APK, so they can't be mapped
+#if (defined(__APPLE__) || defined(__linux__)) && !defined(__ANDROID__)
+#define LEVEL_PACK_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#pragma mark Constructors
+
+/**
+ * Unmaps or frees the pack. The pack is empty afterwards.
+ */
+void LevelPack::dispose() {
+#ifdef LEVEL_PACK_MMAP
+    if (_mapping != nullptr) {
+        munmap(_mapping, _size);
+    }
+#endif
+    _mapping = nullptr;
+    _owned.clear();
+    _data = nullptr;
+    _size = 0;
+}
+
+/**
+ * Initializes this pack from the file at the given path, relative to the
+ * asset directory. The file is memory-mapped on platforms that support it,
+ * and read into memory otherwise.
+ *
+ * @param file  The path of the pack, relative to the asset directory
+ * @return      true if the pack was loaded and is valid, false otherwise
+ */
+bool LevelPack::initWithAsset(const string &file) {
+    dispose();
+    string path = Application::get()->getAssetDirectory() + file;
+
+#ifdef LEVEL_PACK_MMAP
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void *mapping = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                _mapping = mapping;
+                _data = static_cast<const Uint8 *>(mapping);
+                _size = (size_t)info.st_size;
+            }
+        }
+        // The mapping stays valid after the file is closed
+        close(fd);
+        if (_mapping != nullptr) {
+            if (validate()) return true;
+            dispose();
+            return false;
+        }
+    }
+#endif
+
+    // Couldn't map it, so just read the whole thing
+    SDL_RWops *stream = SDL_RWFromFile(path.c_str(), "rb");
+    if (stream == nullptr) return false;
+    Sint64 size = SDL_RWsize(stream);
+    if (size <= 0) {
+        SDL_RWclose(stream);
+        return false;
+    }
+    vector<Uint8> bytes((size_t)size);
+    size_t read = SDL_RWread(stream, bytes.data(), 1, bytes.size());
+    SDL_RWclose(stream);
+    if (read != bytes.size()) return false;
+    return initWithBytes(std::move(bytes));
+}
+
+/**
+ * Initializes this pack from the given bytes, which it takes ownership of.
+ *
+ * @param bytes The bytes of the pack, as made by LevelCompiler
+ * @return      true if the pack is valid, false otherwise
+ */
+bool LevelPack::initWithBytes(vector<Uint8> &&bytes) {
+    dispose();
+    _owned = std::move(bytes);
+    _data = _owned.data();
+    _size = _owned.size();
+    if (validate()) return true;
+    dispose();
+    return false;
+}
+
+#pragma mark Validation
+
+/**
+ * Returns whether the table of the given number of records starting at the
+ * given offset fits in a pack of the given size.
+ *
+ * @param offset    The offset of the table in bytes
+ * @param count     The number of records in the table
+ * @param record    The size of each record in bytes
+ * @param size      The size of the pack in bytes
+ * @return          Whether the table fits in the pack
+ */
+static bool fits(Uint32 offset, Uint32 count, size_t record, size_t size) {
+    return offset % 4 == 0 && offset <= size && count <= (size - offset) / record;
+}
+
+/**
+ * Returns whether the pack is complete and every offset and range in it
+ * is in bounds.
+ *
+ * @return  Whether the pack is valid
+ */
+bool LevelPack::validate() const {
+    if (_data == nullptr || _size < sizeof(Header)) return false;
+
+    const Header &header = getHeader();
+    if (header.magic != LEVEL_PACK_MAGIC) return false;
+    if (header.version != LEVEL_PACK_VERSION) {
+        CULog("MPLevelPack.cpp: Unknown level pack version %u", header.version);
+        return false;
+    }
+    if (header.size != _size) return false;
+
+    if (!fits(header.regionOffset, header.regionCount, sizeof(Region), _size)
+            || !fits(header.sublevelOffset, header.sublevelCount, sizeof(Sublevel), _size)
+            || !fits(header.cellOffset, header.cellCount, sizeof(Cell), _size)
+            || !fits(header.entityOffset, header.entityCount, sizeof(Entity), _size)
+            || !fits(header.stringOffset, header.stringSize, 1, _size)) {
+        return false;
+    }
+    // Every string must be terminated inside the table
+    if (header.stringSize == 0 || getString(header.stringSize - 1)[0] != '\0') return false;
+
+    for (int i = 0; i < getRegionCount(); i++) {
+        const Region &region = getRegion(i);
+        if (region.name >= header.stringSize) return false;
+        if (region.firstSublevel > header.sublevelCount
+                || region.sublevelCount > header.sublevelCount - region.firstSublevel) return false;
+        if (region.firstCell > header.cellCount
+                || region.cellCount > header.cellCount - region.firstCell) return false;
+        if (region.firstEntity > header.entityCount
+                || region.entityCount > header.entityCount - region.firstEntity) return false;
+
+        const Cell *cells = getCells(region);
+        for (Uint32 j = 0; j < region.cellCount; j++) {
+            if (cells[j].roomID >= header.stringSize) return false;
+            if (cells[j].sublevel < 0 || cells[j].sublevel >= (Sint32)region.sublevelCount) return false;
+            if (cells[j].x < 0 || cells[j].x >= region.width || cells[j].y < 0 || cells[j].y >= region.height) return false;
+        }
+
+        const Entity *entities = getEntities(region);
+        for (Uint32 j = 0; j < region.entityCount; j++) {
+            if ((Uint32)entities[j].type > (Uint32)EntityType::EXIT) return false;
+            if (entities[j].sublevel >= (Sint32)region.sublevelCount) return false;
+        }
+    }
+    return true;
+}
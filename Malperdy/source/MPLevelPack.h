@@ -0,0 +1,299 @@
+//
+//  MPLevelPack.h
+//  Malperdy
+//
+//  This class is a read-only view of a compiled level pack. A level pack holds
+//  everything GridModel needs to build the world, already pulled out of the
+//  Tiled JSON for every region: the room type in each cell, the bounds of each
+//  sublevel, and a table of entities that have already been classified, so
+//  nothing needs to look at tileset image names at runtime.
+//
+//  Packs are made ahead of time by the level pack tool (see tools/), which uses
+//  LevelCompiler to do the conversion. The game memory-maps the pack where it
+//  can and reads the tables in place, so loading it takes no JSON parsing at
+//  all. If there's no pack, or the JSON has changed since it was made, the same
+//  LevelCompiler builds one in memory from the JSON instead, so both paths make
+//  exactly the same world.
+//
+//  The file is a header followed by a table for each record type below and
+//  then a table of null-terminated strings. Everything is little-endian and
+//  every record is made of 4-byte fields, so the tables can be read directly
+//  out of the file.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPLevelPack_h
+#define MPLevelPack_h
+
+#include <cugl/cugl.h>
+#include <vector>
+
+using namespace cugl;
+
+/** Magic number at the start of every level pack ("MPLP") */
+#define LEVEL_PACK_MAGIC 0x504C504D
+/** Current version of the level pack format */
+#define LEVEL_PACK_VERSION 2
+/** Sublevel index of an entity that isn't in any sublevel */
+#define LEVEL_PACK_NO_SUBLEVEL -1
+
+class LevelPack {
+public:
+    /** The kinds of entity that can be placed in a room */
+    enum class EntityType : Uint32 {
+        SPIKE,
+        TRAPDOOR,
+        SAP,
+        CHECKPOINT,
+        KEY_CHECKPOINT,
+        KEY_ENEMY,
+        KEY,
+        LOCKED,
+        EXIT
+    };
+
+    /** The start of the file */
+    struct Header {
+        /** Always LEVEL_PACK_MAGIC */
+        Uint32 magic;
+        /** The version of the format, LEVEL_PACK_VERSION */
+        Uint32 version;
+        /** Size of the whole pack in bytes */
+        Uint32 size;
+        /** Hash of the JSON the pack was compiled from, from LevelCompiler::hashSources() */
+        Uint32 sourceHash;
+        /** Dimensions of a room in tiles */
+        Sint32 roomWidth, roomHeight;
+        /** Size of each tile in pixels */
+        Sint32 tileSize;
+        /** How many of each record there are */
+        Uint32 regionCount, sublevelCount, cellCount, entityCount;
+        /** Where each table starts, in bytes from the start of the pack */
+        Uint32 regionOffset, sublevelOffset, cellOffset, entityOffset, stringOffset;
+        /** Size of the string table in bytes */
+        Uint32 stringSize;
+    };
+
+    /** A region, in the same order as the world JSON */
+    struct Region {
+        /** Offset of the region's name in the string table */
+        Uint32 name;
+        /** The type of the region, which picks its backgrounds */
+        Sint32 type;
+        /** Size of the region in rooms */
+        Sint32 width, height;
+        /** The lower left corner of the region in GRID space */
+        Sint32 originX, originY;
+        /** The region's sublevels, as a range of the sublevel table */
+        Uint32 firstSublevel, sublevelCount;
+        /** The region's rooms, as a range of the cell table */
+        Uint32 firstCell, cellCount;
+        /** The region's entities, as a range of the entity table */
+        Uint32 firstEntity, entityCount;
+    };
+
+    /** The bounds of a sublevel, in REGION space */
+    struct Sublevel {
+        Sint32 x, y, width, height;
+    };
+
+    /** A single room, in the order they should be created */
+    struct Cell {
+        /** Where the room goes, in REGION space from the lower left */
+        Sint32 x, y;
+        /** Index of the room's sublevel within its region */
+        Sint32 sublevel;
+        /** Offset of the room type's ID in the string table */
+        Uint32 roomID;
+        /** Whether the room is a solid room */
+        Uint32 solid;
+    };
+
+    /** A single entity, in the order they should be created */
+    struct Entity {
+        /** The room the entity is in, in REGION space from the lower left */
+        Sint32 x, y;
+        /** What the entity is */
+        EntityType type;
+        /** Index of the sublevel the room is in within its region, or LEVEL_PACK_NO_SUBLEVEL */
+        Sint32 sublevel;
+    };
+
+private:
+    /** The bytes of the pack, if they were read into memory instead of mapped */
+    vector<Uint8> _owned;
+    /** The start of the pack, either in [_owned] or in the mapped file */
+    const Uint8 *_data = nullptr;
+    /** The size of the pack in bytes */
+    size_t _size = 0;
+    /** The start of the mapping, if the pack was mapped, to unmap it later */
+    void *_mapping = nullptr;
+
+    /**
+     * Returns whether the pack is complete and every offset and range in it
+     * is in bounds.
+     *
+     * @return  Whether the pack is valid
+     */
+    bool validate() const;
+
+    /**
+     * Returns the table of records of the given type starting at the given
+     * offset in the pack.
+     *
+     * @param offset    The offset of the table in bytes
+     * @return          The first record in the table
+     */
+    template<typename T>
+    const T *table(Uint32 offset) const {
+        return reinterpret_cast<const T *>(_data + offset);
+    }
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates an empty level pack.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    LevelPack() {}
+
+    /**
+     * Destroys this level pack, unmapping the file if it was mapped.
+     */
+    ~LevelPack() { dispose(); }
+
+    /**
+     * Unmaps or frees the pack. The pack is empty afterwards.
+     */
+    void dispose();
+
+    /**
+     * Initializes this pack from the file at the given path, relative to the
+     * asset directory. The file is memory-mapped on platforms that support it,
+     * and read into memory otherwise.
+     *
+     * @param file  The path of the pack, relative to the asset directory
+     * @return      true if the pack was loaded and is valid, false otherwise
+     */
+    bool initWithAsset(const string &file);
+
+    /**
+     * Initializes this pack from the given bytes, which it takes ownership of.
+     *
+     * @param bytes The bytes of the pack, as made by LevelCompiler
+     * @return      true if the pack is valid, false otherwise
+     */
+    bool initWithBytes(vector<Uint8> &&bytes);
+
+    /**
+     * Returns a newly allocated pack loaded from the file at the given path,
+     * relative to the asset directory.
+     *
+     * @param file  The path of the pack, relative to the asset directory
+     * @return      A newly allocated LevelPack, or nullptr if it couldn't be loaded
+     */
+    static shared_ptr<LevelPack> allocWithAsset(const string &file) {
+        shared_ptr<LevelPack> result = make_shared<LevelPack>();
+        return (result->initWithAsset(file) ? result : nullptr);
+    }
+
+    /**
+     * Returns a newly allocated pack made from the given bytes.
+     *
+     * @param bytes The bytes of the pack, as made by LevelCompiler
+     * @return      A newly allocated LevelPack, or nullptr if the bytes aren't a valid pack
+     */
+    static shared_ptr<LevelPack> allocWithBytes(vector<Uint8> &&bytes) {
+        shared_ptr<LevelPack> result = make_shared<LevelPack>();
+        return (result->initWithBytes(std::move(bytes)) ? result : nullptr);
+    }
+
+#pragma mark Getters
+
+    /**
+     * Returns the header of the pack.
+     *
+     * @return  The header of the pack
+     */
+    const Header &getHeader() const {
+        return *table<Header>(0);
+    }
+
+    /**
+     * Returns the number of regions in the pack.
+     *
+     * @return  The number of regions
+     */
+    int getRegionCount() const {
+        return (int)getHeader().regionCount;
+    }
+
+    /**
+     * Returns the region at the given index.
+     *
+     * @param index The index of the region, in the same order as the world JSON
+     * @return      The region at that index
+     */
+    const Region &getRegion(int index) const {
+        return table<Region>(getHeader().regionOffset)[index];
+    }
+
+    /**
+     * Returns the first sublevel of the given region. The rest follow it.
+     *
+     * @param region    The region to get the sublevels of
+     * @return          The first of the region's sublevels
+     */
+    const Sublevel *getSublevels(const Region &region) const {
+        return table<Sublevel>(getHeader().sublevelOffset) + region.firstSublevel;
+    }
+
+    /**
+     * Returns the first cell of the given region. The rest follow it.
+     *
+     * @param region    The region to get the cells of
+     * @return          The first of the region's cells
+     */
+    const Cell *getCells(const Region &region) const {
+        return table<Cell>(getHeader().cellOffset) + region.firstCell;
+    }
+
+    /**
+     * Returns the first entity of the given region. The rest follow it.
+     *
+     * @param region    The region to get the entities of
+     * @return          The first of the region's entities
+     */
+    const Entity *getEntities(const Region &region) const {
+        return table<Entity>(getHeader().entityOffset) + region.firstEntity;
+    }
+
+    /**
+     * Returns the string at the given offset in the string table.
+     *
+     * @param offset    The offset of the string in the string table
+     * @return          The string at that offset
+     */
+    const char *getString(Uint32 offset) const {
+        return reinterpret_cast<const char *>(_data + getHeader().stringOffset + offset);
+    }
+
+    /**
+     * Returns whether the pack was memory-mapped instead of read into memory.
+     *
+     * @return  Whether the pack is memory-mapped
+     */
+    bool isMapped() const {
+        return _mapping != nullptr;
+    }
+};
+
+#endif /* MPLevelPack_h */
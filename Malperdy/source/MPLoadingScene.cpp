@@ -12,6 +12,7 @@
 //
 #include "MPLoadingScene.h"
 #include "MPAudioController.h"
+#include "MPSaveFile.h"
 
 using namespace cugl;
 
@@ -276,10 +277,7 @@ bool LoadingScene::isPending() const {
 * @return whether there is a save file to load
 */
 bool LoadingScene::saveFileExists() {
-    vector<std::string> file_path_list = vector<std::string>(2);
-    file_path_list[0] = Application::get()->getSaveDirectory();
-    file_path_list[1] = "state.json";
-    return filetool::file_exists(cugl::filetool::join_path(file_path_list));
+    return SaveFile::exists();
 }
 
 /* Hides all assets so it's safe to switch screens */
@@ -0,0 +1,108 @@
+//
+//  MPOccupancyGrid.cpp
+//  Malperdy
+//
+//  This class keeps track of which room every character is in, and locks
+//  every room that has anyone in it.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPOccupancyGrid.h"
+
+#pragma mark Tracking
+
+/**
+ * Reports the room the given character is in this frame. Nothing happens
+ * unless it's a different room than last time.
+ *
+ * @param actor The character
+ * @param room  The room the character is in, in HOUSE space
+ */
+void OccupancyGrid::track(const CharacterModel *actor, Vec2 room) {
+    int cell = getIndex(room);
+    auto itr = _actors.find(actor);
+    if (itr == _actors.end()) {
+        Actor entry;
+        entry.frame = _frame;
+        _actors[actor] = entry;
+        move(actor, -1, cell);
+        return;
+    }
+
+    itr->second.frame = _frame;
+    if (itr->second.cell != cell) move(actor, itr->second.cell, cell);
+}
+
+/**
+ * Drops every character that didn't report its room since beginFrame(),
+ * since they are no longer in the world.
+ */
+void OccupancyGrid::endFrame() {
+    for (auto itr = _actors.begin(); itr != _actors.end();) {
+        if (itr->second.frame == _frame) {
+            ++itr;
+            continue;
+        }
+        const CharacterModel *actor = itr->first;
+        int cell = itr->second.cell;
+        itr = _actors.erase(itr);
+        move(actor, cell, -1);
+    }
+}
+
+/**
+ * Stops tracking the given character, unlocking its room.
+ *
+ * @param actor The character to stop tracking
+ */
+void OccupancyGrid::remove(const CharacterModel *actor) {
+    auto itr = _actors.find(actor);
+    if (itr == _actors.end()) return;
+    int cell = itr->second.cell;
+    _actors.erase(itr);
+    move(actor, cell, -1);
+}
+
+/**
+ * Makes the locks of the room in the given cell match who is in the cell.
+ * This should be called whenever a room is moved into a cell without the
+ * characters in it moving.
+ *
+ * @param room  The cell in HOUSE space
+ */
+void OccupancyGrid::syncLocks(Vec2 room) {
+    shared_ptr<RoomModel> model = _rooms->getRoom(room.x, room.y);
+    if (model != nullptr) model->setOccupants(getCount(room));
+}
+
+/**
+ * Moves the given character between cells, locking and unlocking rooms
+ * and telling every listener.
+ */
+void OccupancyGrid::move(const CharacterModel *actor, int from, int to) {
+    if (from >= 0) {
+        _counts[from]--;
+        shared_ptr<RoomModel> room = _rooms->getRooms()[from];
+        if (room != nullptr) room->unlockRoom();
+    }
+    if (to >= 0) {
+        _counts[to]++;
+        shared_ptr<RoomModel> room = _rooms->getRooms()[to];
+        if (room != nullptr) room->lockRoom();
+    }
+    auto itr = _actors.find(actor);
+    if (itr != _actors.end()) itr->second.cell = to;
+
+    Crossing crossing;
+    crossing.actor = actor;
+    crossing.from = getCoords(from);
+    crossing.to = getCoords(to);
+    for (auto listener = _listeners.begin(); listener != _listeners.end(); ++listener) {
+        (*listener)(crossing);
+    }
+}
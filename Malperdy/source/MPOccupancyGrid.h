@@ -0,0 +1,204 @@
+//
+//  MPOccupancyGrid.h
+//  Malperdy
+//
+//  This class keeps track of which room every character is in, so that
+//  whether a room is occupied can be answered without looking at every
+//  character. Characters report their room once per frame, and nothing
+//  changes unless one of them has crossed into a different room.
+//
+//  A room is locked for as long as it has anyone in it. Every character
+//  entering a room locks it once and every character leaving unlocks it
+//  once, so the lock only comes off when the last character leaves.
+//  Listeners are told about every crossing, including characters showing
+//  up for the first time and characters going away.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPOccupancyGrid_h
+#define MPOccupancyGrid_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include <unordered_map>
+#include "MPRoomTable.h"
+#include "MPCharacterModel.h"
+
+using namespace cugl;
+
+class OccupancyGrid {
+public:
+    /** A character moving from one room to another */
+    struct Crossing {
+        /** The character that moved */
+        const CharacterModel *actor;
+        /** The room it left in HOUSE space, or (-1, -1) if it just showed up */
+        Vec2 from;
+        /** The room it entered in HOUSE space, or (-1, -1) if it went away */
+        Vec2 to;
+    };
+
+private:
+    /** Where a single character is */
+    struct Actor {
+        /** Index of the cell the character is in, or -1 if it's outside the table */
+        int cell = -1;
+        /** The last frame the character reported its room */
+        unsigned int frame = 0;
+    };
+
+    /** The table of rooms being tracked */
+    shared_ptr<RoomTable> _rooms;
+    /** How many characters are in each cell, in the same order as the room table */
+    vector<int> _counts;
+    /** Every character being tracked */
+    unordered_map<const CharacterModel *, Actor> _actors;
+    /** The current frame, used to drop characters that stop reporting */
+    unsigned int _frame = 0;
+    /** Everyone to tell about crossings */
+    vector<std::function<void(const Crossing &crossing)>> _listeners;
+
+    /**
+     * Returns the index of the given cell, or -1 if it's outside the table.
+     */
+    int getIndex(Vec2 room) const {
+        return _rooms->inBounds(room.x, room.y) ? (int)room.y * _rooms->getWidth() + (int)room.x : -1;
+    }
+
+    /**
+     * Returns the HOUSE space coordinates of the cell at the given index.
+     */
+    Vec2 getCoords(int index) const {
+        return (index < 0) ? Vec2(-1, -1) : Vec2(index % _rooms->getWidth(), index / _rooms->getWidth());
+    }
+
+    /**
+     * Moves the given character between cells, locking and unlocking rooms
+     * and telling every listener.
+     */
+    void move(const CharacterModel *actor, int from, int to);
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates an occupancy grid with no table.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    OccupancyGrid() {}
+
+    /**
+     * Returns a newly allocated occupancy grid for the given table, with
+     * nobody in it.
+     *
+     * @param rooms The table of rooms to track
+     * @return      A newly allocated OccupancyGrid
+     */
+    static shared_ptr<OccupancyGrid> alloc(const shared_ptr<RoomTable> &rooms) {
+        shared_ptr<OccupancyGrid> result = make_shared<OccupancyGrid>();
+        result->_rooms = rooms;
+        result->_counts.assign(rooms->getWidth() * rooms->getHeight(), 0);
+        return result;
+    }
+
+#pragma mark Tracking
+
+    /**
+     * Starts a new frame. Any character that doesn't report its room before
+     * the next call to endFrame() is dropped.
+     */
+    void beginFrame() {
+        _frame++;
+    }
+
+    /**
+     * Reports the room the given character is in this frame. Nothing happens
+     * unless it's a different room than last time.
+     *
+     * @param actor The character
+     * @param room  The room the character is in, in HOUSE space
+     */
+    void track(const CharacterModel *actor, Vec2 room);
+
+    /**
+     * Drops every character that didn't report its room since beginFrame(),
+     * since they are no longer in the world.
+     */
+    void endFrame();
+
+    /**
+     * Stops tracking the given character, unlocking its room.
+     *
+     * @param actor The character to stop tracking
+     */
+    void remove(const CharacterModel *actor);
+
+    /**
+     * Makes the locks of the room in the given cell match who is in the cell.
+     * This should be called whenever a room is moved into a cell without the
+     * characters in it moving.
+     *
+     * @param room  The cell in HOUSE space
+     */
+    void syncLocks(Vec2 room);
+
+    /**
+     * Adds a listener to be told about every crossing.
+     *
+     * @param listener  The function to call for every crossing
+     */
+    void addListener(const std::function<void(const Crossing &crossing)> &listener) {
+        _listeners.push_back(listener);
+    }
+
+    /**
+     * Stops tracking everyone, without touching any locks.
+     */
+    void clear() {
+        _actors.clear();
+        _counts.assign(_counts.size(), 0);
+    }
+
+#pragma mark Queries
+
+    /**
+     * Returns how many characters are in the given room.
+     *
+     * @param room  The room in HOUSE space
+     * @return      The number of characters in the room
+     */
+    int getCount(Vec2 room) const {
+        int index = getIndex(room);
+        return (index < 0) ? 0 : _counts[index];
+    }
+
+    /**
+     * Returns whether anyone is in the given room.
+     *
+     * @param room  The room in HOUSE space
+     * @return      Whether the room is occupied
+     */
+    bool isOccupied(Vec2 room) const {
+        return getCount(room) > 0;
+    }
+
+    /**
+     * Returns the room the given character was last in.
+     *
+     * @param actor The character
+     * @return      The character's room in HOUSE space, or (-1, -1) if it isn't tracked
+     */
+    Vec2 getRoom(const CharacterModel *actor) const {
+        auto itr = _actors.find(actor);
+        return (itr == _actors.end()) ? Vec2(-1, -1) : getCoords(itr->second.cell);
+    }
+};
+
+#endif /* MPOccupancyGrid_h */
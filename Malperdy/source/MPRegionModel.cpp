@@ -68,6 +68,23 @@ bool RegionModel::isInRegion(int x, int y) {
             && _originY <= y && y < _originY + _height);
 }
 
+/**
+ * Returns the index in [_sublevels] of the sublevel that the room at the given
+ * GRID space coordinates is located in.
+ *
+ * @param x		An x-coordinate of a room in GRID space
+ * @param y		A y-coordinate of a room in GRID space
+ * @return		The index of the sublevel, or NO_SUBLEVEL if there is none in this region
+ */
+int RegionModel::getSublevelIndex(int x, int y) {
+    // Transform these GRID coordinates to HOUSE space to look up in the table
+    x -= _table->getOriginX();
+    y -= _table->getOriginY();
+
+    if (_table->getRegion(x, y) != _number) return NO_SUBLEVEL;
+    return _table->getSublevel(x, y);
+}
+
 /**
  * Returns the sublevel that the room at the given GRID space coordinates is located in.
  *
@@ -76,16 +93,8 @@ bool RegionModel::isInRegion(int x, int y) {
  * @return		The Sublevel containing the given coordinates, or nullptr if there is none
  */
 shared_ptr<RegionModel::Sublevel> RegionModel::getSublevel(int x, int y) {
-    // Transform these GRID coordinates to REGION space
-    x -= _originX;
-    y -= _originY;
-
-    // Check each sublevel for if it contains this room
-    for (shared_ptr<Sublevel> sublevel: *_sublevels) {
-        if (sublevel->isInSublevel(x, y)) return sublevel;
-    }
-
-    return nullptr;
+    int index = getSublevelIndex(x, y);
+    return (index == NO_SUBLEVEL) ? nullptr : _sublevels->at(index);
 }
 
 /**
@@ -96,13 +105,10 @@ shared_ptr<RegionModel::Sublevel> RegionModel::getSublevel(int x, int y) {
  * @return		The RoomModel at the given coordinates, or nullptr if there is none
  */
 shared_ptr<RoomModel> RegionModel::getRoom(int x, int y) {
-    shared_ptr<Sublevel> sublevel = getSublevel(x, y);
+    if (getSublevelIndex(x, y) == NO_SUBLEVEL) return nullptr;
 
-    // Transform these GRID coordinates to REGION space
-    x -= _originX;
-    y -= _originY;
-
-    return (sublevel == nullptr) ? nullptr : sublevel->getRoom(x, y);
+    // Transform these GRID coordinates to HOUSE space
+    return _table->getRoom(x - _table->getOriginX(), y - _table->getOriginY());
 }
 
 #pragma mark Setters
@@ -119,19 +125,20 @@ shared_ptr<RoomModel> RegionModel::getRoom(int x, int y) {
  * @return      Whether the room was set successfully
  */
 bool RegionModel::setRoom(int x, int y, shared_ptr<RoomModel> room) {
-    shared_ptr<Sublevel> sublevel = getSublevel(x, y);
-
-    // Transform these GRID coordinates to REGION space
-    x -= _originX;
-    y -= _originY;
+    if (getSublevelIndex(x, y) == NO_SUBLEVEL) return false;
 
-    return (sublevel == nullptr) ? false : sublevel->setRoom(x, y, room);
+    // Transform these GRID coordinates to HOUSE space
+    return _table->setRoom(x - _table->getOriginX(), y - _table->getOriginY(), room);
 }
 
 #pragma mark Sublevels
 
 /**
  * Adds a sublevel with the given characteristics to this region.
+ *
+ * The rooms of the sublevel must already have been placed in the RoomTable,
+ * tagged with this region's number and the index the sublevel will have,
+ * which is the current number of sublevels.
  * 
  * This DOES NOT handle checkpoint linking; that must be done separately.
  *
@@ -139,16 +146,37 @@ bool RegionModel::setRoom(int x, int y, shared_ptr<RoomModel> room) {
  * @param originY		The y-coordinate of the lower left room of the sublevel, in region space
  * @param width			How many rooms wide this sublevel is
  * @param height		How many rooms tall this sublevel is
- * @param rooms			The rooms of the sublevel as a 2D vector array
  */
-void RegionModel::addSublevel(int originX, int originY, int width, int height,
-        shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> rooms) {
-
+void RegionModel::addSublevel(int originX, int originY, int width, int height) {
     // Create a new sublevel with the given characteristics and store
-    shared_ptr<Sublevel> sublevel = Sublevel::alloc(originX, originY, width, height, rooms);
+    shared_ptr<Sublevel> sublevel = Sublevel::alloc(originX, originY, width, height);
     _sublevels->push_back(sublevel);
 }
 
+/**
+ * Clears all the rooms in the sublevel at the given index by changing the
+ * backgrounds to the given cleared background.
+ *
+ * @param index		The index of the sublevel in [_sublevels]
+ * @param bgCleared	The background texture that marks a room as cleared
+ */
+void RegionModel::clearSublevel(int index, shared_ptr<Texture> bgCleared) {
+    shared_ptr<Sublevel> sublevel = _sublevels->at(index);
+
+    // Sublevel origin in HOUSE space, so it can be looked up in the table
+    int x0 = sublevel->getOriginX() + _originX - _table->getOriginX();
+    int y0 = sublevel->getOriginY() + _originY - _table->getOriginY();
+
+    // For each room in the sublevel
+    for (int y = y0; y < y0 + sublevel->getHeight(); y++) {
+        for (int x = x0; x < x0 + sublevel->getWidth(); x++) {
+            if (_table->getRegion(x, y) != _number || _table->getSublevel(x, y) != index) continue;
+            shared_ptr<RoomModel> room = _table->getRoom(x, y);
+            if (room != nullptr) room->clear(bgCleared);
+        }
+    }
+}
+
 /**
  * Sets the room located in the xth column from the left and the yth
  * row from the bottom in GRID space coordinates to be an exit room.
@@ -190,25 +218,38 @@ bool RegionModel::setExitRoom(int x, int y, shared_ptr<Texture> tex) {
  * @return		Whether the checkpoint was successfully added to the region
  */
 bool RegionModel::addCheckpoint(int cID, int cX, int cY) {
-    // Convert to REGION space
-    cX -= _originX;
-    cY -= _originY;
-
     // Increment number of uncleared checkpoints in the level
     _checkpointsToClear++;
 
-    // Now check each sublevel to find the one this checkpoint belongs to
-    for (int k = 0; k < _sublevels->size(); k++) {
-        // When that sublevel is found
-        if (_sublevels->at(k)->isInSublevel(cX, cY)) {
-            // Add the checkpoint to the map
-            _checkpointMap->emplace(cID, k);
-            return true;
-        }
-    }
+    // Find the sublevel this checkpoint belongs to
+    int index = getSublevelIndex(cX, cY);
 
     // If no such sublevel was found, return false
-    return false;
+    if (index == NO_SUBLEVEL) return false;
+
+    // Add the checkpoint to the map
+    _checkpointMap->emplace(cID, index);
+    return true;
+}
+
+/**
+ * Adds a checkpoint to the region and links it to the sublevel with the given
+ * index, for when it's already known which sublevel the checkpoint is inside.
+ *
+ * @param cID	The ID of the checkpoint to add to this region
+ * @param index	The index of the sublevel the checkpoint is in, or NO_SUBLEVEL
+ * @return		Whether the checkpoint was successfully added to the region
+ */
+bool RegionModel::addCheckpointToSublevel(int cID, int index) {
+    // Increment number of uncleared checkpoints in the level
+    _checkpointsToClear++;
+
+    // If it isn't in a sublevel, return false
+    if (index == NO_SUBLEVEL || index >= getNumSublevels()) return false;
+
+    // Add the checkpoint to the map
+    _checkpointMap->emplace(cID, index);
+    return true;
 }
 
 /**
@@ -231,7 +272,7 @@ int RegionModel::clearCheckpoint(int cID) {
     AudioController::playSFX(CHECKPOINT_SOUND);
 
     // Clear all the rooms in the sublevel
-    _sublevels->at(_checkpointMap->at(cID))->clearSublevel(_bgsCleared->at(_bgType - 1));
+    clearSublevel(_checkpointMap->at(cID), _bgsCleared->at(_bgType - 1));
 
     // Now unlink this checkpoint from the checkpoint map
     _checkpointMap->operator[](cID) = -1;
@@ -253,11 +294,6 @@ int RegionModel::clearCheckpoint(int cID) {
  * player can move on to the next region.
  */
 void RegionModel::clearRegion() {
-    // Clear physics for blockades
-    for (auto itr = _blockadesObs->begin(); itr != _blockadesObs->end(); ++itr) {
-        (*itr)->markRemoved(true);
-    }
-
     // Clear visuals for blockades
     _exitRooms = nullptr;
     for (auto itr = _blockades->begin(); itr != _blockades->end(); ++itr) {
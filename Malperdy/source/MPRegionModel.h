@@ -23,6 +23,7 @@
 #include <map>
 
 #include "MPRoomModel.h"
+#include "MPRoomTable.h"
 #include "MPAudioController.h"
 
 using namespace cugl;
@@ -42,29 +43,25 @@ private:
         /** Width and height, in number of rooms, of this sublevel */
         int _width, _height;
 
-        /** Grid of pointers for all the rooms in the sublevel, where _rooms[i][j]
-        is the room in the ith row from the bottom and jth column from the left in
-        REGION space */
-        shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> _rooms;
-
     public:
         /**
          * Initialize a sublevel with the given characteristics.
          *
+         * The rooms themselves live in the grid's RoomTable, where each cell
+         * records which sublevel it belongs to, so a sublevel only needs to
+         * know its bounds.
+         *
          * @param originX		The x-coordinate of the lower left room of the sublevel, in region space
          * @param originY		The y-coordinate of the lower left room of the sublevel, in region space
          * @param width			How many rooms wide this sublevel is
          * @param height		How many rooms tall this sublevel is
-         * @param rooms			The rooms of the sublevel as a 2D vector array
          * @return				true if the sublevel is initialized properly, false otherwise.
          */
-        bool init(int originX, int originY, int width, int height,
-                shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> rooms) {
+        bool init(int originX, int originY, int width, int height) {
             _originX = originX;
             _originY = originY;
             _width = width;
             _height = height;
-            _rooms = rooms;
             return true;
         }
 
@@ -75,17 +72,16 @@ private:
          * @param originY		The y-coordinate of the lower left room of the sublevel, in region space
          * @param width			How many rooms wide this sublevel is
          * @param height		How many rooms tall this sublevel is
-         * @param rooms			The rooms of the sublevel as a 2D vector array
          * @return				A newly-allocated Sublevel
          */
-        static shared_ptr<Sublevel> alloc(int originX, int originY, int width, int height,
-                shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> rooms) {
+        static shared_ptr<Sublevel> alloc(int originX, int originY, int width, int height) {
             shared_ptr<Sublevel> result = make_shared<Sublevel>();
-            return (result->init(originX, originY, width, height, rooms) ? result : nullptr);
+            return (result->init(originX, originY, width, height) ? result : nullptr);
         }
 
         /**
-         * Returns whether the given coordinates in REGION space are within this sublevel.
+         * Returns whether the given coordinates in REGION space are within the
+         * bounds of this sublevel.
          *
          * @param x		An x-coordinate in region space (cols from left)
          * @param y		A y-coordinate in region space (rows from bottom)
@@ -96,54 +92,24 @@ private:
                     && _originY <= y && y < _originY + _height);
         }
 
-        /**
-         * Returns the room at the given coordinates in REGION space.
-         *
-         * @param x		An x-coordinate for a room in region space (cols from left)
-         * @param y		A y-coordinate for a room in region space (rows from bottom)
-         * @return		Whether there is a room at the given coordinates, or nullptr otherwise
-         */
-        shared_ptr<RoomModel> getRoom(int x, int y) {
-            // Return nullptr now if this room is not in this sublevel
-            if (!isInSublevel(x, y)) return nullptr;
-
-            // Then return the right room
-            return _rooms->at(y)->at(x);
+        /** Returns the x-coordinate of the lower left room of the sublevel, in region space */
+        int getOriginX() {
+            return _originX;
         }
 
-        /**
-         * Sets the given room to be located in the xth column from the
-         * left and the yth row from the bottom in REGION space coordinates.
-         *
-         * Returns whether or not the room was set successfully.
-         *
-         * @param x     The x-coordinate to place the room at in REGION space
-         * @param y     The y-coordinate to place the room at in REGION space
-         * @param room  The room to be placed at the given coordinates
-         * @return      Whether the room was set successfully
-         */
-        bool setRoom(int x, int y, shared_ptr<RoomModel> room) {
-            // Return false now if this location is not in this sublevel
-            if (!isInSublevel(x, y)) return false;
+        /** Returns the y-coordinate of the lower left room of the sublevel, in region space */
+        int getOriginY() {
+            return _originY;
+        }
 
-            // Set the room and then return true
-            _rooms->at(y)->at(x) = room;
-            return true;
+        /** Returns how many rooms wide this sublevel is */
+        int getWidth() {
+            return _width;
         }
 
-        /**
-         * Clears all the rooms in this sublevel by changing the backgrounds to the
-         * given cleared background.
-         *
-         * @param bgCleared	The background texture that marks a room as cleared
-         */
-        void clearSublevel(shared_ptr<Texture> bgCleared) {
-            // For each room in the sublevel
-            for (int x = _originX; x < _originX + _width; x++) {
-                for (int y = _originY; y < _originY + _height; y++) {
-                    _rooms->at(y)->at(x)->clear(bgCleared);
-                }
-            }
+        /** Returns how many rooms tall this sublevel is */
+        int getHeight() {
+            return _height;
         }
     };
 
@@ -155,6 +121,12 @@ private:
     /** Which background type the region uses (corresponds to 1-3 based on region) */
     int _bgType = 0;
 
+    /** The number of this region in the grid (from 1), which is what the RoomTable stores per cell */
+    int _number = NO_REGION;
+
+    /** Reference to the grid's table of rooms, which this region's rooms are stored in */
+    shared_ptr<RoomTable> _table;
+
     /** The width and height of this region in number of rooms */
     int _width, _height;
 
@@ -188,10 +160,6 @@ private:
     shared_ptr<vector<shared_ptr<scene2::PolygonNode>>> _blockades =
             make_shared<vector<shared_ptr<scene2::PolygonNode>>>();
 
-    /** Pointers to the physics obstacles that block the exits */
-    shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> _blockadesObs =
-            make_shared<vector<shared_ptr<physics2::PolygonObstacle>>>();
-
     /** The exit rooms, which unblock when the region is cleared */
     shared_ptr<vector<shared_ptr<RoomModel>>> _exitRooms =
             make_shared<vector<shared_ptr<RoomModel>>>();
@@ -217,11 +185,17 @@ public:
      * @param height	The height of this region in rooms
      * @param originX   The x-coordinate of the region origin in grid space
      * @param originY   The y-coordinate of the region origin in grid space
+     * @param number    The number of this region in the grid, from 1
+     * @param table     The grid's table of rooms, which must cover this region
      * @return          true if the region is initialized properly, false otherwise.
      */
-    bool init(string name, int type, int width, int height, int originX, int originY) {
+    bool init(string name, int type, int width, int height, int originX, int originY,
+            int number, shared_ptr<RoomTable> table) {
+        if (table == nullptr) return false;
         _name = name;
         _bgType = type;
+        _number = number;
+        _table = table;
         _width = width;
         _height = height;
         _originX = originX;
@@ -243,11 +217,14 @@ public:
      * @param height	The height of this region in rooms
      * @param originX   The x-coordinate of the region origin in grid space
      * @param originY   The y-coordinate of the region origin in grid space
+     * @param number    The number of this region in the grid, from 1
+     * @param table     The grid's table of rooms, which must cover this region
      * @return          true if the region is initialized properly, false otherwise.
      */
-    static shared_ptr<RegionModel> alloc(string name, int type, int width, int height, int originX, int originY) {
+    static shared_ptr<RegionModel> alloc(string name, int type, int width, int height, int originX, int originY,
+            int number, shared_ptr<RoomTable> table) {
         shared_ptr<RegionModel> result = make_shared<RegionModel>();
-        return (result->init(name, type, width, height, originX, originY) ? result : nullptr);
+        return (result->init(name, type, width, height, originX, originY, number, table) ? result : nullptr);
     }
 
 #pragma mark Getters
@@ -272,6 +249,15 @@ public:
         return _bgType;
     }
 
+    /**
+     * Returns the number of this region in the grid, counting from 1.
+     *
+     * @return	The number of this region
+     */
+    int getNumber() {
+        return _number;
+    }
+
     /**
      * Returns the number of sublevels in this region.
      *
@@ -352,6 +338,21 @@ public:
         return _exitRooms;
     }
 
+    /**
+     * Returns the blockade texture node covering the given exit room, or
+     * nullptr if the room isn't an exit room or the region has been cleared.
+     *
+     * @param room  The room to get the blockade for
+     * @return      The blockade for the given room
+     */
+    shared_ptr<scene2::PolygonNode> getBlockade(const shared_ptr<RoomModel> &room) {
+        if (_exitRooms == nullptr) return nullptr;
+        for (size_t k = 0; k < _exitRooms->size(); k++) {
+            if (_exitRooms->at(k) == room) return _blockades->at(k);
+        }
+        return nullptr;
+    }
+
     /**
      * Returns whether the given GRID space coordinates are within this
      * region.
@@ -382,12 +383,21 @@ public:
      * @return		Whether both coordinates are within the same sublevel
      */
     bool areInSameSublevel(int x1, int y1, int x2, int y2) {
-        shared_ptr<Sublevel> sublevel1 = getSublevel(x1, y1);
-        shared_ptr<Sublevel> sublevel2 = getSublevel(x2, y2);
-        return (sublevel1 == sublevel2 && sublevel1 != nullptr && sublevel2 != nullptr);
+        int sublevel1 = getSublevelIndex(x1, y1);
+        return (sublevel1 != NO_SUBLEVEL && sublevel1 == getSublevelIndex(x2, y2));
     }
 
 private:
+    /**
+     * Returns the index in [_sublevels] of the sublevel that the room at the given
+     * GRID space coordinates is located in.
+     *
+     * @param x		An x-coordinate of a room in GRID space
+     * @param y		A y-coordinate of a room in GRID space
+     * @return		The index of the sublevel, or NO_SUBLEVEL if there is none in this region
+     */
+    int getSublevelIndex(int x, int y);
+
     /**
      * Returns the sublevel that the room at the given GRID space coordinates is located in.
      *
@@ -397,6 +407,15 @@ private:
      */
     shared_ptr<Sublevel> getSublevel(int x, int y);
 
+    /**
+     * Clears all the rooms in the sublevel at the given index by changing the
+     * backgrounds to the given cleared background.
+     *
+     * @param index		The index of the sublevel in [_sublevels]
+     * @param bgCleared	The background texture that marks a room as cleared
+     */
+    void clearSublevel(int index, shared_ptr<Texture> bgCleared);
+
 public:
 #pragma mark Setters
 
@@ -424,16 +443,6 @@ public:
      */
     bool setExitRoom(int x, int y, shared_ptr<Texture> tex);
 
-    /**
-     * Adds the given obstacle to the list of obstacles for this region's
-     * exit blockades.
-     *
-     * @param obs	A physics obstacle for an exit room blockade, created in GridModel
-     */
-    void addBlockadeObs(shared_ptr<physics2::PolygonObstacle> obs) {
-        _blockadesObs->push_back(obs);
-    }
-
 #pragma mark Backgrounds
 
     /**
@@ -462,16 +471,18 @@ public:
     /**
      * Adds a sublevel with the given characteristics to this region.
      *
+     * The rooms of the sublevel must already have been placed in the RoomTable,
+     * tagged with this region's number and the index the sublevel will have,
+     * which is the current number of sublevels.
+     *
      * This DOES NOT handle checkpoint linking; that msut be done separately.
      *
      * @param originX		The x-coordinate of the lower left room of the sublevel, in region space
      * @param originY		The y-coordinate of the lower left room of the sublevel, in region space
      * @param width			How many rooms wide this sublevel is
      * @param height		How many rooms tall this sublevel is
-     * @param rooms			The rooms of the sublevel as a 2D vector array
      */
-    void addSublevel(int originX, int originY, int width, int height,
-            shared_ptr<vector<shared_ptr<vector<shared_ptr<RoomModel>>>>> rooms);
+    void addSublevel(int originX, int originY, int width, int height);
 
 #pragma mark Checkpoints
 
@@ -487,6 +498,16 @@ public:
      */
     bool addCheckpoint(int cID, int cX, int cY);
 
+    /**
+     * Adds a checkpoint to the region and links it to the sublevel with the given
+     * index, for when it's already known which sublevel the checkpoint is inside.
+     *
+     * @param cID	The ID of the checkpoint to add to this region
+     * @param index	The index of the sublevel the checkpoint is in, or NO_SUBLEVEL
+     * @return		Whether the checkpoint was successfully added to the region
+     */
+    bool addCheckpointToSublevel(int cID, int index);
+
     /**
      * Clears all the rooms associated with the checkpoint with the given ID (backgrounds
      * are swapped to the "cleared" option for the associated region).
@@ -0,0 +1,150 @@
+//
+//  MPRenderInterpolator.cpp
+//  Malperdy
+//
+//  This class smooths out motion when the screen refreshes more often than
+//  the simulation ticks, by drawing every moving body partway between the
+//  transforms its obstacle kept before and after the last tick.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPRenderInterpolator.h"
+
+#pragma mark Tracking
+
+/**
+ * Starts drawing the given node partway between ticks of the given body.
+ * If the body is already tracked, it gets the new node and starts over
+ * without a previous transform.
+ *
+ * @param obstacle  The moving body
+ * @param node      The node that draws it
+ */
+void RenderInterpolator::add(const shared_ptr<physics2::Obstacle> &obstacle,
+                             const shared_ptr<scene2::SceneNode> &node) {
+    // Anything it kept from before it was added is out of date
+    obstacle->snapTransform();
+
+    // Enemies come back from the pool, so the same body can be added again
+    for (auto itr = _bodies.begin(); itr != _bodies.end(); ++itr) {
+        if (itr->obstacle.lock() == obstacle) {
+            itr->node = node;
+            return;
+        }
+    }
+    Body body;
+    body.obstacle = obstacle;
+    body.node = node;
+    _bodies.push_back(body);
+}
+
+/**
+ * Starts shifting the given node with the camera of the given pane.
+ *
+ * @param pane  The scroll pane whose camera is followed
+ * @param node  The node to shift, which may be the pane itself
+ */
+void RenderInterpolator::addPane(const shared_ptr<scene2::ScrollPane> &pane,
+                                 const shared_ptr<scene2::SceneNode> &node) {
+    Pane entry;
+    entry.pane = pane;
+    entry.node = node;
+    _panes.push_back(entry);
+}
+
+/**
+ * Keeps the transform of every obstacle and pane at the end of a tick.
+ * Bodies that have left the physics world are dropped.
+ */
+void RenderInterpolator::capture() {
+    _world->captureTransforms();
+    for (auto itr = _bodies.begin(); itr != _bodies.end();) {
+        shared_ptr<physics2::Obstacle> obstacle = itr->obstacle.lock();
+        if (obstacle == nullptr || itr->node.expired() || obstacle->isRemoved() || obstacle->getBody() == nullptr) {
+            itr = _bodies.erase(itr);
+        } else {
+            ++itr;
+        }
+    }
+
+    for (auto itr = _panes.begin(); itr != _panes.end(); ++itr) {
+        shared_ptr<scene2::ScrollPane> pane = itr->pane.lock();
+        if (pane == nullptr) continue;
+        itr->prevTranslation = itr->currTranslation;
+        itr->currTranslation = pane->getPaneTransform().getTranslation();
+        if (itr->fresh) {
+            itr->prevTranslation = itr->currTranslation;
+            itr->fresh = false;
+        }
+    }
+}
+
+/**
+ * Makes every obstacle and pane start the next tick without a previous
+ * transform, so nothing is drawn sliding to where it jumped.
+ */
+void RenderInterpolator::snap() {
+    _world->snapTransforms();
+    for (auto itr = _panes.begin(); itr != _panes.end(); ++itr) {
+        itr->fresh = true;
+    }
+}
+
+#pragma mark Drawing
+
+/**
+ * Moves every node to where it would be partway through the last tick.
+ * end() must be called once drawing is done.
+ *
+ * @param alpha How much of a tick has passed since the last one, from 0 to 1
+ */
+void RenderInterpolator::begin(float alpha) {
+    if (_drawing) return;
+    _drawing = true;
+    alpha = std::max(0.0f, std::min(alpha, 1.0f));
+
+    for (auto itr = _bodies.begin(); itr != _bodies.end(); ++itr) {
+        shared_ptr<scene2::SceneNode> node = itr->node.lock();
+        if (node == nullptr) continue;
+        itr->savedPosition = node->getPosition();
+        itr->savedAngle = node->getAngle();
+        shared_ptr<physics2::Obstacle> obstacle = itr->obstacle.lock();
+        if (obstacle == nullptr || !obstacle->hasTransforms()) continue;
+        node->setPosition(obstacle->getInterpolatedPosition(alpha) * _scale);
+        node->setAngle(obstacle->getInterpolatedAngle(alpha));
+    }
+
+    for (auto itr = _panes.begin(); itr != _panes.end(); ++itr) {
+        shared_ptr<scene2::SceneNode> node = itr->node.lock();
+        if (node == nullptr) continue;
+        itr->savedPosition = node->getPosition();
+        if (itr->fresh) continue;
+        // How far the camera is from where it will be at the end of the tick
+        node->setPosition(itr->savedPosition + (itr->prevTranslation - itr->currTranslation) * (1 - alpha));
+    }
+}
+
+/**
+ * Puts every node back exactly where it was before begin().
+ */
+void RenderInterpolator::end() {
+    if (!_drawing) return;
+    _drawing = false;
+
+    for (auto itr = _bodies.begin(); itr != _bodies.end(); ++itr) {
+        shared_ptr<scene2::SceneNode> node = itr->node.lock();
+        if (node == nullptr) continue;
+        node->setPosition(itr->savedPosition);
+        node->setAngle(itr->savedAngle);
+    }
+    for (auto itr = _panes.begin(); itr != _panes.end(); ++itr) {
+        shared_ptr<scene2::SceneNode> node = itr->node.lock();
+        if (node == nullptr) continue;
+        node->setPosition(itr->savedPosition);
+    }
+}
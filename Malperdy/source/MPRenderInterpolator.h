@@ -0,0 +1,178 @@
+//
+//  MPRenderInterpolator.h
+//  Malperdy
+//
+//  This class smooths out motion when the screen refreshes more often than
+//  the simulation ticks. After every tick the physics world has each of its
+//  obstacles keep the transform it had before and after the tick. When
+//  drawing, the node of every moving body is moved to where its body would
+//  be partway through the tick, by how much of a tick has passed that hasn't
+//  been simulated yet. Once drawing is done, every node is put back exactly
+//  where it was, so nothing in the simulation ever sees a position that was
+//  only there to be drawn.
+//
+//  The camera is handled the same way. The translation of a scroll pane is
+//  kept after every tick, and the nodes that follow it are shifted while
+//  drawing by how far the pane would have moved partway through the tick.
+//
+//  A body that jumps somewhere, like when its room is swapped or it
+//  respawns, should not be drawn sliding there, so snap() makes every
+//  obstacle start the next tick without a previous transform.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPRenderInterpolator_h
+#define MPRenderInterpolator_h
+
+#include <cugl/cugl.h>
+#include <vector>
+
+using namespace cugl;
+
+class RenderInterpolator {
+private:
+    /** A body and the node that draws it */
+    struct Body {
+        /** The body being drawn, which keeps its own transforms */
+        weak_ptr<physics2::Obstacle> obstacle;
+        /** The node drawing it, in the same space as the body but scaled */
+        weak_ptr<scene2::SceneNode> node;
+        /** Where the node really was while it is being drawn */
+        Vec2 savedPosition;
+        /** The angle the node really had while it is being drawn */
+        float savedAngle = 0;
+    };
+
+    /** A node that follows the camera of a scroll pane */
+    struct Pane {
+        /** The scroll pane whose camera is followed */
+        weak_ptr<scene2::ScrollPane> pane;
+        /** The node to shift with the camera */
+        weak_ptr<scene2::SceneNode> node;
+        /** Translation of the pane before the last tick */
+        Vec2 prevTranslation;
+        /** Translation of the pane after the last tick */
+        Vec2 currTranslation;
+        /** Whether the pane has no previous translation yet */
+        bool fresh = true;
+        /** Where the node really was while it is being drawn */
+        Vec2 savedPosition;
+    };
+
+    /** The physics world whose obstacles keep their transforms */
+    shared_ptr<physics2::ObstacleWorld> _world;
+    /** The scale from PHYSICS space to the space of the nodes */
+    float _scale = 1;
+    /** Every moving body */
+    vector<Body> _bodies;
+    /** Every node following a camera */
+    vector<Pane> _panes;
+    /** Whether the nodes are currently moved for drawing */
+    bool _drawing = false;
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Creates an interpolator with no bodies.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    RenderInterpolator() {}
+
+    /**
+     * Initializes an interpolator with no bodies.
+     *
+     * @param world The physics world whose obstacles are drawn
+     * @param scale The scale from PHYSICS space to the space of the nodes
+     * @return      true if initialization was successful, false otherwise
+     */
+    bool init(const shared_ptr<physics2::ObstacleWorld> &world, float scale) {
+        _world = world;
+        _scale = scale;
+        return _world != nullptr;
+    }
+
+    /**
+     * Returns a newly allocated interpolator with no bodies.
+     *
+     * @param world The physics world whose obstacles are drawn
+     * @param scale The scale from PHYSICS space to the space of the nodes
+     * @return      A newly allocated RenderInterpolator
+     */
+    static shared_ptr<RenderInterpolator> alloc(const shared_ptr<physics2::ObstacleWorld> &world, float scale) {
+        shared_ptr<RenderInterpolator> result = make_shared<RenderInterpolator>();
+        return (result->init(world, scale) ? result : nullptr);
+    }
+
+#pragma mark Tracking
+
+    /**
+     * Starts drawing the given node partway between ticks of the given body.
+     * If the body is already tracked, it gets the new node and starts over
+     * without a previous transform.
+     *
+     * @param obstacle  The moving body
+     * @param node      The node that draws it
+     */
+    void add(const shared_ptr<physics2::Obstacle> &obstacle, const shared_ptr<scene2::SceneNode> &node);
+
+    /**
+     * Starts shifting the given node with the camera of the given pane.
+     *
+     * @param pane  The scroll pane whose camera is followed
+     * @param node  The node to shift, which may be the pane itself
+     */
+    void addPane(const shared_ptr<scene2::ScrollPane> &pane, const shared_ptr<scene2::SceneNode> &node);
+
+    /**
+     * Keeps the transform of every obstacle and pane at the end of a tick.
+     * Bodies that have left the physics world are dropped.
+     */
+    void capture();
+
+    /**
+     * Makes every obstacle and pane start the next tick without a previous
+     * transform, so nothing is drawn sliding to where it jumped.
+     */
+    void snap();
+
+    /**
+     * Forgets every body. Panes are kept.
+     */
+    void clear() {
+        _bodies.clear();
+    }
+
+    /**
+     * Returns how many bodies are tracked.
+     *
+     * @return  The number of bodies
+     */
+    size_t getBodyCount() const {
+        return _bodies.size();
+    }
+
+#pragma mark Drawing
+
+    /**
+     * Moves every node to where it would be partway through the last tick.
+     * end() must be called once drawing is done.
+     *
+     * @param alpha How much of a tick has passed since the last one, from 0 to 1
+     */
+    void begin(float alpha);
+
+    /**
+     * Puts every node back exactly where it was before begin().
+     */
+    void end();
+};
+
+#endif /* MPRenderInterpolator_h */
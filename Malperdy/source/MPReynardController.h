@@ -16,6 +16,7 @@
 
 #include "MPCharacterController.h"
 #include "MPReynardModel.h"
+#include "MPSimClock.h"
 
 /** The maximum number of keys that Reynard can carry */
 #define MAX_KEYS 3
@@ -28,8 +29,8 @@ protected:
     Uint64 _damageBufferLength = 1000;
 
     Vec2 lastCheckPointPosition = Vec2(-1, -1);
-    /** The moment in time that Reynard was last hit */
-    Timestamp _lastHit = Timestamp();
+    /** The simulation time that Reynard was last hit */
+    double _lastHit = SimClock::now();
 
     /** Number of keys Reynard currently has */
     int _keysCount = 0;
@@ -63,10 +64,8 @@ public:
      *      returns true. Otherwise, the function returns false.
      */
     bool canBeHit() {
-        Timestamp now = Timestamp();
-
-        if (now.ellapsedMillis(_lastHit) > _damageBufferLength) {
-            _lastHit = now;
+        if (SimClock::ellapsedMillis(_lastHit) > _damageBufferLength) {
+            _lastHit = SimClock::now();
             return true;
         }
         return false;
@@ -138,6 +137,24 @@ public:
     int getKeysCount() {
         return _keysCount;
     }
+
+    /**
+     * Returns the IDs of all the keys Reynard is carrying, in the order they were picked up
+     */
+    const vector<int>& getKeyIDs() {
+        return *_keyIDs;
+    }
+
+    /**
+     * Replaces the keys Reynard is carrying with the ones with the given IDs.
+     * This doesn't play any sounds, since it's only used when respawning.
+     *
+     * @param keyIDs    The IDs of the keys Reynard should be carrying
+     */
+    void setKeyIDs(const vector<int> &keyIDs) {
+        *_keyIDs = keyIDs;
+        _keysCount = (int)keyIDs.size();
+    }
 };
 
 
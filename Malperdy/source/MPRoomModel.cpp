@@ -40,6 +40,9 @@ using namespace cugl;
 /** Initialize RoomLoader for loading in rooms from a JSON */
 shared_ptr<RoomLoader> RoomModel::_roomLoader = RoomLoader::alloc("json/rooms.json");
 
+/** Geometry for each room type, built the first time a room of that type is made */
+map<string, shared_ptr<vector<Poly2>>> RoomModel::_roomTypeGeometry;
+
 #pragma mark -
 #pragma mark Constants
 /** Initialize scale by which rooms should be scaled to be in pixel space */
@@ -62,6 +65,32 @@ float BOUND[] = {				 0,						  0,
 					-BOUND_WIDTH/2,		DEFAULT_ROOM_HEIGHT,
 					-BOUND_WIDTH/2,						  0 };
 
+/**
+ * Returns the geometry of the room type with the given ID in room-local
+ * coordinates, building it the first time that type is asked for.
+ *
+ * @param roomID    ID of the room type
+ * @return          The polygons making up that room type's geometry
+ */
+shared_ptr<vector<Poly2>> RoomModel::getRoomTypeGeometry(const string &roomID) {
+    auto cached = _roomTypeGeometry.find(roomID);
+    if (cached != _roomTypeGeometry.end()) return cached->second;
+
+    shared_ptr<vector<Poly2>> polys = make_shared<vector<Poly2>>();
+    shared_ptr<vector<shared_ptr<JsonValue>>> roomData = _roomLoader->getRoomData(roomID);
+    polys->reserve(roomData->size());
+
+    // Triangulate each polygon and scale it to the default room size, once for the whole type
+    for (auto itr = roomData->begin(); itr != roomData->end(); ++itr) {
+        Poly2 poly(*itr);
+        poly *= ROOM_SCALE;
+        polys->push_back(std::move(poly));
+    }
+
+    _roomTypeGeometry[roomID] = polys;
+    return polys;
+}
+
 /**
  * Creates all the polygons for any geometry for the room type with the given ID.
  * If no room ID is given, then it defaults to a solid room.
@@ -71,49 +100,30 @@ float BOUND[] = {				 0,						  0,
  * @param roomID	ID of room type with the desired geometry
  */
 void RoomModel::buildGeometry(string roomID, int region) {
-    // Get data for the room with the corresponding ID
 	// If no roomID is given, use a default solid room
-	shared_ptr<vector<shared_ptr<JsonValue>>> roomData = _roomLoader->getRoomData(roomID == "" ? "room_solid" : roomID);
+	_roomID = (roomID == "" ? "room_solid" : roomID);
+	shared_ptr<vector<Poly2>> polys = getRoomTypeGeometry(_roomID);
 
-	// Initialize vector of physics objects for the room
-	_physicsGeometry = make_shared<vector<shared_ptr<physics2::PolygonObstacle>>>();
 	// Initialize vector of polygons for the room
 	_geometry = make_shared<vector<shared_ptr<scene2::PolygonNode>>>();
+    _geometry->reserve(polys->size());
 
-    // Initialize variable to temporarily hold polygon info
-    shared_ptr<Poly2> poly;
-    vector<Vec2> verts;
-
-    // For each set of polygon coordinates in the room's geometry
-    for (int k = 0; k < roomData->size(); k++) {
-        // Get polygon
-        poly = make_shared<Poly2>(roomData->at(k));
-        // Scale coordinates to default room size
-        poly->operator*=(ROOM_SCALE);
-        // Ensure that all points are integers
-        verts = poly->getVertices();
-        for (vector<Vec2>::iterator itr = verts.begin(); itr != verts.end(); ++itr) {
-            (*itr).x = floor((*itr).x);
-            (*itr).y = floor((*itr).y);
-        }
+    // Every room in a region is the same shade
+    if (region == 3) region = 5;
+    GEOMETRY_COLOR = Color4(10 * region, 10 * region, 10 * region, 255);
 
-        // Convert polygon into a scene graph node and add as a child to the room node
+    // The room only adds its color; the polygons themselves come from its type
+    for (auto itr = polys->begin(); itr != polys->end(); ++itr) {
         shared_ptr<scene2::PolygonNode> polyNode = scene2::PolygonNode::alloc();
-        polyNode->setPolygon(*poly);
-        if (region == 3) region = 5;
-        GEOMETRY_COLOR = Color4(10 * region, 10 * region, 10 * region, 255);
+        polyNode->setPolygon(*itr);
         polyNode->setColor(GEOMETRY_COLOR);
         // Ensure that polygons are drawn to their absolute coordinates
         polyNode->setAbsolute(true);
-        // Set position of polygon node accordingly
         addChild(polyNode);
         _geometry->push_back(polyNode);
 
-        // Generate PolygonObstacle and set the corresponding properties for level geometry
-        shared_ptr<physics2::PolygonObstacle> physPoly = physics2::PolygonObstacle::alloc(*poly, Vec2::ZERO);
-        physPoly->setBodyType(b2_staticBody);
-        // Store as part of the physics geometry
-        _physicsGeometry->push_back(physPoly);
+        // The physics for this geometry are built by GridModel, as a separate chain body
+        // for each cell the room is in. Only the merged outline is shared by the room type
     }
 }
 
@@ -202,7 +212,7 @@ bool RoomModel::initTrap(TrapModel::TrapType type, bool param) {
     if (type == TrapModel::TrapType::SPIKE) {
         shared_ptr<SpikeTrap> trap = make_shared<SpikeTrap>();
         
-        if(_physicsGeometry->size() == 0){
+        if(_geometry->size() == 0){
             trap->init(DEFAULT_ROOM_WIDTH, DEFAULT_ROOM_HEIGHT, true);
         }
         else{
@@ -260,7 +270,7 @@ bool RoomModel::initTrap(TrapModel::TrapType type, bool param) {
  */
 void RoomModel::dispose() {
 	removeAllChildren();
-	_physicsGeometry = nullptr;
+	_geometry = nullptr;
     _lockIcon = nullptr;
 }
 
@@ -280,6 +290,17 @@ void RoomModel::clear(shared_ptr<Texture> bg) {
     _bgClearedNode->setTexture(bg);
 }
 
+/**
+ * Sets whether this room is fogged (contents hidden) or not, and
+ * tints it to match.
+ */
+void RoomModel::setFogged(bool isFogged) {
+    fogged = isFogged;
+    // Checkpoints are always shown, so they can be found through the fog
+    bool checkpoint = (_trap != nullptr && _trap->getType() == TrapModel::TrapType::CHECKPOINT);
+    setColor((fogged && !checkpoint) ? fogColor : Color4::WHITE);
+}
+
 #pragma mark Updates
 bool RoomModel::update(float dt) {
     // SHOWING LOCKS
@@ -310,35 +331,3 @@ bool RoomModel::update(float dt) {
 
     return false;
 }
-
-/**
- * Execute animations
- *
- * @return whether it finished and does not need any more updates
- */
-bool RoomModel::updateSwap() {
-    // ROOM SWAP TRANSITION
-    if ((Vec2(destination.x * DEFAULT_ROOM_WIDTH,
-        destination.y * DEFAULT_ROOM_HEIGHT)).distance(SceneNode::getPosition()) < 10) {
-        this->setPosition(destination.x, destination.y);
-    }
-    else {
-        // Move the room over time, rather than just teleporting to its new destination
-        float cur_x = SceneNode::getPosition().x;
-        float cur_y = SceneNode::getPosition().y;
-        float diff_x = destination.x * DEFAULT_ROOM_WIDTH - cur_x;
-
-        if (abs(destination.x * DEFAULT_ROOM_WIDTH - cur_x) < 5) {
-            this->SceneNode::setPosition(destination.x * DEFAULT_ROOM_WIDTH,
-                destination.y * DEFAULT_ROOM_HEIGHT * (SWAP_SPEED)+cur_y * (1 - SWAP_SPEED));
-        }
-        else {
-            float yfactor = 1 / (abs(diff_x) / 100 + 1);
-
-            this->SceneNode::setPosition(destination.x * DEFAULT_ROOM_WIDTH * (SWAP_SPEED)+cur_x * (1 - SWAP_SPEED),
-                destination.y * (yfactor)*DEFAULT_ROOM_HEIGHT + cur_y * (1 - yfactor));
-        }
-    }
-
-    return false;
-}
@@ -54,8 +54,6 @@ using namespace cugl;
 #define DEFAULT_ROOM_HEIGHT 480
 /** The ID of the default room type */
 #define DEFAULT_ROOM_ID "leftrightupdown"
-/** The speed at which the rooms should swap, smaller is slower */
-#define SWAP_SPEED 0.1f
 /** The rate at which a room should clear (background changes) */
 #define CLEAR_RATE 0.05f
 /** The transparency value of a locked room */
@@ -83,9 +81,17 @@ private:
     // ROOM LOADING
     /** Loads in room formats from a JSON and is used to look up geometries for rooms */
     static shared_ptr<RoomLoader> _roomLoader;
+    /**
+     * Room geometry in room-local coordinates, triangulated and scaled once for
+     * each room type and then shared by every room of that type. Keys are room
+     * type IDs.
+     */
+    static map<string, shared_ptr<vector<Poly2>>> _roomTypeGeometry;
 
     /** This room's original location */
     Vec2 _originalLoc;
+    /** The ID of this room's type, which determines its geometry */
+    string _roomID;
 
     /** Whether this room is a solid room */
     bool isSolid = false;
@@ -95,6 +101,8 @@ private:
     // STATUS
     /** Whether this room is currently locked/unable to be swapped. False by default */
     bool locked = false;
+    /** How many characters are in this room, each of which keeps it locked */
+    int _occupants = 0;
     /* Whether this room's contents are currently hidden. False by default */
     bool fogged = true;
     /** Value to track original background opacity, from 0-1, starting at 1 */
@@ -107,8 +115,6 @@ private:
     // GEOMETRY
     /** Vector of polygon nodes forming the room's geometry */
     shared_ptr<vector<shared_ptr<scene2::PolygonNode>>> _geometry;
-    /** Vector of physics objects forming the room's geometry */
-    shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> _physicsGeometry;
     /** Vector constant representing by how much the room geometry needs to be scaled */
     static const Vec2 ROOM_SCALE;
 
@@ -117,6 +123,7 @@ private:
     /** Reference to the scene node for the lock */
     std::shared_ptr<cugl::scene2::PolygonNode> _lockIcon;
 
+    /** Where the room is or is going, in grid space in the form (column, row) */
     Vec2 destination;
 
     /**
@@ -206,12 +213,36 @@ public:
 #pragma mark Getters
 
     /**
-     * Returns a shared pointer to the vector of physics objects that compose
-     * the room geometry.
-     * 
-     * @return  Shared pointer to vector of physics objects for room geometry
+     * Returns the ID of this room's type, which all rooms with the same
+     * geometry share.
+     *
+     * The physics for the room geometry are built by GridModel, which only
+     * needs to do the work once for each room type.
+     *
+     * @return  The ID of this room's type
      */
-    shared_ptr<vector<shared_ptr<physics2::PolygonObstacle>>> getPhysicsGeometry() { return _physicsGeometry; }
+    string getRoomID() { return _roomID; }
+
+    /**
+     * Returns the geometry of the room type with the given ID in room-local
+     * coordinates, building it the first time that type is asked for.
+     *
+     * The polygons are shared by every room of that type, and must not be
+     * changed. Rooms copy them into their own polygon nodes, and GridModel
+     * builds the physics for the type from them.
+     *
+     * @param roomID    ID of the room type
+     * @return          The polygons making up that room type's geometry
+     */
+    static shared_ptr<vector<Poly2>> getRoomTypeGeometry(const string &roomID);
+
+    /**
+     * Returns where this room is, or where it is going if it is still
+     * sliding into place after a swap.
+     *
+     * @return  The room's destination in grid space in the form (column, row)
+     */
+    Vec2 getDestination() const { return destination; }
 
     /**
      * Returns a shared pointer to the vector of polygon nodes that compose the
@@ -246,20 +277,30 @@ public:
 
 #pragma mark Setters
     /**
-     * Sets this room to be locked, meaning it can no longer be swapped.
+     * Locks this room for one more character, meaning it can no longer be
+     * swapped until every character has left.
      */
     void lockRoom() {
-        locked = true;
-        lockChangePending = true;
+        setOccupants(_occupants + 1);
     }
 
     /**
-     * Sets this room to be unlocked, meaning it can now be swapped,
-     * unless there is some factor that would prevent it from being
-     * unlocked (fogged, permalocked, etc).
+     * Releases the lock of one character that left this room. Once every
+     * character has left, it can be swapped again, unless there is some
+     * factor that would prevent it from being unlocked (fogged, permalocked, etc).
      */
     void unlockRoom() {
-        locked = permlocked || fogged;
+        setOccupants(max(_occupants - 1, 0));
+    }
+
+    /**
+     * Sets how many characters are in this room, locking it if there are any.
+     *
+     * @param occupants The number of characters in this room
+     */
+    void setOccupants(int occupants) {
+        _occupants = occupants;
+        locked = (_occupants > 0) || permlocked || fogged;
         lockChangePending = true;
     }
 
@@ -281,9 +322,10 @@ public:
     void clear(shared_ptr<Texture> bg);
 
     /**
-     * Sets whether this room is fogged (contents hidden) or not.
+     * Sets whether this room is fogged (contents hidden) or not, and
+     * tints it to match.
      */
-    void setFogged(bool isFogged) { fogged = isFogged; }
+    void setFogged(bool isFogged);
 
     /**
      * Sets this room to be at the given location in grid space, where the
@@ -294,11 +336,10 @@ public:
      * @param value The room's desired location in grid space in the form (column, row)
      */
     void setPosition(const Vec2 value, bool animated) {
+        // Keep the destination up to date even when teleporting, so an old animation doesn't pull the room back
+        destination = value;
         if (!animated)
             this->setPosition(value.x, value.y);
-        else{
-            destination = value;
-        }
     }
 
     /**
@@ -392,13 +433,6 @@ public:
     }
 
 #pragma mark Updates
-    /**
-     * Change position gradually
-     * @return whether it finished and does not need any more updates
-     */
-    bool updateSwap();
-
-    
     bool update(float dt);
 
 };
@@ -0,0 +1,250 @@
+//
+//  MPRoomTable.h
+//  Malperdy
+//
+//  This class is the dense storage for every room in the level. Rooms are
+//  kept in a single row-major array that spans the bounds of the whole grid,
+//  so looking up a room is a single index computation instead of a search
+//  through regions and sublevels. Alongside each room, the table stores the
+//  number of the region and the index of the sublevel that the cell belongs
+//  to, which are precomputed when the level is loaded.
+//
+//  Everything in this table is in HOUSE space, so (0, 0) is the lower left
+//  corner of the grid. The grid origin is stored so that callers working in
+//  GRID space (like RegionModel) can convert.
+//
+//  GridModel owns the table; RegionModel holds a reference to the same one.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPRoomTable_h
+#define MPRoomTable_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "MPRoomModel.h"
+
+using namespace cugl;
+
+/** Region number for a cell that doesn't belong to any region */
+#define NO_REGION 0
+/** Sublevel index for a cell that doesn't belong to any sublevel */
+#define NO_SUBLEVEL -1
+
+class RoomTable {
+private:
+    /** Width and height of the table in number of rooms */
+    int _width = 0, _height = 0;
+
+    /** The location of the lower left corner of the table in GRID space */
+    int _originX = 0, _originY = 0;
+
+    /** All the rooms in the grid, where the room at (x, y) is at index y * width + x */
+    vector<shared_ptr<RoomModel>> _rooms;
+
+    /** Region number (from 1) of every cell, or NO_REGION if it's outside all regions */
+    vector<int> _regions;
+
+    /** Sublevel index within its region of every cell, or NO_SUBLEVEL if there is none */
+    vector<int> _sublevels;
+
+public:
+#pragma mark Constructors
+
+    /**
+     * Initializes an empty table with the given bounds. Every cell starts
+     * with no room, no region, and no sublevel.
+     *
+     * @param originX   The x-coordinate of the lower left cell in GRID space
+     * @param originY   The y-coordinate of the lower left cell in GRID space
+     * @param width     The number of columns of rooms in the table
+     * @param height    The number of rows of rooms in the table
+     * @return          true if the table is initialized properly, false otherwise.
+     */
+    bool init(int originX, int originY, int width, int height) {
+        if (width < 0 || height < 0) return false;
+        _originX = originX;
+        _originY = originY;
+        _width = width;
+        _height = height;
+        _rooms.assign(width * height, nullptr);
+        _regions.assign(width * height, NO_REGION);
+        _sublevels.assign(width * height, NO_SUBLEVEL);
+        return true;
+    }
+
+    /**
+     * Returns a newly-allocated empty table with the given bounds.
+     *
+     * @param originX   The x-coordinate of the lower left cell in GRID space
+     * @param originY   The y-coordinate of the lower left cell in GRID space
+     * @param width     The number of columns of rooms in the table
+     * @param height    The number of rows of rooms in the table
+     * @return          A newly-allocated RoomTable
+     */
+    static shared_ptr<RoomTable> alloc(int originX, int originY, int width, int height) {
+        shared_ptr<RoomTable> result = make_shared<RoomTable>();
+        return (result->init(originX, originY, width, height) ? result : nullptr);
+    }
+
+#pragma mark Getters
+
+    /** Returns the number of columns of rooms in the table */
+    int getWidth() const {
+        return _width;
+    }
+
+    /** Returns the number of rows of rooms in the table */
+    int getHeight() const {
+        return _height;
+    }
+
+    /** Returns the x-coordinate of the lower left cell in GRID space */
+    int getOriginX() const {
+        return _originX;
+    }
+
+    /** Returns the y-coordinate of the lower left cell in GRID space */
+    int getOriginY() const {
+        return _originY;
+    }
+
+    /**
+     * Returns whether the given HOUSE space coordinates are inside the table.
+     *
+     * @param x     An x-coordinate in HOUSE space
+     * @param y     A y-coordinate in HOUSE space
+     * @return      Whether the coordinates are inside the table
+     */
+    bool inBounds(int x, int y) const {
+        return (0 <= x && x < _width && 0 <= y && y < _height);
+    }
+
+    /**
+     * Returns the room at the given HOUSE space coordinates, or nullptr if
+     * there is no room there or the coordinates are out of bounds.
+     *
+     * @param x     An x-coordinate in HOUSE space
+     * @param y     A y-coordinate in HOUSE space
+     * @return      The room at the given coordinates
+     */
+    shared_ptr<RoomModel> getRoom(int x, int y) const {
+        return inBounds(x, y) ? _rooms[y * _width + x] : nullptr;
+    }
+
+    /**
+     * Returns the region number (from 1) of the cell at the given HOUSE space
+     * coordinates, or NO_REGION if it isn't in any region.
+     *
+     * @param x     An x-coordinate in HOUSE space
+     * @param y     A y-coordinate in HOUSE space
+     * @return      The region number of the given cell
+     */
+    int getRegion(int x, int y) const {
+        return inBounds(x, y) ? _regions[y * _width + x] : NO_REGION;
+    }
+
+    /**
+     * Returns the index of the sublevel within its region of the cell at the
+     * given HOUSE space coordinates, or NO_SUBLEVEL if it isn't in one.
+     *
+     * @param x     An x-coordinate in HOUSE space
+     * @param y     A y-coordinate in HOUSE space
+     * @return      The sublevel index of the given cell
+     */
+    int getSublevel(int x, int y) const {
+        return inBounds(x, y) ? _sublevels[y * _width + x] : NO_SUBLEVEL;
+    }
+
+    /**
+     * Returns the HOUSE space coordinates of the cell holding the given room,
+     * or (-1, -1) if the room isn't in the table.
+     *
+     * This searches the whole table, so it should only be used for rare events.
+     *
+     * @param room  The room to look for
+     * @return      The coordinates of the room in (column, row) form
+     */
+    Vec2 findRoom(const shared_ptr<RoomModel> &room) const {
+        for (size_t i = 0; i < _rooms.size(); i++) {
+            if (_rooms[i] == room) return Vec2(i % _width, i / _width);
+        }
+        return Vec2(-1, -1);
+    }
+
+    /**
+     * Returns all the rooms in the table in row-major order, starting from
+     * the bottom row. Empty cells are nullptr.
+     *
+     * @return  The contiguous array of rooms
+     */
+    const vector<shared_ptr<RoomModel>>& getRooms() const {
+        return _rooms;
+    }
+
+#pragma mark Setters
+
+    /**
+     * Places the given room at the given HOUSE space coordinates, leaving
+     * the region and sublevel of the cell unchanged.
+     *
+     * @param x     An x-coordinate in HOUSE space
+     * @param y     A y-coordinate in HOUSE space
+     * @param room  The room to put in the cell
+     * @return      Whether the room was set successfully
+     */
+    bool setRoom(int x, int y, shared_ptr<RoomModel> room) {
+        if (!inBounds(x, y)) return false;
+        _rooms[y * _width + x] = room;
+        return true;
+    }
+
+    /**
+     * Fills in the cell at the given HOUSE space coordinates with a room and
+     * the region and sublevel it belongs to. This should only be used while
+     * the level is being loaded.
+     *
+     * @param x         An x-coordinate in HOUSE space
+     * @param y         A y-coordinate in HOUSE space
+     * @param room      The room to put in the cell
+     * @param region    The region number (from 1) of the cell
+     * @param sublevel  The index of the sublevel within the region
+     * @return          Whether the cell was set successfully
+     */
+    bool setCell(int x, int y, shared_ptr<RoomModel> room, int region, int sublevel) {
+        if (!inBounds(x, y)) return false;
+        int i = y * _width + x;
+        _rooms[i] = room;
+        _regions[i] = region;
+        _sublevels[i] = sublevel;
+        return true;
+    }
+
+#pragma mark Iteration
+
+    /**
+     * Calls the given function on every room in the table, along with its
+     * HOUSE space coordinates. Empty cells are skipped. Rooms are visited in
+     * storage order, so row by row starting from the bottom.
+     *
+     * The function should have the signature f(int x, int y, const shared_ptr<RoomModel>&).
+     *
+     * @param f     The function to call on each room
+     */
+    template<typename F>
+    void forEachRoom(F f) const {
+        int i = 0;
+        for (int y = 0; y < _height; y++) {
+            for (int x = 0; x < _width; x++, i++) {
+                if (_rooms[i] != nullptr) f(x, y, _rooms[i]);
+            }
+        }
+    }
+};
+
+#endif /* MPRoomTable_h */
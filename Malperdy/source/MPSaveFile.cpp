@@ -0,0 +1,530 @@
+//
+//  MPSaveFile.cpp
+//  Malperdy
+//
+//  This class reads and writes the save file for the game, in a versioned
+//  binary format with a checksummed header. Saves are written on a background
+//  thread to a temporary file that then replaces the old save.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPSaveFile.h"
+#include <cstdio>
+#include <cstring>
+
+#if defined (__WINDOWS__)
+    #include <windows.h>
+    #include <io.h>
+    #include <locale>
+    #include <codecvt>
+#else
+    #include <unistd.h>
+#endif
+
+/** Magic number at the start of every save file ("MPSV") */
+#define SAVE_FILE_MAGIC 0x4D505356
+/** Suffix of the temporary file a save is written to before it replaces the old one */
+#define SAVE_FILE_TEMP_SUFFIX ".tmp"
+/** Largest save body that will be read, so a corrupt header can't make us allocate forever */
+#define SAVE_FILE_MAX_SIZE (16 * 1024 * 1024)
+
+shared_ptr<ThreadPool> SaveFile::_writer = nullptr;
+int SaveFile::_pending = 0;
+std::mutex SaveFile::_pendingMutex;
+std::condition_variable SaveFile::_pendingDone;
+
+#pragma mark Encoding Helpers
+
+/**
+ * Returns the FNV-1a hash of the given bytes, used as the checksum of a save.
+ *
+ * @param bytes The bytes to hash
+ * @return      The hash of the bytes
+ */
+static Uint32 checksum(const vector<Uint8> &bytes) {
+    Uint32 hash = 2166136261u;
+    for (Uint8 b : bytes) {
+        hash ^= b;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * Appends the given number to the buffer in network order, the same way
+ * BinaryWriter writes it.
+ *
+ * @param buffer    The buffer to append to
+ * @param value     The number to append
+ */
+static void putUint32(vector<Uint8> &buffer, Uint32 value) {
+    Uint32 bits = marshall(value);
+    const Uint8 *bytes = (const Uint8 *)&bits;
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(bits));
+}
+
+/**
+ * Appends the given number to the buffer as a varint, 7 bits at a time with
+ * the high bit set on every byte but the last.
+ *
+ * @param buffer    The buffer to append to
+ * @param value     The number to append
+ */
+static void putVarint(vector<Uint8> &buffer, Uint32 value) {
+    while (value >= 0x80) {
+        buffer.push_back((Uint8)(value | 0x80));
+        value >>= 7;
+    }
+    buffer.push_back((Uint8)value);
+}
+
+/**
+ * Appends the given signed number to the buffer as a zigzag varint, so small
+ * negative numbers stay small.
+ *
+ * @param buffer    The buffer to append to
+ * @param value     The number to append
+ */
+static void putSignedVarint(vector<Uint8> &buffer, Sint32 value) {
+    putVarint(buffer, ((Uint32)value << 1) ^ (Uint32)(value >> 31));
+}
+
+/**
+ * Appends the given float to the buffer as 4 little-endian bytes.
+ *
+ * @param buffer    The buffer to append to
+ * @param value     The number to append
+ */
+static void putFloat(vector<Uint8> &buffer, float value) {
+    Uint32 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; i++) {
+        buffer.push_back((Uint8)(bits >> (8 * i)));
+    }
+}
+
+/**
+ * Reads a varint from the buffer, starting at the given position.
+ *
+ * @param buffer    The buffer to read from
+ * @param pos       The position to read at, moved past the varint
+ * @param value     Set to the number that was read
+ * @return          Whether there was a whole varint to read
+ */
+static bool getVarint(const vector<Uint8> &buffer, size_t &pos, Uint32 &value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= buffer.size()) return false;
+        Uint8 b = buffer[pos++];
+        value |= (Uint32)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+/**
+ * Reads a zigzag varint from the buffer, starting at the given position.
+ *
+ * @param buffer    The buffer to read from
+ * @param pos       The position to read at, moved past the varint
+ * @param value     Set to the number that was read
+ * @return          Whether there was a whole varint to read
+ */
+static bool getSignedVarint(const vector<Uint8> &buffer, size_t &pos, Sint32 &value) {
+    Uint32 raw;
+    if (!getVarint(buffer, pos, raw)) return false;
+    value = (Sint32)(raw >> 1) ^ -(Sint32)(raw & 1);
+    return true;
+}
+
+/**
+ * Reads a float from the buffer, starting at the given position.
+ *
+ * @param buffer    The buffer to read from
+ * @param pos       The position to read at, moved past the float
+ * @param value     Set to the number that was read
+ * @return          Whether there was a whole float to read
+ */
+static bool getFloat(const vector<Uint8> &buffer, size_t &pos, float &value) {
+    if (pos + 4 > buffer.size()) return false;
+    Uint32 bits = 0;
+    for (int i = 0; i < 4; i++) {
+        bits |= (Uint32)buffer[pos++] << (8 * i);
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+#pragma mark Paths
+
+/**
+ * Returns the path of the save file.
+ *
+ * @return  The path of the save file
+ */
+string SaveFile::getPath() {
+    vector<std::string> file_path_list = vector<std::string>(2);
+    file_path_list[0] = Application::get()->getSaveDirectory();
+    file_path_list[1] = SAVE_FILE_NAME;
+    return filetool::join_path(file_path_list);
+}
+
+/**
+ * Returns the path of the old JSON save file.
+ *
+ * @return  The path of the old JSON save file
+ */
+string SaveFile::getLegacyPath() {
+    vector<std::string> file_path_list = vector<std::string>(2);
+    file_path_list[0] = Application::get()->getSaveDirectory();
+    file_path_list[1] = SAVE_FILE_LEGACY_NAME;
+    return filetool::join_path(file_path_list);
+}
+
+#pragma mark Saving and Loading
+
+/**
+ * Returns whether there is a save file to load, in either format.
+ *
+ * @return  Whether there is a save file to load
+ */
+bool SaveFile::exists() {
+    finish();
+    return filetool::file_exists(getPath()) || filetool::file_exists(getLegacyPath());
+}
+
+/**
+ * Saves the given data. The file is written on a background thread, so this
+ * returns right away. Saves always finish in the order they were made.
+ *
+ * @param data  The data to save
+ */
+void SaveFile::save(const Data &data) {
+    if (_writer == nullptr) {
+        // One thread, so saves can never overtake each other
+        _writer = ThreadPool::alloc(1);
+    }
+
+    // Paths come from the Application, so work them out on this thread
+    string path = getPath();
+    string legacy = getLegacyPath();
+    {
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        _pending++;
+    }
+    _writer->addTask([data, path, legacy]() {
+        if (writeBinary(path, data)) {
+            // The old save is out of date now
+            if (filetool::file_exists(legacy)) filetool::file_delete(legacy);
+        } else {
+            CULog("MPSaveFile.cpp: Saving failed");
+        }
+        std::lock_guard<std::mutex> lock(_pendingMutex);
+        _pending--;
+        _pendingDone.notify_all();
+    });
+}
+
+/**
+ * Loads the save file. If a save is still being written, this waits for it
+ * to finish first.
+ *
+ * If there is no binary save, the old JSON save is read instead. Any save
+ * file that turns out to be invalid is deleted.
+ *
+ * @param data  Set to the contents of the save file
+ * @return      Whether a save was loaded
+ */
+bool SaveFile::load(Data &data) {
+    finish();
+
+    string path = getPath();
+    if (filetool::file_exists(path)) {
+        if (readBinary(path, data)) return true;
+        CULog("MPSaveFile.cpp: Save file is invalid, deleting it");
+        filetool::file_delete(path);
+    }
+
+    string legacy = getLegacyPath();
+    if (filetool::file_exists(legacy)) {
+        if (readJson(legacy, data)) return true;
+        filetool::file_delete(legacy);
+    }
+    return false;
+}
+
+/**
+ * Deletes the save file in both formats, after waiting for any save that
+ * is still being written.
+ */
+void SaveFile::erase() {
+    finish();
+    if (filetool::file_exists(getPath())) filetool::file_delete(getPath());
+    if (filetool::file_exists(getLegacyPath())) filetool::file_delete(getLegacyPath());
+}
+
+#pragma mark Background Writer
+
+/**
+ * Blocks until every save that has been made has been written.
+ */
+void SaveFile::finish() {
+    std::unique_lock<std::mutex> lock(_pendingMutex);
+    _pendingDone.wait(lock, []() { return _pending == 0; });
+}
+
+/**
+ * Finishes writing every save and shuts down the background writer. This
+ * should be called when the application shuts down.
+ */
+void SaveFile::stop() {
+    finish();
+    if (_writer != nullptr) {
+        _writer->dispose();
+        _writer = nullptr;
+    }
+}
+
+#pragma mark File Helpers
+
+/**
+ * Writes the given bytes to the file at the given path, replacing anything
+ * that was there. This only returns true once every byte has reached the
+ * disk, so a file that was cut short is never mistaken for a good one.
+ *
+ * @param path  The path of the file
+ * @param bytes The bytes to write
+ * @return      Whether the whole file was written
+ */
+static bool writeFileSynced(const string &path, const vector<Uint8> &bytes) {
+#if defined (__WINDOWS__)
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    FILE *file = _wfopen(converter.from_bytes(path).c_str(), L"wb");
+#else
+    FILE *file = fopen(path.c_str(), "wb");
+#endif
+    if (file == nullptr) return false;
+
+    bool written = fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    written = written && fflush(file) == 0;
+#if defined (__WINDOWS__)
+    written = written && _commit(_fileno(file)) == 0;
+#else
+    written = written && fsync(fileno(file)) == 0;
+#endif
+    // Closing can fail to write too, so it counts even if everything else worked
+    return (fclose(file) == 0) && written;
+}
+
+/**
+ * Atomically replaces the file at the destination with the one at the source.
+ * Whatever happens, the destination is always either the old file or the new
+ * one, and never missing.
+ *
+ * @param source    The path of the new file
+ * @param dest      The path of the file to replace
+ * @return          Whether the file was replaced
+ */
+static bool replaceFile(const string &source, const string &dest) {
+#if defined (__WINDOWS__)
+    // Windows won't rename over an existing file, but MoveFileEx can
+    std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    return MoveFileExW(converter.from_bytes(source).c_str(), converter.from_bytes(dest).c_str(),
+                       MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    return std::rename(source.c_str(), dest.c_str()) == 0;
+#endif
+}
+
+#pragma mark Formats
+
+/**
+ * Writes the given data to the given path in the binary format. The data
+ * goes to a temporary file first, which then replaces the file at path.
+ *
+ * @param path  The path of the save file
+ * @param data  The data to save
+ * @return      Whether the save was written
+ */
+bool SaveFile::writeBinary(const string &path, const Data &data) {
+    // Put the body together first, so it can be checksummed
+    vector<Uint8> body;
+
+    putVarint(body, (Uint32)data.activatedCheckpoints.size());
+    for (int index : data.activatedCheckpoints) {
+        putVarint(body, (Uint32)index);
+    }
+
+    putFloat(body, data.reynardPosition.x);
+    putFloat(body, data.reynardPosition.y);
+
+    putVarint(body, (Uint32)data.enemyPositions.size());
+    for (const Vec2 &pos : data.enemyPositions) {
+        putFloat(body, pos.x);
+        putFloat(body, pos.y);
+    }
+
+    // Room coordinates are whole numbers, stored as the change from the last swap
+    putVarint(body, (Uint32)data.swapHistory.size());
+    Sint32 last[4] = {0, 0, 0, 0};
+    for (const vector<Vec2> &swap : data.swapHistory) {
+        Sint32 coords[4] = {(Sint32)roundf(swap[0].x), (Sint32)roundf(swap[0].y),
+                            (Sint32)roundf(swap[1].x), (Sint32)roundf(swap[1].y)};
+        for (int i = 0; i < 4; i++) {
+            putSignedVarint(body, coords[i] - last[i]);
+            last[i] = coords[i];
+        }
+    }
+
+    // The fog bitmap is already packed, so it goes in as is
+    putVarint(body, (Uint32)data.fog.size());
+    body.insert(body.end(), data.fog.begin(), data.fog.end());
+
+    vector<Uint8> file;
+    file.reserve(16 + body.size());
+    putUint32(file, SAVE_FILE_MAGIC);
+    putUint32(file, SAVE_FILE_VERSION);
+    putUint32(file, (Uint32)body.size());
+    putUint32(file, checksum(body));
+    file.insert(file.end(), body.begin(), body.end());
+
+    // Only a temporary file that was written in full may replace the old save
+    string temp = path + SAVE_FILE_TEMP_SUFFIX;
+    if (!writeFileSynced(temp, file) || !replaceFile(temp, path)) {
+        if (filetool::file_exists(temp)) filetool::file_delete(temp);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Reads the binary save file at the given path.
+ *
+ * @param path  The path of the save file
+ * @param data  Set to the contents of the save file
+ * @return      Whether the file was a complete, valid save
+ */
+bool SaveFile::readBinary(const string &path, Data &data) {
+    shared_ptr<BinaryReader> reader = BinaryReader::alloc(path);
+    if (reader == nullptr || !reader->ready(16)) return false;
+
+    if (reader->readUint32() != SAVE_FILE_MAGIC) return false;
+    Uint32 version = reader->readUint32();
+    if (version < 1 || version > SAVE_FILE_VERSION) {
+        CULog("MPSaveFile.cpp: Unknown save version %u", version);
+        return false;
+    }
+    Uint32 size = reader->readUint32();
+    Uint32 sum = reader->readUint32();
+    if (size > SAVE_FILE_MAX_SIZE) return false;
+
+    vector<Uint8> body(size);
+    if (size > 0 && reader->read(body.data(), size) != size) return false;
+    reader->close();
+    if (checksum(body) != sum) return false;
+
+    Data result;
+    size_t pos = 0;
+    Uint32 count;
+
+    if (!getVarint(body, pos, count) || count > body.size()) return false;
+    for (Uint32 i = 0; i < count; i++) {
+        Uint32 index;
+        if (!getVarint(body, pos, index)) return false;
+        result.activatedCheckpoints.push_back((int)index);
+    }
+
+    if (!getFloat(body, pos, result.reynardPosition.x) || !getFloat(body, pos, result.reynardPosition.y)) return false;
+
+    if (!getVarint(body, pos, count) || count > body.size()) return false;
+    for (Uint32 i = 0; i < count; i++) {
+        Vec2 enemy;
+        if (!getFloat(body, pos, enemy.x) || !getFloat(body, pos, enemy.y)) return false;
+        result.enemyPositions.push_back(enemy);
+    }
+
+    if (!getVarint(body, pos, count) || count > body.size()) return false;
+    Sint32 last[4] = {0, 0, 0, 0};
+    for (Uint32 i = 0; i < count; i++) {
+        for (int j = 0; j < 4; j++) {
+            Sint32 delta;
+            if (!getSignedVarint(body, pos, delta)) return false;
+            last[j] += delta;
+        }
+        vector<Vec2> swap;
+        swap.push_back(Vec2(last[0], last[1]));
+        swap.push_back(Vec2(last[2], last[3]));
+        result.swapHistory.push_back(swap);
+    }
+
+    // Version 1 saves stop before the fog
+    if (version >= 2) {
+        if (!getVarint(body, pos, count) || count > body.size() - pos) return false;
+        result.fog.assign(body.begin() + pos, body.begin() + pos + count);
+        pos += count;
+    }
+
+    // Anything left over means the file isn't what we think it is
+    if (pos != body.size()) return false;
+
+    data = result;
+    return true;
+}
+
+/**
+ * Reads an old JSON save file at the given path.
+ *
+ * @param path  The path of the save file
+ * @param data  Set to the contents of the save file
+ * @return      Whether the file was a complete, valid save
+ */
+bool SaveFile::readJson(const string &path, Data &data) {
+    shared_ptr<JsonReader> jr = JsonReader::alloc(path);
+    if (jr == nullptr) return false;
+    jr->reset();
+    if (!jr->ready()) return false;
+    std::shared_ptr<JsonValue> jsonRoot = jr->readJson();
+
+    /**
+     * JSON structure:
+     * "state.json"
+     *  - "EnemyPos" :      [enemy1Pos's x, enemy1Pos's y, ...]
+     *  - "ReynardPos" :    [reynardPos's x, reynardPos's y]
+     *  - "RoomSwap" :     [Swap1-Room1-x, Swap1-Room1-y, Swap1-Room2-x, Swap1-Room2-y, Swap2....]
+     */
+    if (jsonRoot == nullptr
+            || jsonRoot->get("EnemyPos") == nullptr
+            || jsonRoot->get("ReynardPos") == nullptr
+            || jsonRoot->get("RoomSwap") == nullptr
+            || jsonRoot->get("ActivatedCheckpoints") == nullptr) {
+        return false;
+    }
+    std::vector<float> enemyPos1D = jsonRoot->get("EnemyPos")->asFloatArray();
+    std::vector<float> reynardPos1D = jsonRoot->get("ReynardPos")->asFloatArray();
+    std::vector<float> swapHistory1D = jsonRoot->get("RoomSwap")->asFloatArray();
+    std::vector<int> activatedcheckpts1D = jsonRoot->get("ActivatedCheckpoints")->asIntArray();
+    if (enemyPos1D.size() % 2 != 0 || reynardPos1D.size() != 2 || swapHistory1D.size() % 4 != 0) {
+        return false;
+    }
+
+    Data result;
+    for (size_t i = 0; i < enemyPos1D.size(); i += 2) {
+        result.enemyPositions.push_back(Vec2(enemyPos1D[i], enemyPos1D[i + 1]));
+    }
+    result.reynardPosition = Vec2(reynardPos1D[0], reynardPos1D[1]);
+    result.activatedCheckpoints = activatedcheckpts1D;
+    for (size_t i = 0; i < swapHistory1D.size(); i += 4) {
+        vector<Vec2> thisSwap = vector<Vec2>();
+        thisSwap.push_back(Vec2(swapHistory1D[i], swapHistory1D[i + 1]));
+        thisSwap.push_back(Vec2(swapHistory1D[i + 2], swapHistory1D[i + 3]));
+        result.swapHistory.push_back(thisSwap);
+    }
+
+    data = result;
+    return true;
+}
@@ -0,0 +1,172 @@
+//
+//  MPSaveFile.h
+//  Malperdy
+//
+//  This class reads and writes the save file for the game. Saves are stored in
+//  a small versioned binary format instead of JSON, since the swap history gets
+//  long over a session and writing it out as a JSON array of floats was causing
+//  a frame spike at every checkpoint.
+//
+//  The file starts with a header holding a magic number, the format version,
+//  the size of the rest of the file, and a checksum of it. Numbers in the
+//  header are in network order, the way BinaryReader reads them. The rest
+//  of the file packs counts and checkpoint indices as varints. Each swap is
+//  stored as the difference from the swap before it, since consecutive swaps
+//  are usually close together. The fog of war is stored as GridModel's fog
+//  bitmap, byte for byte. Saves from version 1 have no fog, and start with
+//  every room fogged.
+//
+//  Saves are written on a background thread, first to a temporary file. Only
+//  once every byte of it is on the disk does it atomically replace the old
+//  save. If the game crashes partway through, the old save is still there,
+//  and anything that still looks wrong is caught by the checksum when it's
+//  read back.
+//
+//  Saves from older versions of the game (state.json) can still be read, and
+//  get replaced by a binary save the next time the game is saved.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPSaveFile_h
+#define MPSaveFile_h
+
+#include <cugl/cugl.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+using namespace cugl;
+
+/** Name of the save file in the save directory */
+#define SAVE_FILE_NAME "state.sav"
+/** Name of the old JSON save file in the save directory */
+#define SAVE_FILE_LEGACY_NAME "state.json"
+/** Current version of the save format */
+#define SAVE_FILE_VERSION 2
+
+class SaveFile {
+public:
+    /** Everything that gets saved, in PHYSICS space */
+    struct Data {
+        /** Position of every enemy, in the order they spawn in the level */
+        vector<Vec2> enemyPositions;
+        /** Position of Reynard */
+        Vec2 reynardPosition;
+        /** Indices of every checkpoint that has been activated */
+        vector<int> activatedCheckpoints;
+        /** Every swap so far, each as a pair of room coordinates */
+        vector<vector<Vec2>> swapHistory;
+        /** The fog of war bitmap of the grid, or empty if the save has none */
+        vector<Uint8> fog;
+    };
+
+private:
+    /** Single background thread that writes saves, so they happen in order */
+    static shared_ptr<ThreadPool> _writer;
+    /** How many saves have been handed to the writer and not finished yet */
+    static int _pending;
+    /** Guards the count of pending saves */
+    static std::mutex _pendingMutex;
+    /** Signalled whenever the writer finishes a save */
+    static std::condition_variable _pendingDone;
+
+    /**
+     * Writes the given data to the given path in the binary format. The data
+     * goes to a temporary file first, which then replaces the file at path.
+     *
+     * @param path  The path of the save file
+     * @param data  The data to save
+     * @return      Whether the save was written
+     */
+    static bool writeBinary(const string &path, const Data &data);
+
+    /**
+     * Reads the binary save file at the given path.
+     *
+     * @param path  The path of the save file
+     * @param data  Set to the contents of the save file
+     * @return      Whether the file was a complete, valid save
+     */
+    static bool readBinary(const string &path, Data &data);
+
+    /**
+     * Reads an old JSON save file at the given path.
+     *
+     * @param path  The path of the save file
+     * @param data  Set to the contents of the save file
+     * @return      Whether the file was a complete, valid save
+     */
+    static bool readJson(const string &path, Data &data);
+
+public:
+#pragma mark Paths
+
+    /**
+     * Returns the path of the save file.
+     *
+     * @return  The path of the save file
+     */
+    static string getPath();
+
+    /**
+     * Returns the path of the old JSON save file.
+     *
+     * @return  The path of the old JSON save file
+     */
+    static string getLegacyPath();
+
+#pragma mark Saving and Loading
+
+    /**
+     * Returns whether there is a save file to load, in either format.
+     *
+     * @return  Whether there is a save file to load
+     */
+    static bool exists();
+
+    /**
+     * Saves the given data. The file is written on a background thread, so this
+     * returns right away. Saves always finish in the order they were made.
+     *
+     * @param data  The data to save
+     */
+    static void save(const Data &data);
+
+    /**
+     * Loads the save file. If a save is still being written, this waits for it
+     * to finish first.
+     *
+     * If there is no binary save, the old JSON save is read instead. Any save
+     * file that turns out to be invalid is deleted.
+     *
+     * @param data  Set to the contents of the save file
+     * @return      Whether a save was loaded
+     */
+    static bool load(Data &data);
+
+    /**
+     * Deletes the save file in both formats, after waiting for any save that
+     * is still being written.
+     */
+    static void erase();
+
+#pragma mark Background Writer
+
+    /**
+     * Blocks until every save that has been made has been written.
+     */
+    static void finish();
+
+    /**
+     * Finishes writing every save and shuts down the background writer. This
+     * should be called when the application shuts down.
+     */
+    static void stop();
+};
+
+#endif /* MPSaveFile_h */
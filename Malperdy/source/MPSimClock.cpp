@@ -0,0 +1,17 @@
+//
+//  MPSimClock.cpp
+//  Malperdy
+//
+//  This class keeps simulation time, which everything in the game should use
+//  to time things instead of the wall clock.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPSimClock.h"
+
+double SimClock::_now = 0;
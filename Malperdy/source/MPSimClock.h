@@ -0,0 +1,67 @@
+//
+//  MPSimClock.h
+//  Malperdy
+//
+//  This class keeps simulation time, which everything in the game should use
+//  to time things instead of the wall clock. It only moves forward when
+//  GameScene steps the simulation, by exactly the timestep of that step, so a
+//  run fed the same input always sees the same times. That is what lets a
+//  recorded session be replayed exactly.
+//
+//  Simulation time moves at the unscaled timestep, even in slow motion or
+//  while paused, the same as the wall clock did.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPSimClock_h
+#define MPSimClock_h
+
+class SimClock {
+private:
+    /** The current simulation time, in seconds since the clock was reset */
+    static double _now;
+
+public:
+    /**
+     * Returns the current simulation time.
+     *
+     * @return  The number of seconds since the clock was reset
+     */
+    static double now() {
+        return _now;
+    }
+
+    /**
+     * Returns how many milliseconds of simulation time have passed since the
+     * given time. Times from before the clock was reset count as just now.
+     *
+     * @param since     An earlier value of now()
+     * @return          The milliseconds that have passed since then
+     */
+    static double ellapsedMillis(double since) {
+        return (_now > since ? (_now - since) * 1000.0 : 0.0);
+    }
+
+    /**
+     * Moves simulation time forward by a single step.
+     *
+     * @param dt    The length of the step, in seconds
+     */
+    static void advance(float dt) {
+        _now += dt;
+    }
+
+    /**
+     * Puts simulation time back to zero, for the start of a new session.
+     */
+    static void reset() {
+        _now = 0;
+    }
+};
+
+#endif /* MPSimClock_h */
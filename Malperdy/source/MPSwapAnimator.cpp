@@ -0,0 +1,81 @@
+//
+//  MPSwapAnimator.cpp
+//  Malperdy
+//
+//  This class animates rooms sliding into place after they are swapped,
+//  keeping track of only the rooms that are still moving.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include "MPSwapAnimator.h"
+
+#pragma mark Animating
+
+/**
+ * Starts moving the given room from where it is now to its destination.
+ * If the room is already moving, it turns around from where it is.
+ *
+ * @param room  The room to move, whose destination is already set
+ */
+void SwapAnimator::start(const shared_ptr<RoomModel> &room) {
+    Tween tween;
+    tween.room = room;
+    tween.start = room->SceneNode::getPosition();
+    tween.end = Vec2(room->getDestination().x * DEFAULT_ROOM_WIDTH, room->getDestination().y * DEFAULT_ROOM_HEIGHT);
+
+    for (auto itr = _active.begin(); itr != _active.end(); ++itr) {
+        if (itr->room == room) {
+            *itr = tween;
+            return;
+        }
+    }
+    _active.push_back(tween);
+}
+
+/**
+ * Stops moving the given room, leaving it wherever it is. This should be
+ * called whenever a room is put in place without animating, so an old
+ * animation doesn't pull it back. onArrive is not called.
+ *
+ * @param room  The room to stop moving
+ */
+void SwapAnimator::cancel(const shared_ptr<RoomModel> &room) {
+    for (size_t i = 0; i < _active.size(); i++) {
+        if (_active[i].room == room) {
+            _active[i] = _active.back();
+            _active.pop_back();
+            return;
+        }
+    }
+}
+
+/**
+ * Moves every room that is in flight, and drops the ones that arrived.
+ *
+ * @param dt    The amount of time that has passed since the last frame
+ */
+void SwapAnimator::update(float dt) {
+    for (size_t i = 0; i < _active.size();) {
+        Tween &tween = _active[i];
+        tween.elapsed += dt;
+
+        if (tween.elapsed < SWAP_DURATION) {
+            float t = _easing(tween.elapsed / SWAP_DURATION);
+            tween.room->SceneNode::setPosition(tween.start + (tween.end - tween.start) * t);
+            i++;
+            continue;
+        }
+
+        // Snap the room into place and stop tracking it
+        shared_ptr<RoomModel> room = tween.room;
+        room->SceneNode::setPosition(tween.end);
+        _active[i] = _active.back();
+        _active.pop_back();
+        if (onArrive) onArrive(room);
+    }
+}
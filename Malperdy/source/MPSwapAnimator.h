@@ -0,0 +1,121 @@
+//
+//  MPSwapAnimator.h
+//  Malperdy
+//
+//  This class animates rooms sliding into place after they are swapped. Only
+//  the rooms that are still moving are kept, so the cost each frame depends
+//  on how many rooms are in flight rather than on how many swaps have been
+//  made. Each room moves from wherever it was to its destination over a fixed
+//  amount of time, eased so it slows down as it arrives, and is dropped as
+//  soon as it gets there.
+//
+//  The physics of a room are moved the moment it is swapped, so only the
+//  scene graph is animated here. onArrive is called exactly once for every
+//  room that finishes moving, for anything that should wait until the room
+//  is in place.
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#ifndef MPSwapAnimator_h
+#define MPSwapAnimator_h
+
+#include <cugl/cugl.h>
+#include <vector>
+#include "MPRoomModel.h"
+
+using namespace cugl;
+
+/** How long it takes a swapped room to slide into place, in seconds */
+#define SWAP_DURATION 0.5f
+
+class SwapAnimator {
+private:
+    /** A single room that is moving */
+    struct Tween {
+        /** The room being moved */
+        shared_ptr<RoomModel> room;
+        /** Where the room started, in the grid's node space */
+        Vec2 start;
+        /** Where the room is going, in the grid's node space */
+        Vec2 end;
+        /** How long the room has been moving */
+        float elapsed = 0;
+    };
+
+    /** Every room that is still moving, in no particular order */
+    vector<Tween> _active;
+    /** The easing applied to every tween */
+    std::function<float(float)> _easing;
+
+public:
+    /** Called once for every room that arrives at its destination */
+    std::function<void(const shared_ptr<RoomModel> &room)> onArrive;
+
+#pragma mark Constructors
+
+    /**
+     * Creates an animator with no rooms moving.
+     *
+     * NEVER USE A CONSTRUCTOR WITH NEW. If you want to allocate an object on
+     * the heap, use one of the static constructors instead.
+     */
+    SwapAnimator() : _easing(EasingFunction::alloc(EasingFunction::Type::CUBIC_OUT)) {}
+
+    /**
+     * Returns a newly allocated animator with no rooms moving.
+     *
+     * @return  A newly allocated SwapAnimator
+     */
+    static shared_ptr<SwapAnimator> alloc() {
+        return make_shared<SwapAnimator>();
+    }
+
+#pragma mark Animating
+
+    /**
+     * Starts moving the given room from where it is now to its destination.
+     * If the room is already moving, it turns around from where it is.
+     *
+     * @param room  The room to move, whose destination is already set
+     */
+    void start(const shared_ptr<RoomModel> &room);
+
+    /**
+     * Stops moving the given room, leaving it wherever it is. This should be
+     * called whenever a room is put in place without animating, so an old
+     * animation doesn't pull it back. onArrive is not called.
+     *
+     * @param room  The room to stop moving
+     */
+    void cancel(const shared_ptr<RoomModel> &room);
+
+    /**
+     * Moves every room that is in flight, and drops the ones that arrived.
+     *
+     * @param dt    The amount of time that has passed since the last frame
+     */
+    void update(float dt);
+
+    /**
+     * Stops moving every room, leaving each one wherever it is.
+     */
+    void clear() {
+        _active.clear();
+    }
+
+    /**
+     * Returns how many rooms are still moving.
+     *
+     * @return  The number of rooms in flight
+     */
+    int getCount() const {
+        return (int)_active.size();
+    }
+};
+
+#endif /* MPSwapAnimator_h */
@@ -176,6 +176,15 @@ public:
         return (_trapState == TrapState::ACTIVATED);
     }
 
+    /**
+     * Returns the trap's current state.
+     *
+     * @return  The state the trap is in
+     */
+    TrapState getTrapState() const {
+        return _trapState;
+    }
+
     /**
      * Sets the traps's state, changing physical attributes of the trap.
      *
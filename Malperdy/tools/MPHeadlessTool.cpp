@@ -0,0 +1,322 @@
+//
+//  MPHeadlessTool.cpp
+//  Malperdy
+//
+//  This is a command line tool that plays the game with nobody watching, for
+//  gameplay regression and performance tests on build servers. It loads the
+//  real assets and builds the real GameScene, then steps GameScene::update at
+//  a fixed timestep as fast as it can, with input coming from a script or from
+//  a recorded session. When it is done it prints how long the updates took.
+//
+//  Nothing is ever drawn and no audio engine is started. The scene still
+//  needs its textures, since sprite sheets decide how big characters are, so
+//  it runs with SDL's offscreen video driver. On Linux that needs EGL, which
+//  Mesa provides in software, but no display.
+//
+//  Usage:
+//      headless <assets directory> [ticks] [script]
+//      headless <assets directory> --replay <recording>
+//
+//  Ticks defaults to 3600, one minute of play. The script is a text file with
+//  one input event per line, in the form "<tick> <event> [x y]":
+//
+//      jump, dash_left, dash_right, zoom_in, zoom_out, debug, reset
+//          Press that button on the given tick
+//      press x y
+//          Start holding the mouse down at the given screen position
+//      drag x y
+//          Move the held mouse to the given screen position, dragging it
+//      release x y
+//          Let go of the mouse at the given screen position
+//
+//  Lines starting with # are ignored. Without a script, Reynard just runs.
+//
+//  A recording is a session.mprec file from the game's save directory. The
+//  session is played again from the save it started with, for every tick that
+//  was recorded, and the state of the game is checked against the recording
+//  to make sure it played out exactly the same. The tool exits with 2 if it
+//  didn't.
+//
+//  With CUGL and the game both built with CU_PROFILE defined, the tool also
+//  prints the profiler summary over the last ticks, and writes every profiled
+//  zone to profile.json in its save directory, which can be opened in
+//  chrome://tracing or Perfetto.
+//
+//  The tool is built on its own from this file plus every source file but
+//  main.cpp and MPApp.cpp, linked against CUGL, for example:
+//      c++ -std=c++17 -Icugl/include -Isource tools/MPHeadlessTool.cpp
+//          $(ls source/*.cpp | grep -v -e main.cpp -e MPApp.cpp) -lcugl -lSDL2 -o headless
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include <cugl/cugl.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "MPGameScene.h"
+#include "MPAudioController.h"
+#include "MPSaveFile.h"
+#include "MPInputRecording.h"
+
+using namespace cugl;
+
+/** How many ticks to run if none are given */
+#define DEFAULT_TICKS 3600
+
+/** A single line of an input script */
+struct ScriptEvent {
+    /** The tick the event happens on */
+    int tick;
+    /** What happens */
+    string name;
+    /** Where it happens, for mouse events */
+    Vec2 position;
+};
+
+/**
+ * Reads the input script at the given path, sorted by tick.
+ *
+ * @param path      The path of the script
+ * @param events    Where to put the events that were read
+ * @return          Whether the script could be read
+ */
+static bool loadScript(const string &path, vector<ScriptEvent> &events) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        return false;
+    }
+    string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        ScriptEvent event;
+        if (!(fields >> event.tick >> event.name)) {
+            std::cerr << "Bad script line: " << line << std::endl;
+            return false;
+        }
+        fields >> event.position.x >> event.position.y;
+        events.push_back(event);
+    }
+    std::stable_sort(events.begin(), events.end(), [](const ScriptEvent &a, const ScriptEvent &b) {
+        return a.tick < b.tick;
+    });
+    return true;
+}
+
+/**
+ * Turns a script into one frame of input for every tick. The mouse stays
+ * down from a press until the matching release, while buttons only count on
+ * the tick they are pressed.
+ *
+ * @param events    The events of the script, sorted by tick
+ * @param ticks     How many ticks to make frames for
+ * @return          The frame for each tick
+ */
+static vector<InputController::Frame> buildFrames(const vector<ScriptEvent> &events, int ticks) {
+    vector<InputController::Frame> frames;
+    frames.reserve(ticks);
+    InputController::Frame held;
+    size_t next = 0;
+    for (int tick = 0; tick < ticks; tick++) {
+        // Buttons are only pressed for a single tick
+        InputController::Frame frame = held;
+        for (; next < events.size() && events[next].tick <= tick; next++) {
+            const ScriptEvent &event = events[next];
+            if (event.name == "jump") frame.jump = true;
+            else if (event.name == "dash_left") frame.dashLeft = true;
+            else if (event.name == "dash_right") frame.dashRight = true;
+            else if (event.name == "zoom_in") frame.zoomIn = true;
+            else if (event.name == "zoom_out") frame.zoomOut = true;
+            else if (event.name == "debug") frame.debug = true;
+            else if (event.name == "reset") frame.reset = true;
+            else if (event.name == "press") {
+                held.down = true;
+                held.drag = false;
+                held.position = held.dragStart = event.position;
+            } else if (event.name == "drag") {
+                held.drag = held.down;
+                held.position = event.position;
+            } else if (event.name == "release") {
+                held.down = held.drag = false;
+                held.position = held.dragEnd = event.position;
+            } else {
+                std::cerr << "Unknown script event " << event.name << " on tick " << event.tick << std::endl;
+            }
+            frame.down = held.down;
+            frame.drag = held.drag;
+            frame.position = held.position;
+            frame.dragStart = held.dragStart;
+            frame.dragEnd = held.dragEnd;
+        }
+        frames.push_back(frame);
+    }
+    return frames;
+}
+
+/**
+ * An application that never draws, and just holds onto the assets and the
+ * scene for the driver.
+ */
+class HeadlessRunner : public Application {
+protected:
+    /** The loaded assets */
+    shared_ptr<AssetManager> _assets;
+
+public:
+    /** The scene being run */
+    GameScene gameplay;
+
+    /**
+     * Creates a runner that will load its assets from the given directory.
+     *
+     * @param assets    The directory with the game's assets
+     */
+    HeadlessRunner(const string &assets) {
+        _assetdir = assets;
+    }
+
+    /**
+     * Loads every asset, without starting the audio engine or any input devices.
+     */
+    void onStartup() override {
+        _assets = AssetManager::alloc();
+        AudioController::init(_assets);
+
+        _assets->attach<Font>(FontLoader::alloc()->getHook());
+        _assets->attach<JsonValue>(JsonLoader::alloc()->getHook());
+        _assets->attach<Texture>(TextureLoader::alloc()->getHook());
+        _assets->attach<Sound>(SoundLoader::alloc()->getHook());
+        _assets->attach<scene2::SceneNode>(Scene2Loader::alloc()->getHook());
+        _assets->loadDirectory("json/assets.json");
+
+        Application::onStartup();
+    }
+
+    /**
+     * Starts a game in the scene.
+     *
+     * @param mode      The game mode, 1 for a new game
+     * @param record    Whether to record the session, to check a replay against
+     * @return          Whether the scene was initialized
+     */
+    bool start(int mode, bool record) {
+        gameplay.setHeadless(true);
+        gameplay.setMode(mode);
+        gameplay.setRecording(record);
+        return gameplay.init(_assets);
+    }
+
+    /**
+     * Lets go of the scene and the assets.
+     */
+    void onShutdown() override {
+        gameplay.dispose();
+        _assets = nullptr;
+        // Don't quit partway through writing a save
+        SaveFile::stop();
+        Application::onShutdown();
+    }
+};
+
+int main(int argc, char *argv[]) {
+    bool replay = (argc > 2 && string(argv[2]) == "--replay");
+    if (argc < 2 || argc > 4 || (replay && argc != 4)) {
+        std::cerr << "Usage: " << argv[0] << " <assets directory> [ticks] [script]" << std::endl;
+        std::cerr << "       " << argv[0] << " <assets directory> --replay <recording>" << std::endl;
+        return 1;
+    }
+    string assets = string(argv[1]) + "/";
+    int ticks = DEFAULT_TICKS;
+    vector<ScriptEvent> events;
+    shared_ptr<InputRecording> recording = nullptr;
+    if (replay) {
+        recording = InputRecording::load(argv[3]);
+        if (recording == nullptr) {
+            std::cerr << "Couldn't read the recording " << argv[3] << std::endl;
+            return 1;
+        }
+        ticks = (int)recording->getTickCount();
+    } else {
+        if (argc > 2) ticks = atoi(argv[2]);
+        if (argc > 3 && !loadScript(argv[3], events)) return 1;
+    }
+
+    // There is no display on a build server, and nothing to hear
+    SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+
+    HeadlessRunner app(assets);
+    // A name of its own keeps its saves apart from the real game's
+    app.setName("MalperdyHeadless");
+    app.setOrganization("Humblegends");
+    app.setDisplaySize(1024, 576);
+    if (!app.init()) {
+        std::cerr << "Couldn't start the application" << std::endl;
+        return 1;
+    }
+    app.onStartup();
+    // A replay has to start from the same save the session did
+    if (replay && !recording->restoreSave()) {
+        std::cerr << "Couldn't restore the save the recording started from" << std::endl;
+        app.onShutdown();
+        return 1;
+    }
+    if (!app.start(replay ? recording->getMode() : 1, replay)) {
+        std::cerr << "Couldn't start the game" << std::endl;
+        app.onShutdown();
+        return 1;
+    }
+
+    vector<InputController::Frame> frames = (replay ? recording->getFrames() : buildFrames(events, ticks));
+    vector<double> times;
+    times.reserve(ticks);
+    for (int tick = 0; tick < ticks; tick++) {
+        // Each update is exactly one tick, so it takes exactly one frame
+        app.gameplay.getInput().pushFrame(frames[tick]);
+        auto start = std::chrono::steady_clock::now();
+        app.gameplay.update(FIXED_STEP);
+        auto end = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        CU_PROFILE_FRAME();
+    }
+#ifdef CU_PROFILE
+    string trace = app.getSaveDirectory() + "profile.json";
+    Profiler::exportTrace(trace);
+#endif
+    bool matched = !replay || app.gameplay.getRecording()->getStateHash() == recording->getStateHash();
+    app.onShutdown();
+
+    // Report how long the updates took
+    double total = 0;
+    for (double time : times) total += time;
+    vector<double> sorted = times;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&sorted](double p) {
+        return sorted.empty() ? 0.0 : sorted[std::min(sorted.size() - 1, (size_t)(p * sorted.size()))];
+    };
+    std::cout << "ticks " << ticks << std::endl;
+    std::cout << "total_ms " << total << std::endl;
+    std::cout << "mean_ms " << (ticks > 0 ? total / ticks : 0.0) << std::endl;
+    std::cout << "p50_ms " << percentile(0.5) << std::endl;
+    std::cout << "p95_ms " << percentile(0.95) << std::endl;
+    std::cout << "p99_ms " << percentile(0.99) << std::endl;
+    std::cout << "max_ms " << (sorted.empty() ? 0.0 : sorted.back()) << std::endl;
+    std::cout << "realtime_x " << (total > 0 ? ticks * FIXED_STEP * 1000 / total : 0.0) << std::endl;
+#ifdef CU_PROFILE
+    std::cout << "trace " << trace << std::endl;
+    std::cout << Profiler::getSummary();
+#endif
+    if (replay) {
+        std::cout << "replay " << (matched ? "matched" : "DIVERGED") << std::endl;
+        if (!matched) return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+//
+//  MPLevelPackTool.cpp
+//  Malperdy
+//
+//  This is a command line tool that compiles the world JSON and all of its
+//  regions into the level pack that ships with the game. Run it whenever the
+//  levels change. The pack records a hash of the JSON it was made from, and
+//  the game compiles the JSON itself at load time instead of using a pack
+//  that doesn't match, so a stale pack only costs load time.
+//
+//  Usage:
+//      levelpack <assets directory> [world JSON] [output pack]
+//
+//  The world JSON defaults to json/levels/MP_WorldData.json and the output to
+//  json/levels/MP_World.pack, both relative to the assets directory.
+//
+//  The tool is built on its own from this file plus MPLevelCompiler.cpp and
+//  MPLevelPack.cpp, linked against CUGL, for example:
+//      c++ -std=c++17 -Icugl/include -Isource tools/MPLevelPackTool.cpp
+//          source/MPLevelCompiler.cpp source/MPLevelPack.cpp -lcugl -lSDL2 -o levelpack
+//
+//  Owner: agent
+//  Contributors: agent
+//  Version: 10/16/26
+//
+//  Copyright (c) 2026 Humblegends. All rights reserved.
+//
+
+#include <cugl/cugl.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include "MPLevelCompiler.h"
+
+using namespace cugl;
+
+/** Default path of the world JSON, relative to the assets */
+#define DEFAULT_WORLD "json/levels/MP_WorldData.json"
+/** Default path of the level pack, relative to the assets */
+#define DEFAULT_PACK "json/levels/MP_World.pack"
+
+/**
+ * Reads the file at the given path.
+ *
+ * @param path  The path of the file
+ * @return      The contents of the file, or an empty string if it couldn't be read
+ */
+static string readFile(const string &path) {
+    std::ifstream in(path, std::ios::binary);
+    std::stringstream contents;
+    if (in) contents << in.rdbuf();
+    return contents.str();
+}
+
+/**
+ * Loads the JSON file at the given path.
+ *
+ * @param path  The path of the file
+ * @return      The JSON in the file, or nullptr if it couldn't be read
+ */
+static shared_ptr<JsonValue> loadJson(const string &path) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Couldn't open " << path << std::endl;
+        return nullptr;
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    return JsonValue::allocWithJson(contents.str());
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2 || argc > 4) {
+        std::cerr << "Usage: " << argv[0] << " <assets directory> [world JSON] [output pack]" << std::endl;
+        return 1;
+    }
+    string assets = string(argv[1]) + "/";
+    string worldFile = (argc > 2 ? argv[2] : DEFAULT_WORLD);
+    string packFile = (argc > 3 ? argv[3] : DEFAULT_PACK);
+
+    shared_ptr<JsonValue> world = loadJson(assets + worldFile);
+    Uint32 sourceHash = LevelCompiler::hashSources(world, [&assets](const string &file) {
+        return readFile(assets + file);
+    });
+    vector<Uint8> pack = LevelCompiler::compile(world, [&assets](const string &file) {
+        return loadJson(assets + file);
+    }, sourceHash);
+    if (pack.empty()) {
+        std::cerr << "Couldn't compile " << worldFile << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(assets + packFile, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(pack.data()), (std::streamsize)pack.size());
+    if (!out) {
+        std::cerr << "Couldn't write " << packFile << std::endl;
+        return 1;
+    }
+
+    const LevelPack::Header &header = *reinterpret_cast<const LevelPack::Header *>(pack.data());
+    std::cout << "Wrote " << packFile << ": " << header.regionCount << " regions, "
+              << header.cellCount << " rooms, " << header.entityCount << " entities, "
+              << pack.size() << " bytes" << std::endl;
+    return 0;
+}